@@ -33,10 +33,19 @@
 #include <QCoreApplication>
 
 #include "common/typedef.h"
+#include "decoder/decoderHost.h"
 #include "ui/YUViewApplication.h"
 
 int main(int argc, char *argv[])
 {
+  if (argc > 1 && QString(argv[1]) == DECODER_HOST_ARGUMENT)
+  {
+    // YUView was started as a decoder host by a decoderRemote. Run the decoder without a GUI.
+    QCoreApplication app(argc, argv);
+    YUViewApplication::setApplicationNames();
+    return decoderHost::run(app.arguments().mid(2));
+  }
+
 #if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
   QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling); // DPI support
   QCoreApplication::setAttribute(Qt::AA_UseHighDpiPixmaps); // DPI support
@@ -103,6 +103,22 @@ unsigned int functions::getOptimalThreadCount()
     return 1;
 }
 
+unsigned int functions::getDecoderThreadCount()
+{
+  QSettings settings;
+  settings.beginGroup("Decoders");
+  int nrThreads = getOptimalDecoderThreadCount();
+  if (settings.value("SetNrThreads", false).toBool())
+    nrThreads = settings.value("NrThreads", nrThreads).toInt();
+  settings.endGroup();
+  return (unsigned int)qMax(nrThreads, 1);
+}
+
+unsigned int functions::getOptimalDecoderThreadCount()
+{
+  return (unsigned int)qBound(1, QThread::idealThreadCount() / 4, DECODER_MAX_AUTO_THREADS);
+}
+
 unsigned int functions::systemMemorySizeInMB()
 {
   static unsigned int memorySizeInMB;
@@ -133,7 +149,7 @@ unsigned int functions::systemMemorySizeInMB()
   return memorySizeInMB;
 }
 
-QIcon functions::convertIcon(QString iconPath)
+QIcon functions::convertIcon(QString iconPath, bool mirrored)
 {
   QSettings settings;
   QString themeName = settings.value("Theme", "Default").toString();
@@ -155,7 +171,7 @@ QIcon functions::convertIcon(QString iconPath)
   }
 
   // Color the icon in the active/inactive colors
-  QImage input(iconPath);
+  QImage input = QImage(iconPath).mirrored(mirrored, false);
 
   QImage active(input.size(), input.format());
   QImage inActive(input.size(), input.format());
@@ -100,6 +100,12 @@ void setupUi(void *ui, void(*setupUi)(void *ui, QWidget *widget));
 // so that one thread is "reserved" for the main GUI. I don't know if this is optimal.
 unsigned int getOptimalThreadCount();
 
+// Get the number of threads that each decoder (libde265, dav1d, FFmpeg) may use internally.
+// This is set in the settings or the optimal decoder thread count.
+unsigned int getDecoderThreadCount();
+// A quarter of the ideal thread count (QThread::idealThreadCount()) but at most DECODER_MAX_AUTO_THREADS and at least 1
+unsigned int getOptimalDecoderThreadCount();
+
 // Returns the size of system memory in megabytes.
 // This function is thread safe and inexpensive to call.
 unsigned int systemMemorySizeInMB();
@@ -113,8 +119,8 @@ QString getThemeFileName(QString themeName);
 // #backgroundColor, #activeColor, #inactiveColor, #highlightColor
 // The values to replace them by are returned in this order.
 QStringList getThemeColors(QString themeName);
-// Return the icon/pixmap from the given file path (inverted if necessary)
-QIcon convertIcon(QString iconPath);
+// Return the icon/pixmap from the given file path (inverted if necessary). The image can be mirrored horizontally.
+QIcon convertIcon(QString iconPath, bool mirrored=false);
 QPixmap convertPixmap(QString pixmapPath);
 
 } // namespace functions
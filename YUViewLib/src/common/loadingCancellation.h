@@ -0,0 +1,56 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LOADINGCANCELLATION_H
+#define LOADINGCANCELLATION_H
+
+#include <QAtomicInt>
+
+/* Interactive loading requests can be cancelled if the user already requested another frame (the latest request wins).
+ * The interactive loading thread registers the cancellation flag of the job that it is currently working on. The code
+ * that runs in this thread (decoding, conversion to RGB) checks isCancelled() at safe points and returns early if the
+ * flag is set. The state of the item must stay consistent. The requested frame is just not loaded.
+ * No flag is registered for all other threads (e.g. the caching threads) so their jobs are never cancelled.
+ */
+class loadingCancellation
+{
+public:
+  // Register the flag of the job that the current thread works on (nullptr: the job can not be cancelled)
+  static void setThreadFlag(QAtomicInt *flag) { threadFlag = flag; }
+  // Was the job that the current thread works on cancelled?
+  static bool isCancelled() { return threadFlag != nullptr && threadFlag->load() != 0; }
+
+private:
+  static thread_local QAtomicInt *threadFlag;
+};
+
+#endif // LOADINGCANCELLATION_H
@@ -0,0 +1,153 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pictureHash.h"
+
+#include <QCryptographicHash>
+
+namespace
+{
+  // The CRC of the decoded picture hash is a CRC-16 with the polynomial 0x1021. The reference software processes
+  // one bit at a time and appends 16 zero bits at the end (the augmented form). We process one byte at a time
+  // using a table. This gives the same result if the initial value is adjusted for the 16 zero bits.
+  struct crcTable
+  {
+    crcTable()
+    {
+      for (unsigned int i = 0; i < 256; i++)
+      {
+        unsigned int crc = i << 8;
+        for (int bit = 0; bit < 8; bit++)
+          crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        table[i] = (unsigned short)(crc & 0xffff);
+      }
+
+      // Process 16 zero bits in the augmented form starting at 0xffff
+      unsigned int crc = 0xffff;
+      for (int bit = 0; bit < 16; bit++)
+        crc = ((crc << 1) & 0xffff) ^ (((crc >> 15) & 1) * 0x1021);
+      initValue = (unsigned short)crc;
+    }
+    unsigned short table[256];
+    unsigned short initValue;
+  };
+
+  QByteArray calculateMD5(const unsigned char *src, int stride, int widthInBytes, int height)
+  {
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    for (int y = 0; y < height; y++)
+      hash.addData((const char*)(src + y * stride), widthInBytes);
+    return hash.result();
+  }
+
+  QByteArray calculateCRC(const unsigned char *src, int stride, int widthInBytes, int height)
+  {
+    static const crcTable crc16;
+
+    unsigned int crc = crc16.initValue;
+    for (int y = 0; y < height; y++)
+    {
+      const unsigned char *line = src + y * stride;
+      for (int i = 0; i < widthInBytes; i++)
+        crc = ((crc << 8) ^ crc16.table[((crc >> 8) ^ line[i]) & 0xff]) & 0xffff;
+    }
+
+    QByteArray hash;
+    hash.append(char(crc >> 8));
+    hash.append(char(crc & 0xff));
+    return hash;
+  }
+
+  QByteArray calculateChecksum(const unsigned char *src, int stride, int width, int height, int bytesPerSample)
+  {
+    quint32 checksum = 0;
+    for (int y = 0; y < height; y++)
+    {
+      const unsigned char *line = src + y * stride;
+      const unsigned int maskY = (y & 0xff) ^ (y >> 8);
+      if (bytesPerSample == 1)
+      {
+        for (int x = 0; x < width; x++)
+          checksum += line[x] ^ ((x & 0xff) ^ (x >> 8) ^ maskY);
+      }
+      else
+      {
+        for (int x = 0; x < width; x++)
+        {
+          const unsigned int mask = (x & 0xff) ^ (x >> 8) ^ maskY;
+          checksum += (line[2*x] ^ mask) + (line[2*x+1] ^ mask);
+        }
+      }
+    }
+
+    QByteArray hash;
+    hash.append(char(checksum >> 24));
+    hash.append(char((checksum >> 16) & 0xff));
+    hash.append(char((checksum >> 8) & 0xff));
+    hash.append(char(checksum & 0xff));
+    return hash;
+  }
+}
+
+QString pictureHash::getHashTypeName(hashType type)
+{
+  if (type == hashMD5)
+    return "MD5";
+  if (type == hashCRC)
+    return "CRC";
+  if (type == hashChecksum)
+    return "Checksum";
+  return "Invalid";
+}
+
+int pictureHash::getHashLength(hashType type)
+{
+  if (type == hashMD5)
+    return 16;
+  if (type == hashCRC)
+    return 2;
+  if (type == hashChecksum)
+    return 4;
+  return 0;
+}
+
+QByteArray pictureHash::calculatePlaneHash(hashType type, const unsigned char *src, int stride, int width, int height, int bitDepth)
+{
+  const int bytesPerSample = (bitDepth > 8) ? 2 : 1;
+  if (type == hashMD5)
+    return calculateMD5(src, stride, width * bytesPerSample, height);
+  if (type == hashCRC)
+    return calculateCRC(src, stride, width * bytesPerSample, height);
+  if (type == hashChecksum)
+    return calculateChecksum(src, stride, width, height, bytesPerSample);
+  return QByteArray();
+}
@@ -0,0 +1,70 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PICTUREHASH_H
+#define PICTUREHASH_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+/* The decoded picture hash as it is transmitted in the decoded picture hash SEI of HEVC and VVC.
+ * There is one hash per color component. The hashes are calculated over the decoded sample arrays
+ * exactly like the reference decoders (HM/VTM) do it. Samples with a bit depth above 8 are hashed
+ * as two bytes (little endian).
+ */
+namespace pictureHash
+{
+  enum hashType
+  {
+    hashMD5,
+    hashCRC,
+    hashChecksum,
+    hashInvalid
+  };
+  QString getHashTypeName(hashType type);
+  // The length of the hash of one component in bytes (16 for MD5, 2 for CRC and 4 for the checksum)
+  int getHashLength(hashType type);
+
+  // The hashes of all components of a picture
+  struct pictureHashes
+  {
+    hashType type {hashInvalid};
+    QList<QByteArray> planes;
+  };
+
+  // Calculate the hash of one plane. The samples are stored with one byte (bitDepth <= 8) or two bytes
+  // (little endian) per sample. The stride is given in bytes.
+  QByteArray calculatePlaneHash(hashType type, const unsigned char *src, int stride, int width, int height, int bitDepth);
+}
+
+#endif // PICTUREHASH_H
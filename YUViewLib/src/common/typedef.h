@@ -201,6 +201,26 @@ private:
 // If the zoom factor is >= this value, the statistics values will be drawn alongside the blocks.
 #define STATISTICS_DRAW_VALUES_ZOOM 16
 
+// The number of rasterized statistics layers that are kept per statistics source (e.g. for two views side by side)
+#define STATISTICS_MAX_CACHED_LAYERS 2
+
+// The number of frames that are kept in the statistics cache after they were drawn (in addition to the prefetched frames)
+#define STATISTICS_MAX_RECENT_FRAMES 8
+
+// If the blocks of the statistics are drawn smaller than this (in pixels), aggregated cells of at least this size are
+// drawn instead (level of detail). Vectors are averaged over bigger cells than the values so that they stay readable.
+#define STATISTICS_LOD_VALUE_CELL_SIZE 4
+#define STATISTICS_LOD_VECTOR_CELL_SIZE 8
+
+// By default, each decoder (libde265, dav1d, FFmpeg) uses a quarter of the available cores for its internal threads
+// but not more than this. Every compressed video has an interactive and a caching decoder that can run at the same time.
+#define DECODER_MAX_AUTO_THREADS 8
+
+// When stepping backwards in a compressed video, the decoded frames of the GOP(s) before the current frame are kept
+// so that the next backward steps do not have to decode the GOP again. Each compressed video has two of these windows
+// (interactive and caching decoder) and each one may use this fraction (1/N) of the cache size from the settings.
+#define DECODED_FRAME_WINDOW_CACHE_FRACTION 8
+
 // If this macro is set to true, YUView will try to self update if an update is available.
 // If it is set to false, we will still check for updates, but the update feature is 
 // disabled. Do not set this manually in your own build because the update feature will
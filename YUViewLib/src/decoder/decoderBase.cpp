@@ -52,10 +52,11 @@ using namespace YUView;
 #define DEBUG_DECODERBASE(fmt,...) ((void)0)
 #endif
 
-decoderBase::decoderBase(bool cachingDecoder)
+decoderBase::decoderBase(bool cachingDecoder, int nrThreads)
 {
-  DEBUG_DECODERBASE("decoderBase::decoderBase create base%s", cachingDecoder ? " - caching" : "");
+  DEBUG_DECODERBASE("decoderBase::decoderBase create base%s nrThreads %d", cachingDecoder ? " - caching" : "", nrThreads);
   isCachingDecoder = cachingDecoder;
+  this->nrThreads = qMax(nrThreads, 1);
 
   resetDecoder();
 }
@@ -34,6 +34,7 @@
 #define DECODERBASE_H
 
 #include <QLibrary>
+#include <QSet>
 
 #include "filesource/fileSourceAnnexBFile.h"
 #include "statistics/statisticHandler.h"
@@ -51,7 +52,8 @@ class decoderBase
 {
 public:
   // Create a new decoder. cachingDecoder: Is this a decoder used for caching or interactive decoding?
-  decoderBase(bool cachingDecoder=false);
+  // nrThreads: How many threads may the decoder use internally (if the decoder supports threading)?
+  decoderBase(bool cachingDecoder=false, int nrThreads=1);
   virtual ~decoderBase() {};
 
   // Reset the decoder. Afterwards, the decoder should behave as if you just created a new one (without
@@ -71,6 +73,10 @@ public:
   // Call decodeNextFrame to advance to the next frame. When the function returns false, more data is probably needed.
   virtual bool decodeNextFrame() = 0;
   virtual QByteArray getRawFrameData() = 0;
+  // Get a reference to the current YUV frame in the buffer of the decoder without copying it. The reference stays valid
+  // when the decoder continues decoding. Decoders that can not keep their pictures alive return an invalid reference
+  // and the frame must be retrieved with getRawFrameData (which copies it to a packed buffer).
+  virtual YUV_Internals::yuvPictureRef getRawFrameRef() { return YUV_Internals::yuvPictureRef(); }
   YUView::RawFormat getRawFormat() const { return rawFormat; }
   YUV_Internals::yuvPixelFormat getYUVPixelFormat() const { return formatYUV; }
   RGB_Internals::rgbPixelFormat getRGBPixelFormat() const { return formatRGB; }
@@ -89,6 +95,17 @@ public:
   bool statisticsEnabled() const { return retrieveStatistics; }
   void enableStatisticsRetrieval() { retrieveStatistics = true; }
   statisticsData getStatisticsData(int typeIdx);
+  // Only the statistics with these type IDs are extracted from the bitstream (usually the types that are rendered).
+  // If a type is missing, set the new list, reset the decoder and decode to the current frame again.
+  void setStatisticsTypesToRetrieve(const QSet<int> &typeIDs) { statisticsTypesToRetrieve = typeIDs; }
+  bool isStatisticsTypeRetrieved(int typeID) const { return statisticsTypesToRetrieve.contains(typeID); }
+  // Set this before decoding frames that are only decoded to get to the requested frame (e.g. after a seek).
+  // No statistics are extracted for these frames.
+  void setDecodingPreroll(bool preroll) { decodingPreroll = preroll; }
+  // Only decode random access points and skip all other frames (if the decoder supports this). Set this before
+  // seeking to a random access point of which only the first frame is needed (e.g. while scrubbing).
+  // Afterwards, the decoder must be reset (seek) before decoding other frames.
+  virtual void setDecodeKeyFramesOnly(bool keyFramesOnly) { Q_UNUSED(keyFramesOnly); }
   virtual void fillStatisticList(statisticHandler &statSource) const { Q_UNUSED(statSource); };
 
   // Error handling
@@ -103,6 +120,9 @@ public:
   // If needed, also version information (like HM 16.4)
   virtual QString getDecoderName() const = 0;
   virtual QString getCodecName() = 0;
+
+  // The number of threads that the decoder uses internally
+  int getNrThreads() const { return nrThreads; }
   
 protected:
 
@@ -119,9 +139,12 @@ protected:
   
   int decodeSignal { 0 }; ///< Which signal should be decoded?
   bool isCachingDecoder; ///< Is this the caching or the interactive decoder?
+  int nrThreads;         ///< The number of threads that the decoder may use internally. Decoders without threading set this to 1.
 
   bool internalsSupported { false };  ///< Enable in the constructor if you support statistics
   bool retrieveStatistics { false };  ///< If enabled, the decoder should also retrive statistics data from the bitstream
+  QSet<int> statisticsTypesToRetrieve; ///< Skip all other statistics types when extracting statistics data
+  bool decodingPreroll { false };     ///< The current frame is only decoded to get to the requested frame. Don't extract statistics.
   QSize frameSize;
 
   // Some decoders are able to handel both YUV and RGB output
@@ -144,7 +167,7 @@ protected:
 class decoderBaseSingleLib : public decoderBase
 {
 public:
-  decoderBaseSingleLib(bool cachingDecoder=false) : decoderBase(cachingDecoder) {};
+  decoderBaseSingleLib(bool cachingDecoder=false, int nrThreads=1) : decoderBase(cachingDecoder, nrThreads) {};
   virtual ~decoderBaseSingleLib() {};
 
   QStringList getLibraryPaths() const Q_DECL_OVERRIDE { return QStringList() << getDecoderName() << library.fileName() << library.fileName(); }
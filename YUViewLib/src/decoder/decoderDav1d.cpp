@@ -41,6 +41,7 @@
 #include "common/typedef.h"
 
 using namespace YUView;
+using namespace YUV_Internals;
 
 // Debug the decoder (0:off 1:interactive deocder only 2:caching decoder only 3:both)
 #define DECODERDAV1D_DEBUG_OUTPUT 0
@@ -75,8 +76,8 @@ decoderDav1d_Functions::decoderDav1d_Functions()
   memset(this, 0, sizeof(*this));
 }
 
-decoderDav1d::decoderDav1d(int signalID, bool cachingDecoder) :
-  decoderBaseSingleLib(cachingDecoder)
+decoderDav1d::decoderDav1d(int signalID, bool cachingDecoder, int nrThreads) :
+  decoderBaseSingleLib(cachingDecoder, nrThreads)
 {
   currentOutputBuffer.clear();
 
@@ -106,10 +107,24 @@ decoderDav1d::~decoderDav1d()
 
 void decoderDav1d::resetDecoder()
 {
-  // Delete decoder
   if (!decoder)
     return setError("Resetting the decoder failed. No decoder allocated.");
 
+  if (decodeSignal == openedDecodeSignal && retrieveStatistics == openedWithStatistics)
+  {
+    // The settings that are applied when opening the decoder did not change (e.g. when seeking).
+    // Flushing the decoder is enough. This is much cheaper than closing it and opening a new one.
+    DEBUG_DAV1D("decoderDav1d::resetDecoder - flush decoder");
+    dav1d_flush(decoder);
+    decoderBase::resetDecoder();
+    currentOutputBuffer.clear();
+    decodedFrameWaiting = false;
+    flushing = false;
+    return;
+  }
+
+  // Delete decoder
+
   dav1d_close(&decoder);
   if (decoder != nullptr)
     DEBUG_DAV1D("Error closing the decoder. The close function should set the decoder pointer to NULL");
@@ -137,6 +152,7 @@ void decoderDav1d::resolveLibraryFunctionPointers()
   if (!resolve(dav1d_parse_sequence_header, "dav1d_parse_sequence_header")) return;
   if (!resolve(dav1d_send_data, "dav1d_send_data")) return;
   if (!resolve(dav1d_get_picture, "dav1d_get_picture")) return;
+  if (!resolve(dav1d_picture_unref, "dav1d_picture_unref")) return;
   if (!resolve(dav1d_close, "dav1d_close")) return;
   if (!resolve(dav1d_flush, "dav1d_flush")) return;
 
@@ -181,6 +197,12 @@ void decoderDav1d::allocateNewDecoder()
 
   dav1d_default_settings(&settings);
 
+  // Distribute the threads to tiles and frames. Frame threading adds a delay of one frame per thread
+  // so the interactive decoder (which decodes single frames on demand) only uses tile threads.
+  settings.n_tile_threads = isCachingDecoder ? qMin(nrThreads, 4) : qMin(nrThreads, 64);
+  settings.n_frame_threads = isCachingDecoder ? qMax(nrThreads / settings.n_tile_threads, 1) : 1;
+  DEBUG_DAV1D("decoderDav1d::allocateNewDecoder - %d tile threads %d frame threads", settings.n_tile_threads, settings.n_frame_threads);
+
   // Create new decoder object
   int err = dav1d_open(&decoder, &settings);
   if (err != 0)
@@ -214,6 +236,8 @@ void decoderDav1d::allocateNewDecoder()
     }
     dav1d_set_analyzer_settings(decoder, &analyzerSettings);
   }
+  openedDecodeSignal = decodeSignal;
+  openedWithStatistics = retrieveStatistics;
 
   // The decoder is ready to receive data
   decoderBase::resetDecoder();
@@ -230,12 +254,15 @@ bool decoderDav1d::decodeNextFrame()
     return false;
   }
   if (decodedFrameWaiting)
-  {
     decodedFrameWaiting = false;
-    return true;
-  }
+  else if (!decodeFrame())
+    return false;
 
-  return decodeFrame();
+  if (retrieveStatistics && !decodingPreroll)
+    // Get the statistics from the image and put them into the statistics cache
+    cacheStatistics(curPicture);
+
+  return true;
 }
 
 bool decoderDav1d::decodeFrame()
@@ -243,7 +270,7 @@ bool decoderDav1d::decodeFrame()
   if (decoder == nullptr)
     return false;
 
-  curPicture.clear();
+  curPicture.clear(dav1d_picture_unref);
 
   int res = dav1d_get_picture(decoder, curPicture.getPicture());
   if (res >= 0)
@@ -310,15 +337,71 @@ QByteArray decoderDav1d::getRawFrameData()
     // Put image data into buffer
     copyImgToByteArray(curPicture, currentOutputBuffer);
     DEBUG_DAV1D("decoderDav1d::getRawFrameData copied frame to buffer");
-
-    if (retrieveStatistics)
-      // Get the statistics from the image and put them into the statistics cache
-      cacheStatistics(curPicture);
   }
 
   return currentOutputBuffer;
 }
 
+// Keeps a decoded Dav1dPicture (and with it the picture buffer in dav1d) alive while a yuvPictureRef to it exists.
+class dav1dPictureBuffer : public yuvPictureBuffer
+{
+public:
+  dav1dPictureBuffer(QSharedPointer<Dav1dPicture> picture) : picture(picture) {}
+private:
+  QSharedPointer<Dav1dPicture> picture;
+};
+
+yuvPictureRef decoderDav1d::getRawFrameRef()
+{
+  QSize s = curPicture.getFrameSize();
+  if (s.width() <= 0 || s.height() <= 0)
+  {
+    DEBUG_DAV1D("decoderDav1d::getRawFrameRef: Current picture has invalid size.");
+    return yuvPictureRef();
+  }
+  if (decoderState != decoderRetrieveFrames)
+  {
+    DEBUG_DAV1D("decoderDav1d::getRawFrameRef: Wrong decoder state.");
+    return yuvPictureRef();
+  }
+
+  uint8_t *planes[3];
+  if (!getCurPicturePlanes(planes))
+    return yuvPictureRef();
+
+  QSharedPointer<yuvPictureBuffer> buffer(new dav1dPictureBuffer(curPicture.getSharedPicture()));
+  return yuvPictureRef(buffer, planes[0], int(curPicture.getStride(0)), planes[1], planes[2], int(curPicture.getStride(1)));
+}
+
+void decoderDav1d::Dav1dPictureWrapper::clear(void (*dav1d_picture_unref)(Dav1dPicture*))
+{
+  curPicture.reset(new Dav1dPicture(), [dav1d_picture_unref](Dav1dPicture *picture) {
+    dav1d_picture_unref(picture);
+    delete picture;
+  });
+}
+
+bool decoderDav1d::getCurPicturePlanes(uint8_t *planes[3]) const
+{
+  const int nrPlanes = (curPicture.getSubsampling() == YUV_400) ? 1 : 3;
+  for (int c = 0; c < 3; c++)
+  {
+    planes[c] = nullptr;
+    if (c >= nrPlanes)
+      continue;
+    if (decodeSignal == 0)
+      planes[c] = curPicture.getData(c);
+    else if (decodeSignal == 1)
+      planes[c] = curPicture.getDataPrediction(c);
+    else if (decodeSignal == 2)
+      planes[c] = curPicture.getDataReconstructionPreFiltering(c);
+
+    if (planes[c] == nullptr)
+      return false;
+  }
+  return true;
+}
+
 bool decoderDav1d::pushData(QByteArray &data) 
 {
   if (decoderState != decoderNeedsMoreData)
@@ -724,6 +807,14 @@ void decoderDav1d::cacheStatistics(const Dav1dPictureWrapper &img)
   dav1dFrameInfo frameInfo(img.getFrameSize(), frameHeader->frame_type);
   frameInfo.frameSize = img.getFrameSize();
 
+  // Only extract the statistics types that are retrieved (rendered). Checking these once per block is
+  // much cheaper than filling all the statistics types.
+  frameInfo.retrieveType.resize(nrStatisticsTypes);
+  for (int t = 0; t < nrStatisticsTypes; t++)
+    frameInfo.retrieveType.setBit(t, isStatisticsTypeRetrieved(t));
+  if (frameInfo.retrieveType.count(true) == 0)
+    return;
+
   const int sb_step = subBlockSize >> 2;
 
   for (int y = 0; y < frameInfo.frameSizeAligned.height(); y += sb_step)
@@ -845,38 +936,51 @@ void decoderDav1d::parseBlockPartition(Av1Block *blockData, int x, int y, int bl
   // Set prediction mode (ID 0)
   const bool isIntra = (b.intra != 0);
   const int predMode = isIntra ? 0 : 1;
-  curPOCStats[0].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, predMode);
+  if (frameInfo.retrieveType[0])
+    curPOCStats[0].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, predMode);
 
   bool FrameIsIntra = (frameInfo.frameType == DAV1D_FRAME_TYPE_KEY || frameInfo.frameType == DAV1D_FRAME_TYPE_INTRA);
   if (FrameIsIntra)
   {
     // Set the segment ID (ID 1)
-    curPOCStats[1].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.seg_id);
+    if (frameInfo.retrieveType[1])
+      curPOCStats[1].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.seg_id);
   }
 
   // Set the skip "flag" (ID 2)
-  curPOCStats[2].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.skip);
+  if (frameInfo.retrieveType[2])
+    curPOCStats[2].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.skip);
 
   // Set the skip_mode (ID 3)
-  curPOCStats[3].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.skip_mode);
+  if (frameInfo.retrieveType[3])
+    curPOCStats[3].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.skip_mode);
 
   if (isIntra)
   {
     // Set the intra pred mode luma/chrmoa (ID 4, 5)
-    curPOCStats[4].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.y_mode);
-    curPOCStats[5].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.uv_mode);
+    if (frameInfo.retrieveType[4])
+      curPOCStats[4].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.y_mode);
+    if (frameInfo.retrieveType[5])
+      curPOCStats[5].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.uv_mode);
 
     // Set the palette size Y/UV (ID 6, 7)
-    curPOCStats[6].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.pal_sz[0]);
-    curPOCStats[7].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.pal_sz[1]);
+    if (frameInfo.retrieveType[6])
+      curPOCStats[6].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.pal_sz[0]);
+    if (frameInfo.retrieveType[7])
+      curPOCStats[7].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.pal_sz[1]);
 
     // Set the intra angle delta luma/chroma (ID 8, 9)
-    curPOCStats[8].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.y_angle);
-    curPOCStats[9].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.uv_angle);
+    if (frameInfo.retrieveType[8])
+      curPOCStats[8].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.y_angle);
+    if (frameInfo.retrieveType[9])
+      curPOCStats[9].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.uv_angle);
 
     // Calculate and set the intra prediction direction luma/chroma (ID 10, 11)
     for (int yc=0; yc<2; yc++)
     {
+      if (!frameInfo.retrieveType[10 + yc])
+        continue;
+
       int angleDelta = (yc == 0) ? b.y_angle : b.uv_angle;
       IntraPredMode predMode = (yc == 0) ? (IntraPredMode)b.y_mode : (IntraPredMode)b.uv_mode;
       QIntPair vec = calculateIntraPredDirection(predMode, angleDelta);
@@ -893,8 +997,10 @@ void decoderDav1d::parseBlockPartition(Av1Block *blockData, int x, int y, int bl
     if (b.y_mode == CFL_PRED)
     {
       // Set the chroma from luma alpha U/V (ID 12, 13)
-      curPOCStats[12].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.cfl_alpha[0]);
-      curPOCStats[13].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.cfl_alpha[1]);
+      if (frameInfo.retrieveType[12])
+        curPOCStats[12].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.cfl_alpha[0]);
+      if (frameInfo.retrieveType[13])
+        curPOCStats[13].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.cfl_alpha[1]);
     }
   }
   else // inter
@@ -903,45 +1009,56 @@ void decoderDav1d::parseBlockPartition(Av1Block *blockData, int x, int y, int bl
     bool isCompound = (compoundType != COMP_INTER_NONE);
 
     // Set the reference frame indices 0/1 (ID 14, 15)
-    curPOCStats[14].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.ref[0]);
-    if (isCompound)
+    if (frameInfo.retrieveType[14])
+      curPOCStats[14].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.ref[0]);
+    if (isCompound && frameInfo.retrieveType[15])
       curPOCStats[15].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.ref[1]);
 
     // Set the compound prediction type (ID 16)
-    curPOCStats[16].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.comp_type);
+    if (frameInfo.retrieveType[16])
+      curPOCStats[16].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.comp_type);
 
     // Set the wedge index (ID 17)
-    if (b.comp_type == COMP_INTER_WEDGE || b.interintra_type == INTER_INTRA_WEDGE)
+    if ((b.comp_type == COMP_INTER_WEDGE || b.interintra_type == INTER_INTRA_WEDGE) && frameInfo.retrieveType[17])
       curPOCStats[17].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.wedge_idx);
 
     // Set the mask sign (ID 18)
-    if (isCompound) // TODO: This might not be correct
+    if (isCompound && frameInfo.retrieveType[18]) // TODO: This might not be correct
       curPOCStats[18].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.mask_sign);
 
     // Set the inter mode (ID 19)
-    curPOCStats[19].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.inter_mode);
+    if (frameInfo.retrieveType[19])
+      curPOCStats[19].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.inter_mode);
 
     // Set the dynamic reference list index (ID 20)
-    if (isCompound) // TODO: This might not be correct
+    if (isCompound && frameInfo.retrieveType[20]) // TODO: This might not be correct
       curPOCStats[20].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.drl_idx);
 
     if (isCompound)
     {
       // Set inter intra type (ID 21)
-      curPOCStats[21].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.interintra_type);
+      if (frameInfo.retrieveType[21])
+        curPOCStats[21].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.interintra_type);
       // Set inter intra mode (ID 22)
-      curPOCStats[22].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.interintra_mode);
+      if (frameInfo.retrieveType[22])
+        curPOCStats[22].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.interintra_mode);
     }
 
     // Set motion mode (ID 23)
-    curPOCStats[23].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.motion_mode);
+    if (frameInfo.retrieveType[23])
+      curPOCStats[23].addBlockValue(cbPosX, cbPosY, cbWidth, cbHeight, b.motion_mode);
 
     // Set motion vector 0/1 (ID 24, 25)
-    curPOCStats[24].addBlockVector(cbPosX, cbPosY, cbWidth, cbHeight, b.mv[0].x, b.mv[0].y);
-    if (isCompound)
+    if (frameInfo.retrieveType[24])
+      curPOCStats[24].addBlockVector(cbPosX, cbPosY, cbWidth, cbHeight, b.mv[0].x, b.mv[0].y);
+    if (isCompound && frameInfo.retrieveType[25])
       curPOCStats[25].addBlockVector(cbPosX, cbPosY, cbWidth, cbHeight, b.mv[1].x, b.mv[1].y);
   }
 
+  // Set the transform size (ID 26)
+  if (!frameInfo.retrieveType[26])
+    return;
+
   const TxfmSize tx_val = TxfmSize(isIntra ? b.tx : b.max_ytx);
   static const int TxfmSizeWidthTable[] = {4, 8, 16, 32, 64, 4, 8, 8, 16, 16, 32, 32, 64, 4, 16, 8, 32, 16, 64};
   static const int TxfmSizeHeightTable[] = { 4, 8, 16, 32, 64, 8, 4, 16, 8, 32, 16, 64, 32, 16, 4, 32, 8, 64, 16};
@@ -33,7 +33,9 @@
 #ifndef DECODERDAV1D_H
 #define DECODERDAV1D_H
 
+#include <QBitArray>
 #include <QLibrary>
+#include <QSharedPointer>
 
 #include "decoderBase.h"
 #include "externalHeader/dav1d/dav1d.h"
@@ -50,6 +52,7 @@ struct decoderDav1d_Functions
   int         (*dav1d_parse_sequence_header) (Dav1dSequenceHeader*, const uint8_t*, const size_t);
   int         (*dav1d_send_data)             (Dav1dContext*, Dav1dData*);
   int         (*dav1d_get_picture)           (Dav1dContext*, Dav1dPicture*);
+  void        (*dav1d_picture_unref)         (Dav1dPicture*);
   void        (*dav1d_close)                 (Dav1dContext**);
   void        (*dav1d_flush)                 (Dav1dContext*);
 
@@ -64,7 +67,7 @@ struct decoderDav1d_Functions
 class decoderDav1d : public decoderBaseSingleLib, public decoderDav1d_Functions 
 {
 public:
-  decoderDav1d(int signalID, bool cachingDecoder=false);
+  decoderDav1d(int signalID, bool cachingDecoder=false, int nrThreads=1);
   ~decoderDav1d();
 
   void resetDecoder() Q_DECL_OVERRIDE;
@@ -77,6 +80,7 @@ public:
   // Decoding / pushing data
   bool decodeNextFrame() Q_DECL_OVERRIDE;
   QByteArray getRawFrameData() Q_DECL_OVERRIDE;
+  YUV_Internals::yuvPictureRef getRawFrameRef() Q_DECL_OVERRIDE;
   bool pushData(QByteArray &data) Q_DECL_OVERRIDE;
 
   // Check if the given library file is an existing libde265 decoder that we can use.
@@ -106,6 +110,9 @@ private:
   Dav1dContext *decoder {nullptr};
   Dav1dSettings settings;
   Dav1dAnalyzerFlags analyzerSettings;
+  // The decoder was opened with these settings. If they did not change, resetDecoder only flushes the decoder.
+  int openedDecodeSignal {-1};
+  bool openedWithStatistics {false};
 
   int nrSignals {1};
   bool flushing {false};
@@ -123,31 +130,37 @@ private:
   class Dav1dPictureWrapper
   {
   public:
-    Dav1dPictureWrapper() {}
+    Dav1dPictureWrapper() : curPicture(new Dav1dPicture()) {}
 
     void setInternalsSupported() { internalsSupported = true;  }
 
-    void clear() { memset(&curPicture, 0, sizeof(Dav1dPicture)); }
-    QSize getFrameSize() const { return QSize(curPicture.p.w, curPicture.p.h); }
-    Dav1dPicture *getPicture() const { return (Dav1dPicture*)(&curPicture); }
-    YUVSubsamplingType getSubsampling() const { return decoderDav1d::convertFromInternalSubsampling(curPicture.p.layout); }
-    int getBitDepth() const { return curPicture.p.bpc; }
-    uint8_t *getData(int component) const { return (uint8_t*)curPicture.data[component]; }
-    ptrdiff_t getStride(int component) const { return curPicture.stride[component]; }
-    uint8_t *getDataPrediction(int component) const { return internalsSupported ? (uint8_t*)curPicture.pred[component] : nullptr; }
-    uint8_t *getDataReconstructionPreFiltering(int component) const { return internalsSupported ? (uint8_t*)curPicture.pre_lpf[component] : nullptr; }
-    Av1Block *getBlockData() const { return internalsSupported ? reinterpret_cast<Av1Block*>(curPicture.blk_data) : nullptr; }
-
-    Dav1dSequenceHeader *getSequenceHeader() const { return curPicture.seq_hdr; }
-    Dav1dFrameHeader *getFrameHeader() const { return curPicture.frame_hdr; }
+    // Start over with a new (empty) picture. The reference to the previous picture is released (dav1d_picture_unref)
+    // when the last copy of the shared picture is gone. References to it (getRawFrameRef) stay valid until then.
+    void clear(void (*dav1d_picture_unref)(Dav1dPicture*));
+    QSize getFrameSize() const { return QSize(curPicture->p.w, curPicture->p.h); }
+    Dav1dPicture *getPicture() const { return curPicture.data(); }
+    QSharedPointer<Dav1dPicture> getSharedPicture() const { return curPicture; }
+    YUVSubsamplingType getSubsampling() const { return decoderDav1d::convertFromInternalSubsampling(curPicture->p.layout); }
+    int getBitDepth() const { return curPicture->p.bpc; }
+    uint8_t *getData(int component) const { return (uint8_t*)curPicture->data[component]; }
+    ptrdiff_t getStride(int component) const { return curPicture->stride[component]; }
+    uint8_t *getDataPrediction(int component) const { return internalsSupported ? (uint8_t*)curPicture->pred[component] : nullptr; }
+    uint8_t *getDataReconstructionPreFiltering(int component) const { return internalsSupported ? (uint8_t*)curPicture->pre_lpf[component] : nullptr; }
+    Av1Block *getBlockData() const { return internalsSupported ? reinterpret_cast<Av1Block*>(curPicture->blk_data) : nullptr; }
+
+    Dav1dSequenceHeader *getSequenceHeader() const { return curPicture->seq_hdr; }
+    Dav1dFrameHeader *getFrameHeader() const { return curPicture->frame_hdr; }
     
   private:
-    Dav1dPicture curPicture;
+    QSharedPointer<Dav1dPicture> curPicture;
     bool internalsSupported {false};
   };
 
   Dav1dPictureWrapper curPicture;
 
+  // Get the planes of the current picture for the selected signal (reconstruction, prediction, ...)
+  bool getCurPicturePlanes(uint8_t *planes[3]) const;
+
   // We buffer the current image as a QByteArray so you can call getYUVFrameData as often as necessary
   // without invoking the copy operation from the libde265 buffer to the QByteArray again.
 #if SSE_CONVERSION
@@ -167,9 +180,11 @@ private:
     QSize sizeInBlocksAligned;
     int b4_stride;
     Dav1dFrameType frameType;
+    QBitArray retrieveType;  // Which statistics types (by ID) should be extracted
   };
 
   // Statistics
+  static const int nrStatisticsTypes = 27;
   void fillStatisticList(statisticHandler &statSource) const Q_DECL_OVERRIDE;
   void cacheStatistics(const Dav1dPictureWrapper &img);
   void parseBlockRecursive(Av1Block *blockData, int x, int y, BlockLevel level, dav1dFrameInfo &frameInfo);
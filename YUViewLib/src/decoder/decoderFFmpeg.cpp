@@ -44,8 +44,8 @@ using namespace YUView;
 using namespace YUV_Internals;
 using namespace RGB_Internals;
 
-decoderFFmpeg::decoderFFmpeg(AVCodecIDWrapper codecID, QSize size, QByteArray extradata, yuvPixelFormat fmt, QPair<int,int> profileLevel, QPair<int,int> sampleAspectRatio, bool cachingDecoder) : 
-  decoderBase(cachingDecoder)
+decoderFFmpeg::decoderFFmpeg(AVCodecIDWrapper codecID, QSize size, QByteArray extradata, yuvPixelFormat fmt, QPair<int,int> profileLevel, QPair<int,int> sampleAspectRatio, bool cachingDecoder, int nrThreads) : 
+  decoderBase(cachingDecoder, nrThreads)
 {
   // The libraries are only loaded on demand. This way a FFmpegLibraries instance can exist without loading 
   // the libraries which is slow and uses a lot of memory.
@@ -85,8 +85,8 @@ decoderFFmpeg::decoderFFmpeg(AVCodecIDWrapper codecID, QSize size, QByteArray ex
   DEBUG_FFMPEG("Created new FFmpeg decoder - codec %s%s", this->getCodecName(), cachingDecoder ? " - caching" : "");
 }
 
-decoderFFmpeg::decoderFFmpeg(AVCodecParametersWrapper codecpar, bool cachingDecoder) :
-  decoderBase(cachingDecoder)
+decoderFFmpeg::decoderFFmpeg(AVCodecParametersWrapper codecpar, bool cachingDecoder, int nrThreads) :
+  decoderBase(cachingDecoder, nrThreads)
 {
   // The libraries are only loaded on demand. This way a FFmpegLibraries instance can exist without loading 
   // the libraries which is slow and uses a lot of memory.
@@ -125,6 +125,16 @@ void decoderFFmpeg::resetDecoder()
   flushing = false;
 }
 
+void decoderFFmpeg::setDecodeKeyFramesOnly(bool keyFramesOnly)
+{
+  if (!decCtx)
+    return;
+
+  DEBUG_FFMPEG("decoderFFmpeg::setDecodeKeyFramesOnly %d", keyFramesOnly);
+  if (ff.set_skip_frame(decCtx, keyFramesOnly ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT) < 0)
+    DEBUG_FFMPEG("decoderFFmpeg::setDecodeKeyFramesOnly Setting skip_frame failed");
+}
+
 bool decoderFFmpeg::decodeNextFrame()
 {
   if (decoderState != decoderRetrieveFrames)
@@ -138,9 +148,9 @@ bool decoderFFmpeg::decodeNextFrame()
   if (!decodeFrame())
     return false;
 
-  copyCurImageToBuffer();
+  currentOutputBuffer.clear();
   
-  if (retrieveStatistics)
+  if (retrieveStatistics && !decodingPreroll)
     // Get the statistics from the image and put them into the statistics cache
     cacheCurStatistics();
 
@@ -155,14 +165,47 @@ QByteArray decoderFFmpeg::getRawFrameData()
     return QByteArray();
   }
 
-  DEBUG_FFMPEG("decoderFFmpeg::getYUVFrameData Copy frame");
-
   if (currentOutputBuffer.isEmpty())
-    DEBUG_FFMPEG("decoderFFmpeg::loadYUVFrameData empty buffer");
+  {
+    DEBUG_FFMPEG("decoderFFmpeg::getYUVFrameData Copy frame");
+    copyCurImageToBuffer();
+  }
 
   return currentOutputBuffer;
 }
 
+// Holds a reference to the buffers of a decoded AVFrame (av_frame_clone) until the last yuvPictureRef to it is gone.
+// The FFmpeg libraries are never unloaded once they were loaded successfully so av_frame_free stays valid.
+class AVFrameRefBuffer : public yuvPictureBuffer
+{
+public:
+  AVFrameRefBuffer(AVFrame *frame, void (*av_frame_free)(AVFrame **frame)) : frame(frame), av_frame_free(av_frame_free) {}
+  virtual ~AVFrameRefBuffer() { av_frame_free(&frame); }
+private:
+  AVFrame *frame;
+  void (*av_frame_free)(AVFrame **frame);
+};
+
+yuvPictureRef decoderFFmpeg::getRawFrameRef()
+{
+  if (decoderState != decoderRetrieveFrames || !frame || rawFormat != raw_YUV)
+    return yuvPictureRef();
+
+  const yuvPixelFormat pixFmt = getYUVPixelFormat();
+  if (!pixFmt.planar || pixFmt.uvInterleaved || ff.lib.av_frame_clone == nullptr)
+    return yuvPictureRef();
+
+  AVFrame *clone = ff.lib.av_frame_clone(frame.get_frame());
+  if (clone == nullptr)
+    return yuvPictureRef();
+
+  DEBUG_FFMPEG("decoderFFmpeg::getRawFrameRef Reference frame");
+  QSharedPointer<yuvPictureBuffer> buffer(new AVFrameRefBuffer(clone, ff.lib.av_frame_free));
+  const bool hasChroma = (pixFmt.subsampling != YUV_400);
+  return yuvPictureRef(buffer, frame.get_data(0), frame.get_line_size(0), 
+                       hasChroma ? frame.get_data(1) : nullptr, hasChroma ? frame.get_data(2) : nullptr, frame.get_line_size(1));
+}
+
 void decoderFFmpeg::copyCurImageToBuffer()
 {
   if (!frame)
@@ -277,6 +320,13 @@ void decoderFFmpeg::cacheCurStatistics()
   // Clear the local statistics cache
   curPOCStats.clear();
 
+  // Only get the types that are retrieved (rendered)
+  bool retrieveType[4];
+  for (int t = 0; t < 4; t++)
+    retrieveType[t] = isStatisticsTypeRetrieved(t);
+  if (!retrieveType[0] && !retrieveType[1] && !retrieveType[2] && !retrieveType[3])
+    return;
+
   // Try to get the motion information
   AVFrameSideDataWrapper sd = ff.get_side_data(frame, AV_FRAME_DATA_MOTION_VECTORS);
   if (sd)
@@ -292,8 +342,12 @@ void decoderFFmpeg::cacheCurStatistics()
       const int16_t mvX = mvs.dst_x - mvs.src_x;
       const int16_t mvY = mvs.dst_y - mvs.src_y;
 
-      curPOCStats[mvs.source < 0 ? 0 : 1].addBlockValue(blockX, blockY, mvs.w, mvs.h, (int)mvs.source);
-      curPOCStats[mvs.source < 0 ? 2 : 3].addBlockVector(blockX, blockY, mvs.w, mvs.h, mvX, mvY);
+      const int valueTypeID = mvs.source < 0 ? 0 : 1;
+      const int vectorTypeID = mvs.source < 0 ? 2 : 3;
+      if (retrieveType[valueTypeID])
+        curPOCStats[valueTypeID].addBlockValue(blockX, blockY, mvs.w, mvs.h, (int)mvs.source);
+      if (retrieveType[vectorTypeID])
+        curPOCStats[vectorTypeID].addBlockVector(blockX, blockY, mvs.w, mvs.h, mvX, mvY);
     }
   }
 }
@@ -470,6 +524,14 @@ bool decoderFFmpeg::createDecoder(AVCodecIDWrapper codecID, AVCodecParametersWra
   if (ret < 0)
     return setErrorB(QStringLiteral("Could not request motion vector retrieval. Return code %1").arg(ret));
 
+  // Set the number of threads. Frame threading adds a delay of one frame per thread so the interactive
+  // decoder (which decodes single frames on demand) only uses slice threads.
+  ret = ff.av_dict_set(opts, "threads", QByteArray::number(nrThreads).constData(), 0);
+  if (ret >= 0)
+    ret = ff.av_dict_set(opts, "thread_type", isCachingDecoder ? "frame+slice" : "slice", 0);
+  if (ret < 0)
+    return setErrorB(QStringLiteral("Could not set the number of decoder threads. Return code %1").arg(ret));
+
   // Open codec
   ret = ff.avcodec_open2(decCtx, videoCodec, opts);
   if (ret < 0)
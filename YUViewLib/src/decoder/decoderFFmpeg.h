@@ -39,15 +39,17 @@
 class decoderFFmpeg : public decoderBase
 {
 public:
-  decoderFFmpeg(AVCodecIDWrapper codec, QSize frameSize, QByteArray extradata, yuvPixelFormat fmt, QPair<int,int> profileLevel, QPair<int,int> sampleAspectRatio, bool cachingDecoder=false);
-  decoderFFmpeg(AVCodecParametersWrapper codecpar, bool cachingDecoder=false);
+  decoderFFmpeg(AVCodecIDWrapper codec, QSize frameSize, QByteArray extradata, yuvPixelFormat fmt, QPair<int,int> profileLevel, QPair<int,int> sampleAspectRatio, bool cachingDecoder=false, int nrThreads=1);
+  decoderFFmpeg(AVCodecParametersWrapper codecpar, bool cachingDecoder=false, int nrThreads=1);
   ~decoderFFmpeg();
 
   void resetDecoder() Q_DECL_OVERRIDE;
+  void setDecodeKeyFramesOnly(bool keyFramesOnly) Q_DECL_OVERRIDE;
 
   // Decoding / pushing data
   bool decodeNextFrame() Q_DECL_OVERRIDE;
   QByteArray getRawFrameData() Q_DECL_OVERRIDE;
+  YUV_Internals::yuvPictureRef getRawFrameRef() Q_DECL_OVERRIDE;
   
   // Push an AVPacket or raw data. When this returns false, pushing the given packet failed. Probably the 
   // decoder switched to decoderRetrieveFrames. Don't forget to push the given packet again later.
@@ -79,6 +81,7 @@ protected:
   // Statistics caching
   void cacheCurStatistics();
 
+  // Only filled on request (getRawFrameData). Planar YUV frames are handed out by reference (getRawFrameRef).
   QByteArray currentOutputBuffer;
   void copyCurImageToBuffer();   // Copy the raw data from the de265_image source *src to the byte array
 
@@ -305,7 +305,7 @@ QByteArray decoderHM::getRawFrameData()
     copyImgToByteArray(currentHMPic, currentOutputBuffer);
     DEBUG_DECHM("decoderHM::getRawFrameData copied frame to buffer");
 
-    if (retrieveStatistics)
+    if (retrieveStatistics && !decodingPreroll)
       // Get the statistics from the image and put them into the statistics cache
       cacheStatistics(currentHMPic);
   }
@@ -424,11 +424,13 @@ void decoderHM::cacheStatistics(libHMDec_picture *img)
     {-32, 32} 
   };
 
-  // Get all the statistics
-  // TODO: Could we only retrieve the statistics that are active/displayed?
+  // Get the statistics that are retrieved (rendered)
   unsigned int nrTypes = libHMDEC_get_internal_type_number();
   for (unsigned int t = 0; t <= nrTypes; t++)
   {
+    if (!isStatisticsTypeRetrieved(t))
+      continue;
+
     bool callAgain;
     do
     {
@@ -439,14 +441,21 @@ void decoderHM::cacheStatistics(libHMDec_picture *img)
       libHMDec_InternalsType statType = libHMDEC_get_internal_type(t);
       if (stats != nullptr && nrValues > 0)
       {
+        // The number of blocks is known. Reserve the space in the arrays once.
+        statisticsData &data = curPOCStats[t];
+        if (statType == LIBHMDEC_TYPE_VECTOR || statType == LIBHMDEC_TYPE_INTRA_DIR)
+          data.vectorData.reserve(data.vectorData.size() + nrValues);
+        if (statType != LIBHMDEC_TYPE_VECTOR)
+          data.valueData.reserve(data.valueData.size() + nrValues);
+
         for (unsigned int i = 0; i < nrValues; i++)
         {
           libHMDec_BlockValue b = stats[i];
 
           if (statType == LIBHMDEC_TYPE_VECTOR)
-            curPOCStats[t].addBlockVector(b.x, b.y, b.w, b.h, b.value, b.value2);
+            data.addBlockVector(b.x, b.y, b.w, b.h, b.value, b.value2);
           else
-            curPOCStats[t].addBlockValue(b.x, b.y, b.w, b.h, b.value);
+            data.addBlockValue(b.x, b.y, b.w, b.h, b.value);
           if (statType == LIBHMDEC_TYPE_INTRA_DIR)
           {
             // Also add the vecotr to draw
@@ -454,7 +463,7 @@ void decoderHM::cacheStatistics(libHMDec_picture *img)
             {
               int vecX = (float)vectorTable[b.value][0] * b.w / 4;
               int vecY = (float)vectorTable[b.value][1] * b.w / 4;
-              curPOCStats[t].addBlockVector(b.x, b.y, b.w, b.h, vecX, vecY);
+              data.addBlockVector(b.x, b.y, b.w, b.h, vecX, vecY);
             }
           }
         }
@@ -0,0 +1,221 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "decoderHost.h"
+
+#include <QDataStream>
+
+#include "decoder/decoderDav1d.h"
+#include "decoder/decoderHM.h"
+#include "decoder/decoderLibde265.h"
+#include "decoder/decoderVTM.h"
+
+using namespace YUView;
+using namespace decoderHostProtocol;
+
+#define DECODERHOST_DEBUG_OUTPUT 0
+#if DECODERHOST_DEBUG_OUTPUT && !NDEBUG
+#include <QDebug>
+#define DEBUG_DECODERHOST qDebug
+#else
+#define DEBUG_DECODERHOST(fmt,...) ((void)0)
+#endif
+
+bool decoderHostProtocol::writeMessage(QLocalSocket &socket, const QByteArray &message, int timeout)
+{
+  QByteArray data;
+  QDataStream stream(&data, QIODevice::WriteOnly);
+  stream << message;
+  if (socket.write(data) != data.size())
+    return false;
+  while (socket.bytesToWrite() > 0)
+    if (!socket.waitForBytesWritten(timeout))
+      return false;
+  return true;
+}
+
+bool decoderHostProtocol::readMessage(QLocalSocket &socket, QByteArray &message, int timeout)
+{
+  // The message is serialized as a QByteArray (the length as quint32 followed by the data)
+  while (socket.bytesAvailable() < (qint64)sizeof(quint32))
+    if (!socket.waitForReadyRead(timeout))
+      return false;
+
+  quint32 length;
+  QDataStream lengthStream(socket.read(sizeof(quint32)));
+  lengthStream >> length;
+  if (length == 0xFFFFFFFF)
+  {
+    // A null QByteArray
+    message.clear();
+    return true;
+  }
+
+  while (socket.bytesAvailable() < (qint64)length)
+    if (!socket.waitForReadyRead(timeout))
+      return false;
+  message = socket.read(length);
+  return true;
+}
+
+int decoderHost::run(const QStringList &args)
+{
+  if (args.size() != 4)
+    return 1;
+
+  DEBUG_DECODERHOST("decoderHost::run Connecting to %s", args[0].toLatin1().data());
+  QLocalSocket socket;
+  socket.connectToServer(args[0]);
+  if (!socket.waitForConnected(DECODER_HOST_TIMEOUT))
+    return 1;
+
+  decoderHost host(decoderEngine(args[1].toInt()), args[2].toInt(), args[3].toInt());
+  host.serverName = args[0];
+
+  // Process requests until the connection is closed (or the YUView process is gone)
+  QByteArray request;
+  while (readMessage(socket, request, -1))
+  {
+    QByteArray reply;
+    const bool goOn = host.processRequest(request, reply);
+    if (!writeMessage(socket, reply, DECODER_HOST_TIMEOUT))
+      return 1;
+    if (!goOn)
+      break;
+  }
+
+  DEBUG_DECODERHOST("decoderHost::run Quit");
+  return 0;
+}
+
+decoderHost::decoderHost(decoderEngine engine, int signalID, int nrThreads)
+{
+  // The host always decodes for caching
+  if (engine == decoderEngineLibde265)
+    decoder.reset(new decoderLibde265(signalID, true, nrThreads));
+  else if (engine == decoderEngineHM)
+    decoder.reset(new decoderHM(signalID, true));
+  else if (engine == decoderEngineVTM)
+    decoder.reset(new decoderVTM(signalID, true));
+  else if (engine == decoderEngineDav1d)
+    decoder.reset(new decoderDav1d(signalID, true, nrThreads));
+}
+
+bool decoderHost::processRequest(const QByteArray &request, QByteArray &reply)
+{
+  QDataStream in(request);
+  qint32 cmd;
+  in >> cmd;
+
+  QDataStream out(&reply, QIODevice::WriteOnly);
+  if (decoder.isNull())
+  {
+    out << qint32(stateError) << QString("The decoder engine can not run in a separate process.") << QSize() << qint32(raw_Invalid) << QString();
+    return cmd != cmdQuit;
+  }
+
+  DEBUG_DECODERHOST("decoderHost::processRequest command %d", cmd);
+  if (cmd == cmdGetInfo)
+  {
+    writeState(out);
+    out << decoder->getSignalNames() << decoder->getDecoderName() << decoder->getCodecName() << decoder->getLibraryPaths() << qint32(decoder->getNrThreads());
+  }
+  else if (cmd == cmdResetDecoder)
+  {
+    decoder->resetDecoder();
+    writeState(out);
+  }
+  else if (cmd == cmdPushData)
+  {
+    QByteArray data;
+    in >> data;
+    const bool result = decoder->pushData(data);
+    writeState(out);
+    out << result;
+  }
+  else if (cmd == cmdDecodeNextFrame)
+  {
+    const bool result = decoder->decodeNextFrame();
+    writeState(out);
+    out << result;
+  }
+  else if (cmd == cmdGetRawFrameData)
+  {
+    const QByteArray data = decoder->getRawFrameData();
+    const bool result = writeFrameToSharedMemory(data);
+    writeState(out);
+    out << result << frameMemory.key() << qint32(data.size());
+  }
+  else if (cmd == cmdQuit)
+  {
+    writeState(out);
+    return false;
+  }
+  return true;
+}
+
+void decoderHost::writeState(QDataStream &stream) const
+{
+  state s = stateEndOfBitstream;
+  if (decoder->errorInDecoder())
+    s = stateError;
+  else if (decoder->needsMoreData())
+    s = stateNeedsMoreData;
+  else if (decoder->decodeFrames())
+    s = stateRetrieveFrames;
+
+  stream << qint32(s) << decoder->decoderErrorString();
+  stream << decoder->getFrameSize() << qint32(decoder->getRawFormat()) << decoder->getYUVPixelFormat().getName();
+}
+
+bool decoderHost::writeFrameToSharedMemory(const QByteArray &data)
+{
+  if (data.isEmpty())
+    return false;
+
+  if (!frameMemory.isAttached() || frameMemory.size() < data.size())
+  {
+    // Create a new (larger) segment. The client attaches to it when it sees the new key.
+    if (frameMemory.isAttached())
+      frameMemory.detach();
+    frameMemory.setKey(QString("%1_frame%2").arg(serverName).arg(frameMemoryCounter++));
+    if (!frameMemory.create(data.size()))
+    {
+      DEBUG_DECODERHOST("decoderHost::writeFrameToSharedMemory Error creating shared memory %s", frameMemory.errorString().toLatin1().data());
+      return false;
+    }
+  }
+
+  // The client only reads the segment after it received the reply. No locking is needed.
+  memcpy(frameMemory.data(), data.constData(), data.size());
+  return true;
+}
@@ -0,0 +1,100 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DECODERHOST_H
+#define DECODERHOST_H
+
+#include <QLocalSocket>
+#include <QScopedPointer>
+#include <QSharedMemory>
+#include <QStringList>
+
+#include "decoder/decoderBase.h"
+
+// Start YUView with this argument (followed by the arguments of decoderHost::run) to run it as a decoder host
+#define DECODER_HOST_ARGUMENT "-decoderHost"
+// How long to wait for the decoder host to connect/answer (ms)
+#define DECODER_HOST_TIMEOUT 30000
+
+// The protocol between decoderRemote and decoderHost. Each message is prefixed with its length.
+// The requests start with the command. The replies start with the state of the decoder (see decoderHost::writeState).
+namespace decoderHostProtocol
+{
+  enum command
+  {
+    cmdGetInfo,         ///< Get the names, library paths and the supported signals
+    cmdResetDecoder,
+    cmdPushData,
+    cmdDecodeNextFrame,
+    cmdGetRawFrameData, ///< The frame is written to shared memory. The reply contains its key and size.
+    cmdQuit
+  };
+  enum state
+  {
+    stateNeedsMoreData,
+    stateRetrieveFrames,
+    stateEndOfBitstream,
+    stateError
+  };
+
+  bool writeMessage(QLocalSocket &socket, const QByteArray &message, int timeout);
+  bool readMessage(QLocalSocket &socket, QByteArray &message, int timeout);
+}
+
+/* The decoder host runs one of the external decoder libraries (HM, VTM, libde265 or dav1d) in a separate YUView
+ * process without a GUI. It connects to the local server of a decoderRemote in the main YUView process and processes
+ * the requests one at a time. The decoded frames are written to a shared memory segment. If the decoder library
+ * crashes, only the host process is gone.
+ */
+class decoderHost
+{
+public:
+  // Run the host. The arguments are: the name of the local server, the decoder engine, the signal to decode and
+  // the number of threads. Returns when the connection is closed. The return value is the exit code of the process.
+  static int run(const QStringList &args);
+
+private:
+  decoderHost(YUView::decoderEngine engine, int signalID, int nrThreads);
+
+  // Process the request and write the reply. Returns false if the host should quit.
+  bool processRequest(const QByteArray &request, QByteArray &reply);
+  void writeState(QDataStream &stream) const;
+  // Copy the frame into the shared memory (a new segment is created if the current one is too small)
+  bool writeFrameToSharedMemory(const QByteArray &data);
+
+  QScopedPointer<decoderBase> decoder;
+  QString serverName;
+  QSharedMemory frameMemory;
+  int frameMemoryCounter {0};
+};
+
+#endif // DECODERHOST_H
@@ -61,8 +61,8 @@ decoderLibde265_Functions::decoderLibde265_Functions()
   memset(this, 0, sizeof(*this)); 
 }
 
-decoderLibde265::decoderLibde265(int signalID, bool cachingDecoder) :
-  decoderBaseSingleLib(cachingDecoder)
+decoderLibde265::decoderLibde265(int signalID, bool cachingDecoder, int nrThreads) :
+  decoderBaseSingleLib(cachingDecoder, nrThreads)
 {
   currentOutputBuffer.clear();
 
@@ -91,6 +91,20 @@ void decoderLibde265::resetDecoder()
   if (!decoder)
     return;
 
+  if (de265_reset && decodeSignal == allocatedDecodeSignal)
+  {
+    // The decoded signal did not change (e.g. when seeking). Resetting the decoder is enough. This is much
+    // cheaper than freeing it and allocating a new one. The worker threads and all settings are kept.
+    DEBUG_LIBDE265("decoderLibde265::resetDecoder - reset decoder");
+    de265_reset(decoder);
+    decoderBase::resetDecoder();
+    currentOutputBuffer.clear();
+    decodedFrameWaiting = false;
+    flushing = false;
+    curImage = nullptr;
+    return;
+  }
+
   // Delete decoder
   de265_error err = de265_free_decoder(decoder);
   if (err != DE265_OK)
@@ -137,6 +151,9 @@ void decoderLibde265::resolveLibraryFunctionPointers()
   if (!resolve(de265_free_decoder, "de265_free_decoder")) return;
   DEBUG_LIBDE265("decoderLibde265::resolveLibraryFunctionPointers - decoding functions found");
 
+  // Older versions of the library can not be reset. The decoder is freed and allocated again in this case.
+  resolve(de265_reset, "de265_reset", true);
+
   // Get pointers to the internals/statistics functions (if present)
   // If not, disable the statistics extraction. Normal decoding of the video will still work.
 
@@ -221,10 +238,10 @@ void decoderLibde265::allocateNewDecoder()
   de265_set_limit_TID(decoder, 100);
 
   // Set the number of decoder threads. Libde265 can use wavefronts to utilize these.
-  // TODO: We should add a setting for this maybe?
-  de265_error err = de265_start_worker_threads(decoder, 8);
+  de265_error err = de265_start_worker_threads(decoder, nrThreads);
   if (err != DE265_OK)
     return setError("Error starting libde265 worker threads (de265_start_worker_threads)");
+  allocatedDecodeSignal = decodeSignal;
 
   // The decoder is ready to receive data
   decoderBase::resetDecoder();
@@ -330,7 +347,7 @@ QByteArray decoderLibde265::getRawFrameData()
     copyImgToByteArray(curImage, currentOutputBuffer);
     DEBUG_LIBDE265("decoderLibde265::getRawFrameData copied frame to buffer");
     
-    if (retrieveStatistics)
+    if (retrieveStatistics && !decodingPreroll)
       // Get the statistics from the image and put them into the statistics cache
       cacheStatistics(curImage);
   }
@@ -462,9 +479,11 @@ void decoderLibde265::cacheStatistics(const de265_image *img)
   int ctb_size = 1 << log2CTBSize;  // width and height of each CTB
 
   // Save Slice index
+  if (isStatisticsTypeRetrieved(0))
   {
     QScopedArrayPointer<uint16_t> tmpArr(new uint16_t[ widthInCTB * heightInCTB ]);
     de265_internals_get_CTB_sliceIdx(img, tmpArr.data());
+    curPOCStats[0].valueData.reserve(widthInCTB * heightInCTB);
     for (int y = 0; y < heightInCTB; y++)
       for (int x = 0; x < widthInCTB; x++)
       {
@@ -473,6 +492,21 @@ void decoderLibde265::cacheStatistics(const de265_image *img)
       }
   }
 
+  // Only get the internals from the decoder that are needed for the retrieved (rendered) statistics types.
+  // Everything below is organized in coding blocks (ID 1 to 11).
+  bool retrieveType[12];
+  bool retrieveAnyCBType = false;
+  for (int t = 1; t < 12; t++)
+  {
+    retrieveType[t] = isStatisticsTypeRetrieved(t);
+    retrieveAnyCBType |= retrieveType[t];
+  }
+  if (!retrieveAnyCBType)
+    return;
+  const bool retrievePBInfo = retrieveType[5] || retrieveType[6] || retrieveType[7] || retrieveType[8];
+  const bool retrieveIntraDirInfo = retrieveType[9] || retrieveType[10];
+  const bool retrieveTUInfo = retrieveIntraDirInfo || retrieveType[11];
+
   /// --- CB internals/statistics (part Size, prediction mode, PCM flag, CU trans_quant_bypass_flag)
 
   // TODO: How do we get the POC in here? / Should the decoder not be able to tell us the POC?
@@ -498,7 +532,8 @@ void decoderLibde265::cacheStatistics(const de265_image *img)
   QScopedArrayPointer<int16_t> vec0_y(new int16_t[widthInPB*heightInPB]);
   QScopedArrayPointer<int16_t> vec1_x(new int16_t[widthInPB*heightInPB]);
   QScopedArrayPointer<int16_t> vec1_y(new int16_t[widthInPB*heightInPB]);
-  de265_internals_get_PB_info(img, refPOC0.data(), refPOC1.data(), vec0_x.data(), vec0_y.data(), vec1_x.data(), vec1_y.data());
+  if (retrievePBInfo)
+    de265_internals_get_PB_info(img, refPOC0.data(), refPOC1.data(), vec0_x.data(), vec0_y.data(), vec1_x.data(), vec1_y.data());
 
   // Get intra prediction mode (intra direction) layout from image
   int widthInIntraDirUnits, heightInIntraDirUnits, log2IntraDirUnitsSize;
@@ -508,7 +543,8 @@ void decoderLibde265::cacheStatistics(const de265_image *img)
   // Get intra prediction mode (intra direction) from image
   QScopedArrayPointer<uint8_t> intraDirY(new uint8_t[widthInIntraDirUnits*heightInIntraDirUnits]);
   QScopedArrayPointer<uint8_t> intraDirC(new uint8_t[widthInIntraDirUnits*heightInIntraDirUnits]);
-  de265_internals_get_intraDir_info(img, intraDirY.data(), intraDirC.data());
+  if (retrieveIntraDirInfo)
+    de265_internals_get_intraDir_info(img, intraDirY.data(), intraDirC.data());
 
   // Get TU info array layout
   int widthInTUInfoUnits, heightInTUInfoUnits, log2TUInfoUnitSize;
@@ -517,7 +553,8 @@ void decoderLibde265::cacheStatistics(const de265_image *img)
 
   // Get TU info
   QScopedArrayPointer<uint8_t> tuInfo(new uint8_t[widthInTUInfoUnits*heightInTUInfoUnits]);
-  de265_internals_get_TUInfo_info(img, tuInfo.data());
+  if (retrieveTUInfo)
+    de265_internals_get_TUInfo_info(img, tuInfo.data());
 
   for (int y = 0; y < heightInCB; y++)
   {
@@ -540,18 +577,22 @@ void decoderLibde265::cacheStatistics(const de265_image *img)
         bool    tqBypass = (val & 512);        // Next bit (TransQuant bypass flag)
 
                                                // Set part mode (ID 1)
-        curPOCStats[1].addBlockValue(cbPosX, cbPosY, cbSizePix, cbSizePix, partMode);
+        if (retrieveType[1])
+          curPOCStats[1].addBlockValue(cbPosX, cbPosY, cbSizePix, cbSizePix, partMode);
 
         // Set prediction mode (ID 2)
-        curPOCStats[2].addBlockValue(cbPosX, cbPosY, cbSizePix, cbSizePix, predMode);
+        if (retrieveType[2])
+          curPOCStats[2].addBlockValue(cbPosX, cbPosY, cbSizePix, cbSizePix, predMode);
 
         // Set PCM flag (ID 3)
-        curPOCStats[3].addBlockValue(cbPosX, cbPosY, cbSizePix, cbSizePix, pcmFlag);
+        if (retrieveType[3])
+          curPOCStats[3].addBlockValue(cbPosX, cbPosY, cbSizePix, cbSizePix, pcmFlag);
 
         // Set transQuant bypass flag (ID 4)
-        curPOCStats[4].addBlockValue(cbPosX, cbPosY, cbSizePix, cbSizePix, tqBypass);
+        if (retrieveType[4])
+          curPOCStats[4].addBlockValue(cbPosX, cbPosY, cbSizePix, cbSizePix, tqBypass);
 
-        if (predMode != 0)
+        if (predMode != 0 && retrievePBInfo)
         {
           // For each of the prediction blocks set some info
 
@@ -569,27 +610,30 @@ void decoderLibde265::cacheStatistics(const de265_image *img)
 
             // Add ref index 0 (ID 5)
             int16_t ref0 = refPOC0[pbIdx];
-            if (ref0 != -1)
+            if (ref0 != -1 && retrieveType[5])
               curPOCStats[5].addBlockValue(pbX, pbY, pbW, pbH, ref0-iPOC);
 
             // Add ref index 1 (ID 6)
             int16_t ref1 = refPOC1[pbIdx];
-            if (ref1 != -1)
+            if (ref1 != -1 && retrieveType[6])
               curPOCStats[6].addBlockValue(pbX, pbY, pbW, pbH, ref1-iPOC);
 
             // Add motion vector 0 (ID 7)
-            if (ref0 != -1)
+            if (ref0 != -1 && retrieveType[7])
               curPOCStats[7].addBlockVector(pbX, pbY, pbW, pbH, vec0_x[pbIdx], vec0_y[pbIdx]);
 
             // Add motion vector 1 (ID 8)
-            if (ref1 != -1)
+            if (ref1 != -1 && retrieveType[8])
               curPOCStats[8].addBlockVector(pbX, pbY, pbW, pbH, vec1_x[pbIdx], vec1_y[pbIdx]);
           }
         }
 
         // Walk into the TU tree
-        int tuIdx = (cbPosY / tuInfo_unit_size) * widthInTUInfoUnits + (cbPosX / tuInfo_unit_size);
-        cacheStatistics_TUTree_recursive(tuInfo.data(), widthInTUInfoUnits, tuInfo_unit_size, iPOC, tuIdx, cbSizePix / tuInfo_unit_size, 0, predMode == 0, intraDirY.data(), intraDirC.data(), intraDir_infoUnit_size, widthInIntraDirUnits);
+        if (retrieveTUInfo)
+        {
+          int tuIdx = (cbPosY / tuInfo_unit_size) * widthInTUInfoUnits + (cbPosX / tuInfo_unit_size);
+          cacheStatistics_TUTree_recursive(tuInfo.data(), widthInTUInfoUnits, tuInfo_unit_size, iPOC, tuIdx, cbSizePix / tuInfo_unit_size, 0, predMode == 0 && retrieveIntraDirInfo, intraDirY.data(), intraDirC.data(), intraDir_infoUnit_size, widthInIntraDirUnits);
+        }
       }
     }
   }
@@ -684,7 +728,8 @@ void decoderLibde265::cacheStatistics_TUTree_recursive(uint8_t *const tuInfo, in
     int tuWidth = tuWidth_units * tuUnitSizePix;
     int posX = tuIdx % tuInfoWidth * tuUnitSizePix;
     int posY = tuIdx / tuInfoWidth * tuUnitSizePix;
-    curPOCStats[11].addBlockValue(posX, posY, tuWidth, tuWidth, trDepth);
+    if (isStatisticsTypeRetrieved(11))
+      curPOCStats[11].addBlockValue(posX, posY, tuWidth, tuWidth, trDepth);
 
     if (isIntra)
     {
@@ -711,7 +756,7 @@ void decoderLibde265::cacheStatistics_TUTree_recursive(uint8_t *const tuInfo, in
 
       // Set Intra prediction direction Luma (ID 9)
       int intraDirLuma = intraDirY[intraDirIdx];
-      if (intraDirLuma <= 34)
+      if (intraDirLuma <= 34 && isStatisticsTypeRetrieved(9))
       {
         curPOCStats[9].addBlockValue(posX, posY, tuWidth, tuWidth, intraDirLuma);
 
@@ -726,7 +771,7 @@ void decoderLibde265::cacheStatistics_TUTree_recursive(uint8_t *const tuInfo, in
 
       // Set Intra prediction direction Chroma (ID 10)
       int intraDirChroma = intraDirC[intraDirIdx];
-      if (intraDirChroma <= 34)
+      if (intraDirChroma <= 34 && isStatisticsTypeRetrieved(10))
       {
         curPOCStats[10].addBlockValue(posX, posY, tuWidth, tuWidth, intraDirChroma);
 
@@ -63,6 +63,7 @@ struct decoderLibde265_Functions
   de265_error            (*de265_flush_data)           (de265_decoder_context*);
   const de265_image*     (*de265_get_next_picture)     (de265_decoder_context*);
   de265_error            (*de265_free_decoder)         (de265_decoder_context*);
+  void                   (*de265_reset)                (de265_decoder_context*);
 
   // libde265 decoder library function pointers for internals
   void (*de265_internals_get_CTB_Info_Layout)		   (const de265_image*, int*, int*, int*);
@@ -85,7 +86,7 @@ struct decoderLibde265_Functions
 class decoderLibde265 : public decoderBaseSingleLib, public decoderLibde265_Functions 
 {
 public:
-  decoderLibde265(int signalID, bool cachingDecoder=false);
+  decoderLibde265(int signalID, bool cachingDecoder=false, int nrThreads=1);
   ~decoderLibde265();
 
   void resetDecoder() Q_DECL_OVERRIDE;
@@ -128,6 +129,8 @@ private:
   void allocateNewDecoder();
 
   de265_decoder_context* decoder {nullptr};
+  // The signal that the decoder was allocated for. If it did not change, resetDecoder only resets the decoder.
+  int allocatedDecodeSignal {-1};
 
   int nrSignals {1};
   bool flushing {false};
@@ -0,0 +1,334 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "decoderRemote.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QProcess>
+
+#include "common/functions.h"
+#include "decoder/decoderHost.h"
+
+using namespace YUView;
+using namespace decoderHostProtocol;
+
+// Debug the decoder (0:off 1:on)
+#define DECODERREMOTE_DEBUG_OUTPUT 0
+#if DECODERREMOTE_DEBUG_OUTPUT && !NDEBUG
+#include <QDebug>
+#define DEBUG_DECODERREMOTE qDebug
+#else
+#define DEBUG_DECODERREMOTE(fmt,...) ((void)0)
+#endif
+
+/// ------------------------ decoderRemoteConnection ------------------------
+
+// Starts the host process and performs the requests. This object lives in the connection thread of the decoderRemote.
+class decoderRemoteConnection : public QObject
+{
+  Q_OBJECT
+public:
+  decoderRemoteConnection() : QObject(nullptr) {}
+  QString getErrorString() const { return errorString; }
+public slots:
+  bool start(int engine, int signalID, int nrThreads);
+  QByteArray request(const QByteArray &message);
+  void stop();
+private:
+  QScopedPointer<QLocalServer> server;
+  QScopedPointer<QProcess> process;
+  QLocalSocket *socket {nullptr};
+  QString errorString;
+  static QAtomicInt serverCounter;
+};
+
+QAtomicInt decoderRemoteConnection::serverCounter(0);
+
+bool decoderRemoteConnection::start(int engine, int signalID, int nrThreads)
+{
+  // Listen on a new local server and start the host. The host connects to the server.
+  const QString serverName = QString("YUViewDecoder_%1_%2").arg(QCoreApplication::applicationPid()).arg(serverCounter.fetchAndAddOrdered(1));
+  server.reset(new QLocalServer);
+  if (!server->listen(serverName))
+  {
+    errorString = "Error listening for the decoder process: " + server->errorString();
+    return false;
+  }
+
+  DEBUG_DECODERREMOTE("decoderRemoteConnection::start starting host for server %s", serverName.toLatin1().data());
+  QStringList args;
+  args << DECODER_HOST_ARGUMENT << serverName << QString::number(engine) << QString::number(signalID) << QString::number(nrThreads);
+  process.reset(new QProcess);
+  process->setProcessChannelMode(QProcess::ForwardedChannels);
+  process->start(QCoreApplication::applicationFilePath(), args);
+  if (!process->waitForStarted(DECODER_HOST_TIMEOUT))
+  {
+    errorString = "Error starting the decoder process: " + process->errorString();
+    return false;
+  }
+
+  if (!server->waitForNewConnection(DECODER_HOST_TIMEOUT))
+  {
+    errorString = "The decoder process did not connect.";
+    return false;
+  }
+  socket = server->nextPendingConnection();
+  return true;
+}
+
+QByteArray decoderRemoteConnection::request(const QByteArray &message)
+{
+  QByteArray reply;
+  if (!socket)
+  {
+    // Starting the host failed. The errorString says why.
+    if (errorString.isEmpty())
+      errorString = "The decoder process is not running.";
+    return QByteArray();
+  }
+  if (!writeMessage(*socket, message, DECODER_HOST_TIMEOUT) || !readMessage(*socket, reply, DECODER_HOST_TIMEOUT))
+  {
+    errorString = "The connection to the decoder process was lost. The decoder process may have crashed.";
+    if (process && process->state() == QProcess::NotRunning && process->exitStatus() == QProcess::CrashExit)
+      errorString = "The decoder process crashed.";
+    return QByteArray();
+  }
+  return reply;
+}
+
+void decoderRemoteConnection::stop()
+{
+  if (socket && socket->state() == QLocalSocket::ConnectedState)
+  {
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    stream << qint32(cmdQuit);
+    request(message);
+  }
+  if (process && !process->waitForFinished(1000))
+    process->kill();
+  process.reset();
+  server.reset();
+  socket = nullptr;
+}
+
+/// ------------------------ decoderRemote ------------------------
+
+decoderRemote::decoderRemote(decoderEngine engine, int signalID, bool cachingDecoder, int nrThreads) :
+  decoderBase(cachingDecoder, nrThreads)
+{
+  decodeSignal = signalID;
+  decoderName = functions::getDecoderEngineName(engine);
+
+  connection = new decoderRemoteConnection;
+  connection->moveToThread(&connectionThread);
+  connectionThread.start();
+
+  // Starting the host may take a while (up to two timeouts if it does not start). Don't wait for it here.
+  // All requests are queued in the connection thread after the start so they are only performed once the host is connected.
+  QMetaObject::invokeMethod(connection, "start", Qt::QueuedConnection, Q_ARG(int, int(engine)), Q_ARG(int, signalID), Q_ARG(int, nrThreads));
+}
+
+decoderRemote::~decoderRemote()
+{
+  QMetaObject::invokeMethod(connection, "stop", Qt::BlockingQueuedConnection);
+  connectionThread.quit();
+  connectionThread.wait();
+  delete connection;
+}
+
+bool decoderRemote::isEngineSupported(decoderEngine engine)
+{
+  // FFmpeg is not a research decoder and the FFmpeg decoder is created from the demuxer of the file
+  return engine == decoderEngineLibde265 || engine == decoderEngineHM || engine == decoderEngineVTM || engine == decoderEngineDav1d;
+}
+
+QStringList decoderRemote::getSignalNames() const
+{
+  QMutexLocker locker(&infoMutex);
+  return signalNames;
+}
+
+QStringList decoderRemote::getLibraryPaths() const
+{
+  QMutexLocker locker(&infoMutex);
+  return libraryPaths;
+}
+
+QString decoderRemote::getDecoderName() const
+{
+  QMutexLocker locker(&infoMutex);
+  return decoderName;
+}
+
+QString decoderRemote::getCodecName()
+{
+  QMutexLocker locker(&infoMutex);
+  return codecName;
+}
+
+bool decoderRemote::sendRequest(const QByteArray &request, QByteArray &reply)
+{
+  if (!infoReceived)
+  {
+    // Get the information about the decoder in the host
+    infoReceived = true;
+    QByteArray infoRequest, infoReply;
+    QDataStream infoRequestStream(&infoRequest, QIODevice::WriteOnly);
+    infoRequestStream << qint32(cmdGetInfo);
+    if (!sendRequestToHost(infoRequest, infoReply) || errorInDecoder())
+      return false;
+    QDataStream infoReplyStream(infoReply);
+    QMutexLocker locker(&infoMutex);
+    qint32 threads;
+    infoReplyStream >> signalNames >> decoderName >> codecName >> libraryPaths >> threads;
+    DEBUG_DECODERREMOTE("decoderRemote::sendRequest Decoder %s running in separate process with %d threads", decoderName.toLatin1().data(), threads);
+  }
+  return sendRequestToHost(request, reply);
+}
+
+bool decoderRemote::sendRequestToHost(const QByteArray &request, QByteArray &reply)
+{
+  QMetaObject::invokeMethod(connection, "request", Qt::BlockingQueuedConnection, Q_RETURN_ARG(QByteArray, reply), Q_ARG(QByteArray, request));
+  if (reply.isEmpty())
+  {
+    // The host is gone. Release the shared memory. The segment is freed when nobody is attached to it anymore.
+    if (frameMemory.isAttached())
+      frameMemory.detach();
+    return setErrorB(connection->getErrorString());
+  }
+
+  QDataStream replyStream(reply);
+
+  qint32 state, raw;
+  QString error, formatName;
+  replyStream >> state >> error >> frameSize >> raw >> formatName;
+  rawFormat = RawFormat(raw);
+  formatYUV = YUV_Internals::yuvPixelFormat(formatName);
+  if (state == stateNeedsMoreData)
+    decoderState = decoderNeedsMoreData;
+  else if (state == stateRetrieveFrames)
+    decoderState = decoderRetrieveFrames;
+  else if (state == stateEndOfBitstream)
+    decoderState = decoderEndOfBitstream;
+  else
+    setError(error);
+
+  // Only return the command specific part of the reply
+  reply = reply.mid(replyStream.device()->pos());
+  return true;
+}
+
+void decoderRemote::resetDecoder()
+{
+  if (errorInDecoder())
+    return;
+
+  DEBUG_DECODERREMOTE("decoderRemote::resetDecoder");
+  QByteArray request, reply;
+  QDataStream requestStream(&request, QIODevice::WriteOnly);
+  requestStream << qint32(cmdResetDecoder);
+  sendRequest(request, reply);
+}
+
+bool decoderRemote::pushData(QByteArray &data)
+{
+  if (errorInDecoder())
+    return false;
+
+  QByteArray request, reply;
+  QDataStream requestStream(&request, QIODevice::WriteOnly);
+  requestStream << qint32(cmdPushData) << data;
+  if (!sendRequest(request, reply))
+    return false;
+  QDataStream replyStream(reply);
+  bool result;
+  replyStream >> result;
+  return result;
+}
+
+bool decoderRemote::decodeNextFrame()
+{
+  if (errorInDecoder())
+    return false;
+
+  QByteArray request, reply;
+  QDataStream requestStream(&request, QIODevice::WriteOnly);
+  requestStream << qint32(cmdDecodeNextFrame);
+  if (!sendRequest(request, reply))
+    return false;
+  QDataStream replyStream(reply);
+  bool result;
+  replyStream >> result;
+  return result;
+}
+
+QByteArray decoderRemote::getRawFrameData()
+{
+  if (errorInDecoder())
+    return QByteArray();
+
+  QByteArray request, reply;
+  QDataStream requestStream(&request, QIODevice::WriteOnly);
+  requestStream << qint32(cmdGetRawFrameData);
+  if (!sendRequest(request, reply))
+    return QByteArray();
+  QDataStream replyStream(reply);
+  bool result;
+  QString key;
+  qint32 size;
+  replyStream >> result >> key >> size;
+  if (!result)
+    return QByteArray();
+
+  // The host creates a new segment if the frames get larger
+  if (frameMemory.key() != key)
+  {
+    if (frameMemory.isAttached())
+      frameMemory.detach();
+    frameMemory.setKey(key);
+  }
+  if (!frameMemory.isAttached() && !frameMemory.attach(QSharedMemory::ReadOnly))
+  {
+    setError("Error attaching to the shared memory of the decoder process: " + frameMemory.errorString());
+    return QByteArray();
+  }
+  if (frameMemory.size() < size)
+    return QByteArray();
+
+  return QByteArray((const char*)frameMemory.constData(), size);
+}
+
+#include "decoderRemote.moc"
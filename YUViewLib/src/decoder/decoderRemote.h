@@ -0,0 +1,99 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DECODERREMOTE_H
+#define DECODERREMOTE_H
+
+#include <QMutex>
+#include <QSharedMemory>
+#include <QThread>
+
+#include "decoder/decoderBase.h"
+
+class decoderRemoteConnection;
+
+/* This decoder runs one of the external decoder libraries (HM, VTM, libde265 or dav1d) in a separate process.
+ * YUView is started again as a headless decoder host (see decoderHost) which loads the library and decodes.
+ * The requests are sent over a local socket and the decoded frames are read from shared memory. If the decoder
+ * library crashes, only the host process is gone and this decoder goes to the error state.
+ * The host is started in the background so that creating the decoder does not block. The first request waits until
+ * the host is connected. Until then, the information about the decoder (name, signals...) is not known yet.
+ * Statistics and references to the decoded pictures (getRawFrameRef) are not supported so this is used for caching.
+ */
+class decoderRemote : public decoderBase
+{
+public:
+  decoderRemote(YUView::decoderEngine engine, int signalID, bool cachingDecoder=false, int nrThreads=1);
+  ~decoderRemote();
+
+  // Can the decoders of this engine run in a separate process?
+  static bool isEngineSupported(YUView::decoderEngine engine);
+
+  void resetDecoder() Q_DECL_OVERRIDE;
+
+  int nrSignalsSupported() const Q_DECL_OVERRIDE { return getSignalNames().size(); }
+  QStringList getSignalNames() const Q_DECL_OVERRIDE;
+
+  // Decoding / pushing data
+  bool decodeNextFrame() Q_DECL_OVERRIDE;
+  QByteArray getRawFrameData() Q_DECL_OVERRIDE;
+  bool pushData(QByteArray &data) Q_DECL_OVERRIDE;
+
+  QStringList getLibraryPaths() const Q_DECL_OVERRIDE;
+  QString getDecoderName() const Q_DECL_OVERRIDE;
+  QString getCodecName() Q_DECL_OVERRIDE;
+
+private:
+  // Send the request to the host and read the state of the decoder from the reply. The rest of the reply
+  // is returned in reply. Returns false if the host could not be reached (e.g. because it crashed).
+  // Before the first request, the information about the decoder is requested from the host.
+  bool sendRequest(const QByteArray &request, QByteArray &reply);
+  bool sendRequestToHost(const QByteArray &request, QByteArray &reply);
+  bool infoReceived {false};
+
+  // The connection to the host lives in its own thread. The decoder is used from different threads (the caching
+  // threads) but the local socket may only be used from the thread that it was created in.
+  QThread connectionThread;
+  decoderRemoteConnection *connection {nullptr};
+
+  // The decoded frames are read from this shared memory segment
+  QSharedMemory frameMemory;
+
+  // The information is received from the host in the thread that sends the first request. It is read from the GUI thread.
+  mutable QMutex infoMutex;
+  QStringList signalNames {"Reconstruction"};
+  QString decoderName;
+  QString codecName;
+  QStringList libraryPaths;
+};
+
+#endif // DECODERREMOTE_H
@@ -307,7 +307,7 @@ QByteArray decoderVTM::getRawFrameData()
     copyImgToByteArray(currentVTMPic, currentOutputBuffer);
     DEBUG_DECVTM("decoderVTM::getRawFrameData copied frame to buffer");
 
-    if (retrieveStatistics)
+    if (retrieveStatistics && !decodingPreroll)
       // Get the statistics from the image and put them into the statistics cache
       cacheStatistics(currentVTMPic);
   }
@@ -421,11 +421,13 @@ void decoderVTM::cacheStatistics(libVTMDec_picture *img)
     {-32, 32} 
   };
 
-  //// Get all the statistics
-  //// TODO: Could we only retrieve the statistics that are active/displayed?
+  //// Get the statistics that are retrieved (rendered)
   //unsigned int nrTypes = libVTMDec_get_internal_type_number();
   //for (unsigned int t = 0; t <= nrTypes; t++)
   //{
+  //  if (!isStatisticsTypeRetrieved(t))
+  //    continue;
+  //
   //  bool callAgain;
   //  do
   //  {
@@ -869,6 +869,7 @@ FFmpegLibraryFunctions::FFmpegLibraryFunctions()
 
   av_frame_alloc = nullptr;
   av_frame_free = nullptr;
+  av_frame_clone = nullptr;
   av_mallocz = nullptr;
   avutil_version = nullptr;
 
@@ -918,10 +919,12 @@ bool FFmpegLibraryFunctions::bindFunctionsFromAVUtilLib()
 {
   if (!resolveAvUtil(av_frame_alloc, "av_frame_alloc")) return false;
   if (!resolveAvUtil(av_frame_free, "av_frame_free")) return false;
+  if (!resolveAvUtil(av_frame_clone, "av_frame_clone")) return false;
   if (!resolveAvUtil(av_mallocz, "av_mallocz")) return false;
   if (!resolveAvUtil(avutil_version, "avutil_version")) return false;
   if (!resolveAvUtil(av_dict_set, "av_dict_set")) return false;
   if (!resolveAvUtil(av_dict_get, "av_dict_get")) return false;
+  if (!resolveAvUtil(av_opt_set_int, "av_opt_set_int")) return false;
   if (!resolveAvUtil(av_frame_get_side_data, "av_frame_get_side_data")) return false;
   if (!resolveAvUtil(av_frame_get_metadata, "av_frame_get_metadata")) return false;
   if (!resolveAvUtil(av_log_set_callback, "av_log_set_callback")) return false;
@@ -3130,33 +3133,32 @@ bool AVPacketWrapper::checkForObuFormat(QByteArray &data)
     int posInData = 0;
     while (posInData + 2 <= data.length())
     {
-      parserCommon::sub_byte_reader reader(data, posInData);
+      parserCommon::fast_bit_reader reader(data, posInData);
 
-      QString bitsRead;
-      bool obu_forbidden_bit = (reader.readBits(1, bitsRead) != 0);
-      unsigned int obu_type = reader.readBits(4, bitsRead); // obu_type
+      bool obu_forbidden_bit = (reader.readBits(1) != 0);
+      unsigned int obu_type = reader.readBits(4); // obu_type
       if (obu_type == 0 || (obu_type >= 9 && obu_type <= 14))
         // RESERVED obu types should not occur (highly unlikely)
         return false;
-      bool obu_extension_flag = (reader.readBits(1, bitsRead) != 0);
-      bool obu_has_size_field = (reader.readBits(1, bitsRead) != 0);
-      bool obu_reserved_1bit = (reader.readBits(1, bitsRead) != 0);
+      bool obu_extension_flag = (reader.readBits(1) != 0);
+      bool obu_has_size_field = (reader.readBits(1) != 0);
+      bool obu_reserved_1bit = (reader.readBits(1) != 0);
 
       if (obu_forbidden_bit || obu_reserved_1bit)
         return false;
       if (obu_extension_flag)
       {
-        reader.readBits(3, bitsRead); // temporal_id
-        reader.readBits(2, bitsRead); // spatial_id
-        unsigned int extension_header_reserved_3bits = reader.readBits(3, bitsRead);
+        reader.readBits(3); // temporal_id
+        reader.readBits(2); // spatial_id
+        unsigned int extension_header_reserved_3bits = reader.readBits(3);
         if (extension_header_reserved_3bits != 0)
           return false;
       }
       unsigned int obu_size;
       if (obu_has_size_field)
       {
-        int bitCount;
-        obu_size = reader.readLeb128(bitsRead, bitCount);
+        int bitCount = 0;
+        obu_size = reader.readLeb128(bitCount);
       }
       else
       {
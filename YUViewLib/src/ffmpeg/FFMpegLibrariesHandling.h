@@ -95,10 +95,12 @@ public:
   // From avutil
   AVFrame                  *(*av_frame_alloc)         (void);
   void                      (*av_frame_free)          (AVFrame **frame);
+  AVFrame                  *(*av_frame_clone)         (const AVFrame *src);
   void                     *(*av_mallocz)             (size_t size);
   unsigned                  (*avutil_version)         (void);
   int                       (*av_dict_set)            (AVDictionary **pm, const char *key, const char *value, int flags);
   AVDictionaryEntry        *(*av_dict_get)            (AVDictionary *m, const char *key, const AVDictionaryEntry *prev, int flags);
+  int                       (*av_opt_set_int)         (void *obj, const char *name, int64_t val, int search_flags);
   AVFrameSideData          *(*av_frame_get_side_data) (const AVFrame *frame, AVFrameSideDataType type);
   AVDictionary             *(*av_frame_get_metadata)  (const AVFrame *frame);
   void 	                    (*av_log_set_callback)    (void(*callback)(void *, int, const char *, va_list));
@@ -815,6 +817,8 @@ public:
   int getFrameFromDecoder(AVCodecContextWrapper & decCtx, AVFrameWrapper &frame);
 
   void flush_buffers(AVCodecContextWrapper &decCtx) { lib.avcodec_flush_buffers(decCtx.get_codec()); }
+  // Set which frames the decoder skips (AVCodecContext::skip_frame). This can be changed while decoding.
+  int set_skip_frame(AVCodecContextWrapper &decCtx, AVDiscard discard) { return lib.av_opt_set_int(decCtx.get_codec(), "skip_frame", discard, 0); }
 
   FFmpegLibraryVersion libVersion;
 
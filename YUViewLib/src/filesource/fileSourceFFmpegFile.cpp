@@ -153,16 +153,15 @@ QByteArray fileSourceFFmpegFile::getNextUnit(bool getLastDataAgain, uint64_t *pt
   }
   else if (packetDataFormat == packetFormatOBU)
   {
-    parserCommon::sub_byte_reader reader(currentPacketData, posInData);
+    parserCommon::fast_bit_reader reader(currentPacketData, posInData);
 
     try
     {
-      QString bitsRead;
-      bool obu_forbidden_bit = (reader.readBits(1, bitsRead) != 0);
-      reader.readBits(4, bitsRead); // obu_type
-      bool obu_extension_flag = (reader.readBits(1, bitsRead) != 0);
-      bool obu_has_size_field = (reader.readBits(1, bitsRead) != 0);
-      bool obu_reserved_1bit = (reader.readBits(1, bitsRead) != 0);
+      bool obu_forbidden_bit = (reader.readBits(1) != 0);
+      reader.readBits(4); // obu_type
+      bool obu_extension_flag = (reader.readBits(1) != 0);
+      bool obu_has_size_field = (reader.readBits(1) != 0);
+      bool obu_reserved_1bit = (reader.readBits(1) != 0);
 
       if (obu_forbidden_bit || obu_reserved_1bit)
       {
@@ -171,9 +170,9 @@ QByteArray fileSourceFFmpegFile::getNextUnit(bool getLastDataAgain, uint64_t *pt
       }
       if (obu_extension_flag)
       {
-        reader.readBits(3, bitsRead); // temporal_id
-        reader.readBits(2, bitsRead); // spatial_id
-        unsigned int extension_header_reserved_3bits = reader.readBits(3, bitsRead);
+        reader.readBits(3); // temporal_id
+        reader.readBits(2); // spatial_id
+        unsigned int extension_header_reserved_3bits = reader.readBits(3);
         if (extension_header_reserved_3bits != 0)
         {
           currentPacketData.clear();
@@ -182,8 +181,8 @@ QByteArray fileSourceFFmpegFile::getNextUnit(bool getLastDataAgain, uint64_t *pt
       }
       if (obu_has_size_field)
       {
-        int bitCount;
-        unsigned int obu_size = reader.readLeb128(bitsRead, bitCount);
+        int bitCount = 0;
+        unsigned int obu_size = reader.readLeb128(bitCount);
         unsigned int completeSize = obu_size + reader.nrBytesRead();
         lastReturnArray = currentPacketData.mid(posInData, completeSize);
         posInData += completeSize;
@@ -0,0 +1,180 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "fileSourceMapped.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+  inline bool isWhiteSpace(char c)
+  {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+}
+
+fileSourceMapped::fileSourceMapped(int64_t windowSize) :
+  windowSize(windowSize)
+{
+}
+
+fileSourceMapped::~fileSourceMapped()
+{
+  if (this->mappedData != nullptr)
+    this->file.unmap(this->mappedData);
+}
+
+bool fileSourceMapped::openFile(const QString &filePath)
+{
+  if (this->mappedData != nullptr)
+    this->file.unmap(this->mappedData);
+  this->mappedData = nullptr;
+  this->mappedStart = 0;
+  this->mappedSize = 0;
+
+  if (this->file.isOpen())
+    this->file.close();
+  this->file.setFileName(filePath);
+  this->isFileOpened = this->file.open(QIODevice::ReadOnly);
+  this->fileSize = this->isFileOpened ? this->file.size() : 0;
+  return this->isFileOpened;
+}
+
+bool fileSourceMapped::mapWindow(int64_t startPos)
+{
+  if (this->mappedData != nullptr)
+    this->file.unmap(this->mappedData);
+  this->mappedStart = startPos;
+  this->mappedSize = qMin(this->windowSize, this->fileSize - startPos);
+  this->mappedData = this->file.map(startPos, this->mappedSize);
+  if (this->mappedData == nullptr)
+    this->mappedSize = 0;
+  return this->mappedData != nullptr;
+}
+
+bool fileSourceMapped::readLine(int64_t &pos, const char *&line, int &lineLength)
+{
+  if (!this->isFileOpened || pos < 0 || pos >= this->fileSize)
+    return false;
+
+  const int64_t mappedEnd = this->mappedStart + this->mappedSize;
+  if (pos < this->mappedStart || pos >= mappedEnd)
+    if (!this->mapWindow(pos))
+      return false;
+
+  auto start = reinterpret_cast<const char*>(this->mappedData) + (pos - this->mappedStart);
+  auto available = this->mappedStart + this->mappedSize - pos;
+  auto newline = static_cast<const char*>(std::memchr(start, '\n', size_t(available)));
+  if (newline == nullptr && this->mappedStart + this->mappedSize < this->fileSize && pos != this->mappedStart)
+  {
+    // The line continues after the end of the window. Move the window to the start of the line.
+    if (!this->mapWindow(pos))
+      return false;
+    start = reinterpret_cast<const char*>(this->mappedData);
+    available = this->mappedSize;
+    newline = static_cast<const char*>(std::memchr(start, '\n', size_t(available)));
+  }
+
+  // Without a newline, this is either the last line of the file or a line that is longer than the window
+  const int64_t length = (newline == nullptr) ? available : (newline - start);
+  pos += (newline == nullptr) ? length : length + 1;
+  line = start;
+  lineLength = int(length);
+  if (lineLength > 0 && line[lineLength - 1] == '\r')
+    lineLength--;
+  return true;
+}
+
+void fileSourceMappedFields::tokenize(const char *line, int lineLength, char delimiter)
+{
+  this->nrFields = 0;
+  int fieldBegin = 0;
+  for (int i = 0; i <= lineLength && this->nrFields < maxNrFields; i++)
+  {
+    if (i == lineLength || line[i] == delimiter)
+    {
+      this->fieldStart[this->nrFields] = line + fieldBegin;
+      this->fieldLength[this->nrFields] = i - fieldBegin;
+      this->nrFields++;
+      fieldBegin = i + 1;
+    }
+  }
+}
+
+char fileSourceMappedFields::firstChar(int i) const
+{
+  if (i < 0 || i >= this->nrFields)
+    return 0;
+  for (int c = 0; c < this->fieldLength[i]; c++)
+    if (!isWhiteSpace(this->fieldStart[i][c]))
+      return this->fieldStart[i][c];
+  return 0;
+}
+
+int fileSourceMappedFields::toInt(int i) const
+{
+  if (i < 0 || i >= this->nrFields)
+    return 0;
+
+  const char *c = this->fieldStart[i];
+  const char *end = c + this->fieldLength[i];
+  bool negative = false;
+  bool signFound = false;
+  bool anyDigit = false;
+  int64_t value = 0;
+  for (; c != end; c++)
+  {
+    if (isWhiteSpace(*c))
+      continue;
+    if (!anyDigit && !signFound && (*c == '-' || *c == '+'))
+    {
+      negative = (*c == '-');
+      signFound = true;
+    }
+    else if (*c >= '0' && *c <= '9')
+    {
+      value = value * 10 + (*c - '0');
+      if (value > int64_t(INT32_MAX) + 1)
+        return 0;
+      anyDigit = true;
+    }
+    else
+      return 0;
+  }
+  if (negative)
+    value = -value;
+  if (value > INT32_MAX)
+    return 0;
+  return int(value);
+}
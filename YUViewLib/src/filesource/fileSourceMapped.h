@@ -0,0 +1,98 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef FILESOURCEMAPPED_H
+#define FILESOURCEMAPPED_H
+
+#include <QFile>
+#include <QString>
+
+/* Read-only access to a (possibly very large) text file using memory mapping.
+ * The file is mapped in windows so that files which are larger than the address space can be
+ * read as well. Lines are returned as pointers into the mapping. No data is copied and
+ * nothing is allocated per line.
+ */
+class fileSourceMapped
+{
+public:
+  fileSourceMapped(int64_t windowSize = defaultWindowSize);
+  ~fileSourceMapped();
+
+  bool openFile(const QString &filePath);
+  bool isOk() const { return isFileOpened; }
+  int64_t getFileSize() const { return fileSize; }
+
+  // Get the line that starts at pos (without the line ending). On return, pos points to the
+  // start of the next line. The pointer is valid until the next call. Returns false at the end of the file.
+  // A line that is longer than the window size is returned in parts.
+  bool readLine(int64_t &pos, const char *&line, int &lineLength);
+
+  static const int64_t defaultWindowSize = (sizeof(void*) >= 8) ? (int64_t(1) << 30) : (int64_t(1) << 26);
+
+private:
+  bool mapWindow(int64_t startPos);
+
+  QFile file;
+  bool isFileOpened {false};
+  int64_t fileSize {0};
+
+  const int64_t windowSize;
+  uchar *mappedData {nullptr};
+  int64_t mappedStart {0};
+  int64_t mappedSize {0};
+};
+
+/* Split a line into the fields between the delimiters without copying it. Like in the
+ * statistics files, white spaces within the fields are ignored.
+ */
+class fileSourceMappedFields
+{
+public:
+  void tokenize(const char *line, int lineLength, char delimiter);
+
+  int count() const { return nrFields; }
+  bool isEmpty(int i) const { return firstChar(i) == 0; }
+  // The first character of the field that is not a white space (0 if the field is empty)
+  char firstChar(int i) const;
+  // Parse the field as a decimal integer. Like QString::toInt, 0 is returned if the field is not a number.
+  int toInt(int i) const;
+
+  static const int maxNrFields = 16;
+
+private:
+  const char *fieldStart[maxNrFields];
+  int fieldLength[maxNrFields];
+  int nrFields {0};
+};
+
+#endif // FILESOURCEMAPPED_H
@@ -507,7 +507,7 @@ bool parserAVFormat::parseAVPacket(unsigned int packetID, AVPacketWrapper &packe
   }
 
   // Set a useful name of the TreeItem (the root for this NAL)
-  itemTree->itemData.append(QString("AVPacket %1%2").arg(packetID).arg(packet.get_flag_keyframe() ? " - Keyframe": "") + specificDescription);
+  itemTree->setName(QString("AVPacket %1%2").arg(packetID).arg(packet.get_flag_keyframe() ? " - Keyframe": "") + specificDescription);
 
   return true;
 }
@@ -613,6 +613,10 @@ bool parserAVFormat::hvcC_nalUnit::parse_hvcC_nalUnit(int unitID, reader_helper
 
 bool parserAVFormat::runParsingOfFile(QString compressedFilePath)
 {
+  // All items of the packet tree are allocated from the arena of the model and their strings are added to its table
+  TreeItemArena::scope arenaScope(packetModel->getItemArena());
+  TreeItemStringTable::scope stringScope(packetModel->getStringTable());
+
   // Open the file but don't parse it yet.
   QScopedPointer<fileSourceFFmpegFile> ffmpegFile(new fileSourceFFmpegFile());
  if (!ffmpegFile->openFile(compressedFilePath, nullptr, nullptr, false))
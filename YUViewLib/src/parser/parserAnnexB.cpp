@@ -32,10 +32,13 @@
 
 #include "parserAnnexB.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <QProgressDialog>
 #include <QElapsedTimer>
 
+using namespace parserCommon;
+
 #define PARSERANNEXB_DEBUG_OUTPUT 0
 #if PARSERANNEXB_DEBUG_OUTPUT && !NDEBUG
 #include <QDebug>
@@ -57,7 +60,7 @@ QString parserAnnexB::getShortStreamDescription(int streamIndex) const
 
 bool parserAnnexB::addFrameToList(int poc, QUint64Pair fileStartEndPos, bool randomAccessPoint)
 {
-  if (POCList.contains(poc))
+  if (POCSet.contains(poc))
     return false;
 
   if (pocOfFirstRandomAccessFrame == -1 && randomAccessPoint)
@@ -71,43 +74,45 @@ bool parserAnnexB::addFrameToList(int poc, QUint64Pair fileStartEndPos, bool ran
     newFrame.randomAccessPoint = randomAccessPoint;
     frameList.append(newFrame);
 
+    if (randomAccessPoint)
+      randomAccessPoints.append(poc, frameList.size() - 1);
+
     POCList.append(poc);
+    POCSet.insert(poc);
   }
   return true;
 }
 
+void parserAnnexB::setNALUnitDescription(TreeItem *nalRoot, int nalIdx, const QString &nalTypeName, const QString &specificDescription)
+{
+  // Set a useful name of the TreeItem (the root for this NAL) or the packet record in lazy mode
+  if (nalRoot == nullptr && !packetModel->isLazy())
+    return;
+  nalUnitDescription = QString("NAL %1: %2").arg(nalIdx).arg(nalTypeName) + specificDescription;
+  if (nalRoot)
+    nalRoot->setName(nalUnitDescription);
+}
+
+int parserAnnexB::getFrameIndexForPOC(int poc) const
+{
+  // Once parsing is done, the POCList is sorted and we can do a binary search
+  auto it = std::lower_bound(POCList.begin(), POCList.end(), poc);
+  if (it != POCList.end() && *it == poc)
+    return int(it - POCList.begin());
+  // The list is not sorted (yet) or the POC is not in the list
+  return POCList.indexOf(poc);
+}
+
 int parserAnnexB::getClosestSeekableFrameNumberBefore(int frameIdx, int &codingOrderFrameIdx) const
 {
   // Get the POC for the frame number
   int seekPOC = POCList[frameIdx];
 
   int bestSeekPOC = -1;
-  for (int i=0; i<frameList.length(); i++)
-  {
-    annexBFrame f = frameList[i];
-    if (f.randomAccessPoint)
-    {
-      if (bestSeekPOC == -1)
-      {
-        bestSeekPOC = f.poc;
-        codingOrderFrameIdx = i;
-      }
-      else
-      {
-        if (f.poc <= seekPOC)
-        {
-          // We could seek here
-          bestSeekPOC = f.poc;
-          codingOrderFrameIdx = i;
-        }
-        else
-          break;
-      }
-    }
-  }
+  randomAccessPoints.getClosestBefore(seekPOC, bestSeekPOC, codingOrderFrameIdx);
 
   // Get the frame index for the given POC
-  return POCList.indexOf(bestSeekPOC);
+  return getFrameIndexForPOC(bestSeekPOC);
 }
 
 QUint64Pair parserAnnexB::getFrameStartEndPos(int codingOrderFrameIdx)
@@ -117,6 +122,17 @@ QUint64Pair parserAnnexB::getFrameStartEndPos(int codingOrderFrameIdx)
   return frameList[codingOrderFrameIdx].fileStartEndPos;
 }
 
+bool parserAnnexB::getDecodedPictureHash(int frameIdx, pictureHash::pictureHashes &hash) const
+{
+  if (frameIdx < 0 || frameIdx >= POCList.size())
+    return false;
+  auto it = decodedPictureHashes.find(POCList[frameIdx]);
+  if (it == decodedPictureHashes.end())
+    return false;
+  hash = *it;
+  return true;
+}
+
 bool parserAnnexB::parseAnnexBFile(QScopedPointer<fileSourceAnnexBFile> &file, QWidget *mainWindow)
 {
   DEBUG_ANNEXB("parserAnnexB::parseAnnexBFile");
@@ -154,10 +170,14 @@ bool parserAnnexB::parseAnnexBFile(QScopedPointer<fileSourceAnnexBFile> &file, Q
     if (stream_info.file_size > 0)
       progressPercentValue = clip((int)(pos * 100 / stream_info.file_size), 0, 100);
 
+    bool parsingSuccess = false;
+    nalUnitDescription.clear();
     try
     {
       nalData = file->getNextNALUnit(false, &nalStartEndPosFile);
-      if (!parseAndAddNALUnit(nalID, nalData, this->bitrateItemModel.data(), nullptr, nalStartEndPosFile))
+      QMutexLocker lock(&parsingMutex);
+      parsingSuccess = parseAndAddNALUnit(nalID, nalData, this->bitrateItemModel.data(), nullptr, nalStartEndPosFile);
+      if (!parsingSuccess)
       {
         DEBUG_ANNEXB("parserAnnexB::parseAndAddNALUnit Error parsing NAL %d", nalID);
       }
@@ -174,6 +194,13 @@ bool parserAnnexB::parseAnnexBFile(QScopedPointer<fileSourceAnnexBFile> &file, Q
       DEBUG_ANNEXB("parserAnnexB::parseAndAddNALUnit Exception thrown parsing NAL %d", nalID);
     }
 
+    if (packetModel->isLazy())
+    {
+      // Every NAL unit gets a record (also if parsing failed) so that the rows of the model are the NAL IDs
+      const QString name = nalUnitDescription.isEmpty() ? QString("NAL %1").arg(nalID) : nalUnitDescription;
+      packetModel->addPacketRecord(nalStartEndPosFile, name, !parsingSuccess);
+    }
+
     nalID++;
 
     if (progressDialog)
@@ -211,7 +238,10 @@ bool parserAnnexB::parseAnnexBFile(QScopedPointer<fileSourceAnnexBFile> &file, Q
   }
 
   // We are done.
-  parseAndAddNALUnit(-1, QByteArray(), this->bitrateItemModel.data());
+  {
+    QMutexLocker lock(&parsingMutex);
+    parseAndAddNALUnit(-1, QByteArray(), this->bitrateItemModel.data());
+  }
   DEBUG_ANNEXB("parserAnnexB::parseAndAddNALUnit Parsing done. Found %d POCs.", POCList.length());
 
   if (packetModel)
@@ -229,10 +259,95 @@ bool parserAnnexB::parseAnnexBFile(QScopedPointer<fileSourceAnnexBFile> &file, Q
 bool parserAnnexB::runParsingOfFile(QString compressedFilePath)
 {
   DEBUG_ANNEXB("playlistItemCompressedVideo::runParsingOfFile");
+  parsedFilePath = compressedFilePath;
   QScopedPointer<fileSourceAnnexBFile> file(new fileSourceAnnexBFile(compressedFilePath));
   return parseAnnexBFile(file);
 }
 
+void parserAnnexB::enableModel()
+{
+  parserBase::enableModel();
+  packetModel->setLazyMode(this);
+}
+
+bool parserAnnexB::createPacketDetails(int packetIdx, QUint64Pair fileStartEndPos, TreeItem *root)
+{
+  DEBUG_ANNEXB("parserAnnexB::createPacketDetails packet %d", packetIdx);
+  if (parsedFilePath.isEmpty())
+    return false;
+
+  // Find the last random access point before the NAL unit and get the parameter sets that are active there.
+  // The parser must see the same NAL units as in the first pass from there in order to be in the same state.
+  // If there is none (or we don't know the parameter sets for it), we have to start at the beginning of the file.
+  QList<QByteArray> parameterSets;
+  uint64_t startPos = 0;
+  {
+    QMutexLocker lock(&parsingMutex);
+    auto it = std::upper_bound(frameList.constBegin(), frameList.constEnd(), fileStartEndPos.first, [](uint64_t pos, const annexBFrame &frame) { return pos < frame.fileStartEndPos.first; });
+    while (it != frameList.constBegin())
+    {
+      it--;
+      if (it->randomAccessPoint)
+      {
+        const int frameIdx = getFrameIndexForPOC(it->poc);
+        if (frameIdx >= 0)
+          parameterSets = getSeekFrameParamerSets(frameIdx, startPos);
+        break;
+      }
+    }
+    if (parameterSets.isEmpty())
+      startPos = 0;
+  }
+
+  fileSourceAnnexBFile file(parsedFilePath);
+  if (!file.isOk() || (startPos > 0 && !file.seek(startPos)))
+    return false;
+
+  // The syntax elements are only logged (to the TreeItem) for the requested NAL unit
+  QScopedPointer<parserAnnexB> parser(createNewParser());
+  BitrateItemModel *bitrateModel = parser->bitrateItemModel.data();
+  TreeItem nalParent(nullptr);
+  bool parsingSuccess = false;
+  int nalID = 0;
+  try
+  {
+    for (const QByteArray &parameterSet : parameterSets)
+      parser->parseAndAddNALUnit(nalID++, parameterSet, bitrateModel);
+
+    while (!file.atEnd())
+    {
+      QUint64Pair nalStartEndPosFile;
+      QByteArray nalData = file.getNextNALUnit(false, &nalStartEndPosFile);
+      if (nalStartEndPosFile.first > fileStartEndPos.first)
+        break;
+      if (nalStartEndPosFile.first == fileStartEndPos.first)
+      {
+        parsingSuccess = parser->parseAndAddNALUnit(packetIdx, nalData, bitrateModel, &nalParent, nalStartEndPosFile);
+        break;
+      }
+      parser->parseAndAddNALUnit(nalID++, nalData, bitrateModel, nullptr, nalStartEndPosFile);
+    }
+  }
+  catch (...)
+  {
+    // Keep what was parsed of the NAL unit before the error occurred
+    DEBUG_ANNEXB("parserAnnexB::createPacketDetails Exception thrown parsing packet %d", packetIdx);
+  }
+
+  if (nalParent.childItems.isEmpty())
+    return false;
+
+  // Move the syntax elements of the NAL unit to the given root
+  TreeItem *nalRoot = nalParent.childItems.first();
+  for (TreeItem *item : nalRoot->childItems)
+  {
+    item->parentItem = root;
+    root->childItems.append(item);
+  }
+  nalRoot->childItems.clear();
+  return parsingSuccess;
+}
+
 QList<QTreeWidgetItem*> parserAnnexB::stream_info_type::getStreamInfo()
 {
   QList<QTreeWidgetItem*> infoList;
@@ -33,17 +33,24 @@
 #ifndef PARSERANNEXB_H
 #define PARSERANNEXB_H
 
+#include <QHash>
 #include <QList>
+#include <QMutex>
+#include <QSet>
 
+#include "common/pictureHash.h"
 #include "video/videoHandlerYUV.h"
+#include "parserAnnexBSeekIndex.h"
 #include "parserBase.h"
 #include "filesource/fileSourceAnnexBFile.h"
 
 using namespace YUV_Internals;
 
 /* The (abstract) base class for the various types of AnnexB files (AVC, HEVC, VVC) that we can parse.
+ * For the bitstream analysis, the packet model is used in lazy mode. While parsing the file, only a compact
+ * record is added for every NAL unit. The syntax tree of a NAL unit is created by parsing it again when needed.
 */
-class parserAnnexB : public parserBase
+class parserAnnexB : public parserBase, public parserCommon::PacketDetailProvider
 {
   Q_OBJECT
 
@@ -90,11 +97,25 @@ public:
 
   QUint64Pair getFrameStartEndPos(int codingOrderFrameIdx);
 
+  // Get the hash of the frame with the given index (display order) from the decoded picture hash SEI.
+  // Returns false if there is no hash for the frame in the bitstream.
+  bool getDecodedPictureHash(int frameIdx, pictureHash::pictureHashes &hash) const;
+  bool hasDecodedPictureHashes() const { return !decodedPictureHashes.isEmpty(); }
+  // Get the POC of the frame with the given index (display order). Returns -1 if the index is out of range.
+  int getFramePOC(int frameIdx) const { return (frameIdx >= 0 && frameIdx < POCList.size()) ? POCList[frameIdx] : -1; }
+
   bool parseAnnexBFile(QScopedPointer<fileSourceAnnexBFile> &file, QWidget *mainWindow=nullptr);
 
   // Called from the bitstream analyzer. This function can run in a background process.
   bool runParsingOfFile(QString compressedFilePath) Q_DECL_OVERRIDE;
 
+  // Enable the packet model in lazy mode
+  void enableModel() Q_DECL_OVERRIDE;
+
+  // Parse the NAL unit at the given position in the file again (starting at the random access point before it)
+  // and add the syntax tree to the root. This is called from the GUI thread while the background parser may still run.
+  bool createPacketDetails(int packetIdx, QUint64Pair fileStartEndPos, parserCommon::TreeItem *root) Q_DECL_OVERRIDE;
+
   // Parsing of an SEI message may fail when the required parameter sets are not yet available and parsing has to be performed
   // once the required parameter sets are recieved.
   enum sei_parsing_return_t
@@ -136,6 +157,21 @@ public:
   };
 
 protected:
+
+  // Create a new (empty) parser of the same type. This is used to parse NAL units again for the lazy packet model.
+  virtual parserAnnexB *createNewParser() const = 0;
+
+  // In lazy mode, parseAndAddNALUnit does not create a TreeItem for NAL units but it sets this description (e.g. "NAL 3: PPS_NUT").
+  // It is used as the name of the packet record in the model.
+  QString nalUnitDescription;
+  // Set the description ("NAL <nalIdx>: <nalTypeName><specificDescription>") as the name of the nalRoot (if given) or
+  // as the name of the packet record in lazy mode.
+  void setNALUnitDescription(parserCommon::TreeItem *nalRoot, int nalIdx, const QString &nalTypeName, const QString &specificDescription);
+
+  // The file that is parsed in runParsingOfFile. It is opened again to parse NAL units in createPacketDetails.
+  QString parsedFilePath;
+  // This is locked while a NAL unit is parsed and added to the lists of frames and NAL units below
+  QMutex parsingMutex;
   
   struct annexBFrame
   {
@@ -150,17 +186,32 @@ protected:
 
   // We also keep a sorted list of POC values in order to map from frame indices to POC
   QList<int> POCList;
+  // The same POC values in a set for fast lookup while the POCList is not sorted yet
+  QSet<int> POCSet;
+
+  // Get the frame index (the index in the sorted POCList) of the given POC. Returns -1 if not found.
+  int getFrameIndexForPOC(int poc) const;
 
   // Returns false if the POC was already present int the list
   bool addFrameToList(int poc, QUint64Pair fileStartEndPos, bool randomAccessPoint);
 
+  // All random access points from the frameList. Used to find the frame to start decoding from when seeking.
+  randomAccessPointTable randomAccessPoints;
+
   // A list of nal units sorted by position in the file.
   // Only parameter sets and random access positions go in here.
   // So basically all information we need to seek in the stream and get the active parameter sets to start the decoder at a certain position.
   QList<QSharedPointer<nal_unit>> nalUnitList;
 
+  // For every POC of a random access point, the index of the first slice of that frame in the nalUnitList.
+  // Together with a parameterSetHistory per parameter set type, this is used to get the parameter sets for seeking.
+  QHash<int, int> randomAccessNALIdxPerPOC;
+
   int pocOfFirstRandomAccessFrame {-1};
 
+  // The hashes from the decoded picture hash SEIs per POC
+  QHash<int, pictureHash::pictureHashes> decodedPictureHashes;
+
   // Save general information about the file here
   struct stream_info_type
   {
@@ -171,7 +171,7 @@ bool parserAnnexBAVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateItem
   TreeItem *nalRoot = nullptr;
   if (parent)
     nalRoot = new TreeItem(parent);
-  else if (!packetModel->isNull())
+  else if (!packetModel->isNull() && !packetModel->isLazy())
     nalRoot = new TreeItem(packetModel->getRootItem());
 
   // Create a nal_unit and read the header
@@ -213,6 +213,7 @@ bool parserAnnexBAVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateItem
 
     // Also add sps to list of all nals
     nalUnitList.append(new_sps);
+    spsHistory.add(new_sps->seq_parameter_set_id, nalUnitList.size() - 1, new_sps);
 
     // Add the SPS ID
     specificDescription = parsingSuccess ? QString(" SPS_NUT ID %1").arg(new_sps->seq_parameter_set_id) : " SPS_NUT ERR";
@@ -235,6 +236,7 @@ bool parserAnnexBAVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateItem
 
     // Also add pps to list of all nals
     nalUnitList.append(new_pps);
+    ppsHistory.add(new_pps->pic_parameter_set_id, nalUnitList.size() - 1, new_pps);
 
     // Add the PPS ID
     specificDescription = parsingSuccess ? QString(" PPS_NUT ID %1").arg(new_pps->pic_parameter_set_id) : "PPS_NUT ERR";
@@ -284,6 +286,8 @@ bool parserAnnexBAVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateItem
       {
         // This is the first slice of a random access point. Add it to the list.
         nalUnitList.append(new_slice);
+        if (!randomAccessNALIdxPerPOC.contains(new_slice->globalPOC))
+          randomAccessNALIdxPerPOC.insert(new_slice->globalPOC, nalUnitList.size() - 1);
       }
 
       currentSliceIntra = new_slice->isRandomAccess();
@@ -314,7 +318,7 @@ bool parserAnnexBAVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateItem
       sei_data.remove(0, nrBytes);
 
       if (message_tree)
-        message_tree->itemData[0] = QString("sei_message %1 - %2").arg(sei_count).arg(new_sei->payloadTypeName);
+        message_tree->setName(QString("sei_message %1 - %2").arg(sei_count).arg(new_sei->payloadTypeName));
 
       // The real number of bytes to read from the bitstream may be higher than the indicated payload size (emulation prevention)
       int realPayloadSize = determineRealNumberOfBytesSEIEmulationPrevention(sei_data, new_sei->payloadSize);
@@ -414,12 +418,9 @@ bool parserAnnexBAVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateItem
     currentAUAllSliceTypes += currentSliceType + " ";
   }
 
+  setNALUnitDescription(nalRoot, nal_avc.nal_idx, nal_unit_type_toString.value(nal_avc.nal_unit_type), specificDescription);
   if (nalRoot)
-  {
-    // Set a useful name of the TreeItem (the root for this NAL)
-    nalRoot->itemData.append(QString("NAL %1: %2").arg(nal_avc.nal_idx).arg(nal_unit_type_toString.value(nal_avc.nal_unit_type)) + specificDescription);
     nalRoot->setError(!parsingSuccess);
-  }
 
   return parsingSuccess;
 }
@@ -1950,51 +1951,23 @@ QList<QByteArray> parserAnnexBAVC::getSeekFrameParamerSets(int iFrameNr, uint64_
   // Get the POC for the frame number
   int seekPOC = POCList[iFrameNr];
 
-  // Collect the active parameter sets
-  sps_map active_SPS_list;
-  pps_map active_PPS_list;
-
-  for (auto nal : nalUnitList)
-  {
-    // This should be an hevc nal
-    auto nal_avc = nal.dynamicCast<nal_unit_avc>();
-
-    if (nal_avc->isSlice()) 
-    {
-      // We can cast this to a slice.
-      auto s = nal_avc.dynamicCast<slice_header>();
-
-      if (s->globalPOC == seekPOC)
-      {
-        // Seek here
-        filePos = s->filePosStartEnd.first;
-
-        // Get the bitstream of all active parameter sets
-        QList<QByteArray> paramSets;
+  // Get the first slice of the random access point with this POC
+  if (!randomAccessNALIdxPerPOC.contains(seekPOC))
+    return QList<QByteArray>();
+  const int sliceIdx = randomAccessNALIdxPerPOC.value(seekPOC);
+  auto seekSlice = nalUnitList[sliceIdx].dynamicCast<slice_header>();
 
-        for (auto s : active_SPS_list)
-          paramSets.append(s->getRawNALData());
-        for (auto p : active_PPS_list)
-          paramSets.append(p->getRawNALData());
+  // Seek here
+  filePos = seekSlice->filePosStartEnd.first;
 
-        return paramSets;
-      }
-    }
-    else if (nal_avc->nal_unit_type == SPS) 
-    {
-      // Add sps (replace old one if existed)
-      auto s = nal_avc.dynamicCast<sps>();
-      active_SPS_list.insert(s->seq_parameter_set_id, s);
-    }
-    else if (nal_avc->nal_unit_type == PPS)
-    {
-      // Add pps (replace old one if existed)
-      auto p = nal_avc.dynamicCast<pps>();
-      active_PPS_list.insert(p->pic_parameter_set_id, p);
-    }
-  }
+  // Get the bitstream of all parameter sets that are active at the slice
+  QList<QByteArray> paramSets;
+  for (auto s : spsHistory.getActiveBefore(sliceIdx))
+    paramSets.append(s->getRawNALData());
+  for (auto p : ppsHistory.getActiveBefore(sliceIdx))
+    paramSets.append(p->getRawNALData());
 
-  return QList<QByteArray>();
+  return paramSets;
 }
 
 QByteArray parserAnnexBAVC::getExtradata()
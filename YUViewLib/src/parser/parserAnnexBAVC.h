@@ -62,6 +62,8 @@ public:
   QPair<int,int> getSampleAspectRatio() Q_DECL_OVERRIDE;
 
 protected:
+  parserAnnexB *createNewParser() const Q_DECL_OVERRIDE { return new parserAnnexBAVC(); }
+
   // ----- Some nested classes that are only used in the scope of this file handler class
 
   // All the different NAL unit types (T-REC-H.265-201504 Page 85)
@@ -535,6 +537,9 @@ protected:
   // the parameter sets.
   QMap<int, QSharedPointer<sps>> active_SPS_list;
   QMap<int, QSharedPointer<pps>> active_PPS_list;
+  // All versions of the parameter sets with their position in the nalUnitList. Used for seeking.
+  parameterSetHistory<sps> spsHistory;
+  parameterSetHistory<pps> ppsHistory;
   // In order to calculate POCs we need the first slice of the last reference picture
   QSharedPointer<slice_header> last_picture_first_slice;
   // It is allowed that units (like SEI messages) sent before the parameter sets but still refer to the 
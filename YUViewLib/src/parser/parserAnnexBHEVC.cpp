@@ -156,60 +156,25 @@ QList<QByteArray> parserAnnexBHEVC::getSeekFrameParamerSets(int iFrameNr, uint64
   // Get the POC for the frame number
   int seekPOC = POCList[iFrameNr];
 
-  // Collect the active parameter sets
-  vps_map active_VPS_list;
-  sps_map active_SPS_list;
-  pps_map active_PPS_list;
-
-  for (auto nal : nalUnitList)
-  {
-    // This should be an hevc nal
-    auto nal_hevc = nal.dynamicCast<nal_unit_hevc>();
-
-    if (nal_hevc->isSlice()) 
-    {
-      // We can cast this to a slice.
-      auto s = nal_hevc.dynamicCast<slice>();
-
-      if (s->globalPOC == seekPOC)
-      {
-        // Seek here
-        filePos = s->filePosStartEnd.first;
-
-        // Get the bitstream of all active parameter sets
-        QList<QByteArray> paramSets;
-
-        for (auto v : active_VPS_list)
-          paramSets.append(v->getRawNALData());
-        for (auto s : active_SPS_list)
-          paramSets.append(s->getRawNALData());
-        for (auto p : active_PPS_list)
-          paramSets.append(p->getRawNALData());
-
-        return paramSets;
-      }
-    }
-    else if (nal_hevc->nal_type == VPS_NUT)
-    {
-      // Add vps (replace old one if existed)
-      auto v = nal_hevc.dynamicCast<vps>();
-      active_VPS_list.insert(v->vps_video_parameter_set_id, v);
-    }
-    else if (nal_hevc->nal_type == SPS_NUT) 
-    {
-      // Add sps (replace old one if existed)
-      auto s = nal_hevc.dynamicCast<sps>();
-      active_SPS_list.insert(s->sps_seq_parameter_set_id, s);
-    }
-    else if (nal_hevc->nal_type == PPS_NUT) 
-    {
-      // Add pps (replace old one if existed)
-      auto p = nal_hevc.dynamicCast<pps>();
-      active_PPS_list.insert(p->pps_pic_parameter_set_id, p);
-    }
-  }
-
-  return QList<QByteArray>();
+  // Get the first slice of the random access point with this POC
+  if (!randomAccessNALIdxPerPOC.contains(seekPOC))
+    return QList<QByteArray>();
+  const int sliceIdx = randomAccessNALIdxPerPOC.value(seekPOC);
+  auto seekSlice = nalUnitList[sliceIdx].dynamicCast<slice>();
+
+  // Seek here
+  filePos = seekSlice->filePosStartEnd.first;
+
+  // Get the bitstream of all parameter sets that are active at the slice
+  QList<QByteArray> paramSets;
+  for (auto v : vpsHistory.getActiveBefore(sliceIdx))
+    paramSets.append(v->getRawNALData());
+  for (auto s : spsHistory.getActiveBefore(sliceIdx))
+    paramSets.append(s->getRawNALData());
+  for (auto p : ppsHistory.getActiveBefore(sliceIdx))
+    paramSets.append(p->getRawNALData());
+
+  return paramSets;
 }
 
 QByteArray parserAnnexBHEVC::getExtradata()
@@ -344,7 +309,7 @@ bool parserAnnexBHEVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateIte
   TreeItem *nalRoot = nullptr;
   if (parent)
     nalRoot = new TreeItem(parent);
-  else if (!packetModel->isNull())
+  else if (!packetModel->isNull() && !packetModel->isLazy())
     nalRoot = new TreeItem(packetModel->getRootItem());
 
   // Create a nal_unit and read the header
@@ -389,6 +354,7 @@ bool parserAnnexBHEVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateIte
 
     // Put parameter sets into the NAL unit list
     nalUnitList.append(new_vps);
+    vpsHistory.add(new_vps->vps_video_parameter_set_id, nalUnitList.size() - 1, new_vps);
 
     // Add vps (replace old one if existed)
     active_VPS_list.insert(new_vps->vps_video_parameter_set_id, new_vps);
@@ -411,6 +377,7 @@ bool parserAnnexBHEVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateIte
 
     // Also add sps to list of all nals
     nalUnitList.append(new_sps);
+    spsHistory.add(new_sps->sps_seq_parameter_set_id, nalUnitList.size() - 1, new_sps);
 
     // Add the SPS ID
     specificDescription = parsingSuccess ? QString(" SPS_NUT ID %1").arg(new_sps->sps_seq_parameter_set_id) : " SPS_NUT ERR";
@@ -430,6 +397,7 @@ bool parserAnnexBHEVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateIte
 
     // Also add pps to list of all nals
     nalUnitList.append(new_pps);
+    ppsHistory.add(new_pps->pps_pic_parameter_set_id, nalUnitList.size() - 1, new_pps);
 
     // Add the PPS ID
     specificDescription = parsingSuccess ? QString(" PPS_NUT ID %1").arg(new_pps->pps_pic_parameter_set_id) : " PPS_NUT ERR";
@@ -502,8 +470,12 @@ bool parserAnnexBHEVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateIte
       if (nal_hevc.isIRAP())
       {
         if (new_slice->first_slice_segment_in_pic_flag)
+        {
           // This is the first slice of a random access point. Add it to the list.
           nalUnitList.append(new_slice);
+          if (!randomAccessNALIdxPerPOC.contains(new_slice->globalPOC))
+            randomAccessNALIdxPerPOC.insert(new_slice->globalPOC, nalUnitList.size() - 1);
+        }
         currentSliceIntra = true;
       }
       currentSliceType = new_slice->getSliceTypeString();
@@ -534,7 +506,7 @@ bool parserAnnexBHEVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateIte
       sei_data.remove(0, nrBytes);
 
       if (message_tree)
-        message_tree->itemData[0] = QString("sei_message %1 - %2").arg(sei_count).arg(new_sei->payloadTypeName);
+        message_tree->setName(QString("sei_message %1 - %2").arg(sei_count).arg(new_sei->payloadTypeName));
 
       QByteArray sub_sei_data = sei_data.mid(0, new_sei->payloadSize);
 
@@ -569,6 +541,19 @@ bool parserAnnexBHEVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateIte
         result = new_active_parameter_sets_sei->parse_active_parameter_sets_sei(sub_sei_data, active_VPS_list, message_tree);
         reparse = new_active_parameter_sets_sei;
       }
+      else if (new_sei->payloadType == 132 && nal_hevc.nal_type == SUFFIX_SEI_NUT)
+      {
+        auto new_decoded_picture_hash_sei = QSharedPointer<decoded_picture_hash_sei>(new decoded_picture_hash_sei(new_sei));
+        result = new_decoded_picture_hash_sei->parse_decoded_picture_hash_sei(sub_sei_data, message_tree);
+        if (result == SEI_PARSING_OK && curFramePOC != -1)
+        {
+          // The suffix SEI follows the slices of the picture that it belongs to
+          pictureHash::pictureHashes hash;
+          hash.type = pictureHash::hashType(new_decoded_picture_hash_sei->hash_type);
+          hash.planes = new_decoded_picture_hash_sei->picture_hash;
+          decodedPictureHashes.insert(curFramePOC, hash);
+        }
+      }
       else if (new_sei->payloadType == 147)
       {
         auto new_alternative_transfer_characteristics_sei = QSharedPointer<alternative_transfer_characteristics_sei>(new alternative_transfer_characteristics_sei(new_sei));
@@ -647,9 +632,7 @@ bool parserAnnexBHEVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateIte
     currentAUAllSliceTypes += currentSliceType + " ";
   }
 
-  if (nalRoot)
-    // Set a useful name of the TreeItem (the root for this NAL)
-    nalRoot->itemData.append(QString("NAL %1: %2").arg(nal_hevc.nal_idx).arg(nal_unit_type_toString.value(nal_hevc.nal_type)) + specificDescription);
+  setNALUnitDescription(nalRoot, nal_hevc.nal_idx, nal_unit_type_toString.value(nal_hevc.nal_type), specificDescription);
 
   return true;
 }
@@ -2296,6 +2279,29 @@ bool parserAnnexBHEVC::alternative_transfer_characteristics_sei::parse_internal(
   return true;
 }
 
+bool parserAnnexBHEVC::decoded_picture_hash_sei::parse_internal(QByteArray &data, TreeItem *root)
+{
+  reader_helper reader(data, root, "decoded picture hash");
+  QStringList hash_type_meaning = QStringList() << "MD5" << "CRC" << "Checksum" << "Reserved";
+  READBITS_M(hash_type, 8, hash_type_meaning);
+  const int hashLength = pictureHash::getHashLength(pictureHash::hashType(qMin(hash_type, 3u)));
+  if (hashLength == 0)
+    return reader.addErrorMessageChildItem("Unknown hash_type.");
+
+  // There is one hash per color component (one for 4:0:0, three otherwise). We don't need the SPS to know this.
+  const int nrComponents = (int(payloadSize) - 1) / hashLength;
+  const QString hashName = (hash_type == 0) ? "picture_md5" : (hash_type == 1) ? "picture_crc" : "picture_checksum";
+  for (int cIdx = 0; cIdx < nrComponents; cIdx++)
+  {
+    QByteArray hash;
+    for (int i = 0; i < hashLength; i++)
+      if (!reader.readBits(8, hash, QString("%1[%2]").arg(hashName).arg(cIdx), i))
+        return false;
+    picture_hash.append(hash);
+  }
+  return true;
+}
+
 bool parserAnnexBHEVC::dolbyVisionMetadata::parse_metadata(const QByteArray &data, TreeItem *root)
 {
   if (root == nullptr)
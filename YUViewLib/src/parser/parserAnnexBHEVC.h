@@ -62,6 +62,8 @@ public:
   bool parseAndAddNALUnit(int nalID, QByteArray data, parserCommon::BitrateItemModel *bitrateModel, parserCommon::TreeItem *parent=nullptr, QUint64Pair nalStartEndPosFile = QUint64Pair(-1,-1), QString *nalTypeName=nullptr) Q_DECL_OVERRIDE;
 
 protected:
+  parserAnnexB *createNewParser() const Q_DECL_OVERRIDE { return new parserAnnexBHEVC(); }
+
   // ----- Some nested classes that are only used in the scope of this file handler class
 
   // All the different NAL unit types (T-REC-H.265-201504 Page 85)
@@ -744,6 +746,19 @@ protected:
     bool parse_internal(QByteArray &sliceHeaderData, parserCommon::TreeItem *root);
   };
 
+  class decoded_picture_hash_sei : public sei
+  {
+  public:
+    decoded_picture_hash_sei(QSharedPointer<sei> sei_src) : sei(sei_src) {};
+    parserAnnexB::sei_parsing_return_t parse_decoded_picture_hash_sei(QByteArray &sliceHeaderData, parserCommon::TreeItem *root) { return parse_internal(sliceHeaderData, root) ? SEI_PARSING_OK : SEI_PARSING_ERROR; }
+
+    unsigned int hash_type;
+    // The MD5 (16 bytes), CRC (2 bytes) or checksum (4 bytes) of each color component
+    QList<QByteArray> picture_hash;
+  private:
+    bool parse_internal(QByteArray &sliceHeaderData, parserCommon::TreeItem *root);
+  };
+
   struct dolbyVisionMetadata : nal_unit_hevc
   {
     dolbyVisionMetadata(const nal_unit_hevc &nal) : nal_unit_hevc(nal) {}
@@ -767,6 +782,10 @@ protected:
   vps_map active_VPS_list;
   sps_map active_SPS_list;
   pps_map active_PPS_list;
+  // All versions of the parameter sets with their position in the nalUnitList. Used for seeking.
+  parameterSetHistory<vps> vpsHistory;
+  parameterSetHistory<sps> spsHistory;
+  parameterSetHistory<pps> ppsHistory;
   // We keept a pointer to the last slice with first_slice_segment_in_pic_flag set. 
   // All following slices with dependent_slice_segment_flag set need this slice to infer some values.
   QSharedPointer<slice> lastFirstSliceSegmentInPic;
@@ -165,7 +165,7 @@ bool parserAnnexBMpeg2::parseAndAddNALUnit(int nalID, QByteArray data, BitrateIt
   TreeItem *nalRoot = nullptr;
   if (parent)
     nalRoot = new TreeItem(parent);
-  else if (!packetModel->isNull())
+  else if (!packetModel->isNull() && !packetModel->isLazy())
     nalRoot = new TreeItem(packetModel->getRootItem());
 
   // Create a nal_unit and read the header
@@ -245,7 +245,7 @@ bool parserAnnexBMpeg2::parseAndAddNALUnit(int nalID, QByteArray data, BitrateIt
       return false;
 
     if (message_tree)
-      message_tree->itemData[0] = new_extension->get_extension_function_name();
+      message_tree->setName(new_extension->get_extension_function_name());
 
     if (new_extension->extension_type == EXT_SEQUENCE)
     {
@@ -313,9 +313,7 @@ bool parserAnnexBMpeg2::parseAndAddNALUnit(int nalID, QByteArray data, BitrateIt
     currentAUAllSliceTypes += currentSliceType + " ";
   }
   
-  if (nalRoot)
-    // Set a useful name of the TreeItem (the root for this NAL)
-    nalRoot->itemData.append(QString("NAL %1: %2").arg(nal_mpeg2.nal_idx).arg(nal_unit_type_toString.value(nal_mpeg2.nal_unit_type)) + specificDescription);
+  setNALUnitDescription(nalRoot, nal_mpeg2.nal_idx, nal_unit_type_toString.value(nal_mpeg2.nal_unit_type), specificDescription);
 
   return parsingSuccess;
 }
@@ -56,6 +56,9 @@ public:
   QPair<int,int> getProfileLevel() Q_DECL_OVERRIDE;
   QPair<int,int> getSampleAspectRatio() Q_DECL_OVERRIDE;
 
+protected:
+  parserAnnexB *createNewParser() const Q_DECL_OVERRIDE { return new parserAnnexBMpeg2(); }
+
 private:
 
   // All the different NAL unit types (T-REC-H.262-199507 Page 24 Table 6-1)
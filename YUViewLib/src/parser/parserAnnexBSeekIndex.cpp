@@ -0,0 +1,62 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "parserAnnexBSeekIndex.h"
+
+#include <climits>
+
+void randomAccessPointTable::append(int poc, int codingOrderFrameIdx)
+{
+  entry newEntry;
+  newEntry.poc = poc;
+  newEntry.codingOrderFrameIdx = codingOrderFrameIdx;
+  if (entries.isEmpty())
+    // The first random access point is never compared against the seek POC
+    newEntry.maxPOC = INT_MIN;
+  else
+    newEntry.maxPOC = std::max(entries.last().maxPOC, poc);
+  entries.append(newEntry);
+}
+
+bool randomAccessPointTable::getClosestBefore(int seekPOC, int &poc, int &codingOrderFrameIdx) const
+{
+  if (entries.isEmpty())
+    return false;
+
+  // Find the first random access point (after the first one) with a POC greater than the seek POC.
+  // Decoding starts at the random access point right before it.
+  auto firstAfter = std::upper_bound(entries.begin() + 1, entries.end(), seekPOC, [](int pocValue, const entry &e) { return pocValue < e.maxPOC; });
+  const entry &seekEntry = *(firstAfter - 1);
+  poc = seekEntry.poc;
+  codingOrderFrameIdx = seekEntry.codingOrderFrameIdx;
+  return true;
+}
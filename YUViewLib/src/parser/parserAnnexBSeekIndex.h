@@ -0,0 +1,111 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PARSERANNEXBSEEKINDEX_H
+#define PARSERANNEXBSEEKINDEX_H
+
+#include <algorithm>
+
+#include <QList>
+#include <QMap>
+#include <QSharedPointer>
+
+/* A table of all random access points of a bitstream in coding order. Finding the random access point
+ * where decoding has to start for a certain POC is a binary search in this table instead of a linear
+ * search over all frames of the bitstream.
+*/
+class randomAccessPointTable
+{
+public:
+  void clear() { entries.clear(); }
+  int size() const { return entries.size(); }
+
+  // Add a random access point. These must be added in coding order.
+  void append(int poc, int codingOrderFrameIdx);
+
+  // Get the random access point where decoding has to start in order to decode the frame with the given POC.
+  // This is the last random access point (in coding order) before the first random access point with a POC
+  // greater than seekPOC. The first random access point is always a valid result.
+  // Returns false if there are no random access points.
+  bool getClosestBefore(int seekPOC, int &poc, int &codingOrderFrameIdx) const;
+
+private:
+  struct entry
+  {
+    int poc;
+    int codingOrderFrameIdx;
+    // The maximum POC of all random access points from the second one up to this one. This is
+    // non-decreasing, so the first random access point after the seek position can be found with a binary search.
+    int maxPOC;
+  };
+  QList<entry> entries;
+};
+
+/* All versions of one type of parameter set (e.g. all SPS) in the order in which they appeared in the bitstream.
+ * The versions are kept separately for every parameter set ID together with their position in the bitstream,
+ * so the parameter sets that are active at any position can be reconstructed with one binary search per ID.
+*/
+template <class T>
+class parameterSetHistory
+{
+public:
+  void clear() { versionsPerID.clear(); }
+
+  // Add a new version of the parameter set with the given ID. The positions must be increasing.
+  void add(int id, int position, QSharedPointer<T> parameterSet)
+  {
+    versionsPerID[id].append(version{position, parameterSet});
+  }
+
+  // Get the last version of every parameter set that appeared before the given position (sorted by ID)
+  QList<QSharedPointer<T>> getActiveBefore(int position) const
+  {
+    QList<QSharedPointer<T>> activeSets;
+    for (const auto &versions : versionsPerID)
+    {
+      auto it = std::lower_bound(versions.begin(), versions.end(), position, [](const version &v, int pos) { return v.position < pos; });
+      if (it != versions.begin())
+        activeSets.append((it - 1)->parameterSet);
+    }
+    return activeSets;
+  }
+
+private:
+  struct version
+  {
+    int position;
+    QSharedPointer<T> parameterSet;
+  };
+  QMap<int, QList<version>> versionsPerID;
+};
+
+#endif // PARSERANNEXBSEEKINDEX_H
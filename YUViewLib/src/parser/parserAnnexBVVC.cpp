@@ -112,7 +112,7 @@ bool parserAnnexBVVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateItem
   TreeItem *nalRoot = nullptr;
   if (parent)
     nalRoot = new TreeItem(parent);
-  else if (!packetModel->isNull())
+  else if (!packetModel->isNull() && !packetModel->isLazy())
     nalRoot = new TreeItem(packetModel->getRootItem());
 
   // Create a nal_unit and read the header
@@ -145,11 +145,78 @@ bool parserAnnexBVVC::parseAndAddNALUnit(int nalID, QByteArray data, BitrateItem
   else
     curFrameFileStartEndPos.second = nalStartEndPosFile.second;
 
+  if (nal_vvc.isSuffixSEI())
+  {
+    if (!parseSuffixSEI(payload, nalRoot))
+      return false;
+    specificDescription = " Suffix SEI";
+  }
+
   sizeCurrentAU += data.size();
 
-  if (nalRoot)
-    // Set a useful name of the TreeItem (the root for this NAL)
-    nalRoot->itemData.append(QString("NAL %1: %2").arg(nal_vvc.nal_idx).arg(nal_vvc.nal_unit_type_id) + specificDescription);
+  setNALUnitDescription(nalRoot, nal_vvc.nal_idx, QString::number(nal_vvc.nal_unit_type_id), specificDescription);
+
+  return true;
+}
+
+bool parserAnnexBVVC::parseSuffixSEI(const QByteArray &payload, TreeItem *root)
+{
+  reader_helper reader(payload, root, "sei_rbsp()");
+
+  // Each SEI NAL may contain multiple sei_messages. The last byte contains the rbsp trailing bits.
+  while (reader.nrBytesLeft() > 0)
+  {
+    reader_sub_level sub_level_adder(reader, "sei_message()");
+
+    unsigned int payloadType = 0;
+    unsigned int payloadSize = 0;
+    unsigned int byte;
+    do
+    {
+      READBITS(byte, 8);
+      payloadType += byte;
+    } while (byte == 255);
+    LOGVAL(payloadType);
+    do
+    {
+      READBITS(byte, 8);
+      payloadSize += byte;
+    } while (byte == 255);
+    LOGVAL(payloadSize);
+
+    if (payloadType != 132)
+    {
+      // We only need the decoded picture hash. Skip the payload.
+      for (unsigned int i = 0; i < payloadSize; i++)
+        READBITS(byte, 8);
+      continue;
+    }
+
+    reader_sub_level hash_level_adder(reader, "decoded_picture_hash()");
+    unsigned int dph_sei_hash_type;
+    QStringList dph_sei_hash_type_meaning = QStringList() << "MD5" << "CRC" << "Checksum" << "Reserved";
+    READBITS_M(dph_sei_hash_type, 8, dph_sei_hash_type_meaning);
+    unsigned int dph_sei_single_component_flag;
+    READBITS(dph_sei_single_component_flag, 1);
+    READZEROBITS(7, "dph_sei_reserved_zero_7bits");
+
+    const int hashLength = pictureHash::getHashLength(pictureHash::hashType(qMin(dph_sei_hash_type, 3u)));
+    if (hashLength == 0)
+      return reader.addErrorMessageChildItem("Unknown dph_sei_hash_type.");
+
+    const QString hashName = (dph_sei_hash_type == 0) ? "dph_sei_picture_md5" : (dph_sei_hash_type == 1) ? "dph_sei_picture_crc" : "dph_sei_picture_checksum";
+    for (int cIdx = 0; cIdx < (dph_sei_single_component_flag ? 1 : 3); cIdx++)
+    {
+      QByteArray planeHash;
+      for (int i = 0; i < hashLength; i++)
+        if (!reader.readBits(8, planeHash, QString("%1[%2]").arg(hashName).arg(cIdx), i))
+          return false;
+    }
+
+    // The hashes are not added to decodedPictureHashes. They are looked up by the POC of the frame in display
+    // order but this parser does not parse the picture header and uses the AU counter (decode order) as the POC.
+    // With reordering, the hashes would be compared to the wrong pictures.
+  }
 
   return true;
 }
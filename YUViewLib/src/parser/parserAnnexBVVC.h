@@ -62,6 +62,8 @@ public:
   bool parseAndAddNALUnit(int nalID, QByteArray data, parserCommon::BitrateItemModel *bitrateModel, parserCommon::TreeItem *parent=nullptr, QUint64Pair nalStartEndPosFile = QUint64Pair(-1,-1), QString *nalTypeName=nullptr) Q_DECL_OVERRIDE;
 
 protected:
+  parserAnnexB *createNewParser() const Q_DECL_OVERRIDE { return new parserAnnexBVVC(); }
+
   // ----- Some nested classes that are only used in the scope of this file handler class
 
   /* The basic VVC NAL unit. Additionally to the basic NAL unit, it knows the HEVC nal unit types.
@@ -77,12 +79,17 @@ protected:
     bool parse_nal_unit_header(const QByteArray &parameterSetData, parserCommon::TreeItem *root) override;
 
     bool isAUDelimiter() { return nal_unit_type_id == 19; }
+    bool isSuffixSEI() { return nal_unit_type_id == 24; }
 
     // The information of the NAL unit header
     unsigned int nuh_layer_id;
     unsigned int nuh_temporal_id_plus1;
   };
 
+  // Parse the messages of a suffix SEI. Only the decoded picture hash is interpreted (it is shown but not used for
+  // the verification because the real POC of the picture is not known).
+  bool parseSuffixSEI(const QByteArray &payload, parserCommon::TreeItem *root);
+
   // Since full parsing is not implemented yet, we will just look for AU delimiters (they must be enabled in the bitstream and are by default).
   // This is used by getNextFrameNALUnits to return all information (NAL units) for a specific frame.
   QUint64Pair curFrameFileStartEndPos;   //< Save the file start/end position of the current frame (in case the frame has multiple NAL units)
@@ -61,7 +61,10 @@ parserBase::~parserBase()
 void parserBase::enableModel()
 {
   if (packetModel->isNull())
+  {
+    TreeItemStringTable::scope stringScope(packetModel->getStringTable());
     packetModel->rootItem.reset(new TreeItem(QStringList() << "Name" << "Value" << "Coding" << "Code" << "Meaning", nullptr));
+  }
 }
 
 void parserBase::updateNumberModelItems()
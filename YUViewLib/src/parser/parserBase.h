@@ -58,7 +58,7 @@ public:
   parserCommon::BitrateItemModel *getBitrateItemModel() { return bitrateItemModel.data(); }
   
   void updateNumberModelItems();
-  void enableModel();
+  virtual void enableModel();
 
   // Get info about the stream organized in a tree
   virtual QList<QTreeWidgetItem*> getStreamInfo() = 0;
@@ -32,7 +32,10 @@
 
 #include "parserCommon.h"
 
+#include <algorithm>
+#include <QHash>
 #include <QString>
+#include <QVector>
 #include <assert.h>
 #include <stdlib.h>
 #include <time.h>
@@ -137,8 +140,8 @@ uint64_t sub_byte_reader::readBits64(int nrBits, QString &bitsRead)
 
   // We just use the readBits function twice
   int lowerBits = nrBits - 32;
-  int upper = readBits(32, bitsRead);
-  int lower = readBits(lowerBits, bitsRead);
+  uint64_t upper = readBits(32, bitsRead);
+  uint64_t lower = readBits(lowerBits, bitsRead);
   uint64_t ret = (upper << lowerBits) + lower;
   return ret;
 }
@@ -306,7 +309,8 @@ bool sub_byte_reader::more_rbsp_data()
     unsigned char c = byteArray[posBytes];
     if (terminatingBitFound && c != 0)
       return true;
-    else if (!terminatingBitFound && (c & 128))
+    else if (!terminatingBitFound && c == 128)
+      // The next bit is the terminating bit and the rest of the byte is 0
       terminatingBitFound = true;
     else
       return true;
@@ -377,6 +381,306 @@ bool sub_byte_reader::gotoNextByte()
   return true;
 }
 
+namespace
+{
+  // The input of the fast_bit_reader is converted to RBSP data in blocks of this size
+  const unsigned int fastReaderBlockSize = 256;
+
+  // The value must not be 0
+  int countLeadingZeros64(uint64_t val)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(val);
+#else
+    int n = 0;
+    while (!(val & 0x8000000000000000ull))
+    {
+      val <<= 1;
+      n++;
+    }
+    return n;
+#endif
+  }
+}
+
+void fast_bit_reader::set_input(const QByteArray &inArr, unsigned int inArrOffset)
+{
+  input = inArr;
+  rbsp.clear();
+  posInInput = inArrOffset;
+  initialPosInInput = inArrOffset;
+  numEmuPrevZeroBytes = 0;
+  emulationPreventionPositions.clear();
+  cache = 0;
+  nrBitsInCache = 0;
+  posInRbsp = 0;
+  nrBitsRead = 0;
+}
+
+void fast_bit_reader::disableEmulationPrevention()
+{
+  skipEmulationPrevention = false;
+  set_input(input, initialPosInInput);
+}
+
+bool fast_bit_reader::unescapeNextBlock()
+{
+  const unsigned int inputSize = unsigned(input.size());
+  if (posInInput >= inputSize)
+    return false;
+
+  const unsigned int blockEnd = std::min(posInInput + fastReaderBlockSize, inputSize);
+  const char *data = input.constData();
+  if (!skipEmulationPrevention)
+  {
+    rbsp.append(data + posInInput, int(blockEnd - posInInput));
+    posInInput = blockEnd;
+    return true;
+  }
+
+  // Copy the data in spans between the emulation prevention 3 bytes. An emulation prevention byte
+  // is detected in the same way as in sub_byte_reader::gotoNextByte.
+  unsigned int spanStart = posInInput;
+  for (unsigned int i = posInInput; i < blockEnd; i++)
+  {
+    if (numEmuPrevZeroBytes == 2 && data[i] == (char)3)
+    {
+      rbsp.append(data + spanStart, int(i - spanStart));
+      emulationPreventionPositions.append(unsigned(rbsp.size()));
+      spanStart = i + 1;
+      numEmuPrevZeroBytes = 0;
+    }
+    else if (data[i] == (char)0)
+      numEmuPrevZeroBytes++;
+    else
+      numEmuPrevZeroBytes = 0;
+  }
+  rbsp.append(data + spanStart, int(blockEnd - spanStart));
+  posInInput = blockEnd;
+  return true;
+}
+
+void fast_bit_reader::refillCache()
+{
+  while (nrBitsInCache <= 56)
+  {
+    if (posInRbsp >= unsigned(rbsp.size()) && !unescapeNextBlock())
+      return;
+    cache |= uint64_t((unsigned char)rbsp.constData()[posInRbsp]) << (56 - nrBitsInCache);
+    posInRbsp++;
+    nrBitsInCache += 8;
+  }
+}
+
+unsigned int fast_bit_reader::getCurrentInputByteIdx() const
+{
+  // The byte that the last read bit was taken from. Like in the sub_byte_reader, we only move
+  // to the next byte (and skip an emulation prevention byte) when the next bit is read.
+  const unsigned int rbspByteIdx = (nrBitsRead == 0) ? 0 : (nrBitsRead - 1) / 8;
+  auto nrSkippedBytes = std::upper_bound(emulationPreventionPositions.begin(), emulationPreventionPositions.end(), rbspByteIdx) - emulationPreventionPositions.begin();
+  return initialPosInInput + rbspByteIdx + unsigned(nrSkippedBytes);
+}
+
+unsigned int fast_bit_reader::readBits(int nrBits)
+{
+  // The return unsigned int is of depth 32 bits
+  if (nrBits > 32)
+    throw std::logic_error("Trying to read more than 32 bits at once from the bitstream.");
+  if (nrBits <= 0)
+    return 0;
+
+  if (nrBitsInCache < nrBits)
+  {
+    refillCache();
+    if (nrBitsInCache < nrBits)
+      throw std::logic_error("Error while reading annexB file. Trying to read over buffer boundary.");
+  }
+
+  const unsigned int val = (unsigned int)(cache >> (64 - nrBits));
+  cache <<= nrBits;
+  nrBitsInCache -= nrBits;
+  nrBitsRead += nrBits;
+  return val;
+}
+
+uint64_t fast_bit_reader::readBits64(int nrBits)
+{
+  if (nrBits > 64)
+    throw std::logic_error("Trying to read more than 64 bits at once from the bitstream.");
+  if (nrBits <= 32)
+    return readBits(nrBits);
+
+  const int lowerBits = nrBits - 32;
+  const uint64_t upper = readBits(32);
+  const uint64_t lower = readBits(lowerBits);
+  return (upper << lowerBits) + lower;
+}
+
+QByteArray fast_bit_reader::readBytes(int nrBytes)
+{
+  if (skipEmulationPrevention)
+    throw std::logic_error("Reading bytes with emulation prevention active is not supported.");
+  if (nrBitsRead % 8 != 0)
+    throw std::logic_error("When reading bytes from the bitstream, it should be byte alligned.");
+
+  QByteArray retArray;
+  retArray.reserve(nrBytes);
+  for (int i = 0; i < nrBytes; i++)
+    retArray.append(char(readBits(8)));
+  return retArray;
+}
+
+unsigned int fast_bit_reader::readUE_V(int &bit_count)
+{
+  // Count the leading zero bits. Whole zero words are skipped at once.
+  int golLength = 0;
+  while (true)
+  {
+    if (nrBitsInCache == 0)
+    {
+      refillCache();
+      if (nrBitsInCache == 0)
+        throw std::logic_error("Error while reading annexB file. Trying to read over buffer boundary.");
+    }
+    if (cache != 0)
+      break;
+    golLength += nrBitsInCache;
+    nrBitsRead += nrBitsInCache;
+    nrBitsInCache = 0;
+  }
+  const int zerosInCache = countLeadingZeros64(cache);
+  golLength += zerosInCache;
+
+  // Skip the zeros and the one bit
+  cache <<= zerosInCache;
+  cache <<= 1;
+  nrBitsInCache -= zerosInCache + 1;
+  nrBitsRead += zerosInCache + 1;
+
+  // Read "golLength" bits and add the exponential part
+  const uint64_t val = uint64_t(readBits(golLength)) + (uint64_t(1) << golLength) - 1;
+  bit_count += 2 * golLength + 1;
+  return (unsigned int)val;
+}
+
+int fast_bit_reader::readSE_V(int &bit_count)
+{
+  int val = readUE_V(bit_count);
+  if (val%2 == 0) 
+    return -(val+1)/2;
+  else
+    return (val+1)/2;
+}
+
+uint64_t fast_bit_reader::readLeb128(int &bit_count)
+{
+  // See sub_byte_reader::readLeb128
+  uint64_t value = 0;
+  for (int i = 0; i < 8; i++)
+  {
+    uint64_t leb128_byte = readBits(8);
+    bit_count += 8;
+    value |= ((leb128_byte & 0x7f) << (i*7));
+    if (!(leb128_byte & 0x80))
+      break;
+  }
+  return value;
+}
+
+uint64_t fast_bit_reader::readUVLC(int &bit_count)
+{
+  int leadingZeros = 0;
+  while (readBits(1) == 0)
+    leadingZeros++;
+  bit_count += leadingZeros + 1;
+  if (leadingZeros >= 32)
+    return ((uint64_t)1 << 32) - 1;
+  uint64_t value = readBits(leadingZeros);
+  return value + ((uint64_t)1 << leadingZeros) - 1;
+}
+
+int fast_bit_reader::readNS(int maxVal, int &bit_count)
+{
+  // FloorLog2
+  int floorVal;
+  {
+    int x = maxVal;
+    int s = 0;
+    while (x != 0)
+    {
+      x = x >> 1;
+      s++;
+    }
+    floorVal = s - 1;
+  }
+
+  int w = floorVal + 1;
+  int m = (1 << w) - maxVal;
+  int v = readBits(w-1);
+  bit_count += w-1;
+  if (v < m)
+    return v;
+  int extra_bit = readBits(1);
+  bit_count++;
+  return (v << 1) - m + extra_bit;
+}
+
+int fast_bit_reader::readSU(int nrBits)
+{
+  int value = readBits(nrBits);
+  int signMask = 1 << (nrBits - 1);
+  if (value & signMask)
+    value = value - 2 * signMask;
+  return value;
+}
+
+/* There is more data in the RBSP if the position of the last bit that is equal to 1 in the RBSP 
+ * (the rbsp_stop_one_bit) is after the current position. */
+bool fast_bit_reader::more_rbsp_data()
+{
+  while (unescapeNextBlock())
+  {
+  }
+
+  // Find the last non zero byte behind the cache
+  int lastNonZeroByte = rbsp.size() - 1;
+  while (lastNonZeroByte >= int(posInRbsp) && rbsp.at(lastNonZeroByte) == (char)0)
+    lastNonZeroByte--;
+
+  if (lastNonZeroByte >= int(posInRbsp))
+  {
+    if (nrBitsInCache > 0)
+      return true;
+    // The next bit is the stop bit if it is the only set bit of the remaining data
+    return !(lastNonZeroByte == int(posInRbsp) && (unsigned char)rbsp.at(lastNonZeroByte) == 0x80);
+  }
+
+  // The last set bit is in the cache. The next bit (the MSB of the cache) must not be the last set bit.
+  return (cache << 1) != 0;
+}
+
+bool fast_bit_reader::testReadingBits(int nrBits)
+{
+  // Same calculation as in the sub_byte_reader which is based on the input array
+  const unsigned int bitsReadInCurByte = nrBitsRead - ((nrBitsRead == 0) ? 0 : (nrBitsRead - 1) / 8 * 8);
+  const int curBitsLeft = 8 - int(bitsReadInCurByte);
+  const int entireBytesLeft = input.size() - int(getCurrentInputByteIdx()) - 1;
+  const int nrBitsLeftToRead = curBitsLeft + entireBytesLeft * 8;
+
+  return nrBits <= nrBitsLeftToRead;
+}
+
+unsigned int fast_bit_reader::nrBytesRead() const
+{
+  const unsigned int bitsReadInCurByte = nrBitsRead - ((nrBitsRead == 0) ? 0 : (nrBitsRead - 1) / 8 * 8);
+  return getCurrentInputByteIdx() - initialPosInInput + (bitsReadInCurByte != 0 ? 1 : 0);
+}
+
+unsigned int fast_bit_reader::nrBytesLeft() const
+{
+  return (unsigned int)(std::max(0, input.size() - int(getCurrentInputByteIdx()) - 1));
+}
+
 void sub_byte_writer::writeBits(int val, int nrBits)
 {
   while(nrBits > 0)
@@ -440,11 +744,231 @@ QByteArray sub_byte_writer::getByteArray()
   return byteArray;
 }
 
+/// --------------- TreeItemStringTable / TreeItemArena / TreeItem ---------------------
+
+namespace
+{
+  // The table that the strings of TreeItems are added to in the current thread (if any)
+  thread_local TreeItemStringTable *currentStringTable = nullptr;
+
+  // The arena that TreeItems are allocated from in the current thread (if any)
+  thread_local TreeItemArena *currentArena = nullptr;
+
+  // Every TreeItem is preceded by a header which says where the memory of the item came from
+  enum itemHeader : uint64_t
+  {
+    HEAP_ITEM,
+    ARENA_ITEM,
+    RELEASED_ARENA_ITEM
+  };
+  const size_t headerSize = sizeof(uint64_t);
+  const size_t slotSize = headerSize + (sizeof(TreeItem) + 7) / 8 * 8;
+  const int nrSlotsPerBlock = 4096;
+
+  uint64_t &getHeader(const void *ptr) { return *reinterpret_cast<uint64_t*>((char*)ptr - headerSize); }
+}
+
+TreeItemStringTable::~TreeItemStringTable()
+{
+  for (int b = 0; b < maxNrBlocks; b++)
+    delete[] blocks[b].load();
+}
+
+TreeItemStringTable::scope::scope(TreeItemStringTable *table)
+{
+  previousTable = currentStringTable;
+  currentStringTable = table;
+}
+
+TreeItemStringTable::scope::~scope()
+{
+  currentStringTable = previousTable;
+}
+
+TreeItemStringTable *TreeItemStringTable::current()
+{
+  return currentStringTable;
+}
+
+int TreeItemStringTable::intern(const QString &str)
+{
+  if (str.isEmpty())
+    return -1;
+  auto it = indexOfString.constFind(str);
+  if (it != indexOfString.constEnd())
+    return it.value();
+
+  const int idx = nrStrings.load();
+  if (idx >= maxNrStrings)
+    return -1;
+  const int blockIdx = idx >> blockSizeBits;
+  if (blocks[blockIdx].load() == nullptr)
+    blocks[blockIdx].storeRelease(new QString[blockSize]);
+  blocks[blockIdx].load()[idx & (blockSize - 1)] = str;
+  indexOfString.insert(str, idx);
+  // Only now the string can be read by other threads
+  nrStrings.storeRelease(idx + 1);
+  return idx;
+}
+
+QString TreeItemStringTable::get(int idx) const
+{
+  if (idx < 0 || idx >= nrStrings.loadAcquire())
+    return QString();
+  return blocks[idx >> blockSizeBits].loadAcquire()[idx & (blockSize - 1)];
+}
+
+TreeItemArena::~TreeItemArena()
+{
+  // Destruct all items that were not deleted yet. The items don't delete their children (these are in the arena as well)
+  // so this is one linear pass over the memory.
+  for (int b = 0; b < blocks.size(); b++)
+  {
+    char *block = blocks[b];
+    const int nrSlots = (b == blocks.size() - 1) ? nrSlotsUsedInLastBlock : nrSlotsPerBlock;
+    for (int i = 0; i < nrSlots; i++)
+    {
+      char *item = block + i * slotSize + headerSize;
+      if (getHeader(item) == ARENA_ITEM)
+        reinterpret_cast<TreeItem*>(item)->~TreeItem();
+    }
+    ::operator delete(block);
+  }
+}
+
+TreeItemArena::scope::scope(TreeItemArena *arena)
+{
+  previousArena = currentArena;
+  currentArena = arena;
+}
+
+TreeItemArena::scope::~scope()
+{
+  currentArena = previousArena;
+}
+
+void *TreeItemArena::allocate(size_t size)
+{
+  Q_ASSERT_X(size == sizeof(TreeItem), "TreeItemArena::allocate", "Only TreeItems can be allocated from the arena");
+  char *item;
+  if (currentArena)
+  {
+    item = (char*)currentArena->allocateSlot() + headerSize;
+    getHeader(item) = ARENA_ITEM;
+  }
+  else
+  {
+    item = (char*)::operator new(headerSize + size) + headerSize;
+    getHeader(item) = HEAP_ITEM;
+  }
+  return item;
+}
+
+void TreeItemArena::release(void *ptr)
+{
+  if (ptr == nullptr)
+    return;
+  if (getHeader(ptr) == HEAP_ITEM)
+    ::operator delete((char*)ptr - headerSize);
+  else
+    // The memory is freed together with the arena
+    getHeader(ptr) = RELEASED_ARENA_ITEM;
+}
+
+bool TreeItemArena::isArenaItem(const void *ptr)
+{
+  return getHeader(ptr) != HEAP_ITEM;
+}
+
+void *TreeItemArena::allocateSlot()
+{
+  if (blocks.isEmpty() || nrSlotsUsedInLastBlock == nrSlotsPerBlock)
+  {
+    blocks.append((char*)::operator new(slotSize * nrSlotsPerBlock));
+    nrSlotsUsedInLastBlock = 0;
+  }
+  return blocks.last() + (nrSlotsUsedInLastBlock++) * slotSize;
+}
+
+TreeItem::~TreeItem()
+{
+  // Items from an arena are destructed by the arena
+  for (TreeItem *child : childItems)
+    if (!TreeItemArena::isArenaItem(child))
+      delete child;
+}
+
+void TreeItem::init(TreeItem *parent, const QString &name, const QString &coding, const QString &code, const QString &meaning)
+{
+  parentItem = parent;
+  if (parent)
+    parent->childItems.append(this);
+  // Without a table (or if the table is full), the item keeps the strings itself
+  TreeItemStringTable *strings = TreeItemStringTable::current();
+  if (strings)
+  {
+    nameID = strings->intern(name);
+    codingID = strings->intern(coding);
+    meaningID = strings->intern(meaning);
+  }
+  if (nameID < 0)
+    uniqueName = name;
+  if (codingID < 0)
+    uniqueCoding = coding;
+  if (meaningID < 0)
+    uniqueMeaning = meaning;
+
+  const bool codeIsBinary = std::all_of(code.begin(), code.end(), [](QChar c) { return c == '0' || c == '1'; });
+  if (codeIsBinary && code.size() <= 64)
+  {
+    codeLength = uint8_t(code.size());
+    for (QChar c : code)
+      codeBits = (codeBits << 1) | (c == '1' ? 1 : 0);
+  }
+  else
+    codeString = code;
+}
+
+QString TreeItem::getData(int column, const TreeItemStringTable &strings) const
+{
+  if (column == 0)
+    return (nameID >= 0) ? strings.get(nameID) : uniqueName;
+  if (column == 1)
+  {
+    switch (type)
+    {
+    case valueType::signedInt:
+      return QString::number(signedValue);
+    case valueType::unsignedInt:
+      return QString::number(unsignedValue);
+    case valueType::floatingPoint:
+      return QString::number(doubleValue);
+    case valueType::flag:
+      return (unsignedValue != 0) ? "1" : "0";
+    case valueType::string:
+      return stringValue;
+    default:
+      return QString();
+    }
+  }
+  if (column == 2)
+    return (codingID >= 0) ? strings.get(codingID) : uniqueCoding;
+  if (column == 3)
+    return (codeLength > 0) ? QString::number(codeBits, 2).rightJustified(codeLength, '0') : codeString;
+  if (column == 4)
+    return (meaningID >= 0) ? strings.get(meaningID) : uniqueMeaning;
+  return QString();
+}
+
 /// --------------- reader_helper ---------------------
 
 void reader_helper::init(const QByteArray &inArr, TreeItem *item, QString new_sub_item_name)
 {
-  set_input(inArr);
+  logging = (item != nullptr);
+  if (logging)
+    set_input(inArr);
+  else
+    fastReader.set_input(inArr);
   if (item)
   {
     if (new_sub_item_name.isEmpty())
@@ -531,10 +1055,12 @@ bool reader_helper::readBits(int numBits, QList<unsigned int> &into, QString int
   if (!readBits_catch(val, numBits, code))
     return false;
   into.append(val);
-  if (idx >= 0)
-    intoName += QString("[%1]").arg(idx);
   if (currentTreeLevel)
+  {
+    if (idx >= 0)
+      intoName += QString("[%1]").arg(idx);
     new TreeItem(intoName, val, QString("u(v) -> u(%1)").arg(numBits), code, currentTreeLevel);
+  }
   return true;
 }
 
@@ -545,10 +1071,12 @@ bool reader_helper::readBits(int numBits, QList<unsigned int> &into, QString int
   if (!readBits_catch(val, numBits, code))
     return false;
   into.append(val);
-  if (idx >= 0)
-    intoName += QString("[%1]").arg(idx);
   if (currentTreeLevel)
+  {
+    if (idx >= 0)
+      intoName += QString("[%1]").arg(idx);
     new TreeItem(intoName, val, QString("u(v) -> u(%1)").arg(numBits), code, pMeaning(val), currentTreeLevel);
+  }
   return true;
 }
 
@@ -560,10 +1088,12 @@ bool reader_helper::readBits(int numBits, QByteArray &into, QString intoName, in
   if (!readBits_catch(val, numBits, code))
     return false;
   into.append(val);
-  if (idx >= 0)
-    intoName += QString("[%1]").arg(idx);
   if (currentTreeLevel)
+  {
+    if (idx >= 0)
+      intoName += QString("[%1]").arg(idx);
     new TreeItem(intoName, val, QString("u(v) -> u(%1)").arg(numBits), code, currentTreeLevel);
+  }
   return true;
 }
 
@@ -629,10 +1159,12 @@ bool reader_helper::readFlag(QList<bool> &into, QString intoName, int idx, QStri
     return false;
   bool val = (read_val != 0);
   into.append(val);
-  if (idx >= 0)
-    intoName += QString("[%1]").arg(idx);
   if (currentTreeLevel)
+  {
+    if (idx >= 0)
+      intoName += QString("[%1]").arg(idx);
     new TreeItem(intoName, val, "u(1)", code, meaning, currentTreeLevel);
+  }
   return true;
 }
 
@@ -678,10 +1210,12 @@ bool reader_helper::readUEV(QList<quint32> &into, QString intoName, int idx, QSt
   if (!readUEV_catch(val, bit_count, code))
     return false;
   into.append(val);
-  if (idx >= 0)
-    intoName += QString("[%1]").arg(idx);
   if (currentTreeLevel)
+  {
+    if (idx >= 0)
+      intoName += QString("[%1]").arg(idx);
     new TreeItem(intoName, val, QString("ue(v) -> ue(%1)").arg(bit_count), code, meaning, currentTreeLevel);
+  }
   return true;
 }
 
@@ -704,10 +1238,12 @@ bool reader_helper::readSEV(QList<int> into, QString intoName, int idx)
   if (!readUEV_catch(val, bit_count, code))
     return false;
   into.append(val);
-  if (idx >= 0)
-    intoName += QString("[%1]").arg(idx);
   if (currentTreeLevel)
+  {
+    if (idx >= 0)
+      intoName += QString("[%1]").arg(idx);
     new TreeItem(intoName, val, QString("se(v) -> se(%1)").arg(bit_count), code, currentTreeLevel);
+  }
   return true;
 }
 
@@ -792,7 +1328,7 @@ bool reader_helper::readBits_catch(unsigned int &into, int numBits, QString &cod
 {
   try
   {
-    into = sub_byte_reader::readBits(numBits, code);
+    into = logging ? sub_byte_reader::readBits(numBits, code) : fastReader.readBits(numBits);
   }
   catch (const std::exception& ex)
   {
@@ -806,7 +1342,7 @@ bool reader_helper::readBits64_catch(uint64_t &into, int numBits, QString &code)
 {
   try
   {
-    into = sub_byte_reader::readBits64(numBits, code);
+    into = logging ? sub_byte_reader::readBits64(numBits, code) : fastReader.readBits64(numBits);
   }
   catch (const std::exception& ex)
   {
@@ -820,7 +1356,7 @@ bool reader_helper::readUEV_catch(unsigned int &into, int &bit_count, QString &c
 {
   try
   {
-    into = sub_byte_reader::readUE_V(code, bit_count);
+    into = logging ? sub_byte_reader::readUE_V(code, bit_count) : fastReader.readUE_V(bit_count);
   }
   catch (const std::exception& ex)
   {
@@ -834,7 +1370,7 @@ bool reader_helper::readSEV_catch(int &into, int &bit_count, QString &code)
 {
   try
   {
-    into = sub_byte_reader::readSE_V(code, bit_count);
+    into = logging ? sub_byte_reader::readSE_V(code, bit_count) : fastReader.readSE_V(bit_count);
   }
   catch (const std::exception& ex)
   {
@@ -848,7 +1384,7 @@ bool reader_helper::readLeb128_catch(uint64_t &into, int &bit_count, QString &co
 {
   try
   {
-    into = sub_byte_reader::readLeb128(code, bit_count);
+    into = logging ? sub_byte_reader::readLeb128(code, bit_count) : fastReader.readLeb128(bit_count);
   }
   catch (const std::exception& ex)
   {
@@ -862,7 +1398,7 @@ bool reader_helper::readUVLC_catch(uint64_t &into, int &bit_count, QString &code
 {
   try
   {
-    into = sub_byte_reader::readUVLC(code, bit_count);
+    into = logging ? sub_byte_reader::readUVLC(code, bit_count) : fastReader.readUVLC(bit_count);
   }
   catch (const std::exception& ex)
   {
@@ -876,7 +1412,7 @@ bool reader_helper::readNS_catch(int &into, int maxVal, int &bit_count, QString
 {
   try
   {
-    into = sub_byte_reader::readNS(maxVal, code, bit_count);
+    into = logging ? sub_byte_reader::readNS(maxVal, code, bit_count) : fastReader.readNS(maxVal, bit_count);
   }
   catch (const std::exception& ex)
   {
@@ -890,7 +1426,7 @@ bool reader_helper::readSU_catch(int &into, int numBits, QString &code)
 {
   try
   {
-    into = sub_byte_reader::readSU(numBits, code);
+    into = logging ? sub_byte_reader::readSU(numBits, code) : fastReader.readSU(numBits);
   }
   catch (const std::exception& ex)
   {
@@ -946,12 +1482,13 @@ PacketItemModel::PacketItemModel(QObject *parent) : QAbstractItemModel(parent)
 
 PacketItemModel::~PacketItemModel()
 {
+  qDeleteAll(detailTrees);
 }
 
 QVariant PacketItemModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
   if (orientation == Qt::Horizontal && role == Qt::DisplayRole && rootItem != nullptr)
-    return rootItem->itemData.value(section, QString());
+    return rootItem->getData(section, stringTable);
 
   return QVariant();
 }
@@ -962,6 +1499,25 @@ QVariant PacketItemModel::data(const QModelIndex &index, int role) const
     return QVariant();
 
   TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+  if (item == nullptr)
+  {
+    // A first level item in lazy mode. Only the packet record exists.
+    QMutexLocker lock(&packetRecordsMutex);
+    if (index.row() >= packetRecords.size())
+      return QVariant();
+    const packetRecord &record = packetRecords.at(index.row());
+    if (role == Qt::ForegroundRole)
+    {
+      if (record.isError)
+        return QVariant(QBrush(QColor(255, 0, 0)));
+      return QVariant(QBrush());
+    }
+    if (role == Qt::BackgroundRole)
+      return QVariant(QBrush());
+    if ((role == Qt::DisplayRole || role == Qt::ToolTipRole) && index.column() == 0)
+      return QVariant(record.name);
+    return QVariant();
+  }
   if (role == Qt::ForegroundRole)
   {
     if (item->isError())
@@ -980,9 +1536,9 @@ QVariant PacketItemModel::data(const QModelIndex &index, int role) const
   else if (role == Qt::DisplayRole || role == Qt::ToolTipRole)
   {
     if (index.column() == 0)
-      return QVariant(item->getName(!showVideoOnly));
+      return QVariant(item->getName(!showVideoOnly, stringTable));
     else
-      return QVariant(item->itemData.value(index.column()));
+      return QVariant(item->getData(index.column(), stringTable));
   }
   return QVariant();
 }
@@ -994,9 +1550,14 @@ QModelIndex PacketItemModel::index(int row, int column, const QModelIndex &paren
 
   TreeItem *parentItem;
   if (!parent.isValid())
+  {
+    // In lazy mode, there is no TreeItem for the first level items
+    if (isLazy())
+      return createIndex(row, column, nullptr);
     parentItem = rootItem.data();
+  }
   else
-    parentItem = static_cast<TreeItem*>(parent.internalPointer());
+    parentItem = getItem(parent);
 
   Q_ASSERT_X(parentItem != nullptr, "PacketItemModel::index", "pointer to parent is null. This must never happen");
 
@@ -1013,11 +1574,18 @@ QModelIndex PacketItemModel::parent(const QModelIndex &index) const
     return QModelIndex();
 
   TreeItem *childItem = static_cast<TreeItem*>(index.internalPointer());
+  if (childItem == nullptr)
+    // A first level item in lazy mode
+    return QModelIndex();
   TreeItem *parentItem = childItem->parentItem;
 
   if (parentItem == rootItem.data())
     return QModelIndex();
 
+  const int packetIdx = getPacketIndexOfDetailTree(parentItem);
+  if (packetIdx >= 0)
+    return createIndex(packetIdx, 0, nullptr);
+
   // Get the row of the item in the list of children of the parent item
   int row = 0;
   if (parentItem)
@@ -1036,10 +1604,115 @@ int PacketItemModel::rowCount(const QModelIndex &parent) const
     TreeItem *p = rootItem.data();
     return (p == nullptr) ? 0 : nrShowChildItems;
   }
-  TreeItem *p = static_cast<TreeItem*>(parent.internalPointer());
+  TreeItem *p = getItem(parent);
   return (p == nullptr) ? 0 : p->childItems.count();
 }
 
+bool PacketItemModel::hasChildren(const QModelIndex &parent) const
+{
+  // We don't know what is in a packet before it is parsed. Every packet has at least a header.
+  if (isLazy() && parent.isValid() && parent.internalPointer() == nullptr)
+    return parent.column() == 0;
+  return QAbstractItemModel::hasChildren(parent);
+}
+
+bool PacketItemModel::canFetchMore(const QModelIndex &parent) const
+{
+  if (!isLazy() || !parent.isValid() || parent.internalPointer() != nullptr)
+    return false;
+  return !detailTrees.contains(parent.row());
+}
+
+void PacketItemModel::fetchMore(const QModelIndex &parent)
+{
+  if (!canFetchMore(parent))
+    return;
+
+  const int packetIdx = parent.row();
+  QUint64Pair fileStartEndPos;
+  {
+    QMutexLocker lock(&packetRecordsMutex);
+    if (packetIdx >= packetRecords.size())
+      return;
+    fileStartEndPos = packetRecords.at(packetIdx).fileStartEndPos;
+  }
+
+  if (detailTreesLRU.size() >= maxNrDetailTrees)
+    dropLeastRecentlyUsedDetailTree();
+
+  DEBUG_MODEL("PacketItemModel::fetchMore Creating details for packet %d", packetIdx);
+  // The background parser adds no items in lazy mode so this is the only thread that adds strings to the table.
+  // The detail trees are deleted one by one so they are not allocated from the arena.
+  TreeItemStringTable::scope stringScope(&stringTable);
+  TreeItem *detailTree = new TreeItem(nullptr);
+  if (!detailProvider->createPacketDetails(packetIdx, fileStartEndPos, detailTree) && detailTree->childItems.isEmpty())
+    reader_helper::addErrorMessageChildItem("Error parsing the packet again", detailTree);
+
+  const int nrRows = detailTree->childItems.count();
+  if (nrRows > 0)
+    beginInsertRows(createIndex(packetIdx, 0, nullptr), 0, nrRows - 1);
+  detailTrees.insert(packetIdx, detailTree);
+  detailTreePacketIndices.insert(detailTree, packetIdx);
+  detailTreesLRU.append(packetIdx);
+  if (nrRows > 0)
+    endInsertRows();
+}
+
+void PacketItemModel::dropLeastRecentlyUsedDetailTree()
+{
+  // If the tree is expanded again, canFetchMore returns true and it is parsed again
+  const int dropIdx = detailTreesLRU.takeFirst();
+  TreeItem *dropTree = detailTrees.value(dropIdx);
+  const int nrDropRows = dropTree->childItems.count();
+  if (nrDropRows > 0)
+    beginRemoveRows(createIndex(dropIdx, 0, nullptr), 0, nrDropRows - 1);
+  detailTrees.remove(dropIdx);
+  detailTreePacketIndices.remove(dropTree);
+  if (nrDropRows > 0)
+    endRemoveRows();
+  delete dropTree;
+}
+
+void PacketItemModel::addPacketRecord(QUint64Pair fileStartEndPos, const QString &name, bool isError)
+{
+  QMutexLocker lock(&packetRecordsMutex);
+  packetRecords.append(packetRecord{fileStartEndPos, name, isError});
+}
+
+unsigned int PacketItemModel::getNumberFirstLevelChildren()
+{
+  if (isLazy())
+  {
+    QMutexLocker lock(&packetRecordsMutex);
+    return packetRecords.size();
+  }
+  return rootItem.isNull() ? 0 : rootItem->childItems.size();
+}
+
+TreeItem *PacketItemModel::getItem(const QModelIndex &index) const
+{
+  TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+  if (item == nullptr && isLazy())
+  {
+    TreeItem *detailTree = detailTrees.value(index.row(), nullptr);
+    if (detailTree != nullptr && detailTreesLRU.last() != index.row())
+    {
+      // The tree is used. Move it to the back of the LRU list.
+      detailTreesLRU.removeOne(index.row());
+      detailTreesLRU.append(index.row());
+    }
+    return detailTree;
+  }
+  return item;
+}
+
+int PacketItemModel::getPacketIndexOfDetailTree(TreeItem *item) const
+{
+  if (!isLazy() || item == nullptr || item->parentItem != nullptr)
+    return -1;
+  return detailTreePacketIndices.value(item, -1);
+}
+
 void PacketItemModel::updateNumberModelItems()
 {
   auto n = getNumberFirstLevelChildren();
@@ -1196,6 +1869,13 @@ void BitrateItemModel::updateNumberModelItems()
   endInsertRows();
 }
 
+bool BitrateItemModel::isEntryBefore(const bitrateEntry &a, const bitrateEntry &b, SortMode mode)
+{
+  if (mode == SortMode::DECODE_ORDER)
+    return a.dts < b.dts;
+  return a.pts < b.pts;
+}
+
 void BitrateItemModel::addBitratePoint(int streamIndex, bitrateEntry &entry)
 {
   dtsRange.min = qMin(dtsRange.min, entry.dts);
@@ -1215,13 +1895,13 @@ void BitrateItemModel::addBitratePoint(int streamIndex, bitrateEntry &entry)
   const auto currentSortMode = this->sortMode;
   auto compareFunctionLessThen = [currentSortMode](const bitrateEntry &a, const bitrateEntry &b)
   {
-    if (currentSortMode == SortMode::DECODE_ORDER)
-      return a.dts < b.dts;
-    else
-      return b.pts < a.pts;
+    return isEntryBefore(a, b, currentSortMode);
   };
-  auto insertIterator = std::upper_bound(bitratePerStreamData[streamIndex].begin(), bitratePerStreamData[streamIndex].end(), entry, compareFunctionLessThen);
-  bitratePerStreamData[streamIndex].insert(insertIterator, entry);
+  auto &entries = bitratePerStreamData[streamIndex];
+  auto insertIterator = std::upper_bound(entries.begin(), entries.end(), entry, compareFunctionLessThen);
+  const int insertIdx = int(insertIterator - entries.begin());
+  entries.insert(insertIterator, entry);
+  levelsOfDetailPerStream[streamIndex].update(entries, insertIdx);
 }
 
 void BitrateItemModel::setBitrateSortingIndex(int index)
@@ -1242,16 +1922,17 @@ void BitrateItemModel::setBitrateSortingIndex(int index)
   const auto currentSortMode = this->sortMode;
   auto compareFunctionLessThen = [currentSortMode](const bitrateEntry &a, const bitrateEntry &b)
   {
-    if (currentSortMode == SortMode::DECODE_ORDER)
-      return a.dts < b.dts;
-    else
-      return a.pts < b.pts;
+    return isEntryBefore(a, b, currentSortMode);
   };
 
   // Note: None of these signals really update the bar chart. The way that worked is to set a null Model and then set the model again (see BitstreamAnalysisWidget::bitratePlotOrderComboBoxIndexChanged)
   //emit QAbstractItemModel::layoutAboutToBeChanged();
-  for (auto &list : this->bitratePerStreamData)
-    std::sort(list.begin(), list.end(), compareFunctionLessThen);
+  QMutexLocker locker(&this->bitratePerStreamDataMutex);
+  for (auto it = this->bitratePerStreamData.begin(); it != this->bitratePerStreamData.end(); it++)
+  {
+    std::sort(it.value().begin(), it.value().end(), compareFunctionLessThen);
+    levelsOfDetailPerStream[it.key()].update(it.value(), 0);
+  }
   //emit QAbstractItemModel::layoutChanged();
 
   // auto topLeft = this->index(0, 0);
@@ -1259,6 +1940,114 @@ void BitrateItemModel::setBitrateSortingIndex(int index)
   // emit QAbstractItemModel::dataChanged(topLeft, bottomRight);
 }
 
+void BitrateItemModel::bitrateBucket::merge(const bitrateBucket &other)
+{
+  minBitrate = qMin(minBitrate, other.minBitrate);
+  maxBitrate = qMax(maxBitrate, other.maxBitrate);
+  maxNonKeyframeBitrate = qMax(maxNonKeyframeBitrate, other.maxNonKeyframeBitrate);
+  sumBitrate += other.sumBitrate;
+  nrEntries += other.nrEntries;
+  containsKeyframe = containsKeyframe || other.containsKeyframe;
+}
+
+BitrateItemModel::bitrateBucket BitrateItemModel::bucketFromEntry(const bitrateEntry &entry)
+{
+  bitrateBucket bucket;
+  bucket.minBitrate = entry.bitrate;
+  bucket.maxBitrate = entry.bitrate;
+  bucket.maxNonKeyframeBitrate = entry.keyframe ? 0 : entry.bitrate;
+  bucket.sumBitrate = entry.bitrate;
+  bucket.nrEntries = 1;
+  bucket.containsKeyframe = entry.keyframe;
+  return bucket;
+}
+
+void BitrateItemModel::levelsOfDetail::update(const QList<bitrateEntry> &entries, int firstChangedIdx)
+{
+  // Every level is built from the level below it. Only the buckets from the changed entry on have to be updated.
+  // When entries are added at the end (the usual case), this is one bucket per level.
+  const int nrEntries = entries.size();
+  for (int level = 1; (nrEntries - 1) >> (level - 1) > 0; level++)
+  {
+    if (levels.size() < level)
+      levels.append(QVector<bitrateBucket>());
+    QVector<bitrateBucket> &buckets = levels[level - 1];
+    const int nrBuckets = ((nrEntries - 1) >> level) + 1;
+    const int nrBucketsLowerLevel = ((nrEntries - 1) >> (level - 1)) + 1;
+    buckets.resize(nrBuckets);
+    for (int i = firstChangedIdx >> level; i < nrBuckets; i++)
+    {
+      bitrateBucket bucket = getBucket(entries, level - 1, 2 * i);
+      if (2 * i + 1 < nrBucketsLowerLevel)
+        bucket.merge(getBucket(entries, level - 1, 2 * i + 1));
+      buckets[i] = bucket;
+    }
+  }
+}
+
+BitrateItemModel::bitrateBucket BitrateItemModel::levelsOfDetail::getBucket(const QList<bitrateEntry> &entries, int level, int bucketIdx) const
+{
+  if (level == 0)
+    return bucketFromEntry(entries.at(bucketIdx));
+  return levels.at(level - 1).at(bucketIdx);
+}
+
+QList<BitrateItemModel::bitrateBucket> BitrateItemModel::getBitrateBuckets(int level, int firstBucket, int nrBuckets) const
+{
+  QList<bitrateBucket> buckets;
+  if (level < 0 || firstBucket < 0)
+    return buckets;
+
+  QMutexLocker locker(&this->bitratePerStreamDataMutex);
+  auto entriesIt = bitratePerStreamData.constFind(0);
+  auto lodIt = levelsOfDetailPerStream.constFind(0);
+  if (entriesIt == bitratePerStreamData.constEnd() || lodIt == levelsOfDetailPerStream.constEnd())
+    return buckets;
+  const QList<bitrateEntry> &entries = entriesIt.value();
+  const levelsOfDetail &lod = lodIt.value();
+
+  // Only return buckets for the entries that are shown (nrRatePoints). The background parser may have added more already.
+  const int nrEntries = qMin(int(nrRatePoints), entries.size());
+  if (nrEntries == 0)
+    return buckets;
+  const int lastBucket = qMin(firstBucket + nrBuckets, ((nrEntries - 1) >> level) + 1);
+  for (int i = firstBucket; i < lastBucket; i++)
+  {
+    const int firstEntry = i << level;
+    const int lastEntry = qMin(((i + 1) << level), nrEntries);
+    if (level > lod.levels.size() || lastEntry - firstEntry < (1 << level))
+    {
+      // The last (incomplete) bucket or a level that does not exist yet. Aggregate the shown entries directly.
+      bitrateBucket bucket;
+      for (int e = firstEntry; e < lastEntry; e++)
+        bucket.merge(bucketFromEntry(entries.at(e)));
+      buckets.append(bucket);
+    }
+    else
+      buckets.append(lod.getBucket(entries, level, i));
+  }
+  return buckets;
+}
+
+QString BitrateItemModel::getBucketInfoText(int level, int bucketIdx)
+{
+  if (level == 0)
+    return this->getItemInfoText(bucketIdx);
+
+  auto buckets = getBitrateBuckets(level, bucketIdx, 1);
+  if (buckets.isEmpty())
+    return {};
+  const bitrateBucket &bucket = buckets.first();
+  const int firstEntry = bucketIdx << level;
+  QString text;
+  text += QString("Entries %1 - %2\n").arg(firstEntry).arg(firstEntry + int(bucket.nrEntries) - 1);
+  text += QString("Minimum Bitrate: %1\n").arg(bucket.minBitrate);
+  text += QString("Maximum Bitrate: %1\n").arg(bucket.maxBitrate);
+  text += QString("Average Bitrate: %1").arg(bucket.getAverageBitrate(), 0, 'f', 1);
+  if (bucket.containsKeyframe)
+    text += QString("\nContains keyframes");
+  return text;
+}
 
 /// ------------------- FilterByStreamIndexProxyModel -----------------------------
 
@@ -1276,6 +2065,14 @@ bool FilterByStreamIndexProxyModel::filterAcceptsRow(int row, const QModelIndex
     return true;
   }
 
+  // The lazy mode is only used for bitstreams with one stream. There is no stream index to filter by.
+  PacketItemModel *sourcePacketModel = static_cast<PacketItemModel*>(sourceModel());
+  if (sourcePacketModel != nullptr && sourcePacketModel->isLazy())
+  {
+    DEBUG_FILTER("FilterByStreamIndexProxyModel::filterAcceptsRow lazy model - accepting all");
+    return true;
+  }
+
   TreeItem *parentItem;
   if (!sourceParent.isValid())
   {
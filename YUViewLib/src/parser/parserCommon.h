@@ -34,13 +34,19 @@
 #ifndef PARSERCOMMON_H
 #define PARSERCOMMON_H
 
+#include <climits>
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
 #include <QBrush>
 #include <QByteArray>
+#include <QHash>
 #include <QList>
 #include <QMap>
 #include <QMutex>
 #include <QSortFilterProxyModel>
 #include <QString>
+#include <QVector>
 
 #include "common/typedef.h"
 
@@ -101,6 +107,65 @@ namespace parserCommon
     unsigned int initialPosInBuffer  {0}; // The position that was given when creating the sub reader
   };
 
+  /* A fast alternative to the sub_byte_reader for passes over the bitstream where nothing is logged (e.g. when
+   * building the list of frames and random access points). The emulation prevention bytes are removed from
+   * larger blocks of the input at once and the bits are read from a 64 bit cache. No strings are created.
+   * The interface and the error handling (exceptions) are the same as for the sub_byte_reader.
+   */
+  class fast_bit_reader
+  {
+  public:
+    fast_bit_reader() {};
+    fast_bit_reader(const QByteArray &inArr, unsigned int inArrOffset = 0) { set_input(inArr, inArrOffset); }
+
+    void set_input(const QByteArray &inArr, unsigned int inArrOffset = 0);
+
+    unsigned int readBits(int nrBits);
+    uint64_t     readBits64(int nrBits);
+    QByteArray   readBytes(int nrBytes);
+    unsigned int readUE_V(int &bit_count);
+    int          readSE_V(int &bit_count);
+    uint64_t     readLeb128(int &bit_count);
+    uint64_t     readUVLC(int &bit_count);
+    int          readNS(int maxVal, int &bit_count);
+    int          readSU(int nrBits);
+
+    bool more_rbsp_data();
+    bool payload_extension_present() { return more_rbsp_data(); }
+    bool testReadingBits(int nrBits);
+    unsigned int nrBytesRead() const;
+    unsigned int nrBytesLeft() const;
+
+    // This must be called before anything is read
+    void disableEmulationPrevention();
+
+  protected:
+    // Convert the next block of the input to RBSP data (remove the emulation prevention bytes).
+    // Returns false if the end of the input was reached.
+    bool unescapeNextBlock();
+    // Fill the cache with as many bytes as possible
+    void refillCache();
+    // Get the index of the current byte in the input array (including the emulation prevention bytes)
+    unsigned int getCurrentInputByteIdx() const;
+
+    QByteArray input;
+    QByteArray rbsp;
+
+    bool skipEmulationPrevention {true};
+
+    unsigned int posInInput          {0}; // The next byte in the input that was not converted to RBSP yet
+    unsigned int initialPosInInput   {0}; // The position that was given when creating the reader
+    unsigned int numEmuPrevZeroBytes {0}; // The number of consecutive zero bytes before posInInput
+    // For every removed emulation prevention byte, the index of the following byte in the rbsp array
+    QList<unsigned int> emulationPreventionPositions;
+
+    // The next bits to read are in the most significant bits of the cache
+    uint64_t     cache         {0};
+    int          nrBitsInCache {0};
+    unsigned int posInRbsp     {0}; // The next byte from the rbsp that is not in the cache yet
+    unsigned int nrBitsRead    {0};
+  };
+
   /* This class provides the ability to write to a QByteArray on a bit basis. 
   */
   class sub_byte_writer
@@ -118,49 +183,175 @@ namespace parserCommon
     int posInByte;        // The bit position in the current byte
   };
 
-  // The tree item is used to feed the tree view. Each NAL unit can return a representation using TreeItems
+  /* Memory for the TreeItems of one parsing run. While a scope for an arena exists in a thread, all TreeItems that are
+   * created in this thread are allocated from the arena. Items from an arena don't delete their children (the arena owns
+   * them) and the arena frees all items at once which is much faster than deleting millions of items one by one.
+  */
+  class TreeItemArena
+  {
+  public:
+    TreeItemArena() {}
+    ~TreeItemArena();
+
+    // Allocate all TreeItems that are created in the current thread from the given arena while this object is alive
+    class scope
+    {
+    public:
+      scope(TreeItemArena *arena);
+      ~scope();
+    private:
+      TreeItemArena *previousArena;
+    };
+
+    // These are used by the TreeItem new and delete operators
+    static void *allocate(size_t size);
+    static void release(void *ptr);
+    static bool isArenaItem(const void *ptr);
+
+  private:
+    Q_DISABLE_COPY(TreeItemArena)
+    void *allocateSlot();
+
+    QList<char*> blocks;
+    int nrSlotsUsedInLastBlock {0};
+  };
+
+  /* The names, codings and meanings of the TreeItems of one model. The same few thousand strings are used over and over
+   * again so every string is only saved once and the items only keep an index. While a scope for a table exists in a
+   * thread, all TreeItems that are created in this thread add their strings to it.
+   * Only one thread may add strings at a time (the background parser or, in lazy mode, the GUI thread that creates the
+   * detail trees). Reading (get) needs no lock: The strings are saved in blocks that never move and a string is only
+   * counted after it was written.
+  */
+  class TreeItemStringTable
+  {
+  public:
+    explicit TreeItemStringTable(int maxNrStrings = maxNrBlocks * blockSize) : maxNrStrings(qBound(0, maxNrStrings, maxNrBlocks * blockSize)) {}
+    ~TreeItemStringTable();
+
+    // Add all strings of TreeItems that are created in the current thread to the given table while this object is alive
+    class scope
+    {
+    public:
+      scope(TreeItemStringTable *table);
+      ~scope();
+    private:
+      TreeItemStringTable *previousTable;
+    };
+    static TreeItemStringTable *current();
+
+    // Get the index of the string (add it if it is not in the table yet). Returns -1 for an empty string or if the table is full.
+    // The TreeItems keep the strings that could not be added themselves.
+    int intern(const QString &str);
+    QString get(int idx) const;
+
+  private:
+    Q_DISABLE_COPY(TreeItemStringTable)
+
+    static const int blockSizeBits = 10;
+    static const int blockSize = 1 << blockSizeBits;
+    static const int maxNrBlocks = 1024;
+    const int maxNrStrings;
+
+    // This is only used by the thread that adds the strings
+    QHash<QString, int> indexOfString;
+    QAtomicPointer<QString> blocks[maxNrBlocks];
+    QAtomicInt nrStrings {0};
+  };
+
+  // The tree item is used to feed the tree view. Each NAL unit can return a representation using TreeItems.
+  // There may be millions of items so they are stored compactly: Names, codings and meanings are the same few
+  // thousand strings over and over again and are kept in the TreeItemStringTable of the model. Values and codes are kept 
+  // as numbers and are only converted to strings when they are shown (getData).
   class TreeItem
   {
   public:
     // Some useful constructors of new Tree items. You must at least specify a parent. The new item is atomatically added as a child 
     // of the parent.
-    TreeItem(TreeItem *parent) { parentItem = parent; if (parent) parent->childItems.append(this); }
-    TreeItem(QList<QString> &data, TreeItem *parent) { parentItem = parent; if (parent) parent->childItems.append(this); itemData = data; }
-    TreeItem(const QString &name, TreeItem *parent)  { parentItem = parent; if (parent) parent->childItems.append(this); itemData.append(name); }
-    TreeItem(const QString &name, int          val, TreeItem *parent) { parentItem = parent; if (parent) parent->childItems.append(this); itemData << name << QString::number(val); }
-    TreeItem(const QString &name, QString      val, TreeItem *parent) { parentItem = parent; if (parent) parent->childItems.append(this); itemData << name << val; }
-    TreeItem(const QString &name, int          val, const QString &coding, const QString &code, TreeItem *parent) { parentItem = parent; if (parent) parent->childItems.append(this); itemData << name << QString::number(val) << coding << code; }
-    TreeItem(const QString &name, unsigned int val, const QString &coding, const QString &code, TreeItem *parent) { parentItem = parent; if (parent) parent->childItems.append(this); itemData << name << QString::number(val) << coding << code; }
-    TreeItem(const QString &name, uint64_t     val, const QString &coding, const QString &code, TreeItem *parent) { parentItem = parent; if (parent) parent->childItems.append(this); itemData << name << QString::number(val) << coding << code; }
-    TreeItem(const QString &name, int64_t      val, const QString &coding, const QString &code, TreeItem *parent) { parentItem = parent; if (parent) parent->childItems.append(this); itemData << name << QString::number(val) << coding << code; }
-    TreeItem(const QString &name, bool         val, const QString &coding, const QString &code, TreeItem *parent) { parentItem = parent; if (parent) parent->childItems.append(this); itemData << name << (val ? "1" : "0")    << coding << code; }
-    TreeItem(const QString &name, double       val, const QString &coding, const QString &code, TreeItem *parent) { parentItem = parent; if (parent) parent->childItems.append(this); itemData << name << QString::number(val) << coding << code; }
-    TreeItem(const QString &name, QString      val, const QString &coding, const QString &code, TreeItem *parent) { parentItem = parent; if (parent) parent->childItems.append(this); itemData << name << val << coding << code; }
-    TreeItem(const QString &name, int          val, const QString &coding, const QString &code, QString meaning, TreeItem *parent) { parentItem = parent; if (parent) parent->childItems.append(this); itemData << name << QString::number(val) << coding << code; itemData.append(meaning); }
-    TreeItem(const QString &name, QString      val, const QString &coding, const QString &code, QString meaning, TreeItem *parent, bool isError=false) { parentItem = parent; if (parent) parent->childItems.append(this); itemData << name << val << coding << code; itemData.append(meaning); setError(isError); }
-
-    ~TreeItem() { qDeleteAll(childItems); }
+    TreeItem(TreeItem *parent) { init(parent); }
+    TreeItem(QList<QString> &data, TreeItem *parent) { init(parent, data.value(0), data.value(2), data.value(3), data.value(4)); setValue(data.value(1)); }
+    TreeItem(const QString &name, TreeItem *parent)  { init(parent, name); }
+    TreeItem(const QString &name, int          val, TreeItem *parent) { init(parent, name); setValue(int64_t(val)); }
+    TreeItem(const QString &name, QString      val, TreeItem *parent) { init(parent, name); setValue(val); }
+    TreeItem(const QString &name, int          val, const QString &coding, const QString &code, TreeItem *parent) { init(parent, name, coding, code); setValue(int64_t(val)); }
+    TreeItem(const QString &name, unsigned int val, const QString &coding, const QString &code, TreeItem *parent) { init(parent, name, coding, code); setValue(uint64_t(val)); }
+    TreeItem(const QString &name, uint64_t     val, const QString &coding, const QString &code, TreeItem *parent) { init(parent, name, coding, code); setValue(val); }
+    TreeItem(const QString &name, int64_t      val, const QString &coding, const QString &code, TreeItem *parent) { init(parent, name, coding, code); setValue(val); }
+    TreeItem(const QString &name, bool         val, const QString &coding, const QString &code, TreeItem *parent) { init(parent, name, coding, code); setValue(val); }
+    TreeItem(const QString &name, double       val, const QString &coding, const QString &code, TreeItem *parent) { init(parent, name, coding, code); setValue(val); }
+    TreeItem(const QString &name, QString      val, const QString &coding, const QString &code, TreeItem *parent) { init(parent, name, coding, code); setValue(val); }
+    TreeItem(const QString &name, int          val, const QString &coding, const QString &code, QString meaning, TreeItem *parent) { init(parent, name, coding, code, meaning); setValue(int64_t(val)); }
+    TreeItem(const QString &name, QString      val, const QString &coding, const QString &code, QString meaning, TreeItem *parent, bool isError=false) { init(parent, name, coding, code, meaning); setValue(val); setError(isError); }
+
+    ~TreeItem();
     void setError(bool isError = true) { error = isError; }
     bool isError()                     { return error; }
 
-    QString getName(bool showStreamIndex) const { QString r = (showStreamIndex && streamIndex != -1) ? QString("Stream %1 - ").arg(streamIndex) : ""; if (itemData.count() > 0) r += itemData[0]; return r; }
+    static void *operator new(size_t size) { return TreeItemArena::allocate(size); }
+    static void operator delete(void *ptr) { TreeItemArena::release(ptr); }
+
+    // Get the text for the given column (name, value, coding, code, meaning) using the string table of the model
+    QString getData(int column, const TreeItemStringTable &strings) const;
+    QString getName(bool showStreamIndex, const TreeItemStringTable &strings) const { QString r = (showStreamIndex && streamIndex != -1) ? QString("Stream %1 - ").arg(streamIndex) : ""; return r + getData(0, strings); }
+    // Set a name which is only used once (like "NAL 123: ..."). This is not added to the interned strings.
+    void setName(const QString &name) { nameID = -1; uniqueName = name; }
 
     QList<TreeItem*> childItems;
-    QList<QString> itemData;
     TreeItem *parentItem { nullptr };
 
     int getStreamIndex() { if (streamIndex >= 0) return streamIndex; if (parentItem) return parentItem->getStreamIndex(); return -1; }
     void setStreamIndex(int idx) { streamIndex = idx; }
 
   private:
-    bool error { false };
+    void init(TreeItem *parent, const QString &name = QString(), const QString &coding = QString(), const QString &code = QString(), const QString &meaning = QString());
+
+    enum class valueType : uint8_t
+    {
+      none,
+      signedInt,
+      unsignedInt,
+      floatingPoint,
+      flag,
+      string
+    };
+    void setValue(int64_t val)        { type = valueType::signedInt; signedValue = val; }
+    void setValue(uint64_t val)       { type = valueType::unsignedInt; unsignedValue = val; }
+    void setValue(double val)         { type = valueType::floatingPoint; doubleValue = val; }
+    void setValue(bool val)           { type = valueType::flag; unsignedValue = val ? 1 : 0; }
+    void setValue(const QString &val) { type = valueType::string; stringValue = val; }
+
+    union
+    {
+      int64_t  signedValue {0};
+      uint64_t unsignedValue;
+      double   doubleValue;
+    };
+    // Codes of up to 64 bits are saved as a number. Longer codes are saved in the codeString.
+    uint64_t codeBits {0};
+
+    // These are only set if needed (a null QString needs no memory)
+    QString uniqueName;
+    QString uniqueCoding;
+    QString uniqueMeaning;
+    QString stringValue;
+    QString codeString;
+
+    // Indices into the TreeItemStringTable (or -1 if the string is kept in the item)
+    int nameID    {-1};
+    int codingID  {-1};
+    int meaningID {-1};
+
     // This is set for the first layer items in case of AVPackets
     int streamIndex { -1 };
+    valueType type { valueType::none };
+    uint8_t codeLength { 0 };
+    bool error { false };
   };
 
   typedef QString (*meaning_callback_function)(unsigned int);
 
-  // This is a wrapper around the sub_byte_reader that adds the functionality to log the read symbold to TreeItems
+  // This is a wrapper around the sub_byte_reader that adds the functionality to log the read symbold to TreeItems.
+  // If no TreeItem is given, nothing is logged and the fast_bit_reader is used for reading.
   class reader_helper : protected parserCommon::sub_byte_reader
   {
   public:
@@ -211,14 +402,17 @@ namespace parserCommon
 
     TreeItem *getCurrentItemTree() { return currentTreeLevel; }
 
-    // Some functions passed thourgh from the sub_byte_reader
-    bool          more_rbsp_data()             { return sub_byte_reader::more_rbsp_data();             }
-    bool          payload_extension_present()  { return sub_byte_reader::payload_extension_present();  }
-    unsigned int  nrBytesRead()                { return sub_byte_reader::nrBytesRead();                }
-    unsigned int  nrBytesLeft()                { return sub_byte_reader::nrBytesLeft();                }
-    bool          testReadingBits(int nrBits)  { return sub_byte_reader::testReadingBits(nrBits);      }
-    void          disableEmulationPrevention() {        sub_byte_reader::disableEmulationPrevention(); }
-    QByteArray    readBytes(int nrBytes)       { return sub_byte_reader::readBytes(nrBytes);           }
+    // Is the read data logged to the tree? If not, nothing is logged and no strings are created.
+    bool isLogging() const { return logging; }
+
+    // Some functions passed thourgh from the sub_byte_reader (or the fast_bit_reader if not logging)
+    bool          more_rbsp_data()             { return logging ? sub_byte_reader::more_rbsp_data()            : fastReader.more_rbsp_data();            }
+    bool          payload_extension_present()  { return logging ? sub_byte_reader::payload_extension_present() : fastReader.payload_extension_present(); }
+    unsigned int  nrBytesRead()                { return logging ? sub_byte_reader::nrBytesRead()               : fastReader.nrBytesRead();               }
+    unsigned int  nrBytesLeft()                { return logging ? sub_byte_reader::nrBytesLeft()               : fastReader.nrBytesLeft();               }
+    bool          testReadingBits(int nrBits)  { return logging ? sub_byte_reader::testReadingBits(nrBits)     : fastReader.testReadingBits(nrBits);     }
+    void          disableEmulationPrevention() { sub_byte_reader::disableEmulationPrevention(); fastReader.disableEmulationPrevention();                 }
+    QByteArray    readBytes(int nrBytes)       { return logging ? sub_byte_reader::readBytes(nrBytes)          : fastReader.readBytes(nrBytes);          }
   protected:
     // TODO: This is just too much. Replace by one function maybe ...
     /*
@@ -249,6 +443,9 @@ namespace parserCommon
 
     QList<TreeItem*> itemHierarchy;
     TreeItem *currentTreeLevel { nullptr };
+
+    bool logging { true };
+    fast_bit_reader fastReader;
   };
 
   // A simple wrapper for reader_helper.addLogSubLevel / reader_helper->removeLogSubLevel
@@ -262,6 +459,16 @@ namespace parserCommon
   };
 
   // The item model which is used to display packets from the bitstream. This can be AVPackets or other units from the bitstream (NAL units e.g.)
+  // In the lazy mode of the PacketItemModel, the detailed syntax tree of a packet is only created when it is
+  // needed (the packet is expanded). The provider does this by parsing the packet again.
+  class PacketDetailProvider
+  {
+  public:
+    virtual ~PacketDetailProvider() {}
+    // Parse the packet with the given index (the first level row in the model) again and add all items to the given root.
+    virtual bool createPacketDetails(int packetIdx, QUint64Pair fileStartEndPos, TreeItem *root) = 0;
+  };
+
   class PacketItemModel : public QAbstractItemModel
   {
   public:
@@ -276,11 +483,32 @@ namespace parserCommon
     virtual int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
     virtual int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE { Q_UNUSED(parent); return 5; }
 
+    // In lazy mode, the syntax trees of the first level items are created on demand when they are expanded
+    virtual bool hasChildren(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    virtual bool canFetchMore(const QModelIndex &parent) const Q_DECL_OVERRIDE;
+    virtual void fetchMore(const QModelIndex &parent) Q_DECL_OVERRIDE;
+
+    // If the whole tree is created by the parser (not in lazy mode), the items below the root are allocated
+    // from this arena (see TreeItemArena::scope). It must be declared before the rootItem so that it is destructed after it.
+    TreeItemArena itemArena;
+    TreeItemArena *getItemArena() { return &itemArena; }
+
+    // The strings of all items of this model (see TreeItemStringTable::scope)
+    TreeItemStringTable stringTable;
+    TreeItemStringTable *getStringTable() { return &stringTable; }
+
     // The root of the tree
     QScopedPointer<TreeItem> rootItem;
     TreeItem *getRootItem() { return rootItem.data(); }
     bool isNull() { return rootItem.isNull(); }
 
+    // Switch to the lazy mode. Instead of a TreeItem per packet, the parser adds a compact packet record
+    // (addPacketRecord) for every packet. The details are created by the provider when needed.
+    void setLazyMode(PacketDetailProvider *provider) { detailProvider = provider; }
+    bool isLazy() const { return detailProvider != nullptr; }
+    // This can be called from the background parsing thread.
+    void addPacketRecord(QUint64Pair fileStartEndPos, const QString &name, bool isError);
+
     void setUseColorCoding(bool colorCoding);
     void setShowVideoStreamOnly(bool showVideoOnly);
 
@@ -291,7 +519,33 @@ namespace parserCommon
     // about them. The bitstream analysis window will then update this count and the view to show the new items.
     unsigned int nrShowChildItems {0};
 
-    unsigned int getNumberFirstLevelChildren() { return rootItem.isNull() ? 0 : rootItem->childItems.size(); }
+    unsigned int getNumberFirstLevelChildren();
+
+    // The compact information that is kept for every first level item in lazy mode
+    struct packetRecord
+    {
+      QUint64Pair fileStartEndPos;
+      QString name;
+      bool isError;
+    };
+    QList<packetRecord> packetRecords;
+    mutable QMutex packetRecordsMutex;
+
+    // The syntax trees that were created by the detail provider (key is the packet index) and the packet index of
+    // each tree root. Only the maxNrDetailTrees trees that were used last are kept. The least recently used tree
+    // is the first one in the list. A tree is moved to the back whenever the view accesses it.
+    PacketDetailProvider *detailProvider {nullptr};
+    QMap<int, TreeItem*> detailTrees;
+    QHash<const TreeItem*, int> detailTreePacketIndices;
+    mutable QList<int> detailTreesLRU;
+    static const int maxNrDetailTrees = 64;
+    // Delete the least recently used tree. Its rows are removed, so it is created again when it is expanded again.
+    void dropLeastRecentlyUsedDetailTree();
+
+    // Get the TreeItem for the given index. In lazy mode, this returns the detail tree root (or null) for first level items.
+    TreeItem *getItem(const QModelIndex &index) const;
+    // Is the item the root of a detail tree? Returns the packet index or -1.
+    int getPacketIndexOfDetailTree(TreeItem *item) const;
 
     static QList<QColor> streamIndexColors;
     bool useColorCoding { true };
@@ -347,6 +601,25 @@ namespace parserCommon
     void addBitratePoint(int streamIndex, bitrateEntry &entry);
     void setBitrateSortingIndex(int index);
 
+    // The aggregated values of 2^level consecutive entries (in the current sort order).
+    // Level 0 buckets are the single entries.
+    struct bitrateBucket
+    {
+      unsigned int minBitrate {UINT_MAX};
+      unsigned int maxBitrate {0};
+      unsigned int maxNonKeyframeBitrate {0};
+      uint64_t sumBitrate {0};
+      unsigned int nrEntries {0};
+      bool containsKeyframe {false};
+
+      double getAverageBitrate() const { return nrEntries > 0 ? double(sumBitrate) / nrEntries : 0.0; }
+      void merge(const bitrateBucket &other);
+    };
+    // Get nrBuckets buckets of the given level of the first stream starting at firstBucket. Buckets that
+    // are outside of the range of the shown entries are not returned.
+    QList<bitrateBucket> getBitrateBuckets(int level, int firstBucket, int nrBuckets) const;
+    QString getBucketInfoText(int level, int bucketIdx);
+
   private:
     // The current number of bitrate points that we show.
     // The background parser will add more data to "bitrateData" and periodically update the model
@@ -358,9 +631,22 @@ namespace parserCommon
       PRESENTATION_ORDER
     };
     SortMode sortMode { SortMode::DECODE_ORDER };
+    // The entries are sorted ascending by DTS or PTS. The same order must be used for sorting and inserting.
+    static bool isEntryBefore(const bitrateEntry &a, const bitrateEntry &b, SortMode mode);
 
     QMap<unsigned int, QList<bitrateEntry>> bitratePerStreamData;
     mutable QMutex bitratePerStreamDataMutex;
+
+    // For plotting very long streams, the entries are aggregated in buckets of 2, 4, 8, ... entries.
+    // levels[k] holds the buckets of level k+1. These are updated from the position of the first changed entry.
+    struct levelsOfDetail
+    {
+      void update(const QList<bitrateEntry> &entries, int firstChangedIdx);
+      bitrateBucket getBucket(const QList<bitrateEntry> &entries, int level, int bucketIdx) const;
+      QList<QVector<bitrateBucket>> levels;
+    };
+    QMap<unsigned int, levelsOfDetail> levelsOfDetailPerStream;
+    static bitrateBucket bucketFromEntry(const bitrateEntry &entry);
     RangeInt dtsRange;
     RangeInt ptsRange;
 
@@ -30,32 +30,32 @@
 *   along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 
-#define READBITS(into,numBits) do { if (!reader.readBits(numBits, into, #into)) return false; } while(0)
-#define READBITS_M(into,numBits,meanings) do { if (!reader.readBits(numBits, into, #into, meanings)) return false; } while(0)
-#define READBITS_M_E(into,numBits,meanings,type) do { unsigned int val; if (!reader.readBits(numBits, val, #into, meanings)) return false; into = (type)val; } while (0)
-#define READBITS_A(into,numBits,idx) do { if (!reader.readBits(numBits, into, #into, idx)) return false; } while(0)
-#define READBITS_A_M(into,numBits,idx,meanings) do { if (!reader.readBits(numBits, into, #into, idx, meanings)) return false; } while(0)
+#define READBITS(into,numBits) do { if (!reader.readBits(numBits, into, QStringLiteral(#into))) return false; } while(0)
+#define READBITS_M(into,numBits,meanings) do { if (!reader.readBits(numBits, into, QStringLiteral(#into), meanings)) return false; } while(0)
+#define READBITS_M_E(into,numBits,meanings,type) do { unsigned int val; if (!reader.readBits(numBits, val, QStringLiteral(#into), meanings)) return false; into = (type)val; } while (0)
+#define READBITS_A(into,numBits,idx) do { if (!reader.readBits(numBits, into, QStringLiteral(#into), idx)) return false; } while(0)
+#define READBITS_A_M(into,numBits,idx,meanings) do { if (!reader.readBits(numBits, into, QStringLiteral(#into), idx, meanings)) return false; } while(0)
 #define READZEROBITS(numBits,name) do { if (!reader.readZeroBits(numBits, name)) return false; } while(0)
 #define IGNOREBITS(numBits) do { if (!reader.ignoreBits(numBits)) return false; } while(0)
 
-#define READFLAG(into) do { if (!reader.readFlag(into, #into)) return false; } while(0)
-#define READFLAG_M(into,meanings) do { if (!reader.readFlag(into, #into, meanings)) return false; } while(0)
-#define READFLAG_A(into,idx) do { if (!reader.readFlag(into, #into, idx)) return false; } while(0)
-#define READFLAG_A_M(into,idx,meanings) do { if (!reader.readFlag(into, #into, idx, meanings)) return false; } while(0)
+#define READFLAG(into) do { if (!reader.readFlag(into, QStringLiteral(#into))) return false; } while(0)
+#define READFLAG_M(into,meanings) do { if (!reader.readFlag(into, QStringLiteral(#into), meanings)) return false; } while(0)
+#define READFLAG_A(into,idx) do { if (!reader.readFlag(into, QStringLiteral(#into), idx)) return false; } while(0)
+#define READFLAG_A_M(into,idx,meanings) do { if (!reader.readFlag(into, QStringLiteral(#into), idx, meanings)) return false; } while(0)
 
-#define READUEV(into) do { if (!reader.readUEV(into, #into)) return false; } while(0)
-#define READUEV_M(into,meanings) do { if (!reader.readUEV(into, #into, meanings)) return false; } while(0)
-#define READUEV_A(into,idx) do { if (!reader.readUEV(into, #into, idx)) return false; } while(0)
-#define READUEV_A_M(into,idx,meanings) do { if (!reader.readUEV(into, #into, idx, meanings)) return false; } while(0)
+#define READUEV(into) do { if (!reader.readUEV(into, QStringLiteral(#into))) return false; } while(0)
+#define READUEV_M(into,meanings) do { if (!reader.readUEV(into, QStringLiteral(#into), meanings)) return false; } while(0)
+#define READUEV_A(into,idx) do { if (!reader.readUEV(into, QStringLiteral(#into), idx)) return false; } while(0)
+#define READUEV_A_M(into,idx,meanings) do { if (!reader.readUEV(into, QStringLiteral(#into), idx, meanings)) return false; } while(0)
 
-#define READSEV(into) do { if (!reader.readSEV(into, #into)) return false; } while(0)
-#define READSEV_A(into,idx) do { if (!reader.readSEV(into, #into, idx)) return false; } while(0)
-#define READUEV_APP(into) do { if (!reader.readSEV(into, #into, -1)) return false; } while(0)
+#define READSEV(into) do { if (!reader.readSEV(into, QStringLiteral(#into))) return false; } while(0)
+#define READSEV_A(into,idx) do { if (!reader.readSEV(into, QStringLiteral(#into), idx)) return false; } while(0)
+#define READUEV_APP(into) do { if (!reader.readSEV(into, QStringLiteral(#into), -1)) return false; } while(0)
 
-#define READLEB128(into) do { if (!reader.readLeb128(into, #into)) return false; } while(0)
-#define READUVLC(into) do { if (!reader.readUVLC(into, #into)) return false; } while (0)
-#define READNS(into,maxValue) do { if (!reader.readNS(into, #into, maxValue)) return false; } while (0) 
-#define READSU(into,numBits) do { if (!reader.readSU(into, #into, numBits)) return false; } while (0)
+#define READLEB128(into) do { if (!reader.readLeb128(into, QStringLiteral(#into))) return false; } while(0)
+#define READUVLC(into) do { if (!reader.readUVLC(into, QStringLiteral(#into))) return false; } while (0)
+#define READNS(into,maxValue) do { if (!reader.readNS(into, QStringLiteral(#into), maxValue)) return false; } while (0) 
+#define READSU(into,numBits) do { if (!reader.readSU(into, QStringLiteral(#into), numBits)) return false; } while (0)
 
 #define LOGVAL(val) reader.logValue(val, #val)
 #define LOGVAL_M(val,meaning) reader.logValue(val, #val, meaning)
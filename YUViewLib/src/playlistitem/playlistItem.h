@@ -181,6 +181,9 @@ public:
   virtual bool taggedForDeletion() const { return itemTaggedForDeletion; }
   // Is there a limit on the number of threads that can cache from this item at the same time? (-1 = no limit)
   virtual int cachingThreadLimit() { return -1; }
+  // How many threads does caching one frame of this item occupy? This is more than one if the item
+  // decodes with a decoder that uses threads internally. The video cache accounts for this.
+  virtual int cachingThreadCost() const { return 1; }
   // Tag the item as "to be deleted"
   void tagItemForDeletion() { itemTaggedForDeletion = true; }
   // Cache the given frame. This function is thread save. So multiple instances of this function can run at the same time.
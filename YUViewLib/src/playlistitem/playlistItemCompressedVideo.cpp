@@ -35,16 +35,19 @@
 #include <QThread>
 #include <QInputDialog>
 #include <QPlainTextEdit>
+#include <QtConcurrent>
 
 #include <inttypes.h>
 
 #include "common/functions.h"
+#include "common/loadingCancellation.h"
 #include "common/YUViewDomElement.h"
 #include "decoder/decoderFFmpeg.h"
 #include "decoder/decoderHM.h"
 #include "decoder/decoderVTM.h"
 #include "decoder/decoderDav1d.h"
 #include "decoder/decoderLibde265.h"
+#include "decoder/decoderRemote.h"
 #include "parser/parserAnnexBAVC.h"
 #include "parser/parserAnnexBHEVC.h"
 #include "parser/parserAnnexBVVC.h"
@@ -71,6 +74,9 @@ using namespace functions;
 // by lower than this threshold, we will not seek.
 #define FORWARD_SEEK_THRESHOLD 5
 
+// The number of decoder pairs (interactive/caching) that are kept in the decoder pool of an item
+#define DECODER_POOL_SIZE 2
+
 playlistItemCompressedVideo::playlistItemCompressedVideo(const QString &compressedFilePath, int displayComponent, inputFormat input, decoderEngine decoder)
   : playlistItemWithVideo(compressedFilePath, playlistItem_Indexed)
 {
@@ -81,6 +87,7 @@ playlistItemCompressedVideo::playlistItemCompressedVideo(const QString &compress
 
   // An compressed file can be cached if nothing goes wrong
   cachingEnabled = true;
+  updateFrameWindowMaxMemory();
 
   // Open the input file and get some properties (size, bit depth, subsampling) from the file
   if (input == inputInvalid)
@@ -284,7 +291,9 @@ playlistItemCompressedVideo::playlistItemCompressedVideo(const QString &compress
   // Seek both decoders to the start of the bitstream (this will also push the parameter sets / extradata to the decoder)
   DEBUG_COMPRESSED("playlistItemCompressedVideo::playlistItemCompressedVideo Seek decoders to 0");
   seekToPosition(0, 0, false);
-  if (cachingEnabled)
+  // The process of a remote caching decoder is started in the background. Don't wait for it here. The caching
+  // decoder will seek when it decodes its first frame.
+  if (cachingEnabled && !dynamic_cast<decoderRemote*>(cachingDecoder.data()))
     seekToPosition(0, 0, true);
 
   // Connect signals for requesting data and statistics
@@ -294,6 +303,15 @@ playlistItemCompressedVideo::playlistItemCompressedVideo(const QString &compress
   connect(&statSource, &statisticHandler::requestStatisticsLoading, this, &playlistItemCompressedVideo::loadStatisticToCache, Qt::DirectConnection);
 }
 
+playlistItemCompressedVideo::~playlistItemCompressedVideo()
+{
+  // The background extension of the frame window uses the caching decoder
+  frameWindowGeneration.fetchAndAddOrdered(1);
+  frameWindowExtension.waitForFinished();
+  hashVerificationCancel.store(1);
+  hashVerification.waitForFinished();
+}
+
 void playlistItemCompressedVideo::savePlaylist(QDomElement &root, const QDir &playlistDir) const
 {
   // Determine the relative path to the HEVC file. We save both in the playlist.
@@ -378,12 +396,47 @@ infoData playlistItemCompressedVideo::getInfo() const
       }
       info.items.append(infoItem("Decoder", loadingDecoder->getDecoderName()));
       info.items.append(infoItem("Decoder", loadingDecoder->getCodecName()));
+      info.items.append(infoItem("Decoder Threads", QString::number(loadingDecoder->getNrThreads()), "The number of threads that each decoder (interactive and caching) uses internally. This can be set in the settings."));
       info.items.append(infoItem("Statistics", loadingDecoder->statisticsSupported() ? "Yes" : "No", "Is the decoder able to provide internals (statistics)?"));
       info.items.append(infoItem("Stat Parsing", loadingDecoder->statisticsEnabled() ? "Yes" : "No", "Are the statistics of the sequence currently extracted from the stream?"));
+      QMutexLocker locker(&cachingDecoderErrorMutex);
+      if (!cachingDecoderError.isEmpty())
+        info.items.append(infoItem("Caching Decoder", cachingDecoderError, "There was an error in the caching decoder. Frames are only decoded when they are shown."));
     }
   }
   if (decoderEngineType == decoderEngineFFMpeg)
     info.items.append(infoItem("FFMpeg Log", "Show FFmpeg Log", "Show the log messages from FFmpeg.", true, 0));
+  if (inputFileAnnexBParser && inputFileAnnexBParser->hasDecodedPictureHashes() && decodingEnabled)
+  {
+    const QString hashToolTip = "Decode all pictures and compare them to the decoded picture hash SEI in the bitstream.";
+    QMutexLocker locker(&hashVerificationMutex);
+    const hashVerificationResult &r = hashVerificationState;
+    if (!r.started)
+      info.items.append(infoItem("Picture Hash", "Verify Picture Hashes", hashToolTip, true, 1));
+    else if (hashVerification.isRunning())
+      info.items.append(infoItem("Picture Hash", QString("Verifying... %1/%2").arg(r.nrFramesDecoded).arg(startEndFrame.second + 1), hashToolTip));
+    else
+    {
+      QString result;
+      if (!r.error.isEmpty())
+        result = r.error + " ";
+      if (r.mismatchPOCs.isEmpty())
+        result += QString("%1 pictures match (%2)").arg(r.nrFramesMatch).arg(pictureHash::getHashTypeName(r.type));
+      else
+      {
+        QStringList pocs;
+        for (int i = 0; i < r.mismatchPOCs.size() && i < 10; i++)
+          pocs.append(QString::number(r.mismatchPOCs[i]));
+        if (r.mismatchPOCs.size() > 10)
+          pocs.append("...");
+        result += QString("%1 pictures mismatch (POC %2)").arg(r.mismatchPOCs.size()).arg(pocs.join(", "));
+      }
+      if (r.nrFramesWithoutHash > 0)
+        result += QString(", %1 without hash").arg(r.nrFramesWithoutHash);
+      info.items.append(infoItem("Picture Hash", result, hashToolTip));
+      info.items.append(infoItem("Picture Hash", "Verify Again", hashToolTip, true, 1));
+    }
+  }
 
   return info;
 }
@@ -417,6 +470,8 @@ void playlistItemCompressedVideo::infoListButtonPressed(int buttonID)
         
     newDialog.exec();
   }
+  else if (buttonID == 1)
+    startPictureHashVerification();
 }
 
 itemLoadingState playlistItemCompressedVideo::needsLoading(int frameIdx, bool loadRawData)
@@ -429,7 +484,10 @@ itemLoadingState playlistItemCompressedVideo::needsLoading(int frameIdx, bool lo
   if (videoState == LoadingNeeded && decodingNotPossibleAfter >= 0 && frameIdxInternal >= decodingNotPossibleAfter && frameIdxInternal >= currentFrameIdx[0])
     // The decoder can not decode this frame. 
     return LoadingNotNeeded;
-  if (videoState == LoadingNeeded || statSource.needsLoading(frameIdxInternal) == LoadingNeeded)
+  if (scrubFrameIdx >= 0 && scrubFrameIdx == frameIdxInternal && !videoHandler::isScrubbing())
+    // Only an approximation of this frame is shown. Decode it exactly now.
+    return LoadingNeeded;
+  if (videoState == LoadingNeeded || (!videoHandler::isScrubbing() && statSource.needsLoading(frameIdxInternal) == LoadingNeeded))
     return LoadingNeeded;
   return videoState;
 }
@@ -473,7 +531,7 @@ void playlistItemCompressedVideo::loadRawData(int frameIdxInternal, bool caching
     else
       return;
   }
-  if (caching && cachingDecoder->errorInDecoder())
+  if (caching && checkCachingDecoderError())
     return;
   
   DEBUG_COMPRESSED("playlistItemCompressedVideo::loadYUVData %d %s", frameIdxInternal, caching ? "caching" : "");
@@ -484,9 +542,26 @@ void playlistItemCompressedVideo::loadRawData(int frameIdxInternal, bool caching
     return;
   }
 
+  // When stepping (or caching for backward playback), the frame may already have been decoded
+  const bool useFrameWindow = caching ? !frameWindowExtending : !bypassFrameWindow;
+  if (useFrameWindow && loadRawDataFromFrameWindow(frameIdxInternal, caching))
+    return;
+
+  if (!caching && !bypassFrameWindow)
+  {
+    // While scrubbing, an approximation is good enough
+    if (videoHandler::isScrubbing() && loadRawDataScrubbing(frameIdxInternal))
+      return;
+    if (loadingCancellation::isCancelled())
+      return;
+    scrubFrameIdx = -1;
+  }
+
   // Get the right decoder
   decoderBase *dec = caching ? cachingDecoder.data() : loadingDecoder.data();
   int curFrameIdx = caching ? currentFrameIdx[1] : currentFrameIdx[0];
+  // When extending the frame window, the caching decoder must not change the raw data of the video handler
+  const bool updateVideoRawData = !(caching && frameWindowExtending);
 
   // Should we seek?
   if (curFrameIdx == -1 || frameIdxInternal < curFrameIdx || frameIdxInternal > curFrameIdx + FORWARD_SEEK_THRESHOLD)
@@ -522,13 +597,34 @@ void playlistItemCompressedVideo::loadRawData(int frameIdxInternal, bool caching
       seekToPosition(seekToFrame, seekToDTS, caching);
     }
   }
+
+  // When stepping backwards, caching for backward playback or extending the frame window, keep all frames that are
+  // decoded on the way to the requested frame. The next backward steps can then be served from the frame window.
+  const int decIdx = caching ? 1 : 0;
+  const bool cachingBackwards = caching && frameIdxInternal < curFrameIdx && videoHandler::getPlaybackStep() < 0;
+  frameWindowCollect[decIdx] = caching ? (frameWindowExtending || cachingBackwards) : (!bypassFrameWindow && frameIdxInternal < curFrameIdx);
+  frameWindowCollectStart[decIdx] = currentFrameIdx[decIdx] + 1;
+  frameWindowCollectedFrames[decIdx].clear();
   
   // Decode until we get the right frame from the deocder
   bool rightFrame = caching ? currentFrameIdx[1] == frameIdxInternal : currentFrameIdx[0] == frameIdxInternal;
   while (!rightFrame)
   {
+    if ((!caching && loadingCancellation::isCancelled()) || (caching && frameWindowExtending && isFrameWindowExtensionCancelled()))
+    {
+      // A newer frame was requested (or the frame window was cleared). Stop here. The decoder and currentFrameIdx stay
+      // consistent so the next request can continue from here. The frames that were collected for the frame window are dropped.
+      DEBUG_COMPRESSED("playlistItemCompressedVideo::loadYUVData cancelled at frame %d", caching ? currentFrameIdx[1] : currentFrameIdx[0]);
+      frameWindowCollectedFrames[decIdx].clear();
+      frameWindowCollect[decIdx] = false;
+      return;
+    }
+
     while (dec->needsMoreData())
     {
+      if (!caching && loadingCancellation::isCancelled())
+        // Some decoders (e.g. HM) decode when the data is pushed
+        break;
       DEBUG_COMPRESSED("playlistItemCompressedVideo::loadYUVData decoder needs more data");
       if (isInputFormatTypeFFmpeg(inputFormatType) && decoderEngineType == decoderEngineFFMpeg)
       {
@@ -591,6 +687,8 @@ void playlistItemCompressedVideo::loadRawData(int frameIdxInternal, bool caching
 
     if (dec->decodeFrames())
     {
+      // Frames before the requested one are only decoded to get there. Don't extract statistics for these.
+      dec->setDecodingPreroll((caching ? currentFrameIdx[1] : currentFrameIdx[0]) + 1 != frameIdxInternal);
       if (dec->decodeNextFrame())
       {
         if (caching)
@@ -600,11 +698,10 @@ void playlistItemCompressedVideo::loadRawData(int frameIdxInternal, bool caching
 
         DEBUG_COMPRESSED("playlistItemCompressedVideo::loadYUVData decoded frame %d", caching ? currentFrameIdx[1] : currentFrameIdx[0]);
         rightFrame = caching ? currentFrameIdx[1] == frameIdxInternal : currentFrameIdx[0] == frameIdxInternal;
-        if (rightFrame)
-        {
-          video->rawData = dec->getRawFrameData();
-          video->rawData_frameIdx = frameIdxInternal;
-        }
+        if (frameWindowCollect[decIdx])
+          frameWindowCollectedFrames[decIdx].append(getDecodedFrame(dec));
+        if (rightFrame && updateVideoRawData)
+          setVideoRawData(frameWindowCollect[decIdx] ? frameWindowCollectedFrames[decIdx].last() : getDecodedFrame(dec), frameIdxInternal);
       }
     }
 
@@ -616,6 +713,23 @@ void playlistItemCompressedVideo::loadRawData(int frameIdxInternal, bool caching
     }
   }
 
+  if (frameWindowCollect[decIdx])
+  {
+    if (caching && frameWindowExtending)
+    {
+      // Frames that the caching decoder decoded for the interactive window are only used if they extend it. The user may have moved on.
+      if (!isFrameWindowExtensionCancelled())
+        frameWindow[0].addFrames(frameWindowCollectStart[decIdx], frameWindowCollectedFrames[decIdx], true);
+    }
+    else
+    {
+      frameWindow[decIdx].setCurrentFrame(frameIdxInternal);
+      frameWindow[decIdx].addFrames(frameWindowCollectStart[decIdx], frameWindowCollectedFrames[decIdx]);
+    }
+    frameWindowCollectedFrames[decIdx].clear();
+    frameWindowCollect[decIdx] = false;
+  }
+
   if (decodingNotPossibleAfter >= 0 && frameIdxInternal >= decodingNotPossibleAfter)
   {
     // The specified frame (which is thoretically in the bitstream) can not be decoded.
@@ -626,7 +740,8 @@ void playlistItemCompressedVideo::loadRawData(int frameIdxInternal, bool caching
       currentFrameIdx[0] = frameIdxInternal;
     // Just set the frame number of the buffer to the current frame so that it will trigger a
     // reload when the frame number changes.
-    video->rawData_frameIdx = frameIdxInternal;
+    if (updateVideoRawData)
+      video->rawData_frameIdx = frameIdxInternal;
   }
   else if (loadingDecoder->errorInDecoder())
   {
@@ -637,6 +752,354 @@ void playlistItemCompressedVideo::loadRawData(int frameIdxInternal, bool caching
     
     decodingEnabled = false;
   }
+  if (caching)
+    checkCachingDecoderError();
+}
+
+bool playlistItemCompressedVideo::checkCachingDecoderError()
+{
+  if (!cachingDecoder->errorInDecoder())
+    return false;
+
+  QMutexLocker locker(&cachingDecoderErrorMutex);
+  if (cachingDecoderError.isEmpty())
+  {
+    DEBUG_COMPRESSED("playlistItemCompressedVideo::checkCachingDecoderError %s", cachingDecoder->decoderErrorString().toLatin1().data());
+    cachingDecoderError = cachingDecoder->decoderErrorString();
+    // Update the info panel
+    emit signalItemChanged(false, RECACHE_NONE);
+  }
+  return true;
+}
+
+decodedFrameWindow::frame playlistItemCompressedVideo::getDecodedFrame(decoderBase *dec)
+{
+  decodedFrameWindow::frame frame;
+  // If possible, get a reference to the decoded picture. It is only copied if the raw values are needed.
+  if (rawFormat == raw_YUV)
+    frame.picture = dec->getRawFrameRef();
+  if (frame.picture.isValid())
+    // The picture stays in the buffer of the decoder which may have padded lines
+    frame.nrBytes = frame.picture.getMemorySize(dec->getYUVPixelFormat(), dec->getFrameSize());
+  else
+  {
+    frame.rawData = dec->getRawFrameData();
+    frame.nrBytes = frame.rawData.size();
+  }
+  return frame;
+}
+
+void playlistItemCompressedVideo::setVideoRawData(const decodedFrameWindow::frame &frame, int frameIdxInternal)
+{
+  if (rawFormat == raw_YUV)
+    getYUVVideo()->rawPicture = frame.picture;
+  video->rawData = frame.rawData;
+  video->rawData_frameIdx = frameIdxInternal;
+}
+
+bool playlistItemCompressedVideo::loadRawDataFromFrameWindow(int frameIdxInternal, bool caching)
+{
+  decodedFrameWindow::frame frame;
+  if (!frameWindow[caching ? 1 : 0].getFrame(frameIdxInternal, frame))
+    return false;
+
+  DEBUG_COMPRESSED("playlistItemCompressedVideo::loadRawDataFromFrameWindow frame %d %s", frameIdxInternal, caching ? "caching" : "");
+  setVideoRawData(frame, frameIdxInternal);
+  if (caching)
+    // The caching decoder will seek to the previous GOP when the beginning of its window is reached
+    return true;
+
+  // If the user keeps stepping backwards, the beginning of the window will be reached soon. Once the current frame
+  // is in the lower half of the window, decode the GOP before the window in the background.
+  const indexRange range = frameWindow[0].getRange();
+  if (range.first > 0 && frameIdxInternal - range.first < (range.second - range.first + 1) / 2 && cachingDecoder && !frameWindowExtension.isRunning())
+    frameWindowExtension = QtConcurrent::run(this, &playlistItemCompressedVideo::extendFrameWindow, range.first - 1, frameWindowGeneration.load());
+
+  return true;
+}
+
+bool playlistItemCompressedVideo::loadRawDataScrubbing(int frameIdxInternal)
+{
+  // Get the closest random access point before the frame
+  int rapFrameIdx = -1;
+  if (isInputFormatTypeAnnexB(inputFormatType))
+  {
+    int annexBFrameCount = -1;
+    rapFrameIdx = inputFileAnnexBParser->getClosestSeekableFrameNumberBefore(frameIdxInternal, annexBFrameCount);
+  }
+  else
+    inputFileFFmpegLoading->getClosestSeekableDTSBefore(frameIdxInternal, rapFrameIdx);
+
+  if (rapFrameIdx < 0 || rapFrameIdx == frameIdxInternal)
+    // Decoding the frame itself is just as fast
+    return false;
+
+  if (rapFrameIdx != scrubRAPFrameIdx)
+  {
+    DEBUG_COMPRESSED("playlistItemCompressedVideo::loadRawDataScrubbing frame %d - decoding random access point %d", frameIdxInternal, rapFrameIdx);
+
+    // Force a seek to the random access point and only decode it. The frame window must not collect frames.
+    // Afterwards, the state of the decoder is unknown and the next regular load has to seek again.
+    currentFrameIdx[0] = -1;
+    bypassFrameWindow = true;
+    loadingDecoder->setDecodeKeyFramesOnly(true);
+    loadRawData(rapFrameIdx, false);
+    loadingDecoder->setDecodeKeyFramesOnly(false);
+    bypassFrameWindow = false;
+    const bool rapDecoded = (currentFrameIdx[0] == rapFrameIdx && video->rawData_frameIdx == rapFrameIdx);
+    currentFrameIdx[0] = -1;
+    if (!rapDecoded)
+    {
+      scrubRAPFrameIdx = -1;
+      return false;
+    }
+
+    scrubRAPFrameIdx = rapFrameIdx;
+    scrubRAPFrame = decodedFrameWindow::frame();
+    scrubRAPFrame.rawData = video->rawData;
+    if (rawFormat == raw_YUV)
+      scrubRAPFrame.picture = getYUVVideo()->rawPicture;
+  }
+  else
+    DEBUG_COMPRESSED("playlistItemCompressedVideo::loadRawDataScrubbing frame %d - reusing random access point %d", frameIdxInternal, rapFrameIdx);
+
+  // Show the random access point in place of the requested frame
+  setVideoRawData(scrubRAPFrame, frameIdxInternal);
+  scrubFrameIdx = frameIdxInternal;
+  return true;
+}
+
+void playlistItemCompressedVideo::extendFrameWindow(int lastFrameIdx, int generation)
+{
+  // The caching decoder is used for this. Only one thread may use it at a time.
+  QMutexLocker locker(&cachingMutex);
+  frameWindowExtensionGeneration = generation;
+  if (isFrameWindowExtensionCancelled() || frameWindow[0].contains(lastFrameIdx))
+    // The window was cleared or the interactive decoder was faster
+    return;
+
+  DEBUG_COMPRESSED("playlistItemCompressedVideo::extendFrameWindow decoding up to frame %d", lastFrameIdx);
+  frameWindowExtending = true;
+  loadRawData(lastFrameIdx, true);
+  frameWindowExtending = false;
+}
+
+void playlistItemCompressedVideo::clearFrameWindow()
+{
+  // Waiting for the extension could block the GUI for the decoding of a whole GOP. Let it stop after the current frame
+  // instead. It does not add its frames to the window anymore.
+  frameWindowGeneration.fetchAndAddOrdered(1);
+  frameWindow[0].clear();
+  frameWindow[1].clear();
+  scrubRAPFrameIdx = -1;
+  scrubRAPFrame = decodedFrameWindow::frame();
+}
+
+void playlistItemCompressedVideo::updateFrameWindowMaxMemory()
+{
+  QSettings settings;
+  const int64_t cacheSize = int64_t(settings.value("ThresholdValueMB", 49).toUInt()) * 1000 * 1000;
+  frameWindow[0].setMaxMemory(cacheSize / DECODED_FRAME_WINDOW_CACHE_FRACTION);
+  frameWindow[1].setMaxMemory(cacheSize / DECODED_FRAME_WINDOW_CACHE_FRACTION);
+}
+
+void playlistItemCompressedVideo::updateSettings()
+{
+  updateFrameWindowMaxMemory();
+}
+
+void playlistItemCompressedVideo::startPictureHashVerification()
+{
+  if (hashVerification.isRunning() || !inputFileAnnexBParser || !inputFileAnnexBParser->hasDecodedPictureHashes())
+    return;
+
+  DEBUG_COMPRESSED("playlistItemCompressedVideo::startPictureHashVerification");
+
+  // The verification uses its own decoder and file source so that interactive loading and caching are not affected
+  const int nrThreads = functions::getDecoderThreadCount();
+  if (decoderEngineType == decoderEngineLibde265)
+    hashDecoder.reset(new decoderLibde265(0, true, nrThreads));
+  else if (decoderEngineType == decoderEngineHM)
+    hashDecoder.reset(new decoderHM(0, true));
+  else if (decoderEngineType == decoderEngineVTM)
+    hashDecoder.reset(new decoderVTM(0, true));
+  else if (decoderEngineType == decoderEngineFFMpeg)
+  {
+    QSize frameSize = inputFileAnnexBParser->getSequenceSizeSamples();
+    QByteArray extradata = inputFileAnnexBParser->getExtradata();
+    yuvPixelFormat fmt = inputFileAnnexBParser->getPixelFormat();
+    auto profileLevel = inputFileAnnexBParser->getProfileLevel();
+    auto ratio = inputFileAnnexBParser->getSampleAspectRatio();
+    hashDecoder.reset(new decoderFFmpeg(ffmpegCodec, frameSize, extradata, fmt, profileLevel, ratio, true, nrThreads));
+  }
+  else
+    hashDecoder.reset();
+
+  {
+    QMutexLocker locker(&hashVerificationMutex);
+    hashVerificationState = hashVerificationResult();
+    hashVerificationState.started = true;
+    if (hashDecoder.isNull())
+      hashVerificationState.error = "The selected decoder can not be used for the verification.";
+    else if (hashDecoder->errorInDecoder())
+      hashVerificationState.error = "Error allocating the decoder: " + hashDecoder->decoderErrorString();
+  }
+
+  if (!hashDecoder.isNull() && !hashDecoder->errorInDecoder())
+  {
+    hashVerificationCancel.store(0);
+    hashVerification = QtConcurrent::run(this, &playlistItemCompressedVideo::runPictureHashVerification);
+    hashVerificationTimer.start(1000, this);
+  }
+  emit signalItemChanged(false, RECACHE_NONE);
+}
+
+void playlistItemCompressedVideo::runPictureHashVerification()
+{
+  fileSourceAnnexBFile file(plItemNameOrFileName);
+  decoderBase *dec = hashDecoder.data();
+  // The FFmpeg decoder gets the data of one frame at a time. All other decoders get NAL units.
+  const bool pushFrames = (dynamic_cast<decoderFFmpeg*>(dec) != nullptr);
+  int frameCounterCodingOrder = 0;
+  bool repush = false;
+  int frameIdx = 0;
+  QString error;
+
+  if (!file.isOk())
+    error = "Error opening the file.";
+
+  while (error.isEmpty() && hashVerificationCancel.load() == 0)
+  {
+    while (dec->needsMoreData() && hashVerificationCancel.load() == 0)
+    {
+      if (pushFrames)
+      {
+        QUint64Pair frameStartEndFilePos = inputFileAnnexBParser->getFrameStartEndPos(frameCounterCodingOrder);
+        QByteArray data;
+        if (frameStartEndFilePos != QUint64Pair(-1, -1))
+          data = file.getFrameData(frameStartEndFilePos);
+        if (dec->pushData(data))
+          frameCounterCodingOrder++;
+        else if (!dec->decodeFrames())
+        {
+          error = "The decoder did not switch to decoding frame mode.";
+          break;
+        }
+      }
+      else
+      {
+        QByteArray data = file.getNextNALUnit(repush);
+        repush = !dec->pushData(data);
+      }
+    }
+
+    if (dec->decodeFrames() && dec->decodeNextFrame())
+    {
+      DEBUG_COMPRESSED("playlistItemCompressedVideo::runPictureHashVerification decoded frame %d", frameIdx);
+      pictureHash::pictureHashes expected;
+      const bool hasHash = inputFileAnnexBParser->getDecodedPictureHash(frameIdx, expected);
+      bool match = true;
+      if (hasHash)
+      {
+        QList<QByteArray> planeHashes;
+        if (!calculateDecodedPictureHash(dec, expected.type, planeHashes))
+        {
+          error = "The format of the decoded pictures is not supported.";
+          break;
+        }
+        // The hash SEI may contain less components than the picture (e.g. only luma)
+        for (int c = 0; c < expected.planes.size(); c++)
+          if (c >= planeHashes.size() || planeHashes[c] != expected.planes[c])
+            match = false;
+      }
+
+      QMutexLocker locker(&hashVerificationMutex);
+      hashVerificationState.nrFramesDecoded++;
+      if (!hasHash)
+        hashVerificationState.nrFramesWithoutHash++;
+      else
+      {
+        hashVerificationState.type = expected.type;
+        if (match)
+          hashVerificationState.nrFramesMatch++;
+        else
+          hashVerificationState.mismatchPOCs.append(inputFileAnnexBParser->getFramePOC(frameIdx));
+      }
+      frameIdx++;
+    }
+
+    if (dec->errorInDecoder())
+      error = "Error in the decoder: " + dec->decoderErrorString();
+    else if (!dec->needsMoreData() && !dec->decodeFrames())
+      // The end of the stream was reached
+      break;
+  }
+
+  DEBUG_COMPRESSED("playlistItemCompressedVideo::runPictureHashVerification done after %d frames", frameIdx);
+  QMutexLocker locker(&hashVerificationMutex);
+  hashVerificationState.error = error;
+}
+
+bool playlistItemCompressedVideo::calculateDecodedPictureHash(decoderBase *dec, pictureHash::hashType type, QList<QByteArray> &planeHashes)
+{
+  const yuvPixelFormat fmt = dec->getYUVPixelFormat();
+  if (dec->getRawFormat() != raw_YUV || !fmt.isValid() || !fmt.planar || fmt.uvInterleaved || fmt.bigEndian)
+    return false;
+
+  const QSize frameSize = dec->getFrameSize();
+  const int nrPlanes = (fmt.subsampling == YUV_400) ? 1 : 3;
+  const int bytesPerSample = (fmt.bitsPerSample > 8) ? 2 : 1;
+  const int widthC = (nrPlanes == 1) ? 0 : frameSize.width() / fmt.getSubsamplingHor();
+  const int heightC = (nrPlanes == 1) ? 0 : frameSize.height() / fmt.getSubsamplingVer();
+
+  // Hash the planes in the buffer of the decoder if possible. Otherwise, get a copy in a packed buffer.
+  const YUV_Internals::yuvPictureRef picture = dec->getRawFrameRef();
+  QByteArray rawData;
+  if (!picture.isValid())
+    rawData = dec->getRawFrameData();
+
+  for (int c = 0; c < nrPlanes; c++)
+  {
+    const int width = (c == 0) ? frameSize.width() : widthC;
+    const int height = (c == 0) ? frameSize.height() : heightC;
+    const unsigned char *src;
+    int stride;
+    if (picture.isValid())
+    {
+      src = picture.getPlane(c);
+      stride = picture.getStride(c);
+    }
+    else
+    {
+      // In the packed buffer, the chroma planes are in the order of the format
+      const bool swapUV = (fmt.planeOrder == Order_YVU || fmt.planeOrder == Order_YVUA);
+      const int packedIdx = (c == 0 || !swapUV) ? c : 3 - c;
+      const int64_t lumaBytes = int64_t(frameSize.width()) * frameSize.height() * bytesPerSample;
+      const int64_t chromaBytes = int64_t(widthC) * heightC * bytesPerSample;
+      const int64_t offset = (packedIdx == 0) ? 0 : lumaBytes + (packedIdx - 1) * chromaBytes;
+      if (rawData.size() < offset + ((c == 0) ? lumaBytes : chromaBytes))
+        return false;
+      src = (const unsigned char*)rawData.constData() + offset;
+      stride = width * bytesPerSample;
+    }
+    planeHashes.append(pictureHash::calculatePlaneHash(type, src, stride, width, height, fmt.bitsPerSample));
+  }
+  return true;
+}
+
+// This timer event is called regularly while the picture hash verification is running.
+void playlistItemCompressedVideo::timerEvent(QTimerEvent *event)
+{
+  if (event->timerId() != hashVerificationTimer.timerId())
+    return playlistItemWithVideo::timerEvent(event);
+
+  if (!hashVerification.isRunning())
+  {
+    hashVerificationTimer.stop();
+    hashDecoder.reset();
+  }
+  // Update the progress (or the result) in the info panel
+  emit signalItemChanged(false, RECACHE_NONE);
 }
 
 void playlistItemCompressedVideo::seekToPosition(int seekToFrame, int seekToDTS, bool caching)
@@ -746,25 +1209,43 @@ void playlistItemCompressedVideo::createPropertiesWidget()
 
 bool playlistItemCompressedVideo::allocateDecoder(int displayComponent)
 {
+  {
+    QMutexLocker locker(&cachingDecoderErrorMutex);
+    cachingDecoderError.clear();
+  }
+
+  if (takeDecodersFromPool(displayComponent))
+  {
+    nrDecoderThreads = loadingDecoder->getNrThreads();
+    decodingEnabled = true;
+    return true;
+  }
+
   // Reset (existing) decoders
   loadingDecoder.reset();
   cachingDecoder.reset();
 
+  // The decoders that support threading (libde265, dav1d and FFmpeg) get this many threads each
+  const int nrThreads = functions::getDecoderThreadCount();
+
+  // Run the caching decoder in a separate process so that a crash in the decoder library does not take down YUView
+  const bool remoteCaching = useRemoteCachingDecoder();
+
   if (decoderEngineType == decoderEngineLibde265)
   {
     DEBUG_COMPRESSED("playlistItemCompressedVideo::allocateDecoder Initializing interactive libde265 decoder");
-    loadingDecoder.reset(new decoderLibde265(displayComponent));
-    if (cachingEnabled)
+    loadingDecoder.reset(new decoderLibde265(displayComponent, false, nrThreads));
+    if (cachingEnabled && !remoteCaching)
     {
       DEBUG_COMPRESSED("playlistItemCompressedVideo::allocateDecoder Initializing caching libde265 decoder");
-      cachingDecoder.reset(new decoderLibde265(displayComponent, true));
+      cachingDecoder.reset(new decoderLibde265(displayComponent, true, nrThreads));
     }
   }
   else if (decoderEngineType == decoderEngineHM)
   {
     DEBUG_COMPRESSED("playlistItemCompressedVideo::allocateDecoder Initializing interactive HM decoder");
     loadingDecoder.reset(new decoderHM(displayComponent));
-    if (cachingEnabled)
+    if (cachingEnabled && !remoteCaching)
     {
       DEBUG_COMPRESSED("playlistItemCompressedVideo::allocateDecoder caching interactive HM decoder");
       cachingDecoder.reset(new decoderHM(displayComponent, true));
@@ -774,7 +1255,7 @@ bool playlistItemCompressedVideo::allocateDecoder(int displayComponent)
   {
     DEBUG_COMPRESSED("playlistItemCompressedVideo::allocateDecoder Initializing interactive VTM decoder");
     loadingDecoder.reset(new decoderVTM(displayComponent));
-    if (cachingEnabled)
+    if (cachingEnabled && !remoteCaching)
     {
       DEBUG_COMPRESSED("playlistItemCompressedVideo::allocateDecoder caching interactive VTM decoder");
       cachingDecoder.reset(new decoderVTM(displayComponent, true));
@@ -783,11 +1264,11 @@ bool playlistItemCompressedVideo::allocateDecoder(int displayComponent)
   else if (decoderEngineType == decoderEngineDav1d)
   {
     DEBUG_COMPRESSED("playlistItemCompressedVideo::allocateDecoder Initializing interactive dav1d decoder");
-    loadingDecoder.reset(new decoderDav1d(displayComponent));
-    if (cachingEnabled)
+    loadingDecoder.reset(new decoderDav1d(displayComponent, false, nrThreads));
+    if (cachingEnabled && !remoteCaching)
     {
       DEBUG_COMPRESSED("playlistItemCompressedVideo::allocateDecoder caching interactive dav1d decoder");
-      cachingDecoder.reset(new decoderDav1d(displayComponent, true));
+      cachingDecoder.reset(new decoderDav1d(displayComponent, true, nrThreads));
     }
   }
   else if (decoderEngineType == decoderEngineFFMpeg)
@@ -801,21 +1282,21 @@ bool playlistItemCompressedVideo::allocateDecoder(int displayComponent)
       auto ratio = inputFileAnnexBParser->getSampleAspectRatio();
 
       DEBUG_COMPRESSED("playlistItemCompressedVideo::allocateDecoder Initializing interactive ffmpeg decoder from raw anexB stream. frameSize %dx%d extradata length %d yuvPixelFormat %s profile/level %d/%d, aspect raio %d/%d", frameSize.width(), frameSize.height(), extradata.length(), fmt.getName().toStdString().c_str(), profileLevel.first, profileLevel.second, ratio.first, ratio.second);
-      loadingDecoder.reset(new decoderFFmpeg(ffmpegCodec, frameSize, extradata, fmt, profileLevel, ratio));
+      loadingDecoder.reset(new decoderFFmpeg(ffmpegCodec, frameSize, extradata, fmt, profileLevel, ratio, false, nrThreads));
       if (cachingEnabled)
       {
         DEBUG_COMPRESSED("playlistItemCompressedVideo::allocateDecoder Initializing caching ffmpeg decoder from raw anexB stream. Same settings.");
-        cachingDecoder.reset(new decoderFFmpeg(ffmpegCodec, frameSize, extradata, fmt, profileLevel, ratio, true));
+        cachingDecoder.reset(new decoderFFmpeg(ffmpegCodec, frameSize, extradata, fmt, profileLevel, ratio, true, nrThreads));
       }
     }
     else
     {
       DEBUG_COMPRESSED("playlistItemCompressedVideo::allocateDecoder Initializing interactive ffmpeg decoder using ffmpeg as parser");
-      loadingDecoder.reset(new decoderFFmpeg(inputFileFFmpegLoading->getVideoCodecPar()));
+      loadingDecoder.reset(new decoderFFmpeg(inputFileFFmpegLoading->getVideoCodecPar(), false, nrThreads));
       if (cachingEnabled)
       {
         DEBUG_COMPRESSED("playlistItemCompressedVideo::allocateDecoder Initializing caching ffmpeg decoder using ffmpeg as parser");
-        cachingDecoder.reset(new decoderFFmpeg(inputFileFFmpegCaching->getVideoCodecPar()));
+        cachingDecoder.reset(new decoderFFmpeg(inputFileFFmpegCaching->getVideoCodecPar(), true, nrThreads));
       }
     }
   }
@@ -826,6 +1307,13 @@ bool playlistItemCompressedVideo::allocateDecoder(int displayComponent)
     return false;
   }
 
+  if (remoteCaching)
+  {
+    DEBUG_COMPRESSED("playlistItemCompressedVideo::allocateDecoder Initializing caching decoder in a separate process");
+    cachingDecoder.reset(new decoderRemote(decoderEngineType, displayComponent, true, nrThreads));
+  }
+
+  nrDecoderThreads = loadingDecoder->getNrThreads();
   decodingEnabled = !loadingDecoder->errorInDecoder();
   if (!decodingEnabled)
   {
@@ -838,6 +1326,58 @@ bool playlistItemCompressedVideo::allocateDecoder(int displayComponent)
   return true;
 }
 
+bool playlistItemCompressedVideo::useRemoteCachingDecoder() const
+{
+  QSettings settings;
+  return cachingEnabled && settings.value("Decoders/SeparateProcess", false).toBool() && decoderRemote::isEngineSupported(decoderEngineType);
+}
+
+void playlistItemCompressedVideo::addDecodersToPool()
+{
+  if (loadingDecoder.isNull())
+    return;
+  if (loadingDecoder->errorInDecoder() || (cachingDecoder && cachingDecoder->errorInDecoder()))
+  {
+    // Don't keep decoders that can not be used anymore
+    loadingDecoder.reset();
+    cachingDecoder.reset();
+    return;
+  }
+
+  pooledDecoders d;
+  d.engine = decoderEngineType;
+  d.decodeSignal = loadingDecoder->getDecodeSignal();
+  d.remoteCaching = dynamic_cast<decoderRemote*>(cachingDecoder.data()) != nullptr;
+  d.loading = loadingDecoder;
+  d.caching = cachingDecoder;
+  loadingDecoder.reset();
+  cachingDecoder.reset();
+  DEBUG_COMPRESSED("playlistItemCompressedVideo::addDecodersToPool engine %d signal %d", d.engine, d.decodeSignal);
+  decoderPool.append(d);
+
+  while (decoderPool.size() > DECODER_POOL_SIZE)
+    decoderPool.removeFirst();
+}
+
+bool playlistItemCompressedVideo::takeDecodersFromPool(int decodeSignal)
+{
+  // The separate process for the caching decoder may have been switched on or off in the settings
+  const bool remoteCaching = useRemoteCachingDecoder();
+  for (int i = 0; i < decoderPool.size(); i++)
+  {
+    const pooledDecoders &d = decoderPool[i];
+    if (d.engine != decoderEngineType || d.decodeSignal != decodeSignal || d.caching.isNull() == cachingEnabled || d.remoteCaching != remoteCaching)
+      continue;
+
+    DEBUG_COMPRESSED("playlistItemCompressedVideo::takeDecodersFromPool engine %d signal %d", d.engine, d.decodeSignal);
+    loadingDecoder = d.loading;
+    cachingDecoder = d.caching;
+    decoderPool.removeAt(i);
+    return true;
+  }
+  return false;
+}
+
 void playlistItemCompressedVideo::fillStatisticList()
 {
   if (!loadingDecoder || !loadingDecoder->statisticsSupported())
@@ -853,25 +1393,37 @@ void playlistItemCompressedVideo::loadStatisticToCache(int frameIdx, int typeIdx
 
   if (!loadingDecoder->statisticsSupported())
     return;
-  if (!loadingDecoder->statisticsEnabled())
+  if (!loadingDecoder->statisticsEnabled() || !loadingDecoder->isStatisticsTypeRetrieved(typeIdx))
   {
     // We have to enable collecting of statistics in the decoder. By default (for speed reasons) this is off.
     // Enabeling works like this: Enable collection, reset the decoder and decode the current frame again.
-    // Statisitcs are always retrieved for the loading decoder.
+    // Statisitcs are always retrieved for the loading decoder. Only the statistics types that are rendered
+    // are retrieved so if another type is requested, we have to decode the current frame again as well.
     loadingDecoder->enableStatisticsRetrieval();
+    QSet<int> typeIDs = statSource.getRenderedStatisticsTypeIDs();
+    typeIDs.insert(typeIdx);
+    loadingDecoder->setStatisticsTypesToRetrieve(typeIDs);
 
-    // Reload the current frame (force a seek and decode operation)
-    int frameToLoad = currentFrameIdx[0];
+    // Reload the requested frame (force a seek and decode operation)
     currentFrameIdx[0] = INT_MAX;
-    loadRawData(frameToLoad, false);
+    bypassFrameWindow = true;
+    loadRawData(frameIdxInternal, false);
+    bypassFrameWindow = false;
 
     // The statistics should now be loaded
   }
   else if (frameIdxInternal != currentFrameIdx[0])
+  {
     // If the requested frame is not currently decoded, decode it.
-    // This can happen if the picture was gotten from the cache.
+    // This can happen if the picture was gotten from the cache (or from the frame window).
+    bypassFrameWindow = true;
     loadRawData(frameIdxInternal, false);
+    bypassFrameWindow = false;
+  }
 
+  if (frameIdxInternal != currentFrameIdx[0])
+    // Decoding was cancelled (or failed). The decoder does not hold the statistics of the frame.
+    return;
   statSource.statsCache[typeIdx] = loadingDecoder->getStatisticsData(typeIdx);
 }
 
@@ -930,6 +1482,7 @@ void playlistItemCompressedVideo::reloadItemSource()
 
   // Reset the videoHandlerYUV source. With the next draw event, the videoHandlerYUV will request to decode the frame again.
   video->invalidateAllBuffers();
+  clearFrameWindow();
 
   // Load frame 0. This will decode the first frame in the sequence and set the
   // correct frame size/YUV format.
@@ -953,8 +1506,16 @@ void playlistItemCompressedVideo::loadFrame(int frameIdx, bool playing, bool loa
   Q_ASSERT(QThread::currentThread() != QApplication::instance()->thread());
   const int frameIdxInternal = getFrameIdxInternal(frameIdx);
 
+  if (scrubFrameIdx >= 0 && !videoHandler::isScrubbing())
+  {
+    // Scrubbing ended. The shown frame is only an approximation and has to be decoded exactly.
+    video->invalidateCurrentFrame();
+    scrubFrameIdx = -1;
+  }
+
   auto stateYUV = video->needsLoading(frameIdxInternal, loadRawdata);
-  auto stateStat = statSource.needsLoading(frameIdxInternal);
+  // Statistics are not loaded while scrubbing. This would require decoding every frame exactly.
+  auto stateStat = videoHandler::isScrubbing() ? LoadingNotNeeded : statSource.needsLoading(frameIdxInternal);
 
   if (stateYUV == LoadingNeeded || stateStat == LoadingNeeded)
   {
@@ -965,7 +1526,7 @@ void playlistItemCompressedVideo::loadFrame(int frameIdx, bool playing, bool loa
       DEBUG_COMPRESSED("playlistItemCompressedVideo::loadFrame loading frame %d %s", frameIdxInternal, playing ? "(playing)" : "");
       video->loadFrame(frameIdxInternal);
     }
-    if (stateStat == LoadingNeeded)
+    if (stateStat == LoadingNeeded && !loadingCancellation::isCancelled())
     {
       DEBUG_COMPRESSED("playlistItemCompressedVideo::loadFrame loading statistics %d %s", frameIdxInternal, playing ? "(playing)" : "");
       statSource.loadStatistics(frameIdxInternal);
@@ -978,9 +1539,10 @@ void playlistItemCompressedVideo::loadFrame(int frameIdx, bool playing, bool loa
 
   if (playing && (stateYUV == LoadingNeeded || stateYUV == LoadingNeededDoubleBuffer))
   {
-    // Load the next frame into the double buffer
-    int nextFrameIdx = frameIdxInternal + 1;
-    if (nextFrameIdx <= startEndFrame.second)
+    // Load the next frame (the previous one when playing backwards) into the double buffer.
+    // Backward steps are served from the frame window which is extended in the background GOP by GOP.
+    int nextFrameIdx = frameIdxInternal + videoHandler::getPlaybackStep();
+    if (nextFrameIdx >= startEndFrame.first && nextFrameIdx <= startEndFrame.second)
     {
       DEBUG_COMPRESSED("playlistItplaylistItemCompressedVideoemRawFile::loadFrame loading frame into double buffer %d %s", nextFrameIdx, playing ? "(playing)" : "");
       isFrameLoadingDoubleBuffer = true;
@@ -996,19 +1558,17 @@ void playlistItemCompressedVideo::displaySignalComboBoxChanged(int idx)
 {
   if (loadingDecoder && idx != loadingDecoder->getDecodeSignal())
   {
-    bool resetDecoder = false;
-    loadingDecoder->setDecodeSignal(idx, resetDecoder);
-    cachingDecoder->setDecodeSignal(idx, resetDecoder);
+    // The decoded frames in the frame window show the old signal
+    clearFrameWindow();
 
-    if (resetDecoder)
-    {
-      loadingDecoder->resetDecoder();
-      cachingDecoder->resetDecoder();
+    // Only the decoders that can decode other signals (libde265, dav1d) get here. These would have to be reset
+    // for the new signal anyways. Keep the decoders for the current signal in the pool so that switching back is fast.
+    addDecodersToPool();
+    allocateDecoder(idx);
 
-      // Reset the decoded frame indices so that decoding of the current frame is triggered
-      currentFrameIdx[0] = -1;
-      currentFrameIdx[1] = -1;
-    }
+    // Reset the decoded frame indices so that decoding of the current frame is triggered
+    currentFrameIdx[0] = -1;
+    currentFrameIdx[1] = -1;
 
     // A different display signal was chosen. Invalidate the cache and signal that we will need a redraw.
     videoHandlerYUV *yuvVideo = dynamic_cast<videoHandlerYUV*>(video.data());
@@ -1024,7 +1584,10 @@ void playlistItemCompressedVideo::decoderComboxBoxChanged(int idx)
   decoderEngine e = possibleDecoders.at(idx);
   if (e != decoderEngineType)
   {
-    // Allocate a new decoder of the new type
+    // Allocate a new decoder of the new type (or take it from the pool). The background extension of the frame
+    // window may still use the old one. Keep the old decoders in the pool so that switching back is fast.
+    clearFrameWindow();
+    addDecodersToPool();
     decoderEngineType = e;
     allocateDecoder();
 
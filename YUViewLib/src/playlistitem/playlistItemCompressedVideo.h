@@ -33,11 +33,16 @@
 #ifndef PLAYLISTITEMCOMPRESSEDVIDEO_H
 #define PLAYLISTITEMCOMPRESSEDVIDEO_H
 
+#include <QBasicTimer>
+#include <QFuture>
+#include <QSharedPointer>
+
 #include "decoder/decoderBase.h"
 #include "filesource/fileSourceFFmpegFile.h"
 #include "parser/parserAnnexB.h"
 #include "playlistItemWithVideo.h"
 #include "statistics/statisticHandler.h"
+#include "video/decodedFrameWindow.h"
 #include "ui_playlistItemCompressedFile.h"
 
 class videoHandler;
@@ -59,6 +64,7 @@ public:
   * 'displayComponent' initializes the component to display (reconstruction/prediction/residual/trCoeff).
   */
   playlistItemCompressedVideo(const QString &fileName, int displayComponent=0, YUView::inputFormat input = YUView::inputInvalid, YUView::decoderEngine decoder = YUView::decoderEngineInvalid);
+  virtual ~playlistItemCompressedVideo();
 
   // Save the compressed file element to the given XML structure.
   virtual void savePlaylist(QDomElement &root, const QDir &playlistDir) const Q_DECL_OVERRIDE;
@@ -88,7 +94,8 @@ public:
   // ----- Detection of source/file change events -----
   virtual bool isSourceChanged()        Q_DECL_OVERRIDE { /* TODO */ return false; }
   virtual void reloadItemSource()       Q_DECL_OVERRIDE;
-  virtual void updateSettings()         Q_DECL_OVERRIDE { /* TODO loadingDecoder->updateFileWatchSetting(); statSource.updateSettings(); */ }
+  // TODO loadingDecoder->updateFileWatchSetting(); statSource.updateSettings();
+  virtual void updateSettings()         Q_DECL_OVERRIDE;
 
   // Do we need to load the given frame first?
   virtual itemLoadingState needsLoading(int frameIdx, bool loadRawData) Q_DECL_OVERRIDE;
@@ -105,6 +112,8 @@ public:
   // We only have one caching decoder so it is better if only one thread caches frames from this item.
   // This way, the frames will always be cached in the right order and no unnecessary decoding is performed.
   virtual int cachingThreadLimit() Q_DECL_OVERRIDE { return 1; }
+  // The caching decoder uses this many threads internally
+  virtual int cachingThreadCost() const Q_DECL_OVERRIDE { return nrDecoderThreads; }
 
   YUView::inputFormat getInputFormat() const { return inputFormatType; }
   
@@ -116,15 +125,39 @@ protected:
 
   // We allocate two decoder: One for loading images in the foreground and one for caching in the background.
   // This is better if random access and linear decoding (caching) is performed at the same time.
-  QScopedPointer<decoderBase> loadingDecoder;
-  QScopedPointer<decoderBase> cachingDecoder;
+  // The decoders are shared with the decoder pool.
+  QSharedPointer<decoderBase> loadingDecoder;
+  QSharedPointer<decoderBase> cachingDecoder;
+  // The number of threads that each decoder uses internally (the decoder thread budget)
+  int nrDecoderThreads {1};
 
   // When opening the file, we will fill this list with the possible decoders
   QList<YUView::decoderEngine> possibleDecoders;
   // The actual type of the decoder
   YUView::decoderEngine decoderEngineType;
-  // Delete existing decoders and allocate decoders for the type "decoderEngineType"
+  // Delete existing decoders and allocate decoders for the type "decoderEngineType". If decoders for the engine
+  // and the display component are in the decoder pool, these are used.
   bool allocateDecoder(int displayComponent = 0);
+  // Should the caching decoder run in a separate process (see decoderRemote)? This can be changed in the settings.
+  bool useRemoteCachingDecoder() const;
+
+  // ----- Decoder pool -----
+  // When the decoder engine or the decoded signal is changed, the current decoders are not deleted but kept in
+  // this pool (keyed by engine, signal and whether the caching decoder runs in a separate process). Switching back uses
+  // the initialized decoders from the pool instead of allocating (and possibly loading the library of) new ones.
+  // Decoders taken from the pool must seek before decoding.
+  struct pooledDecoders
+  {
+    YUView::decoderEngine engine;
+    int decodeSignal;
+    bool remoteCaching;
+    QSharedPointer<decoderBase> loading;
+    QSharedPointer<decoderBase> caching;
+  };
+  QList<pooledDecoders> decoderPool;
+  // Move the current decoders to the pool. If the pool is full, the decoders that were added first are deleted.
+  void addDecodersToPool();
+  bool takeDecodersFromPool(int decodeSignal);
 
   // In order to parse raw annexB files, we need a file reader (that can read NAL units)
   // and a parser that can understand what the NAL units mean. We open the file source twice (once for interactive loading,
@@ -152,6 +185,12 @@ protected:
   // TODO: Could we somehow make shure that caching is always performed in display order?
   QMutex cachingMutex;
 
+  // If the caching decoder fails (e.g. because its separate decoder process crashed), interactive decoding still works.
+  // The error is shown in the info panel. Returns true if there is an error in the caching decoder.
+  bool checkCachingDecoderError();
+  mutable QMutex cachingDecoderErrorMutex;
+  QString cachingDecoderError;
+
   statisticHandler statSource;
 
   // Fill the list of statistic types that we can provide
@@ -177,6 +216,77 @@ protected:
   // might be unable to decode some of the frames at the end of the sequence.
   int decodingNotPossibleAfter { -1 };
 
+  // ----- Backward stepping -----
+  // The decoded frames before the current frame of the interactive/caching decoder. Backward steps (and caching for
+  // backward playback) are served from these windows without decoding.
+  decodedFrameWindow frameWindow[2];
+  // If set, all frames that the interactive/caching decoder decodes on the way to the requested frame are collected
+  // and added to the frameWindow when the requested frame is reached.
+  bool frameWindowCollect[2] {false, false};
+  int frameWindowCollectStart[2] {-1, -1};
+  QList<decodedFrameWindow::frame> frameWindowCollectedFrames[2];
+  // Get the frame from the frameWindow instead of decoding it. Start extending the interactive window in the background if needed.
+  bool loadRawDataFromFrameWindow(int frameIdxInternal, bool caching);
+  // Decode the GOP before the interactive frameWindow (up to lastFrameIdx) with the caching decoder and add it to the window.
+  // This runs in the background. The decoded frames are not set as the raw data of the video handler.
+  // The extension is cancelled if the frameWindowGeneration is no longer the given generation.
+  void extendFrameWindow(int lastFrameIdx, int generation);
+  QFuture<void> frameWindowExtension;
+  bool frameWindowExtending {false};
+  int frameWindowExtensionGeneration {0};
+  QAtomicInt frameWindowGeneration;
+  bool isFrameWindowExtensionCancelled() const { return frameWindowGeneration.load() != frameWindowExtensionGeneration; }
+  // Clear the window (the decoder, the decoded signal or the source changed). A running extension is cancelled
+  // after the current frame. This does not wait for it.
+  void clearFrameWindow();
+  // Set the memory limit of the frame windows from the cache size in the settings
+  void updateFrameWindowMaxMemory();
+  // If set, loadRawData always decodes the interactive frame (e.g. because the decoder has to provide the statistics of the frame)
+  bool bypassFrameWindow {false};
+
+  // ----- Scrubbing -----
+  // While the user drags the frame slider, the closest random access point before the requested frame is shown
+  // instead of decoding the exact frame. Only the random access point is decoded (non-RAP frames are discarded).
+  // The approximated frame is decoded exactly when scrubbing ends.
+  bool loadRawDataScrubbing(int frameIdxInternal);
+  // The frame that is currently shown as an approximation (-1 if none)
+  int scrubFrameIdx {-1};
+  // The last decoded random access point and its picture
+  int scrubRAPFrameIdx {-1};
+  decodedFrameWindow::frame scrubRAPFrame;
+
+  // ----- Decoded picture hash verification -----
+  // Decode the whole annexB stream with a separate decoder in the background and compare the hash of every decoded
+  // picture to the hash from the decoded picture hash SEI. The pictures are not converted or shown, so this runs at
+  // the full speed of the decoder. The result is shown in the info panel.
+  void startPictureHashVerification();
+  void runPictureHashVerification();
+  // Calculate the hash of all planes of the current picture of the decoder
+  static bool calculateDecodedPictureHash(decoderBase *dec, pictureHash::hashType type, QList<QByteArray> &planeHashes);
+  QScopedPointer<decoderBase> hashDecoder;
+  QFuture<void> hashVerification;
+  QAtomicInt hashVerificationCancel;
+  struct hashVerificationResult
+  {
+    bool started {false};
+    int nrFramesDecoded {0};
+    int nrFramesMatch {0};
+    int nrFramesWithoutHash {0};
+    pictureHash::hashType type {pictureHash::hashInvalid};
+    QList<int> mismatchPOCs;
+    QString error;
+  };
+  // The result is updated by the background verification
+  mutable QMutex hashVerificationMutex;
+  hashVerificationResult hashVerificationState;
+  // A timer is used to frequently update the info panel while the verification is running (every second)
+  QBasicTimer hashVerificationTimer;
+  virtual void timerEvent(QTimerEvent *event) Q_DECL_OVERRIDE; // Overloaded from QObject. Called when the timer fires.
+
+  // Get the current frame from the decoder (a reference to it if possible) and set it as the raw data of the video handler
+  decodedFrameWindow::frame getDecodedFrame(decoderBase *dec);
+  void setVideoRawData(const decodedFrameWindow::frame &frame, int frameIdxInternal);
+
 private slots:
   // Load the raw (YUV or RGN) data for the given frame index from file. This slot is called by the videoHandler if the frame that is
   // requested to be drawn has not been loaded yet.
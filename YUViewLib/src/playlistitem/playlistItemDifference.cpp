@@ -234,9 +234,9 @@ void playlistItemDifference::loadFrame(int frameIdx, bool playing, bool loadRawD
   
   if (playing && (state == LoadingNeeded || state == LoadingNeededDoubleBuffer))
   {
-    // Load the next frame into the double buffer
-    int nextFrameIdx = frameIdxInternal + 1;
-    if (nextFrameIdx <= startEndFrame.second)
+    // Load the next frame (the previous one when playing backwards) into the double buffer
+    int nextFrameIdx = frameIdxInternal + videoHandler::getPlaybackStep();
+    if (nextFrameIdx >= startEndFrame.first && nextFrameIdx <= startEndFrame.second)
     {
       DEBUG_DIFF("playlistItemDifference::loadFrame loading difference into double buffer %d %s", nextFrameIdx, playing ? "(playing)" : "");
       isDifferenceLoadingToDoubleBuffer = true;
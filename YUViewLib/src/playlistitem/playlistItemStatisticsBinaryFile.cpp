@@ -0,0 +1,138 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "playlistItemStatisticsBinaryFile.h"
+
+playlistItemStatisticsBinaryFile::playlistItemStatisticsBinaryFile(const QString &itemNameOrFileName)
+  : playlistItemStatisticsFile(itemNameOrFileName)
+{
+  // All frame positions are known from the frame table. There is nothing to parse in the background.
+  cancelBackgroundParser = false;
+  fileSortedByPOC = true;
+
+  openBinaryFile();
+
+  connect(&statSource, &statisticHandler::updateItem, [this](bool redraw){ emit signalItemChanged(redraw, RECACHE_NONE); });
+  connect(&statSource, &statisticHandler::requestStatisticsLoading, this, &playlistItemStatisticsBinaryFile::loadStatisticToCache, Qt::DirectConnection);
+}
+
+void playlistItemStatisticsBinaryFile::openBinaryFile()
+{
+  binaryFile.reset(new statisticsBinaryFormat::reader());
+  if (!file.isOk())
+    return;
+  if (!binaryFile->open(plItemNameOrFileName))
+  {
+    parsingError = binaryFile->getError();
+    binaryFile.reset();
+    return;
+  }
+
+  statSource.clearStatTypes();
+  for (const StatisticsType &t : binaryFile->getTypes())
+    statSource.addStatType(t);
+  statSource.setFrameSize(binaryFile->getFrameSize());
+  if (binaryFile->getFrameRate() > 0)
+    frameRate = binaryFile->getFrameRate();
+
+  maxPOC = qMax(binaryFile->getNrFrames() - 1, 0);
+  setStartEndFrame(indexRange(0, maxPOC), false);
+}
+
+void playlistItemStatisticsBinaryFile::loadStatisticToCache(int frameIdxInternal, int typeID)
+{
+  // Frames without data for the type get an empty entry so that they are not requested again
+  statisticsData &data = statSource.statsCache[typeID];
+  if (binaryFile && !binaryFile->readFrameType(frameIdxInternal, typeID, data))
+    data = statisticsData();
+
+  if (blockOutsideOfFrame_idx == -1)
+  {
+    const QSize frameSize = statSource.getFrameSize();
+    const statisticsValueArrays &values = data.valueData;
+    for (int i = 0; i < values.size(); i++)
+      if (values.posX[i] + values.width[i] > frameSize.width() || values.posY[i] + values.height[i] > frameSize.height())
+      {
+        blockOutsideOfFrame_idx = frameIdxInternal;
+        break;
+      }
+  }
+}
+
+playlistItemStatisticsBinaryFile *playlistItemStatisticsBinaryFile::newplaylistItemStatisticsBinaryFile(const YUViewDomElement &root, const QString &playlistFilePath)
+{
+  // Parse the DOM element. It should have all values of a playlistItemStatisticsFile
+  QString absolutePath = root.findChildValue("absolutePath");
+  QString relativePath = root.findChildValue("relativePath");
+
+  // check if file with absolute path exists, otherwise check relative path
+  QString filePath = fileSource::getAbsPathFromAbsAndRel(playlistFilePath, absolutePath, relativePath);
+  if (filePath.isEmpty())
+    return nullptr;
+
+  // We can still not be sure that the file really exists, but we gave our best to try to find it.
+  playlistItemStatisticsBinaryFile *newStat = new playlistItemStatisticsBinaryFile(filePath);
+
+  // Load the propertied of the playlistItem
+  playlistItem::loadPropertiesFromPlaylist(root, newStat);
+
+  // Load the status of the statistics (which are shown, transparency ...)
+  newStat->statSource.loadPlaylist(root);
+
+  return newStat;
+}
+
+void playlistItemStatisticsBinaryFile::getSupportedFileExtensions(QStringList &allExtensions, QStringList &filters)
+{
+  allExtensions.append(statisticsBinaryFormat::fileExtension);
+  filters.append(QString("Binary Statistics File (*.%1)").arg(statisticsBinaryFormat::fileExtension));
+}
+
+void playlistItemStatisticsBinaryFile::reloadItemSource()
+{
+  // Set default variables
+  blockOutsideOfFrame_idx = -1;
+  parsingError.clear();
+  currentDrawnFrameIdx = -1;
+  maxPOC = 0;
+
+  // Clear the loaded data
+  statSource.clearStatisticsCache();
+
+  // Reopen the file
+  file.openFile(plItemNameOrFileName);
+  openBinaryFile();
+
+  statSource.updateStatisticsHandlerControls();
+  emit signalItemChanged(true, RECACHE_NONE);
+}
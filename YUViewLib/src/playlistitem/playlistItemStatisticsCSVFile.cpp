@@ -38,12 +38,7 @@
 #include <QtConcurrent>
 #include <QTime>
 #include "statistics/statisticsExtensions.h"
-
-// The internal buffer for parsing the starting positions. The buffer must not be larger than 2GB
-// so that we can address all the positions in it with int (using such a large buffer is not a good
-// idea anyways)
-#define STAT_PARSING_BUFFER_SIZE 1048576
-#define STAT_MAX_STRING_SIZE 1<<28
+#include "statistics/statisticsFileIndexer.h"
 
 playlistItemStatisticsCSVFile::playlistItemStatisticsCSVFile(const QString &itemNameOrFileName)
   : playlistItemStatisticsFile(itemNameOrFileName)
@@ -55,6 +50,9 @@ playlistItemStatisticsCSVFile::playlistItemStatisticsCSVFile(const QString &item
   // Read the statistics file header
   readHeaderFromFile();
 
+  // The blocks of the frames are read directly from the mapped file
+  mappedFile.openFile(itemNameOrFileName);
+
   // Run the parsing of the file in the background
   cancelBackgroundParser = false;
   timer.start(1000, this);
@@ -76,148 +74,155 @@ void playlistItemStatisticsCSVFile::readFrameAndTypePositionsFromFile()
 {
   try
   {
-    // Open the file (again). Since this is a background process, we open the file again to
-    // not disturb any reading from not background code.
-    fileSource inputFile;
-    if (!inputFile.openFile(file.absoluteFilePath()))
+    // The file is scanned in chunks in parallel. Since this is a background process, the indexer opens
+    // the file again to not disturb any reading from not background code.
+    auto parseLine = [](const char *line, int lineLength, int &poc, int &typeID)
+    {
+      fileSourceMappedFields rowItems;
+      rowItems.tokenize(line, lineLength, ';');
+      // ignore empty entries and headers
+      if (rowItems.isEmpty(0) || rowItems.firstChar(0) == '%')
+        return false;
+      poc = rowItems.toInt(0);
+      typeID = rowItems.toInt(5);
+      return true;
+    };
+    statisticsFileIndexer indexer(file.absoluteFilePath(), parseLine, cancelBackgroundParser);
+    if (!indexer.start(currentDrawnFrameIdx))
       return;
 
-    // We perform reading using an input buffer
-    QByteArray inputBuffer;
-    bool fileAtEnd = false;
-    qint64 bufferStartPos = 0;
-
-    QString lineBuffer;
-    qint64  lineBufferStartPos = 0;
+    // Add a start position as soon as it is known
+    auto addStartPosition = [this](int poc, int typeID, qint64 startPos)
+    {
+      pocTypeStartList[poc][typeID] = startPos;
+      if (poc == currentDrawnFrameIdx)
+        // We added a start position for the frame index that is currently drawn. We might have to redraw.
+        emit signalItemChanged(true, RECACHE_NONE);
+
+      // update number of frames
+      if (poc > maxPOC)
+        maxPOC = poc;
+    };
+
+    // The runs of the chunks are merged in file order. Only then we know where a run really starts and
+    // if the file is continuous. mergedTypes holds the POCs/types that were merged so far.
+    QMap<int, QSet<int>> mergedTypes;
     int     lastPOC = INT_INVALID;
     int     lastType = INT_INVALID;
     bool    sortingFixed = false; 
-    
-    while (!fileAtEnd && !cancelBackgroundParser)
+    auto mergeRun = [&](const statisticsFileIndexer::run &r)
     {
-      // Fill the buffer
-      int bufferSize = inputFile.readBytes(inputBuffer, bufferStartPos, STAT_PARSING_BUFFER_SIZE);
-      if (bufferSize < STAT_PARSING_BUFFER_SIZE)
-        // Less bytes than the maximum buffer size were read. The file is at the end.
-        // This is the last run of the loop.
-        fileAtEnd = true;
-      // a corrupted file may contain an arbitrary amount of non-\n symbols
-      // prevent lineBuffer overflow by dumping it for such cases
-      if (lineBuffer.size() > STAT_MAX_STRING_SIZE)
-        lineBuffer.clear(); // prevent an overflow here
-      for (int i = 0; i < bufferSize; i++)
+      const int poc = r.poc;
+      const int typeID = r.type;
+
+      if (lastType == -1 && lastPOC == -1)
+      {
+        // First POC/type line
+        addStartPosition(poc, typeID, r.startPos);
+        mergedTypes[poc].insert(typeID);
+        lastType = typeID;
+        lastPOC = poc;
+      }
+      else if (typeID != lastType && poc == lastPOC)
       {
-        // Search for '\n' newline characters
-        if (inputBuffer.at(i) == 10)
+        // we found a new type but the POC stayed the same.
+        // This seems to be an interleaved file
+        // Check if we already collected a start position for this type
+        if (!sortingFixed)
         {
-          // We found a newline character
-          if (lineBuffer.size() > 0)
-          {
-            // Parse the previous line
-            // get components of this line
-            QStringList rowItemList = parseCSVLine(lineBuffer, ';');
-
-            // ignore empty entries and headers
-            if (!rowItemList[0].isEmpty() && rowItemList[0][0] != '%')
-            {
-              // check for POC/type information
-              int poc = rowItemList[0].toInt();
-              int typeID = rowItemList[5].toInt();
-
-              if (lastType == -1 && lastPOC == -1)
-              {
-                // First POC/type line
-                pocTypeStartList[poc][typeID] = lineBufferStartPos;
-                if (poc == currentDrawnFrameIdx)
-                  // We added a start position for the frame index that is currently drawn. We might have to redraw.
-                  emit signalItemChanged(true, RECACHE_NONE);
-
-                lastType = typeID;
-                lastPOC = poc;
-
-                // update number of frames
-                if (poc > maxPOC)
-                  maxPOC = poc;
-              }
-              else if (typeID != lastType && poc == lastPOC)
-              {
-                // we found a new type but the POC stayed the same.
-                // This seems to be an interleaved file
-                // Check if we already collected a start position for this type
-                if (!sortingFixed)
-                {
-                  // we only check the first occurence of this, in a non-interleaved file
-                  // the above condition can be met and will reset fileSortedByPOC
-                  
-                  fileSortedByPOC = true;
-                  sortingFixed = true; 
-                }
-                lastType = typeID;
-                if (!pocTypeStartList[poc].contains(typeID))
-                {
-                  pocTypeStartList[poc][typeID] = lineBufferStartPos;
-                  if (poc == currentDrawnFrameIdx)
-                    // We added a start position for the frame index that is currently drawn. We might have to redraw.
-                    emit signalItemChanged(true, RECACHE_NONE);
-                }
-              }
-              else if (poc != lastPOC)
-              {
-                // this is apparently not sorted by POCs and we will not check it further
-                if(!sortingFixed)
-                  sortingFixed = true;
-                
-                // We found a new POC
-                if (fileSortedByPOC)
-                {
-                  // There must not be a start position for any type with this POC already.
-                  if (pocTypeStartList.contains(poc))
-                    throw "The data for each POC must be continuous in an interleaved statistics file->";
-                }
-                else
-                {
-                
-                  // There must not be a start position for this POC/type already.
-                  if (pocTypeStartList.contains(poc) && pocTypeStartList[poc].contains(typeID))
-                    throw "The data for each typeID must be continuous in an non interleaved statistics file->";
-                }
-
-                lastPOC = poc;
-                lastType = typeID;
-
-                pocTypeStartList[poc][typeID] = lineBufferStartPos;
-                if (poc == currentDrawnFrameIdx)
-                  // We added a start position for the frame index that is currently drawn. We might have to redraw.
-                  emit signalItemChanged(true, RECACHE_NONE);
-
-                // update number of frames
-                if (poc > maxPOC)
-                  maxPOC = poc;
-
-                // Update percent of file parsed
-                backgroundParserProgress = ((double)lineBufferStartPos * 100 / (double)inputFile.getFileSize());
-              }
-            }
-          }
-
-          lineBuffer.clear();
-          lineBufferStartPos = bufferStartPos + i + 1;
+          // we only check the first occurence of this, in a non-interleaved file
+          // the above condition can be met and will reset fileSortedByPOC
+          
+          fileSortedByPOC = true;
+          sortingFixed = true; 
+        }
+        lastType = typeID;
+        if (!mergedTypes[poc].contains(typeID))
+        {
+          addStartPosition(poc, typeID, r.startPos);
+          mergedTypes[poc].insert(typeID);
+        }
+      }
+      else if (poc != lastPOC)
+      {
+        // this is apparently not sorted by POCs and we will not check it further
+        if(!sortingFixed)
+        {
+          fileSortedByPOC = false;
+          sortingFixed = true;
+        }
+        
+        // We found a new POC
+        if (fileSortedByPOC)
+        {
+          // There must not be a start position for any type with this POC already.
+          if (mergedTypes.contains(poc))
+            throw "The data for each POC must be continuous in an interleaved statistics file->";
         }
         else
         {
-          // No newline character found
-          lineBuffer.append(inputBuffer.at(i));
+        
+          // There must not be a start position for this POC/type already.
+          if (mergedTypes.contains(poc) && mergedTypes[poc].contains(typeID))
+            throw "The data for each typeID must be continuous in an non interleaved statistics file->";
         }
+
+        lastPOC = poc;
+        lastType = typeID;
+
+        addStartPosition(poc, typeID, r.startPos);
+        mergedTypes[poc].insert(typeID);
+      }
+    };
+
+    // A chunk that is scanned before all chunks before it were merged (e.g. the chunk with the currently drawn frame)
+    // is added right away. Only the POCs/types which start within the chunk for sure are added.
+    auto addPreliminaryStartPositions = [&](const statisticsFileIndexer::chunk &c)
+    {
+      if (!sortingFixed)
+        fileSortedByPOC = c.typeChangeWithinPOC;
+      for (int i = 1; i < c.runs.size(); i++)
+      {
+        const auto &r = c.runs[i];
+        if (c.typeChangeWithinPOC && (r.poc == c.runs.first().poc || r.poc == c.runs.last().poc))
+          // In an interleaved file, a POC that is continued from the previous or in the next chunk is not complete
+          continue;
+        if (!pocTypeStartList.contains(r.poc) || !pocTypeStartList[r.poc].contains(r.type))
+          addStartPosition(r.poc, r.type, r.startPos);
+      }
+    };
+
+    QVector<bool> chunkScanned(indexer.getNrChunks(), false);
+    int nextChunkToMerge = 0;
+    int64_t nrBytesScanned = 0;
+    int chunkIdx;
+    while ((chunkIdx = indexer.waitForNextChunk()) != -1)
+    {
+      const auto &c = indexer.getChunk(chunkIdx);
+      chunkScanned[chunkIdx] = true;
+      if (chunkIdx != nextChunkToMerge)
+        addPreliminaryStartPositions(c);
+      while (nextChunkToMerge < indexer.getNrChunks() && chunkScanned[nextChunkToMerge])
+      {
+        for (const auto &r : indexer.getChunk(nextChunkToMerge).runs)
+          mergeRun(r);
+        nextChunkToMerge++;
       }
 
-      bufferStartPos += bufferSize;
+      // Update percent of file parsed
+      nrBytesScanned += c.endPos - c.startPos;
+      backgroundParserProgress = ((double)nrBytesScanned * 100 / (double)indexer.getFileSize());
     }
+    if (cancelBackgroundParser)
+      return;
 
     // Parsing complete
     backgroundParserProgress = 100.0;
 
     setStartEndFrame(indexRange(0, maxPOC), false);
-    emit signalItemChanged(false, RECACHE_NONE);
+    // Frames that were loaded before their positions were known are empty. Load them again.
+    statSource.clearStatisticsCache();
+    emit signalItemChanged(true, RECACHE_NONE);
 
   } // try
   catch (const char *str)
@@ -407,11 +412,9 @@ void playlistItemStatisticsCSVFile::loadStatisticToCache(int frameIdxInternal, i
 {
   try
   {
-    if (!file.isOk())
+    if (!mappedFile.isOk())
       return;
 
-    QTextStream in(file.getQFile());
-
     if (!pocTypeStartList.contains(frameIdxInternal) || !pocTypeStartList[frameIdxInternal].contains(typeID))
     {
       // There are no statistics in the file for the given frame and index.
@@ -434,22 +437,28 @@ void playlistItemStatisticsCSVFile::loadStatisticToCache(int frameIdxInternal, i
           startPos = value;
     }
 
-    // fast forward
-    in.seek(startPos);
+    // This runs in the caching threads so the types are read from the copy for the loading threads
+    const StatisticsTypeList types = statSource.getLoadingStatisticsTypeList();
+    QHash<int, const StatisticsType*> typeMap;
+    for (const StatisticsType &t : types)
+      typeMap.insert(t.typeID, &t);
 
-    while (!in.atEnd())
-    {
-      // read one line
-      QString aLine = in.readLine();
+    // The lines are tokenized in place in the mapped file
+    int64_t linePos = startPos;
+    const char *line;
+    int lineLength;
+    fileSourceMappedFields rowItems;
 
+    while (mappedFile.readLine(linePos, line, lineLength))
+    {
       // get components of this line
-      QStringList rowItemList = parseCSVLine(aLine, ';');
+      rowItems.tokenize(line, lineLength, ';');
 
-      if (rowItemList[0].isEmpty())
+      if (rowItems.isEmpty(0))
         continue;
 
-      int poc = rowItemList[0].toInt();
-      int type = rowItemList[5].toInt();
+      int poc = rowItems.toInt(0);
+      int type = rowItems.toInt(5);
 
       // if there is a new POC, we are done here!
       if (poc != frameIdxInternal)
@@ -460,35 +469,35 @@ void playlistItemStatisticsCSVFile::loadStatisticToCache(int frameIdxInternal, i
 
       int values[4] = {0};
 
-      values[0] = rowItemList[6].toInt();
+      values[0] = rowItems.toInt(6);
 
       bool vectorData = false;
       bool lineData = false; // or a vector specified by 2 points
 
-      if (rowItemList.count() > 7)
+      if (rowItems.count() > 7)
       {
-        values[1] = rowItemList[7].toInt();
+        values[1] = rowItems.toInt(7);
         vectorData = true;
       }
-      if (rowItemList.count() > 8)
+      if (rowItems.count() > 8)
       {
-        values[2] = rowItemList[8].toInt();
-        values[3] = rowItemList[9].toInt();
+        values[2] = rowItems.toInt(8);
+        values[3] = rowItems.toInt(9);
         lineData = true;
         vectorData = false;
       }
 
-      int posX = rowItemList[1].toInt();
-      int posY = rowItemList[2].toInt();
-      int width = rowItemList[3].toUInt();
-      int height = rowItemList[4].toUInt();
+      int posX = rowItems.toInt(1);
+      int posY = rowItems.toInt(2);
+      int width = qMax(0, rowItems.toInt(3));
+      int height = qMax(0, rowItems.toInt(4));
 
       // Check if block is within the image range
       if (blockOutsideOfFrame_idx == -1 && (posX + width > statSource.getFrameSize().width() || posY + height > statSource.getFrameSize().height()))
         // Block not in image. Warn about this.
         blockOutsideOfFrame_idx = frameIdxInternal;
 
-      const StatisticsType *statsType = statSource.getStatisticsType(type);
+      const StatisticsType *statsType = typeMap.value(type, nullptr);
       Q_ASSERT_X(statsType != nullptr, "StatisticsObject::readStatisticsFromFile", "Stat type not found.");
 
       if (vectorData && statsType->hasVectorData)
@@ -568,13 +577,13 @@ void playlistItemStatisticsCSVFile::reloadItemSource()
 
   // Clear the parsed data
   pocTypeStartList.clear();
-  statSource.statsCache.clear();
-  statSource.statsCacheFrameIdx = -1;
+  statSource.clearStatisticsCache();
 
   // Reopen the file
   file.openFile(plItemNameOrFileName);
   if (!file.isOk())
     return;
+  mappedFile.openFile(plItemNameOrFileName);
 
   // Read the new statistics file header
   readHeaderFromFile();
@@ -36,6 +36,7 @@
 #include <QBasicTimer>
 #include <QFuture>
 #include "filesource/fileSource.h"
+#include "filesource/fileSourceMapped.h"
 #include "playlistItemStatisticsFile.h"
 #include "statistics/statisticHandler.h"
 
@@ -82,6 +83,9 @@ private:
   // A list of file positions where each POC/type starts
   QMap<int, QMap<int, qint64> > pocTypeStartList;
 
+  // The blocks of a POC/type are parsed directly from the memory mapped file
+  fileSourceMapped mappedFile;
+
   // --------------- background parsing ---------------
   //! Parser the whole file and get the positions where a new POC/type starts. Save this position in p_pocTypeStartList.
   //! This is performed in the background using a QFuture.
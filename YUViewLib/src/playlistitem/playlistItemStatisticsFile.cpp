@@ -35,10 +35,15 @@
 #include <cassert>
 #include <iostream>
 #include <QDebug>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QProgressDialog>
+#include <QPushButton>
 #include <QTime>
 #include <QUrl>
 
 #include "common/functions.h"
+#include "statistics/statisticsBinaryFormat.h"
 #include "statistics/statisticsExtensions.h"
 
 // The internal buffer for parsing the starting positions. The buffer must not be larger than 2GB
@@ -56,6 +61,10 @@ playlistItemStatisticsFile::playlistItemStatisticsFile(const QString &itemNameOr
   currentDrawnFrameIdx = -1;
   maxPOC = 0;
   isStatisticsLoading = false;
+  cachingEnabled = true;
+
+  // Frames that were prefetched before a statistics type was switched on have to be cached again
+  connect(&statSource, &statisticHandler::prefetchedFramesInvalid, [this](){ emit signalItemChanged(false, RECACHE_UPDATE); });
 
   // Set statistics icon
   setIcon(0, functions::convertIcon(":img_stats.png"));
@@ -125,7 +134,11 @@ void playlistItemStatisticsFile::timerEvent(QTimerEvent *event)
   // Check if the background process is still running. If it is not, no signal are required anymore.
   // The final update signal was emitted by the background process.
   if (!backgroundParserFuture.isRunning())
+  {
     timer.stop();
+    // The item can be cached now
+    emit signalItemChanged(false, RECACHE_UPDATE);
+  }
   else
   {
     setStartEndFrame(indexRange(0, maxPOC), false);
@@ -151,12 +164,61 @@ void playlistItemStatisticsFile::createPropertiesWidget()
 
   vAllLaout->addLayout(createPlaylistItemControls());
   vAllLaout->addWidget(line);
+  if (canConvertToBinaryFile())
+  {
+    QPushButton *convertButton = new QPushButton("Convert to binary statistics file...");
+    connect(convertButton, &QPushButton::clicked, this, &playlistItemStatisticsFile::onConvertToBinaryFile);
+    vAllLaout->addWidget(convertButton);
+  }
   vAllLaout->addLayout(statSource.createStatisticsHandlerControls());
 
   // Do not add any stretchers at the bottom because the statistics handler controls will
   // expand to take up as much space as there is available
 }
 
+void playlistItemStatisticsFile::onConvertToBinaryFile()
+{
+  if (backgroundParserFuture.isRunning())
+  {
+    QMessageBox::information(propertiesWidget.data(), "Convert Statistics", "The file is still being parsed. Please try again when parsing is finished.");
+    return;
+  }
+
+  QFileInfo fileInfo(file.getAbsoluteFilePath());
+  const QString defaultPath = fileInfo.dir().filePath(fileInfo.completeBaseName() + "." + statisticsBinaryFormat::fileExtension);
+  const QString filePath = QFileDialog::getSaveFileName(propertiesWidget.data(), "Convert to binary statistics file", defaultPath, QString("Binary Statistics File (*.%1)").arg(statisticsBinaryFormat::fileExtension));
+  if (filePath.isEmpty())
+    return;
+
+  statisticsBinaryFormat::writer writer;
+  if (!writer.open(filePath, statSource.getFrameSize(), getFrameRate(), statSource.getStatisticsTypeList()))
+  {
+    QMessageBox::critical(propertiesWidget.data(), "Convert Statistics", "Error opening the output file.");
+    return;
+  }
+
+  // The frames are loaded one after another using the loading function of the item and then written to the file.
+  QProgressDialog progressDialog("Converting statistics...", "Cancel", 0, maxPOC + 1, propertiesWidget.data());
+  progressDialog.setMinimumDuration(1000);
+  progressDialog.setWindowModality(Qt::WindowModal);
+  bool success = true;
+  for (int frameIdx = 0; frameIdx <= maxPOC && success; frameIdx++)
+  {
+    progressDialog.setValue(frameIdx);
+    if (progressDialog.wasCanceled())
+      break;
+    success = writer.writeFrame(frameIdx, statSource.loadAllStatistics(frameIdx));
+  }
+  const bool canceled = progressDialog.wasCanceled();
+  progressDialog.setValue(maxPOC + 1);
+
+  success = writer.close() && success;
+  if (!success || canceled)
+    QFile::remove(filePath);
+  if (!success)
+    QMessageBox::critical(propertiesWidget.data(), "Convert Statistics", "Error writing the binary statistics file.");
+}
+
 void playlistItemStatisticsFile::savePlaylist(QDomElement &root, const QDir &playlistDir) const
 {
   // Determine the relative path to the YUV file-> We save both in the playlist.
@@ -179,6 +241,23 @@ void playlistItemStatisticsFile::savePlaylist(QDomElement &root, const QDir &pla
   root.appendChild(d);
 }
 
+void playlistItemStatisticsFile::cacheFrame(int frameIdx, bool testMode)
+{
+  if (testMode)
+    // There is no conversion to test for statistics
+    return;
+  statSource.cacheStatistics(getFrameIdxInternal(frameIdx));
+}
+
+QList<int> playlistItemStatisticsFile::getCachedFrames() const
+{
+  // Convert indices from internal to external indices
+  QList<int> retList;
+  for (int i : statSource.getCachedFrames())
+    retList.append(getFrameIdxExternal(i));
+  return retList;
+}
+
 void playlistItemStatisticsFile::loadFrame(int frameIdx, bool playback, bool loadRawdata, bool emitSignals)
 {
   Q_UNUSED(playback);
@@ -74,6 +74,18 @@ public:
   // Are statistics currently being loaded?
   virtual bool isLoading() const Q_DECL_OVERRIDE { return isStatisticsLoading; }
 
+  // ----- Caching -----
+  // The statistics of the upcoming frames are prefetched by the caching threads once the file was parsed.
+  // The files can only be read by one thread at a time.
+  virtual bool isCachable() const Q_DECL_OVERRIDE { return playlistItem::isCachable() && !backgroundParserFuture.isRunning(); }
+  virtual int cachingThreadLimit() Q_DECL_OVERRIDE { return 1; }
+  virtual void cacheFrame(int frameIdx, bool testMode) Q_DECL_OVERRIDE;
+  virtual QList<int> getCachedFrames() const Q_DECL_OVERRIDE;
+  virtual int getNumberCachedFrames() const Q_DECL_OVERRIDE { return statSource.getNumberCachedFrames(); }
+  virtual unsigned int getCachingFrameSize() const Q_DECL_OVERRIDE { return statSource.getCachingFrameSize(); }
+  virtual void removeFrameFromCache(int frameIdx) Q_DECL_OVERRIDE { statSource.removeFrameFromCache(getFrameIdxInternal(frameIdx)); }
+  virtual void removeAllFramesFromCache() Q_DECL_OVERRIDE { statSource.removeAllFramesFromCache(); }
+
   // Override from playlistItem. Return the statistics values under the given pixel position.
   virtual ValuePairListSets getPixelValues(const QPoint &pixelPos, int frameIdx) Q_DECL_OVERRIDE { Q_UNUSED(frameIdx); return ValuePairListSets("Stats",statSource.getValuesAt(pixelPos)); }
 
@@ -85,6 +97,10 @@ public:
   virtual bool isSourceChanged()  Q_DECL_OVERRIDE { return file.isFileChanged(); }
   virtual void updateSettings()   Q_DECL_OVERRIDE { file.updateFileWatchSetting(); statSource.updateSettings(); }
 
+private slots:
+  // Ask for a file name and write all statistics of the file into a binary statistics file
+  void onConvertToBinaryFile();
+
 protected:
   virtual indexRange getStartEndFrameLimits() const Q_DECL_OVERRIDE { return indexRange(0, maxPOC); }
 
@@ -95,6 +111,9 @@ protected:
   // Get the tag/name which is used when saving the item to a playlist
   virtual QString getPlaylistTag() const = 0;
 
+  // Can the statistics be converted to the binary statistics format? A binary file does not need to be converted.
+  virtual bool canConvertToBinaryFile() const { return true; }
+
   // The statistics source
   statisticHandler statSource;
 
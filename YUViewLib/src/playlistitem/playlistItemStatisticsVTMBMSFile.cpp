@@ -39,12 +39,8 @@
 #include <QTime>
 
 #include "statistics/statisticsExtensions.h"
-
-// The internal buffer for parsing the starting positions. The buffer must not be larger than 2GB
-// so that we can address all the positions in it with int (using such a large buffer is not a good
-// idea anyways)
-#define STAT_PARSING_BUFFER_SIZE 1048576
-#define STAT_MAX_STRING_SIZE 1<<28
+#include "statistics/statisticsFileIndexer.h"
+#include "statistics/statisticsVTMBMSLexer.h"
 
 playlistItemStatisticsVTMBMSFile::playlistItemStatisticsVTMBMSFile(const QString &itemNameOrFileName)
   : playlistItemStatisticsFile(itemNameOrFileName)
@@ -56,6 +52,9 @@ playlistItemStatisticsVTMBMSFile::playlistItemStatisticsVTMBMSFile(const QString
   // Read the statistics file header
   readHeaderFromFile();
 
+  // The blocks of the frames are read directly from the mapped file
+  mappedFile.openFile(itemNameOrFileName);
+
   // Run the parsing of the file in the background
   cancelBackgroundParser = false;
   timer.start(1000, this);
@@ -77,110 +76,82 @@ void playlistItemStatisticsVTMBMSFile::readFramePositionsFromFile()
 {
   try
   {
-    // Open the file (again). Since this is a background process, we open the file again to
-    // not disturb any reading from not background code.
-    fileSource inputFile;
-    if (!inputFile.openFile(file.absoluteFilePath()))
+    // The file is scanned in chunks in parallel. Since this is a background process, the indexer opens
+    // the file again to not disturb any reading from not background code.
+    auto parseLine = [](const char *line, int lineLength, int &poc, int &type)
+    {
+      // ignore not matching lines
+      type = 0;
+      return statisticsVTMBMSLexer::parsePOC(line, lineLength, poc);
+    };
+    statisticsFileIndexer indexer(file.absoluteFilePath(), parseLine, cancelBackgroundParser);
+    if (!indexer.start(currentDrawnFrameIdx))
       return;
 
-    // We perform reading using an input buffer
-    QByteArray inputBuffer;
-    bool fileAtEnd = false;
-    qint64 bufferStartPos = 0;
-
-    QString lineBuffer;
-    qint64  lineBufferStartPos = 0;
-    int     lastPOC = INT_INVALID;
-    bool    sortingFixed = false; 
-    
-    while (!fileAtEnd && !cancelBackgroundParser)
+    // Add a start position as soon as it is known
+    auto addStartPosition = [this](int poc, qint64 startPos)
     {
-      // Fill the buffer
-      int bufferSize = inputFile.readBytes(inputBuffer, bufferStartPos, STAT_PARSING_BUFFER_SIZE);
-      if (bufferSize < STAT_PARSING_BUFFER_SIZE)
-        // Less bytes than the maximum buffer size were read. The file is at the end.
-        // This is the last run of the loop.
-        fileAtEnd = true;
-      // a corrupted file may contain an arbitrary amount of non-\n symbols
-      // prevent lineBuffer overflow by dumping it for such cases
-      if (lineBuffer.size() > STAT_MAX_STRING_SIZE)
-        lineBuffer.clear(); // prevent an overflow here
-      for (int i = 0; i < bufferSize; i++)
+      pocStartList[poc] = startPos;
+      if (poc == currentDrawnFrameIdx)
+        // We added a start position for the frame index that is currently drawn. We might have to redraw.
+        emit signalItemChanged(true, RECACHE_NONE);
+
+      // update number of frames
+      if (poc > maxPOC)
+        maxPOC = poc;
+    };
+
+    // The runs of the chunks are merged in file order. Only then we know where a run really starts.
+    int lastPOC = INT_INVALID;
+    auto mergeRun = [&](const statisticsFileIndexer::run &r)
+    {
+      if (lastPOC == -1 || r.poc != lastPOC)
       {
-        // Search for '\n' newline characters
-        if (inputBuffer.at(i) == 10)
-        {
-          // We found a newline character
-          if (lineBuffer.size() > 0)
-          {
-            // Parse the previous line
-            // get components of this line
-            // get poc using regular expression
-            // need to match this:
-            // BlockStat: POC 1 @( 120,  80) [ 8x 8] MVL0={ -24,  -2}
-            // BlockStat: POC 1 @( 112,  88) [ 8x 8] PredMode=0
-            QRegularExpression pocRegex("BlockStat: POC ([0-9]+)");
-
-            QRegularExpressionMatch match = pocRegex.match(lineBuffer);
-            // ignore not matching lines
-            if (match.hasMatch())
-            {
-              int poc = match.captured(1).toInt();
-
-              if (lastPOC == -1)
-              {
-                // First POC
-                pocStartList[poc] = lineBufferStartPos;
-                if (poc == currentDrawnFrameIdx)
-                  // We added a start position for the frame index that is currently drawn. We might have to redraw.
-                  emit signalItemChanged(true, RECACHE_NONE);
-
-                lastPOC = poc;
-
-                // update number of frames
-                if (poc > maxPOC)
-                  maxPOC = poc;
-              }
-              else if (poc != lastPOC)
-              {
-                // this is apparently not sorted by POCs and we will not check it further
-                if(!sortingFixed)
-                  sortingFixed = true;
-
-                lastPOC = poc;                
-                pocStartList[poc] = lineBufferStartPos;
-                if (poc == currentDrawnFrameIdx)
-                  // We added a start position for the frame index that is currently drawn. We might have to redraw.
-                  emit signalItemChanged(true, RECACHE_NONE);
-
-                // update number of frames
-                if (poc > maxPOC)
-                  maxPOC = poc;
-
-                // Update percent of file parsed
-                backgroundParserProgress = ((double)lineBufferStartPos * 100 / (double)inputFile.getFileSize());
-              }
-            }
-          }
+        lastPOC = r.poc;
+        addStartPosition(r.poc, r.startPos);
+      }
+    };
 
-          lineBuffer.clear();
-          lineBufferStartPos = bufferStartPos + i + 1;
-        }
-        else
-        {
-          // No newline character found
-          lineBuffer.append(inputBuffer.at(i));
-        }
+    // A chunk that is scanned before all chunks before it were merged (e.g. the chunk with the currently drawn frame)
+    // is added right away. Only the first POC of the chunk may have started in the previous chunk.
+    auto addPreliminaryStartPositions = [&](const statisticsFileIndexer::chunk &c)
+    {
+      for (int i = 1; i < c.runs.size(); i++)
+        if (!pocStartList.contains(c.runs[i].poc))
+          addStartPosition(c.runs[i].poc, c.runs[i].startPos);
+    };
+
+    QVector<bool> chunkScanned(indexer.getNrChunks(), false);
+    int nextChunkToMerge = 0;
+    int64_t nrBytesScanned = 0;
+    int chunkIdx;
+    while ((chunkIdx = indexer.waitForNextChunk()) != -1)
+    {
+      const auto &c = indexer.getChunk(chunkIdx);
+      chunkScanned[chunkIdx] = true;
+      if (chunkIdx != nextChunkToMerge)
+        addPreliminaryStartPositions(c);
+      while (nextChunkToMerge < indexer.getNrChunks() && chunkScanned[nextChunkToMerge])
+      {
+        for (const auto &r : indexer.getChunk(nextChunkToMerge).runs)
+          mergeRun(r);
+        nextChunkToMerge++;
       }
 
-      bufferStartPos += bufferSize;
+      // Update percent of file parsed
+      nrBytesScanned += c.endPos - c.startPos;
+      backgroundParserProgress = ((double)nrBytesScanned * 100 / (double)indexer.getFileSize());
     }
+    if (cancelBackgroundParser)
+      return;
 
     // Parsing complete
     backgroundParserProgress = 100.0;
 
     setStartEndFrame(indexRange(0, maxPOC), false);
-    emit signalItemChanged(false, RECACHE_NONE);
+    // Frames that were loaded before their positions were known are empty. Load them again.
+    statSource.clearStatisticsCache();
+    emit signalItemChanged(true, RECACHE_NONE);
 
   } // try
   catch (const char *str)
@@ -364,11 +335,9 @@ void playlistItemStatisticsVTMBMSFile::loadStatisticToCache(int frameIdxInternal
 {
   try
   {
-    if (!file.isOk())
+    if (!mappedFile.isOk())
       return;
 
-    QTextStream in(file.getQFile());
-
     if (!pocStartList.contains(frameIdxInternal))
     {
       // There are no statistics in the file for the given frame and index.
@@ -376,197 +345,115 @@ void playlistItemStatisticsVTMBMSFile::loadStatisticToCache(int frameIdxInternal
       return;
     }
 
-
-    qint64 startPos = pocStartList[frameIdxInternal];
-
-    // fast forward
-    in.seek(startPos);
-
-    QRegularExpression pocRegex("BlockStat: POC ([0-9]+)");
-
-    // prepare regex for selected type
-    StatisticsType *aType = statSource.getStatisticsType(typeID);
-    Q_ASSERT_X(aType != nullptr, "StatisticsObject::readStatisticsFromFile", "Stat type not found.");
-    QRegularExpression typeRegex(" " + aType->typeName + "="); // for catching lines of the type
-
-    // for extracting scalar value statistics, need to match:
-    // BlockStat: POC 1 @( 112,  88) [ 8x 8] PredMode=0
-    QRegularExpression scalarRegex("POC ([0-9]+) @\\( *([0-9]+), *([0-9]+)\\) *\\[ *([0-9]+)x *([0-9]+)\\] *\\w+=([0-9\\-]+)");
-    // for extracting vector value statistics, need to match:
-    // BlockStat: POC 1 @( 120,  80) [ 8x 8] MVL0={ -24,  -2}
-    QRegularExpression vectorRegex("POC ([0-9]+) @\\( *([0-9]+), *([0-9]+)\\) *\\[ *([0-9]+)x *([0-9]+)\\] *\\w+={ *([0-9\\-]+), *([0-9\\-]+)}");
-    // for extracting affine transform value statistics, need to match:
-    // BlockStat: POC 2 @( 192,  96) [64x32] AffineMVL0={-324,-116,-276,-116,-324, -92}
-    QRegularExpression affineTFRegex("POC ([0-9]+) @\\( *([0-9]+), *([0-9]+)\\) *\\[ *([0-9]+)x *([0-9]+)\\] *\\w+={ *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+)}");
-    // for extracting scalar polygon  statistics, need to match:
-    // BlockStat: POC 2 @[(505, 384)--(511, 384)--(511, 415)--] GeoPUInterIntraFlag=0
-    // BlockStat: POC 2 @[(416, 448)--(447, 448)--(447, 478)--(416, 463)--] GeoPUInterIntraFlag=0
-    // will capture 3-5 points. other polygons are not supported
-    QRegularExpression scalarPolygonRegex("POC ([0-9]+) @\\[((?:\\( *[0-9]+, *[0-9]+\\)--){3,5})\\] *\\w+=([0-9\\-]+)");
-    // for extracting vector polygon statistics:
-    QRegularExpression vectorPolygonRegex("POC ([0-9]+) @\\[((?:\\( *[0-9]+, *[0-9]+\\)--){3,5})\\] *\\w+={ *([0-9\\-]+), *([0-9\\-]+)}");
-    // for extracting the partitioning line, we extract
-    // BlockStat: POC 2 @( 192,  96) [64x32] Line={0,0,31,31}
-    QRegularExpression lineRegex("POC ([0-9]+) @\\( *([0-9]+), *([0-9]+)\\) *\\[ *([0-9]+)x *([0-9]+)\\] *\\w+={ *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+)}");
-
-    while (!in.atEnd())
+    // All types that are rendered and not loaded yet are loaded in one pass over the lines of the POC.
+    // The loading of the other types will then find them in the cache. This runs in the caching threads so the
+    // types are read from the copy for the loading threads.
+    const StatisticsTypeList types = statSource.getLoadingStatisticsTypeList();
+    QHash<QByteArray, const StatisticsType*> typesToLoad;
+    for (const StatisticsType &t : types)
+      if (t.typeID == typeID || (t.render && !statSource.statsCache.contains(t.typeID)))
+        typesToLoad.insert(t.typeName.toLatin1(), &t);
+    Q_ASSERT_X(!typesToLoad.isEmpty(), "StatisticsObject::readStatisticsFromFile", "Stat type not found.");
+
+    int64_t linePos = pocStartList[frameIdxInternal];
+    const char *line;
+    int lineLength;
+    statisticsVTMBMSLexer::blockStat stat;
+
+    while (mappedFile.readLine(linePos, line, lineLength))
     {
-      // read one line
-      QString aLine = in.readLine();
+      int poc;
+      // ignore not matching lines
+      if (!statisticsVTMBMSLexer::parsePOC(line, lineLength, poc))
+        continue;
+      if (poc != frameIdxInternal)
+        break;
 
+      if (!statisticsVTMBMSLexer::parseLine(line, lineLength, stat))
+      {
+        // Only lines of the types that are loaded are errors
+        const char *name;
+        int nameLength;
+        if (statisticsVTMBMSLexer::parseName(line, lineLength, name, nameLength) && typesToLoad.contains(QByteArray::fromRawData(name, nameLength)))
+          parsingError = QString("Error while parsing statistic: ") + QString::fromLatin1(line, lineLength);
+        continue;
+      }
 
-      QRegularExpressionMatch pocMatch = pocRegex.match(aLine);
-      // ignore not matching lines
-      if (pocMatch.hasMatch())
+      // filter lines of different types
+      auto typeIt = typesToLoad.constFind(QByteArray::fromRawData(stat.name, stat.nameLength));
+      if (typeIt == typesToLoad.constEnd())
+        continue;
+      const StatisticsType *aType = typeIt.value();
+      statisticsData &data = statSource.statsCache[aType->typeID];
+
+      // The form of the values must match the type
+      bool formMatches = false;
+      if (!aType->isPolygon && !stat.isPolygon)
       {
-        int poc = pocMatch.captured(1).toInt();
-        if (poc != frameIdxInternal)
+        // Check if block is within the image range
+        if (blockOutsideOfFrame_idx == -1 && (stat.posX + stat.width > statSource.getFrameSize().width() || stat.posY + stat.height > statSource.getFrameSize().height()))
+          // Block not in image. Warn about this.
+          blockOutsideOfFrame_idx = frameIdxInternal;
+
+        if (aType->hasValueData)
         {
-          break;
+          formMatches = !stat.isList;
+          if (formMatches)
+            data.addBlockValue(stat.posX, stat.posY, stat.width, stat.height, stat.values[0]);
         }
-
-        // filter lines of different types
-        QRegularExpressionMatch typeMatch = typeRegex.match(aLine);
-        if (typeMatch.hasMatch())
+        else if (aType->hasVectorData)
         {
-          int poc, posX, posY, width, height, scalar, vecX, vecY;
-
-          QRegularExpressionMatch statisitcMatch;
-          // extract statistics info
-          // try block types
-          if (aType->isPolygon == false)
-          {
-            if (aType->hasValueData)
-            {
-              statisitcMatch = scalarRegex.match(aLine);
-            }
-            else if (aType->hasVectorData)
-            {
-              statisitcMatch = vectorRegex.match(aLine);
-              if (!statisitcMatch.hasMatch())
-              {
-                statisitcMatch = lineRegex.match(aLine);
-              }
-            }
-            else if (aType->hasAffineTFData)
-            {
-              statisitcMatch = affineTFRegex.match(aLine);
-            }
-          }
-          else
-          // try polygons
-          {
-            if (aType->hasValueData)
-            {
-              statisitcMatch = scalarPolygonRegex.match(aLine);
-            }
-            else if (aType->hasVectorData)
-            {
-              statisitcMatch = vectorPolygonRegex.match(aLine);
-            }
-          }
-          if (!statisitcMatch.hasMatch())
-          {
-            parsingError = QString("Error while parsing statistic: ") + QString(aLine);
-            continue;
-          }
-
-          // useful for debugging:
-  //        QStringList all_captured = statisitcMatch.capturedTexts();
+          formMatches = stat.isList && (stat.nrValues == 2 || stat.nrValues == 4);
+          if (formMatches && stat.nrValues == 4)
+            data.addLine(stat.posX, stat.posY, stat.width, stat.height, stat.values[0], stat.values[1], stat.values[2], stat.values[3]);
+          else if (formMatches)
+            data.addBlockVector(stat.posX, stat.posY, stat.width, stat.height, stat.values[0], stat.values[1]);
+        }
+        else if (aType->hasAffineTFData)
+        {
+          formMatches = stat.isList && stat.nrValues == 6;
+          if (formMatches)
+            data.addBlockAffineTF(stat.posX, stat.posY, stat.width, stat.height, stat.values[0], stat.values[1], stat.values[2], stat.values[3], stat.values[4], stat.values[5]);
+        }
+      }
+      else if (aType->isPolygon && stat.isPolygon)
+      {
+        QVector<QPoint> points;
+        points.reserve(stat.nrPolygonPoints);
+        for (int i = 0; i < stat.nrPolygonPoints; i++)
+        {
+          const QPoint &p = stat.polygonPoints[i];
+          points << p;
 
-          poc = statisitcMatch.captured(1).toInt();
-          width = statisitcMatch.captured(4).toInt();
-          height = statisitcMatch.captured(5).toInt();
-          // if there is a new POC, we are done here!
-          if (poc != frameIdxInternal)
-            break;
+          // Check if polygon is within the image range
+          if (blockOutsideOfFrame_idx == -1 && (p.x() > statSource.getFrameSize().width() || p.y() > statSource.getFrameSize().height()))
+            // Block not in image. Warn about this.
+            blockOutsideOfFrame_idx = frameIdxInternal;
+        }
 
-          // process block statistics
-          if (aType->isPolygon == false)
-          {
-            posX = statisitcMatch.captured(2).toInt();
-            posY = statisitcMatch.captured(3).toInt();
-
-            // Check if block is within the image range
-            if (blockOutsideOfFrame_idx == -1 && (posX + width > statSource.getFrameSize().width() || posY + height > statSource.getFrameSize().height()))
-              // Block not in image. Warn about this.
-              blockOutsideOfFrame_idx = frameIdxInternal;
-
-            if (aType->hasVectorData)
-            {
-              vecX = statisitcMatch.captured(6).toInt();
-              vecY = statisitcMatch.captured(7).toInt();
-              if (statisitcMatch.lastCapturedIndex()>7)
-              {
-                int vecX1 = statisitcMatch.captured(8).toInt();
-                int vecY1 = statisitcMatch.captured(9).toInt();
-                statSource.statsCache[typeID].addLine(posX, posY, width, height, vecX, vecY,vecX1,vecY1);
-              }
-              else
-              {
-                statSource.statsCache[typeID].addBlockVector(posX, posY, width, height, vecX, vecY);
-              }
-            }
-            else if (aType->hasAffineTFData)
-            {
-              int vecX0 = statisitcMatch.captured(6).toInt();
-              int vecY0 = statisitcMatch.captured(7).toInt();
-              int vecX1 = statisitcMatch.captured(8).toInt();
-              int vecY1 = statisitcMatch.captured(9).toInt();
-              int vecX2 = statisitcMatch.captured(10).toInt();
-              int vecY2 = statisitcMatch.captured(11).toInt();
-              statSource.statsCache[typeID].addBlockAffineTF(posX, posY, width, height, vecX0, vecY0, vecX1, vecY1, vecX2, vecY2);
-            }
-            else
-            {
-              scalar = statisitcMatch.captured(6).toInt();
-              statSource.statsCache[typeID].addBlockValue(posX, posY, width, height, scalar);
-            }
-          }
-          else
-          // process polygon statistics
-          {
-            QString corners = statisitcMatch.captured(2);
-            QStringList cornerList = corners.split("--");
-            QRegularExpression cornerRegex("\\( *([0-9]+), *([0-9]+)\\)");
-            QVector<QPoint> points;
-            for (const auto &corner : cornerList)
-            {
-              QRegularExpressionMatch cornerMatch = cornerRegex.match(corner);
-              if( cornerMatch.hasMatch())
-              {
-                int x = cornerMatch.captured(1).toInt();
-                int y = cornerMatch.captured(2).toInt();
-                points << QPoint(x,y);
-
-                // Check if polygon is within the image range
-                if (blockOutsideOfFrame_idx == -1 && (x + width > statSource.getFrameSize().width() || y + height > statSource.getFrameSize().height()))
-                  // Block not in image. Warn about this.
-                  blockOutsideOfFrame_idx = frameIdxInternal;
-              }
-            }
-
-            if (aType->hasVectorData)
-            {
-              vecX = statisitcMatch.captured(3).toInt();
-              vecY = statisitcMatch.captured(4).toInt();
-              statSource.statsCache[typeID].addPolygonVector(points, vecX, vecY);
-            }
-            else if(aType->hasValueData)
-            {
-              scalar = statisitcMatch.captured(3).toInt();
-              statSource.statsCache[typeID].addPolygonValue(points, scalar);
-            }
-          }
+        if (aType->hasVectorData)
+        {
+          formMatches = stat.isList && stat.nrValues == 2;
+          if (formMatches)
+            data.addPolygonVector(points, stat.values[0], stat.values[1]);
+        }
+        else if (aType->hasValueData)
+        {
+          formMatches = !stat.isList;
+          if (formMatches)
+            data.addPolygonValue(points, stat.values[0]);
         }
       }
+
+      if (!formMatches)
+        parsingError = QString("Error while parsing statistic: ") + QString::fromLatin1(line, lineLength);
     }
 
-    if(!statSource.statsCache.contains(typeID))
+    for (const StatisticsType *aType : typesToLoad)
     {
-      // There are no statistics in the file for the given frame and index.
-      statSource.statsCache.insert(typeID, statisticsData());
-      return;
+      if(!statSource.statsCache.contains(aType->typeID))
+        // There are no statistics in the file for the given frame and index.
+        statSource.statsCache.insert(aType->typeID, statisticsData());
     }
 
   } // try
@@ -635,13 +522,13 @@ void playlistItemStatisticsVTMBMSFile::reloadItemSource()
 
   // Clear the parsed data
   pocStartList.clear();
-  statSource.statsCache.clear();
-  statSource.statsCacheFrameIdx = -1;
+  statSource.clearStatisticsCache();
 
   // Reopen the file
   file.openFile(plItemNameOrFileName);
   if (!file.isOk())
     return;
+  mappedFile.openFile(plItemNameOrFileName);
 
   // Read the new statistics file header
   readHeaderFromFile();
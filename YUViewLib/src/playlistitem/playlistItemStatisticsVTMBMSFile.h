@@ -38,6 +38,7 @@
 #include <QRegularExpression>
 
 #include "filesource/fileSource.h"
+#include "filesource/fileSourceMapped.h"
 #include "playlistItemStatisticsFile.h"
 #include "statistics/statisticHandler.h"
 
@@ -69,8 +70,7 @@ public:
   virtual void reloadItemSource() Q_DECL_OVERRIDE;
 public slots:
   //! Load the statistics with frameIdx/type from file and put it into the cache.
-  //! If the statistics file is in an interleaved format (types are mixed within one POC) this function also parses
-  //! types which were not requested by the given 'type'.
+  //! All other types that are rendered and not in the cache yet are loaded in the same pass over the file.
   void loadStatisticToCache(int frameIdxInternal, int type);
 
 private:
@@ -83,6 +83,9 @@ private:
   // A list of file positions where each POC starts
   QMap<int, qint64> pocStartList;
 
+  // The blocks of a POC are parsed directly from the memory mapped file
+  fileSourceMapped mappedFile;
+
   // --------------- background parsing ---------------
   //! Parser the whole file and get the positions where a new POC/type starts. Save this position in p_pocTypeStartList.
   //! This is performed in the background using a QFuture.
@@ -91,9 +91,9 @@ void playlistItemWithVideo::loadFrame(int frameIdx, bool playing, bool loadRawDa
   
   if (playing && (state == LoadingNeeded || state == LoadingNeededDoubleBuffer))
   {
-    // Load the next frame into the double buffer
-    int nextFrameIdx = frameIdxInternal + 1;
-    if (nextFrameIdx <= startEndFrame.second)
+    // Load the next frame (the previous one when playing backwards) into the double buffer
+    int nextFrameIdx = frameIdxInternal + videoHandler::getPlaybackStep();
+    if (nextFrameIdx >= startEndFrame.first && nextFrameIdx <= startEndFrame.second)
     {
       DEBUG_PLVIDEO("playlistItemWithVideo::loadFrame loading frame into double buffer %d%s%s", nextFrameIdx, playing ? " playing" : "", loadRawData ? " raw" : "");
       isFrameLoadingDoubleBuffer = true;
@@ -37,6 +37,7 @@
 #include "playlistItemDifference.h"
 #include "playlistItemStatisticsCSVFile.h"
 #include "playlistItemStatisticsVTMBMSFile.h"
+#include "playlistItemStatisticsBinaryFile.h"
 #include "playlistItemImageFile.h"
 #include "playlistItemImageFileSequence.h"
 #include "playlistItemOverlay.h"
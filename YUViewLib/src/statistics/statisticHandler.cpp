@@ -33,7 +33,9 @@
 #include "statisticHandler.h"
 
 #include <cmath>
+#include <QFontDatabase>
 #include <QPainter>
+#include <QtConcurrent>
 #include <QtMath>
 
 #include "common/functions.h"
@@ -57,43 +59,44 @@ QPoint getPolygonCenter(const QPolygon& polygon)
   return p;
 }
 
-statisticHandler::statisticHandler()
+// Copy the types one by one. Copying the list only shares its buffer which is detached when statsTypeList is changed.
+// The style control changes the types through a pointer into that buffer so it must never be shared with other threads.
+StatisticsTypeList copyStatisticsTypeList(const StatisticsTypeList &types)
 {
-  statsCacheFrameIdx = -1;
+  StatisticsTypeList copy;
+  copy.reserve(types.size());
+  for (const StatisticsType &t : types)
+    copy.append(t);
+  return copy;
+}
 
+statisticHandler::statisticHandler()
+{
   spacerItems[0] = nullptr;
   spacerItems[1] = nullptr;
   connect(&statisticsStyleUI, &StatisticsStyleControl::StyleChanged, this, &statisticHandler::updateStatisticItem, Qt::QueuedConnection);
+  connect(&layerWatcher, &QFutureWatcher<QImage>::finished, this, &statisticHandler::onLayerRasterized);
 }
 
-itemLoadingState statisticHandler::needsLoading(int frameIdx)
+statisticHandler::~statisticHandler()
 {
-  if (frameIdx != statsCacheFrameIdx)
-  {
-    // New frame, but do we even render any statistics?
-    for (StatisticsType t : statsTypeList)
-      if(t.render)
-      {
-        // At least one statistic type is drawn. We need to load it.
-        DEBUG_STAT("statisticHandler::needsLoading %d LoadingNeeded", frameIdx);
-        return LoadingNeeded;
-      }
-  }
+  layerWatcher.waitForFinished();
+}
 
+itemLoadingState statisticHandler::needsLoading(int frameIdx)
+{
   QMutexLocker lock(&statsCacheAccessMutex);
+  auto frame = frameCache.constFind(frameIdx);
+
   // Check all the statistics. Do some need loading?
   for (int i = statsTypeList.count() - 1; i >= 0; i--)
   {
     // If the statistics for this frame index were not loaded yet but will be rendered, load them now.
-    int typeIdx = statsTypeList[i].typeID;
-    if (statsTypeList[i].render)
+    if (statsTypeList[i].render && (frame == frameCache.constEnd() || !frame->data.contains(statsTypeList[i].typeID)))
     {
-      if (!statsCache.contains(typeIdx))
-      {
-        // Return that loading is needed before we can render the statitics.
-        DEBUG_STAT("statisticHandler::needsLoading %d LoadingNeeded", frameIdx);
-        return LoadingNeeded;
-      }
+      // Return that loading is needed before we can render the statitics.
+      DEBUG_STAT("statisticHandler::needsLoading %d LoadingNeeded", frameIdx);
+      return LoadingNeeded;
     }
   }
 
@@ -105,41 +108,161 @@ itemLoadingState statisticHandler::needsLoading(int frameIdx)
 void statisticHandler::loadStatistics(int frameIdx)
 {
   DEBUG_STAT("statisticHandler::loadStatistics frame %d", frameIdx);
+  loadFrameToCache(frameIdx, false);
+  invalidateLayers();
+}
 
-  QMutexLocker lock(&statsCacheAccessMutex);
-  if (frameIdx != statsCacheFrameIdx)
-    // New frame to draw. Clear the cache.
-    statsCache.clear();
+void statisticHandler::cacheStatistics(int frameIdx)
+{
+  DEBUG_STAT("statisticHandler::cacheStatistics frame %d", frameIdx);
+  loadFrameToCache(frameIdx, true);
+}
 
-  // Request all the data for the statistics (that were not already loaded to the local cache)
-  int statTypeRenderCount = 0;
-  for (int i = statsTypeList.count() - 1; i >= 0; i--)
+void statisticHandler::loadFrameToCache(int frameIdx, bool prefetch)
+{
+  QMutexLocker loadingLock(&statsLoadingMutex);
+
+  // Start with the types that are already cached for the frame
+  statsCache = getCachedStatistics(frameIdx);
+
+  // Request all the data for the statistics (that were not already loaded to the local cache). This may run in a
+  // caching thread so the types are read from the copy for the loading threads.
+  const StatisticsTypeList types = getLoadingStatisticsTypeList();
+  for (int i = types.count() - 1; i >= 0; i--)
   {
     // If the statistics for this frame index were not loaded yet but will be rendered, load them now.
-    int typeIdx = statsTypeList[i].typeID;
-    if (statsTypeList[i].render)
-    {
-      statTypeRenderCount++;
-      if (!statsCache.contains(typeIdx))
-        // Load the statistics
-        emit requestStatisticsLoading(frameIdx, typeIdx);
-    }
+    int typeIdx = types[i].typeID;
+    if (types[i].render && !statsCache.contains(typeIdx))
+      // Load the statistics
+      emit requestStatisticsLoading(frameIdx, typeIdx);
+  }
+
+  // Build the spatial indices of the statistics that were just loaded
+  qint64 memorySize = 0;
+  for (auto it = statsCache.begin(); it != statsCache.end(); it++)
+  {
+    it->buildIndex();
+    memorySize += it->getMemorySize();
+  }
+
+  QMutexLocker lock(&statsCacheAccessMutex);
+  cachedFrame &frame = frameCache[frameIdx];
+  frameCacheMemorySize += memorySize - frame.memorySize;
+  frame.data = statsCache;
+  frame.memorySize = memorySize;
+  statsCache.clear();
+
+  if (prefetch)
+    frame.prefetched = true;
+  else
+  {
+    recentFrames.removeOne(frameIdx);
+    recentFrames.prepend(frameIdx);
+    while (recentFrames.size() > STATISTICS_MAX_RECENT_FRAMES)
+      removeUnusedFrame(recentFrames.takeLast());
+  }
+}
+
+void statisticHandler::removeUnusedFrame(int frameIdx)
+{
+  auto frame = frameCache.find(frameIdx);
+  if (frame == frameCache.end() || frame->prefetched || recentFrames.contains(frameIdx))
+    return;
+  frameCacheMemorySize -= frame->memorySize;
+  frameCache.erase(frame);
+}
+
+QHash<int, statisticsData> statisticHandler::getCachedStatistics(int frameIdx) const
+{
+  QMutexLocker lock(&statsCacheAccessMutex);
+  return frameCache.value(frameIdx).data;
+}
+
+QList<int> statisticHandler::getCachedFrames() const
+{
+  QMutexLocker lock(&statsCacheAccessMutex);
+  return frameCache.keys();
+}
+
+int statisticHandler::getNumberCachedFrames() const
+{
+  QMutexLocker lock(&statsCacheAccessMutex);
+  return frameCache.size();
+}
+
+unsigned int statisticHandler::getCachingFrameSize() const
+{
+  QMutexLocker lock(&statsCacheAccessMutex);
+  if (!frameCache.isEmpty())
+    return unsigned(qBound(qint64(1), frameCacheMemorySize / frameCache.size(), qint64(UINT_MAX)));
+
+  // Nothing was loaded yet. Assume one value for every 8x8 block for each rendered type.
+  int nrRenderedTypes = 0;
+  for (const StatisticsType &t : loadingTypeList)
+    if (t.render)
+      nrRenderedTypes++;
+  const qint64 bytesPerBlock = 4 * sizeof(unsigned short) + sizeof(int);
+  const qint64 nrBlocks = qint64(statFrameSize.width()) * statFrameSize.height() / 64;
+  return unsigned(qBound(qint64(1), nrBlocks * bytesPerBlock * nrRenderedTypes, qint64(UINT_MAX)));
+}
+
+void statisticHandler::removeFrameFromCache(int frameIdx)
+{
+  QMutexLocker lock(&statsCacheAccessMutex);
+  auto frame = frameCache.find(frameIdx);
+  if (frame == frameCache.end())
+    return;
+  frame->prefetched = false;
+  removeUnusedFrame(frameIdx);
+}
+
+void statisticHandler::removeAllFramesFromCache()
+{
+  QMutexLocker lock(&statsCacheAccessMutex);
+  for (int frameIdx : frameCache.keys())
+  {
+    frameCache[frameIdx].prefetched = false;
+    removeUnusedFrame(frameIdx);
   }
+}
 
-  statsCacheFrameIdx = frameIdx;
+void statisticHandler::invalidatePrefetchedFrames()
+{
+  removeAllFramesFromCache();
+  emit prefetchedFramesInvalid();
+}
+
+void statisticHandler::clearStatisticsCache()
+{
+  QMutexLocker lock(&statsCacheAccessMutex);
+  frameCache.clear();
+  frameCacheMemorySize = 0;
+  recentFrames.clear();
+  invalidateLayers();
+}
+
+QHash<int, statisticsData> statisticHandler::loadAllStatistics(int frameIdx)
+{
+  QMutexLocker loadingLock(&statsLoadingMutex);
+  statsCache.clear();
+  for (const StatisticsType &t : getLoadingStatisticsTypeList())
+    if (!statsCache.contains(t.typeID))
+      emit requestStatisticsLoading(frameIdx, t.typeID);
+
+  QHash<int, statisticsData> allStatistics;
+  allStatistics.swap(statsCache);
+  return allStatistics;
 }
 
 void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double zoomFactor)
 {
-  if (statsCacheFrameIdx != frameIdx)
-    // If the internal statistics cache is not up to date, do not display the statistics.
+  const QHash<int, statisticsData> statistics = getCachedStatistics(frameIdx);
+  drawnFrameIdx = frameIdx;
+  if (statistics.isEmpty())
+    // If the statistics of the frame are not cached, do not display the statistics.
     // The statistics for the new frame index should be loading the background.
     return;
 
-  // Save the state of the painter. This is restored when the function is done.
-  painter->save();
-  painter->setRenderHint(QPainter::Antialiasing,true);
-
   QRect statRect;
   statRect.setSize(statFrameSize * zoomFactor);
   statRect.moveCenter(QPoint(0,0));
@@ -151,13 +274,121 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
   int yMin = statRect.height() / 2 - worldTransform.dy();
   int xMax = statRect.width() / 2 - (worldTransform.dx() - viewport.width());
   int yMax = statRect.height() / 2 - (worldTransform.dy() - viewport.height());
+  const QRect visibleRect = QRect(QPoint(xMin, yMin), QPoint(xMax, yMax));
+  if (visibleRect.isEmpty())
+    return;
 
+  // Save the state of the painter. This is restored when the function is done.
+  painter->save();
   painter->translate(statRect.topLeft());
 
+  // If the layer for this frame, zoom factor, visible area and style was already rasterized, only draw the image.
+  const statisticsLayerKey key = {frameIdx, zoomFactor, visibleRect, painter->device()->devicePixelRatioF(), unsigned(layerRevision.load())};
+  bool layerFound = false;
+  for (const statisticsLayer &layer : layers)
+  {
+    if (layer.key == key)
+    {
+      painter->drawImage(visibleRect.topLeft(), layer.image);
+      layerFound = true;
+      break;
+    }
+  }
+
+  if (!layerFound)
+  {
+    // Is there a layer of the same frame and style (at another zoom factor or position)?
+    const statisticsLayer *previousLayer = nullptr;
+    for (const statisticsLayer &layer : layers)
+    {
+      if (layer.key.frameIdx == key.frameIdx && layer.key.revision == key.revision && layer.key.devicePixelRatio == key.devicePixelRatio)
+      {
+        previousLayer = &layer;
+        break;
+      }
+    }
+
+    // Text can only be rendered in a thread if the platform supports it.
+    if (previousLayer != nullptr && QFontDatabase::supportsThreadedFontRendering())
+    {
+      // Rasterize the layer in the background (e.g. while zooming or panning). Until it is done, the previous layer
+      // is drawn scaled to the current zoom factor. If another layer is being rasterized, this one is requested
+      // again by the repaint when that one is done.
+      if (!layerWatcher.isRunning())
+      {
+        pendingLayerKey = key;
+        // The style control changes the types through a pointer. So the worker gets a deep copy of the types.
+        const StatisticsTypeList types = copyStatisticsTypeList(statsTypeList);
+        layerWatcher.setFuture(QtConcurrent::run(this, &statisticHandler::rasterizeLayer, key, statistics, types, painter->font(), painter->pen()));
+      }
+      const double scale = zoomFactor / previousLayer->key.zoomFactor;
+      const QRectF previousRect(QPointF(previousLayer->key.visibleRect.topLeft()) * scale, QSizeF(previousLayer->key.visibleRect.size()) * scale);
+      painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+      painter->drawImage(previousRect, previousLayer->image);
+    }
+    else
+    {
+      // Rasterize the layer right away. This costs as much as drawing the statistics directly and the following
+      // repaints (e.g. because the mouse moved) only draw the image.
+      const QImage image = rasterizeLayer(key, statistics, statsTypeList, painter->font(), painter->pen());
+      painter->drawImage(visibleRect.topLeft(), image);
+      addLayer({key, image});
+    }
+  }
+
+  // Restore the state the state of the painter from before this function was called.
+  // This will reset the set pens and the translation.
+  painter->restore();
+}
+
+QImage statisticHandler::rasterizeLayer(statisticsLayerKey key, QHash<int, statisticsData> statistics, StatisticsTypeList types, QFont font, QPen pen)
+{
+  QImage image(key.visibleRect.size() * key.devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+  image.setDevicePixelRatio(key.devicePixelRatio);
+  image.fill(Qt::transparent);
+  QPainter painter(&image);
+  painter.setRenderHint(QPainter::Antialiasing,true);
+  painter.setFont(font);
+  painter.setPen(pen);
+  painter.translate(-key.visibleRect.topLeft());
+  paintStatisticsData(&painter, statistics, types, key.zoomFactor, key.visibleRect);
+  return image;
+}
+
+void statisticHandler::onLayerRasterized()
+{
+  // If the statistics or their style changed in the meantime, the layer is dropped. Either way, the repaint
+  // draws the layer or requests the layer that is needed now.
+  const QImage image = layerWatcher.result();
+  if (pendingLayerKey.revision == unsigned(layerRevision.load()))
+    addLayer({pendingLayerKey, image});
+  emit updateItem(true);
+}
+
+void statisticHandler::addLayer(const statisticsLayer &layer)
+{
+  // Only keep a few layers. The same statistics may be shown in two views side by side.
+  layers.prepend(layer);
+  while (layers.size() > STATISTICS_MAX_CACHED_LAYERS)
+    layers.removeLast();
+}
+
+void statisticHandler::paintStatisticsData(QPainter *painter, const QHash<int, statisticsData> &statistics, const StatisticsTypeList &types, double zoomFactor, const QRect &visibleRect)
+{
+  const int xMin = visibleRect.left();
+  const int yMin = visibleRect.top();
+  const int xMax = visibleRect.right();
+  const int yMax = visibleRect.bottom();
+
+  // The visible area in (not zoomed) statistics coordinates. Only the blocks in this area are read from the spatial index.
+  const QRect statVisibleRect = QRect(QPoint(int(std::floor(xMin / zoomFactor)) - 1, int(std::floor(yMin / zoomFactor)) - 1),
+                                      QPoint(int(std::ceil(xMax / zoomFactor)) + 1, int(std::ceil(yMax / zoomFactor)) + 1));
+  QVector<int> visibleItems;
+
   // First, get if more than one statistic that has block values is rendered.
   bool moreThanOneBlockStatRendered = false;
   bool oneBlockStatRendered = false;
-  for (StatisticsType t : statsTypeList)
+  for (const StatisticsType &t : types)
   {
     if(t.render && t.hasValueData)
     {
@@ -171,52 +402,62 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
     }
   }
 
-  // Lock the statsCache mutex so that nothing is changed while we draw the data
-  QMutexLocker lock(&statsCacheAccessMutex);
-
   // Draw all the block types. Also, if the zoom factor is larger than STATISTICS_DRAW_VALUES_ZOOM,
   // also save a list of all the values of the blocks and their position in order to draw the values in the next step.
   QList<QPoint> drawStatPoints;       // The positions of each value
   QList<QStringList> drawStatTexts;   // For each point: The values to draw
   double maxLineWidth = 0.0;          // Also get the maximum width of the lines that is drawn. This will be used as an offset.
-  for (int i = statsTypeList.count() - 1; i >= 0; i--)
+  for (int i = types.count() - 1; i >= 0; i--)
   {
-    int typeIdx = statsTypeList[i].typeID;
-    if (!statsTypeList[i].render || !statsCache.contains(typeIdx))
+    int typeIdx = types[i].typeID;
+    if (!types[i].render || !statistics.contains(typeIdx))
       // This statistics type is not rendered or could not be loaded.
       continue;
 
+    // If the blocks are very small, draw the aggregated cells instead. The grid and the values are not drawn then.
+    const statisticsData &data = *statistics.constFind(typeIdx);
+    const int valueCellSizeLog2 = statisticsLevelOfDetail::getCellSizeLog2(zoomFactor, STATISTICS_LOD_VALUE_CELL_SIZE);
+    const statisticsLevelOfDetail::valueLevel *valueLevel = data.levelOfDetail.getValueLevel(valueCellSizeLog2);
+    if (valueLevel)
+    {
+      if (types[i].renderValueData)
+        paintValueLevel(painter, types[i], *valueLevel, zoomFactor, visibleRect);
+      continue;
+    }
+
     // Go through all the value data
-    for (const statisticsItem_Value &valueItem : statsCache[typeIdx].valueData)
+    const statisticsValueArrays &values = data.valueData;
+    values.index.getBlocksInRect(values, statVisibleRect, visibleItems);
+    for (int j : visibleItems)
     {
       // Calculate the size and position of the rectangle to draw (zoomed in)
-      QRect rect = QRect(valueItem.pos[0], valueItem.pos[1], valueItem.size[0], valueItem.size[1]);
+      QRect rect = values.getRect(j);
       QRect displayRect = QRect(rect.left()*zoomFactor, rect.top()*zoomFactor, rect.width()*zoomFactor, rect.height()*zoomFactor);
       // Check if the rectangle of the statistics item is even visible
       bool rectVisible = (!(displayRect.left() > xMax || displayRect.right() < xMin || displayRect.top() > yMax || displayRect.bottom() < yMin));
 
       if (rectVisible)
       {
-        int value = valueItem.value; // This value determines the color for this item
-        if (statsTypeList[i].renderValueData)
+        int value = values.value[j]; // This value determines the color for this item
+        if (types[i].renderValueData)
         {
           // Get the right color for the item and draw it.
           QColor rectColor;
-          if (statsTypeList[i].scaleValueToBlockSize)
-            rectColor = statsTypeList[i].colMapper.getColor(float(value) / (valueItem.size[0] * valueItem.size[1]));
+          if (types[i].scaleValueToBlockSize)
+            rectColor = types[i].colMapper.getColor(float(value) / (values.width[j] * values.height[j]));
           else
-            rectColor = statsTypeList[i].colMapper.getColor(value);
-          rectColor.setAlpha(rectColor.alpha()*((float)statsTypeList[i].alphaFactor / 100.0));
+            rectColor = types[i].colMapper.getColor(value);
+          rectColor.setAlpha(rectColor.alpha()*((float)types[i].alphaFactor / 100.0));
           painter->setBrush(rectColor);
           painter->fillRect(displayRect, rectColor);
         }
 
         // optionally, draw a grid around the region
-        if (statsTypeList[i].renderGrid)
+        if (types[i].renderGrid)
         {
           // Set the grid color (no fill)
-          QPen gridPen = statsTypeList[i].gridPen;
-          if (statsTypeList[i].scaleGridToZoom)
+          QPen gridPen = types[i].gridPen;
+          if (types[i].scaleGridToZoom)
             gridPen.setWidthF(gridPen.widthF() * zoomFactor);
           painter->setPen(gridPen);
           painter->setBrush(QBrush(QColor(Qt::color0), Qt::NoBrush));  // no fill color
@@ -231,11 +472,11 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
         // Save the position/text in order to draw the values later
         if (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM)
         {
-          QString valTxt  = statsTypeList[i].getValueTxt(value);
-          if (!statsTypeList[i].valMap.contains(value) && statsTypeList[i].scaleValueToBlockSize)
-            valTxt = QString("%1").arg(float(value) / (valueItem.size[0] * valueItem.size[1]));
+          QString valTxt  = types[i].getValueTxt(value);
+          if (!types[i].valMap.contains(value) && types[i].scaleValueToBlockSize)
+            valTxt = QString("%1").arg(float(value) / (values.width[j] * values.height[j]));
 
-          QString typeTxt = statsTypeList[i].typeName;
+          QString typeTxt = types[i].typeName;
           QString statTxt = moreThanOneBlockStatRendered ? typeTxt + ":" + valTxt : valTxt;
 
           int i = drawStatPoints.indexOf(displayRect.topLeft());
@@ -258,21 +499,23 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
   // QList<QPoint> drawStatPoints;       // The positions of each value
   // QList<QStringList> drawStatTexts;   // For each point: The values to draw
   // double maxLineWidth = 0.0;          // Also get the maximum width of the lines that is drawn. This will be used as an offset.
-  for (int i = statsTypeList.count() - 1; i >= 0; i--)
+  for (int i = types.count() - 1; i >= 0; i--)
   {
-    int typeIdx = statsTypeList[i].typeID;
-    if (!statsTypeList[i].render || !statsCache.contains(typeIdx))
+    int typeIdx = types[i].typeID;
+    if (!types[i].render || !statistics.contains(typeIdx))
       // This statistics type is not rendered or could not be loaded.
       continue;
 
     // Go through all the value data
-    for (const statisticsItemPolygon_Value &valueItem : statsCache[typeIdx].polygonValueData)
+    const statisticsPolygonValueArrays &polygonValues = statistics.constFind(typeIdx)->polygonValueData;
+    for (int j = 0; j < polygonValues.size(); j++)
     {
       // Calculate the size and position of the rectangle to draw (zoomed in)
-      QRect boundingRect = valueItem.corners.boundingRect();
+      const QPolygon polygon = polygonValues.getPolygon(j);
+      QRect boundingRect = polygon.boundingRect();
       QTransform trans;
       trans=trans.scale(zoomFactor, zoomFactor);
-      QPolygon displayPolygon = trans.map(valueItem.corners);
+      QPolygon displayPolygon = trans.map(polygon);
       QRect displayBoundingRect = displayPolygon.boundingRect();
 
       // Check if the rectangle of the statistics item is even visible
@@ -280,16 +523,16 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
 
       if (isVisible)
       {
-        int value = valueItem.value; // This value determines the color for this item
-        if (statsTypeList[i].renderValueData)
+        int value = polygonValues.value[j]; // This value determines the color for this item
+        if (types[i].renderValueData)
         {
           // Get the right color for the item and draw it.
           QColor color;
-          if (statsTypeList[i].scaleValueToBlockSize)
-            color = statsTypeList[i].colMapper.getColor(float(value) / (boundingRect.size().width() * boundingRect.size().height()));
+          if (types[i].scaleValueToBlockSize)
+            color = types[i].colMapper.getColor(float(value) / (boundingRect.size().width() * boundingRect.size().height()));
           else
-            color = statsTypeList[i].colMapper.getColor(value);
-          color.setAlpha(color.alpha()*((float)statsTypeList[i].alphaFactor / 100.0));
+            color = types[i].colMapper.getColor(value);
+          color.setAlpha(color.alpha()*((float)types[i].alphaFactor / 100.0));
           painter->setBrush(color);
 
           // Fill polygon
@@ -299,11 +542,11 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
         }
 
         // optionally, draw a grid around the region
-        if (statsTypeList[i].renderGrid)
+        if (types[i].renderGrid)
         {
           // Set the grid color (no fill)
-          QPen gridPen = statsTypeList[i].gridPen;
-          if (statsTypeList[i].scaleGridToZoom)
+          QPen gridPen = types[i].gridPen;
+          if (types[i].scaleGridToZoom)
             gridPen.setWidthF(gridPen.widthF() * zoomFactor);
           painter->setPen(gridPen);
           painter->setBrush(QBrush(QColor(Qt::color0), Qt::NoBrush));  // no fill color
@@ -319,8 +562,8 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
         // // Save the position/text in order to draw the values later
          if (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM)
          {
-            QString valTxt  = statsTypeList[i].getValueTxt(value);
-            QString typeTxt = statsTypeList[i].typeName;
+            QString valTxt  = types[i].getValueTxt(value);
+            QString typeTxt = types[i].typeName;
             QString statTxt = moreThanOneBlockStatRendered ? typeTxt + ":" + valTxt : valTxt;
 
            int i = drawStatPoints.indexOf(getPolygonCenter(displayPolygon));
@@ -354,33 +597,53 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
   }
 
   // Draw all the arrows
-  for (int i = statsTypeList.count() - 1; i >= 0; i--)
+  for (int i = types.count() - 1; i >= 0; i--)
   {
-    int typeIdx = statsTypeList[i].typeID;
-    if (!statsTypeList[i].render || !statsCache.contains(typeIdx))
+    int typeIdx = types[i].typeID;
+    if (!types[i].render || !statistics.contains(typeIdx))
       // This statistics type is not rendered or could not be loaded.
       continue;
 
-    // Go through all the vector data
-    for (const statisticsItem_Vector &vectorItem : statsCache[typeIdx].vectorData)
+    // Go through all the vector data. The arrows of blocks outside of the visible area can reach into it.
+    const statisticsData &data = *statistics.constFind(typeIdx);
+    const int maxVectorComponent = data.maxVectorComponent;
+    const QRect statVectorRect = statVisibleRect.adjusted(-maxVectorComponent, -maxVectorComponent, maxVectorComponent, maxVectorComponent);
+    const statisticsVectorArrays &vectors = data.vectorData;
+    vectors.index.getBlocksInRect(vectors, statVectorRect, visibleItems);
+
+    // If the blocks are very small, draw the averaged vectors instead. Only the lines are drawn from the blocks then.
+    const int vectorCellSizeLog2 = statisticsLevelOfDetail::getCellSizeLog2(zoomFactor, STATISTICS_LOD_VECTOR_CELL_SIZE);
+    const statisticsLevelOfDetail::vectorLevel *vectorLevel = data.levelOfDetail.getVectorLevel(vectorCellSizeLog2);
+    if (vectorLevel)
+    {
+      if (types[i].renderVectorData)
+        paintVectorLevel(painter, types[i], *vectorLevel, zoomFactor, visibleRect, maxVectorComponent);
+      if (!data.levelOfDetail.hasVectorLines())
+        visibleItems.clear();
+    }
+
+    for (int j : visibleItems)
     {
+      if (vectorLevel && !vectors.isLine[j])
+        continue;
+
       // Calculate the size and position of the rectangle to draw (zoomed in)
-      const QRect rect = QRect(vectorItem.pos[0], vectorItem.pos[1], vectorItem.size[0], vectorItem.size[1]);
+      const QRect rect = vectors.getRect(j);
       const QRect displayRect = QRect(rect.left()*zoomFactor, rect.top()*zoomFactor, rect.width()*zoomFactor, rect.height()*zoomFactor);
       
-      if (statsTypeList[i].renderVectorData)
+      if (types[i].renderVectorData)
       {
         // Calculate the start and end point of the arrow. The vector starts at center of the block.
         int x1,y1,x2,y2;
         float vx, vy;
-        if (vectorItem.isLine)
+        if (vectors.isLine[j])
         {
-          x1 = displayRect.left() + zoomFactor*vectorItem.point[0].x();
-          y1 = displayRect.top() + zoomFactor*vectorItem.point[0].y();
-          x2 = displayRect.left() + zoomFactor*vectorItem.point[1].x();
-          y2 = displayRect.top() + zoomFactor*vectorItem.point[1].y();
-          vx = (float)(x2-x1) / statsTypeList[i].vectorScale;
-          vy = (float)(y2-y1) / statsTypeList[i].vectorScale;
+          x1 = displayRect.left() + zoomFactor*vectors.point0[j].x();
+          y1 = displayRect.top() + zoomFactor*vectors.point0[j].y();
+          x2 = displayRect.left() + zoomFactor*vectors.point1[j].x();
+          y2 = displayRect.top() + zoomFactor*vectors.point1[j].y();
+          vx = (float)(x2-x1) / types[i].vectorScale;
+          vy = (float)(y2-y1) / types[i].vectorScale;
         }
         else
         {
@@ -388,8 +651,8 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
           y1 = displayRect.top() + displayRect.height() / 2;
 
           // The length of the vector
-          vx = (float)vectorItem.point[0].x() / statsTypeList[i].vectorScale;
-          vy = (float)vectorItem.point[0].y() / statsTypeList[i].vectorScale;
+          vx = (float)vectors.point0[j].x() / types[i].vectorScale;
+          vy = (float)vectors.point0[j].y() / types[i].vectorScale;
 
           // The end point of the vector
           x2 = x1 + zoomFactor * vx;
@@ -401,15 +664,15 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
         if (arrowVisible)
         {
           // Set the pen for drawing
-          QPen vectorPen = statsTypeList[i].vectorPen;
+          QPen vectorPen = types[i].vectorPen;
           QColor arrowColor = vectorPen.color();
-          if (statsTypeList[i].mapVectorToColor)
+          if (types[i].mapVectorToColor)
             arrowColor.setHsvF(clip((atan2f(vy,vx)+M_PI)/(2*M_PI),0.0,1.0), 1.0,1.0);
-          arrowColor.setAlpha(arrowColor.alpha()*((float)statsTypeList[i].alphaFactor / 100.0));
+          arrowColor.setAlpha(arrowColor.alpha()*((float)types[i].alphaFactor / 100.0));
           vectorPen.setColor(arrowColor);
-          if (statsTypeList[i].scaleVectorToZoom)
+          if (types[i].scaleVectorToZoom)
             vectorPen.setWidthF(vectorPen.widthF() * zoomFactor / 8);
-          if (vectorItem.isLine)
+          if (vectors.isLine[j])
               vectorPen.setCapStyle(Qt::RoundCap);
           painter->setPen(vectorPen);
           painter->setBrush(arrowColor);
@@ -426,12 +689,12 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
             if ((vx != 0 || vy != 0))
             {
               // The size of the arrow head
-              const int headSize = (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && !statsTypeList[i].scaleVectorToZoom) ? 8 : zoomFactor/2;
+              const int headSize = (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && !types[i].scaleVectorToZoom) ? 8 : zoomFactor/2;
 
-              if (statsTypeList[i].arrowHead != StatisticsType::arrowHead_t::none)
+              if (types[i].arrowHead != StatisticsType::arrowHead_t::none)
               {
                 // We draw an arrow head. This means that we will have to draw a shortened line
-                const int shorten = (statsTypeList[i].arrowHead == StatisticsType::arrowHead_t::arrow) ? headSize * 2 : headSize * 0.5;
+                const int shorten = (types[i].arrowHead == StatisticsType::arrowHead_t::arrow) ? headSize * 2 : headSize * 0.5;
                 if (sqrt(vx*vx*zoomFactor*zoomFactor + vy*vy*zoomFactor*zoomFactor) > shorten)
                 {
                   // Shorten the line and draw it
@@ -443,7 +706,7 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
                 // Draw the not shortened line
                 painter->drawLine(x1, y1, x2, y2);
 
-              if (statsTypeList[i].arrowHead == StatisticsType::arrowHead_t::arrow)
+              if (types[i].arrowHead == StatisticsType::arrowHead_t::arrow)
               {
                 // Save the painter state, translate to the arrow tip, rotate the painter and draw the normal triangle.
                 painter->save();
@@ -457,13 +720,13 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
                 // Restore. Revert translation/rotation of the painter.
                 painter->restore();
               }
-              else if (statsTypeList[i].arrowHead == StatisticsType::arrowHead_t::circle)
+              else if (types[i].arrowHead == StatisticsType::arrowHead_t::circle)
                 painter->drawEllipse(x2-headSize/2, y2-headSize/2, headSize, headSize);
             }
 
-            if (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && statsTypeList[i].renderVectorDataValues)
+            if (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && types[i].renderVectorDataValues)
             {
-              if (vectorItem.isLine)
+              if (vectors.isLine[j])
               {
                 // if we just draw a line, we want to simply see the coordinate pairs
                 QString txt1 = QString("(%1, %2)").arg(x1/zoomFactor).arg(y1/zoomFactor);
@@ -534,10 +797,10 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
       if (rectVisible)
       {
         // optionally, draw a grid around the region that the arrow is defined for
-        if (statsTypeList[i].renderGrid && rectVisible)
+        if (types[i].renderGrid && rectVisible)
         {
-          QPen gridPen = statsTypeList[i].gridPen;
-          if (statsTypeList[i].scaleGridToZoom)
+          QPen gridPen = types[i].gridPen;
+          if (types[i].scaleGridToZoom)
             gridPen.setWidthF(gridPen.widthF() * zoomFactor);
 
           painter->setPen(gridPen);
@@ -549,17 +812,19 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
     }
 
     // Go through all the affine transform data
-    for (const statisticsItem_AffineTF &affineTFItem : statsCache[typeIdx].affineTFData)
+    const statisticsAffineTFArrays &affineTFs = data.affineTFData;
+    affineTFs.index.getBlocksInRect(affineTFs, statVectorRect, visibleItems);
+    for (int j : visibleItems)
     {
       // Calculate the size and position of the rectangle to draw (zoomed in)
-      const QRect rect = QRect(affineTFItem.pos[0], affineTFItem.pos[1], affineTFItem.size[0], affineTFItem.size[1]);
+      const QRect rect = affineTFs.getRect(j);
       const QRect displayRect = QRect(rect.left()*zoomFactor, rect.top()*zoomFactor, rect.width()*zoomFactor, rect.height()*zoomFactor);
       // Check if the rectangle of the statistics item is even visible
       const bool rectVisible = (!(displayRect.left() > xMax || displayRect.right() < xMin || displayRect.top() > yMax || displayRect.bottom() < yMin));
 
       if (rectVisible)
       {
-        if (statsTypeList[i].renderVectorData)
+        if (types[i].renderVectorData)
         {
           // affine vectors start at bottom left, top left and top right of the block
           // mv0: LT, mv1: RT, mv2: LB
@@ -575,12 +840,12 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
           yLBstart = displayRect.bottom();
 
           // The length of the vectors
-          vxLT = (float)affineTFItem.point[0].x() / statsTypeList[i].vectorScale;
-          vyLT = (float)affineTFItem.point[0].y() / statsTypeList[i].vectorScale;
-          vxRT = (float)affineTFItem.point[1].x() / statsTypeList[i].vectorScale;
-          vyRT = (float)affineTFItem.point[1].y() / statsTypeList[i].vectorScale;
-          vxLB = (float)affineTFItem.point[2].x() / statsTypeList[i].vectorScale;
-          vyLB = (float)affineTFItem.point[2].y() / statsTypeList[i].vectorScale;
+          vxLT = (float)affineTFs.point[0][j].x() / types[i].vectorScale;
+          vyLT = (float)affineTFs.point[0][j].y() / types[i].vectorScale;
+          vxRT = (float)affineTFs.point[1][j].x() / types[i].vectorScale;
+          vyRT = (float)affineTFs.point[1][j].y() / types[i].vectorScale;
+          vxLB = (float)affineTFs.point[2][j].x() / types[i].vectorScale;
+          vyLB = (float)affineTFs.point[2][j].y() / types[i].vectorScale;
 
           // The end point of the vectors
           xLTend = xLTstart + zoomFactor * vxLT;
@@ -590,17 +855,17 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
           xLBend = xLBstart + zoomFactor * vxLB;
           yLBend = yLBstart + zoomFactor * vyLB;
 
-          paintVector(painter, i, zoomFactor, xLTstart, yLTstart, xLTend, yLTend, vxLT, vyLT, false, xMin, xMax, yMin, yMax);
-          paintVector(painter, i, zoomFactor, xRTstart, yRTstart, xRTend, yRTend, vxRT, vyRT, false, xMin, xMax, yMin, yMax);
-          paintVector(painter, i, zoomFactor, xLBstart, yLBstart, xLBend, yLBend, vxLB, vyLB, false, xMin, xMax, yMin, yMax);
+          paintVector(painter, types[i], zoomFactor, xLTstart, yLTstart, xLTend, yLTend, vxLT, vyLT, false, xMin, xMax, yMin, yMax);
+          paintVector(painter, types[i], zoomFactor, xRTstart, yRTstart, xRTend, yRTend, vxRT, vyRT, false, xMin, xMax, yMin, yMax);
+          paintVector(painter, types[i], zoomFactor, xLBstart, yLBstart, xLBend, yLBend, vxLB, vyLB, false, xMin, xMax, yMin, yMax);
 
         }
 
         // optionally, draw a grid around the region that the arrow is defined for
-        if (statsTypeList[i].renderGrid && rectVisible)
+        if (types[i].renderGrid && rectVisible)
         {
-          QPen gridPen = statsTypeList[i].gridPen;
-          if (statsTypeList[i].scaleGridToZoom)
+          QPen gridPen = types[i].gridPen;
+          if (types[i].scaleGridToZoom)
             gridPen.setWidthF(gridPen.widthF() * zoomFactor);
 
           painter->setPen(gridPen);
@@ -613,20 +878,21 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
   }
   
   // Draw all polygon vector data
-  for (int i = statsTypeList.count() - 1; i >= 0; i--)
+  for (int i = types.count() - 1; i >= 0; i--)
   {
-    int typeIdx = statsTypeList[i].typeID;
-    if (!statsTypeList[i].render || !statsCache.contains(typeIdx))
+    int typeIdx = types[i].typeID;
+    if (!types[i].render || !statistics.contains(typeIdx))
       // This statistics type is not rendered or could not be loaded.
       continue;
 
     // Go through all the vector data
-    for (const statisticsItemPolygon_Vector &vectorItem : statsCache[typeIdx].polygonVectorData)
+    const statisticsPolygonVectorArrays &polygonVectors = statistics.constFind(typeIdx)->polygonVectorData;
+    for (int j = 0; j < polygonVectors.size(); j++)
     {
       // Calculate the size and position of the rectangle to draw (zoomed in)
       QTransform trans;
       trans=trans.scale(zoomFactor, zoomFactor);
-      QPolygon displayPolygon = trans.map(vectorItem.corners);
+      QPolygon displayPolygon = trans.map(polygonVectors.getPolygon(j));
       QRect displayBoundingRect = displayPolygon.boundingRect();
 
       // Check if the rectangle of the statistics item is even visible
@@ -634,7 +900,7 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
 
       if (isVisible)
       {
-        if (statsTypeList[i].renderVectorData)
+        if (types[i].renderVectorData)
         {
           // start vector at center of the block
           int center_x,center_y,head_x,head_y;
@@ -651,8 +917,8 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
           center_y /= displayPolygon.size();
 
           // The length of the vector
-          vx = (float)vectorItem.point[0].x() / statsTypeList[i].vectorScale;
-          vy = (float)vectorItem.point[0].y() / statsTypeList[i].vectorScale;
+          vx = (float)polygonVectors.point[j].x() / types[i].vectorScale;
+          vy = (float)polygonVectors.point[j].y() / types[i].vectorScale;
 
           // The end point of the vector
           head_x = center_x + zoomFactor * vx;
@@ -662,13 +928,13 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
           if (!(center_x < xMin && head_x < xMin) && !(center_x > xMax && head_x > xMax) && !(center_y < yMin && head_y < yMin) && !(center_y > yMax && head_y > yMax))
           {
             // Set the pen for drawing
-            QPen vectorPen = statsTypeList[i].vectorPen;
+            QPen vectorPen = types[i].vectorPen;
             QColor arrowColor = vectorPen.color();
-            if (statsTypeList[i].mapVectorToColor)
+            if (types[i].mapVectorToColor)
               arrowColor.setHsvF(clip((atan2f(vy,vx)+M_PI)/(2*M_PI),0.0,1.0), 1.0,1.0);
-            arrowColor.setAlpha(arrowColor.alpha()*((float)statsTypeList[i].alphaFactor / 100.0));
+            arrowColor.setAlpha(arrowColor.alpha()*((float)types[i].alphaFactor / 100.0));
             vectorPen.setColor(arrowColor);
-            if (statsTypeList[i].scaleVectorToZoom)
+            if (types[i].scaleVectorToZoom)
               vectorPen.setWidthF(vectorPen.widthF() * zoomFactor / 8);
             painter->setPen(vectorPen);
             painter->setBrush(arrowColor);
@@ -685,11 +951,11 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
               if ((vx != 0 || vy != 0))
               {
                 // The size of the arrow head
-                const int headSize = (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && !statsTypeList[i].scaleVectorToZoom) ? 8 : zoomFactor/2;
-                if (statsTypeList[i].arrowHead != StatisticsType::arrowHead_t::none)
+                const int headSize = (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && !types[i].scaleVectorToZoom) ? 8 : zoomFactor/2;
+                if (types[i].arrowHead != StatisticsType::arrowHead_t::none)
                 {
                   // We draw an arrow head. This means that we will have to draw a shortened line
-                  const int shorten = (statsTypeList[i].arrowHead == StatisticsType::arrowHead_t::arrow) ? headSize * 2 : headSize * 0.5;
+                  const int shorten = (types[i].arrowHead == StatisticsType::arrowHead_t::arrow) ? headSize * 2 : headSize * 0.5;
                   if (sqrt(vx*vx*zoomFactor*zoomFactor + vy*vy*zoomFactor*zoomFactor) > shorten)
                   {
                     // Shorten the line and draw it
@@ -701,7 +967,7 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
                   // Draw the not shortened line
                   painter->drawLine(center_x, center_y, head_x, head_y);
 
-                if (statsTypeList[i].arrowHead == StatisticsType::arrowHead_t::arrow)
+                if (types[i].arrowHead == StatisticsType::arrowHead_t::arrow)
                 {
                   // Save the painter state, translate to the arrow tip, rotate the painter and draw the normal triangle.
                   painter->save();
@@ -715,12 +981,12 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
                   // Restore. Revert translation/rotation of the painter.
                   painter->restore();
                 }
-                else if (statsTypeList[i].arrowHead == StatisticsType::arrowHead_t::circle)
+                else if (types[i].arrowHead == StatisticsType::arrowHead_t::circle)
                   painter->drawEllipse(head_x-headSize/2, head_y-headSize/2, headSize, headSize);
               }
 
               // Todo
-              // if (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && statsTypeList[i].renderVectorDataValues)
+              // if (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && types[i].renderVectorDataValues)
               // {
               //   // Also draw the vector value next to the arrow head
               //     QString txt = QString("x %1\ny %2").arg(vx).arg(vy);
@@ -748,10 +1014,10 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
         }
 
         // optionally, draw the polygon outline
-        if (statsTypeList[i].renderGrid && isVisible)
+        if (types[i].renderGrid && isVisible)
         {
-          QPen gridPen = statsTypeList[i].gridPen;
-          if (statsTypeList[i].scaleGridToZoom)
+          QPen gridPen = types[i].gridPen;
+          if (types[i].scaleGridToZoom)
             gridPen.setWidthF(gridPen.widthF() * zoomFactor);
 
           painter->setPen(gridPen);
@@ -762,13 +1028,76 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
       }
     }
   }
+}
 
-  // Restore the state the state of the painter from before this function was called.
-  // This will reset the set pens and the translation.
-  painter->restore();
+void statisticHandler::paintValueLevel(QPainter *painter, const StatisticsType &type, const statisticsLevelOfDetail::valueLevel &level, double zoomFactor, const QRect &visibleRect)
+{
+  // The size of the cells on screen. Only the visible cells are drawn.
+  const double cellSize = (1 << level.cellSizeLog2) * zoomFactor;
+  const int cxMin = qMax(0, int(visibleRect.left() / cellSize));
+  const int cxMax = qMin(level.nrCellsX - 1, int(visibleRect.right() / cellSize));
+  const int cyMin = qMax(0, int(visibleRect.top() / cellSize));
+  const int cyMax = qMin(level.nrCellsY - 1, int(visibleRect.bottom() / cellSize));
+
+  // A map assigns colors to distinct values. Mixing them makes no sense so the most frequent value is shown.
+  const bool useMode = (type.colMapper.type == colorMapper::map);
+  for (int cy = cyMin; cy <= cyMax; cy++)
+  {
+    const int y1 = int(cy * cellSize);
+    const int y2 = int((cy + 1) * cellSize);
+    for (int cx = cxMin; cx <= cxMax; cx++)
+    {
+      const int idx = cy * level.nrCellsX + cx;
+      if (!level.covered[idx])
+        continue;
+
+      QColor rectColor;
+      if (useMode)
+        rectColor = type.colMapper.getColor(level.mode[idx]);
+      else if (type.scaleValueToBlockSize)
+        rectColor = type.colMapper.getColor(level.meanPerPixel[idx]);
+      else
+        rectColor = type.colMapper.getColor(level.mean[idx]);
+      rectColor.setAlpha(rectColor.alpha()*((float)type.alphaFactor / 100.0));
+
+      const int x1 = int(cx * cellSize);
+      const int x2 = int((cx + 1) * cellSize);
+      painter->fillRect(QRect(x1, y1, x2 - x1, y2 - y1), rectColor);
+    }
+  }
 }
 
-void statisticHandler::paintVector(QPainter *painter, const int& statTypeIdx, const double& zoomFactor,
+void statisticHandler::paintVectorLevel(QPainter *painter, const StatisticsType &type, const statisticsLevelOfDetail::vectorLevel &level, double zoomFactor, const QRect &visibleRect, int maxVectorComponent)
+{
+  // The size of the cells on screen. The vectors of cells outside of the visible area can reach into it.
+  const double cellSize = (1 << level.cellSizeLog2) * zoomFactor;
+  const int margin = int(std::ceil(maxVectorComponent * zoomFactor));
+  const int cxMin = qMax(0, int((visibleRect.left() - margin) / cellSize));
+  const int cxMax = qMin(level.nrCellsX - 1, int((visibleRect.right() + margin) / cellSize));
+  const int cyMin = qMax(0, int((visibleRect.top() - margin) / cellSize));
+  const int cyMax = qMin(level.nrCellsY - 1, int((visibleRect.bottom() + margin) / cellSize));
+
+  // The mean vector of each cell starts at the center of the cell
+  for (int cy = cyMin; cy <= cyMax; cy++)
+  {
+    for (int cx = cxMin; cx <= cxMax; cx++)
+    {
+      const int idx = cy * level.nrCellsX + cx;
+      if (!level.covered[idx])
+        continue;
+
+      const int x1 = int((cx + 0.5) * cellSize);
+      const int y1 = int((cy + 0.5) * cellSize);
+      const float vx = (float)level.vector[idx].x() / type.vectorScale;
+      const float vy = (float)level.vector[idx].y() / type.vectorScale;
+      const int x2 = x1 + zoomFactor * vx;
+      const int y2 = y1 + zoomFactor * vy;
+      paintVector(painter, type, zoomFactor, x1, y1, x2, y2, vx, vy, false, visibleRect.left(), visibleRect.right(), visibleRect.top(), visibleRect.bottom());
+    }
+  }
+}
+
+void statisticHandler::paintVector(QPainter *painter, const StatisticsType &type, const double& zoomFactor,
                                    const int& x1, const int& y1, const int& x2, const int& y2,
                                    const float& vx, const float& vy, bool isLine,
                                    const int& xMin, const int& xMax, const int& yMin, const int& yMax)
@@ -778,13 +1107,13 @@ void statisticHandler::paintVector(QPainter *painter, const int& statTypeIdx, co
   if (!(x1 < xMin && x2 < xMin) && !(x1 > xMax && x2 > xMax) && !(y1 < yMin && y2 < yMin) && !(y1 > yMax && y2 > yMax))
   {
     // Set the pen for drawing
-    QPen vectorPen = statsTypeList[statTypeIdx].vectorPen;
+    QPen vectorPen = type.vectorPen;
     QColor arrowColor = vectorPen.color();
-    if (statsTypeList[statTypeIdx].mapVectorToColor)
+    if (type.mapVectorToColor)
       arrowColor.setHsvF(clip((atan2f(vy,vx)+M_PI)/(2*M_PI),0.0,1.0), 1.0,1.0);
-    arrowColor.setAlpha(arrowColor.alpha()*((float)statsTypeList[statTypeIdx].alphaFactor / 100.0));
+    arrowColor.setAlpha(arrowColor.alpha()*((float)type.alphaFactor / 100.0));
     vectorPen.setColor(arrowColor);
-    if (statsTypeList[statTypeIdx].scaleVectorToZoom)
+    if (type.scaleVectorToZoom)
       vectorPen.setWidthF(vectorPen.widthF() * zoomFactor / 8);
     painter->setPen(vectorPen);
     painter->setBrush(arrowColor);
@@ -801,12 +1130,12 @@ void statisticHandler::paintVector(QPainter *painter, const int& statTypeIdx, co
       if ((vx != 0 || vy != 0))
       {
         // The size of the arrow head
-        const int headSize = (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && !statsTypeList[statTypeIdx].scaleVectorToZoom) ? 8 : zoomFactor/2;
+        const int headSize = (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && !type.scaleVectorToZoom) ? 8 : zoomFactor/2;
 
-        if (statsTypeList[statTypeIdx].arrowHead != StatisticsType::arrowHead_t::none)
+        if (type.arrowHead != StatisticsType::arrowHead_t::none)
         {
           // We draw an arrow head. This means that we will have to draw a shortened line
-          const int shorten = (statsTypeList[statTypeIdx].arrowHead == StatisticsType::arrowHead_t::arrow) ? headSize * 2 : headSize * 0.5;
+          const int shorten = (type.arrowHead == StatisticsType::arrowHead_t::arrow) ? headSize * 2 : headSize * 0.5;
 
           if (sqrt(vx*vx*zoomFactor*zoomFactor + vy*vy*zoomFactor*zoomFactor) > shorten)
           {
@@ -819,7 +1148,7 @@ void statisticHandler::paintVector(QPainter *painter, const int& statTypeIdx, co
           // Draw the not shortened line
           painter->drawLine(x1, y1, x2, y2);
 
-        if (statsTypeList[statTypeIdx].arrowHead == StatisticsType::arrowHead_t::arrow)
+        if (type.arrowHead == StatisticsType::arrowHead_t::arrow)
         {
           // Save the painter state, translate to the arrow tip, rotate the painter and draw the normal triangle.
           painter->save();
@@ -833,11 +1162,11 @@ void statisticHandler::paintVector(QPainter *painter, const int& statTypeIdx, co
           // Restore. Revert translation/rotation of the painter.
           painter->restore();
         }
-        else if (statsTypeList[statTypeIdx].arrowHead == StatisticsType::arrowHead_t::circle)
+        else if (type.arrowHead == StatisticsType::arrowHead_t::circle)
           painter->drawEllipse(x2-headSize/2, y2-headSize/2, headSize, headSize);
       }
 
-      if (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && statsTypeList[statTypeIdx].renderVectorDataValues)
+      if (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && type.renderVectorDataValues)
       {
         if (isLine)
         {
@@ -905,6 +1234,27 @@ void statisticHandler::paintVector(QPainter *painter, const int& statTypeIdx, co
 }
 
 
+QSet<int> statisticHandler::getRenderedStatisticsTypeIDs() const
+{
+  QSet<int> typeIDs;
+  for (const StatisticsType &type : getLoadingStatisticsTypeList())
+    if (type.render)
+      typeIDs.insert(type.typeID);
+  return typeIDs;
+}
+
+StatisticsTypeList statisticHandler::getLoadingStatisticsTypeList() const
+{
+  QMutexLocker lock(&statsCacheAccessMutex);
+  return loadingTypeList;
+}
+
+void statisticHandler::updateLoadingTypeList()
+{
+  QMutexLocker lock(&statsCacheAccessMutex);
+  loadingTypeList = copyStatisticsTypeList(statsTypeList);
+}
+
 StatisticsType* statisticHandler::getStatisticsType(int typeID)
 {
   for (int i = 0; i<statsTypeList.count(); i++)
@@ -921,6 +1271,9 @@ StatisticsType* statisticHandler::getStatisticsType(int typeID)
 QStringPairList statisticHandler::getValuesAt(const QPoint &pos)
 {
   QStringPairList valueList;
+  // The values of the frame that was drawn last. The blocks at the position are looked up in the spatial index.
+  const QHash<int, statisticsData> statistics = getCachedStatistics(drawnFrameIdx);
+  QVector<int> itemsAtPos;
 
   for (int i = 0; i<statsTypeList.count(); i++)
   {
@@ -934,35 +1287,40 @@ QStringPairList statisticHandler::getValuesAt(const QPoint &pos)
 
       // Get all value data entries
       bool foundStats = false;
-      for (const statisticsItem_Value &valueItem : statsCache[typeID].valueData)
+      const statisticsData data = statistics.value(typeID);
+      const statisticsValueArrays &values = data.valueData;
+      values.index.getBlocksInRect(values, QRect(pos, QSize(1, 1)), itemsAtPos);
+      for (int j : itemsAtPos)
       {
-        QRect rect = QRect(valueItem.pos[0], valueItem.pos[1], valueItem.size[0], valueItem.size[1]);
+        QRect rect = values.getRect(j);
         if (rect.contains(pos))
         {
-          int value = valueItem.value;
+          int value = values.value[j];
           QString valTxt  = statsTypeList[i].getValueTxt(value);
           if (!statsTypeList[i].valMap.contains(value) && statsTypeList[i].scaleValueToBlockSize)
-            valTxt = QString("%1").arg(float(value) / (valueItem.size[0] * valueItem.size[1]));
+            valTxt = QString("%1").arg(float(value) / (values.width[j] * values.height[j]));
           valueList.append(QStringPair(aType->typeName, valTxt));
           foundStats = true;
         }
       }
 
-      for (const statisticsItem_Vector &vectorItem : statsCache[typeID].vectorData)
+      const statisticsVectorArrays &vectors = data.vectorData;
+      vectors.index.getBlocksInRect(vectors, QRect(pos, QSize(1, 1)), itemsAtPos);
+      for (int j : itemsAtPos)
       {
-        QRect rect = QRect(vectorItem.pos[0], vectorItem.pos[1], vectorItem.size[0], vectorItem.size[1]);
+        QRect rect = vectors.getRect(j);
         if (rect.contains(pos))
         {
           float vectorValue1, vectorValue2;
-          if (vectorItem.isLine)
+          if (vectors.isLine[j])
           {
-           vectorValue1 = (float)(vectorItem.point[1].x() - vectorItem.point[0].x()) / statsTypeList[i].vectorScale;
-           vectorValue2 = (float)(vectorItem.point[1].y() - vectorItem.point[0].y()) / statsTypeList[i].vectorScale;
+           vectorValue1 = (float)(vectors.point1[j].x() - vectors.point0[j].x()) / statsTypeList[i].vectorScale;
+           vectorValue2 = (float)(vectors.point1[j].y() - vectors.point0[j].y()) / statsTypeList[i].vectorScale;
           }
           else
           {
-            vectorValue1 = (float)vectorItem.point[0].x() / statsTypeList[i].vectorScale;
-            vectorValue2 = (float)vectorItem.point[0].y() / statsTypeList[i].vectorScale;
+            vectorValue1 = (float)vectors.point0[j].x() / statsTypeList[i].vectorScale;
+            vectorValue2 = (float)vectors.point0[j].y() / statsTypeList[i].vectorScale;
           }
           valueList.append(QStringPair(QString("%1[x]").arg(aType->typeName), QString::number(vectorValue1)));
           valueList.append(QStringPair(QString("%1[y]").arg(aType->typeName), QString::number(vectorValue2)));
@@ -985,6 +1343,7 @@ QStringPairList statisticHandler::getValuesAt(const QPoint &pos)
 bool statisticHandler::setStatisticsTypeList(const StatisticsTypeList &typeList)
 {
   bool bChanged = false;
+  bool renderedTypeAdded = false;
   for (const StatisticsType &aType : typeList)
   {
     StatisticsType* internalType = getStatisticsType(aType.typeID);
@@ -994,6 +1353,7 @@ bool statisticHandler::setStatisticsTypeList(const StatisticsTypeList &typeList)
 
     if (internalType->render != aType.render)
     {
+      renderedTypeAdded |= aType.render;
       internalType->render = aType.render;
       bChanged = true;
     }
@@ -1019,6 +1379,13 @@ bool statisticHandler::setStatisticsTypeList(const StatisticsTypeList &typeList)
     }
   }
 
+  if (bChanged)
+  {
+    updateLoadingTypeList();
+    invalidateLayers();
+  }
+  if (renderedTypeAdded)
+    invalidatePrefetchedFrames();
   return bChanged;
 }
 
@@ -1127,9 +1494,12 @@ QWidget *statisticHandler::getSecondaryStatisticsHandlerControls(bool recreateCo
 // further signals and of course update the statsTypeList to render the stats correctly.
 void statisticHandler::onStatisticsControlChanged()
 {
+  bool renderedTypeAdded = false;
   for (int row = 0; row < statsTypeList.length(); ++row)
   {
     // Get the values of the statistics type from the controls
+    if (!statsTypeList[row].render && itemNameCheckBoxes[0][row]->isChecked())
+      renderedTypeAdded = true;
     statsTypeList[row].render      = itemNameCheckBoxes[0][row]->isChecked();
     statsTypeList[row].alphaFactor = itemOpacitySliders[0][row]->value();
 
@@ -1156,6 +1526,10 @@ void statisticHandler::onStatisticsControlChanged()
     }
   }
 
+  updateLoadingTypeList();
+  invalidateLayers();
+  if (renderedTypeAdded)
+    invalidatePrefetchedFrames();
   emit updateItem(true);
 }
 
@@ -1163,9 +1537,12 @@ void statisticHandler::onStatisticsControlChanged()
 // controls without emitting further signals and of course update the statsTypeList to render the stats correctly.
 void statisticHandler::onSecondaryStatisticsControlChanged()
 {
+  bool renderedTypeAdded = false;
   for (int row = 0; row < statsTypeList.length(); ++row)
   {
     // Get the values of the statistics type from the controls
+    if (!statsTypeList[row].render && itemNameCheckBoxes[1][row]->isChecked())
+      renderedTypeAdded = true;
     statsTypeList[row].render      = itemNameCheckBoxes[1][row]->isChecked();
     statsTypeList[row].alphaFactor = itemOpacitySliders[1][row]->value();
 
@@ -1188,6 +1565,10 @@ void statisticHandler::onSecondaryStatisticsControlChanged()
     }
   }
 
+  updateLoadingTypeList();
+  invalidateLayers();
+  if (renderedTypeAdded)
+    invalidatePrefetchedFrames();
   emit updateItem(true);
 }
 
@@ -1210,6 +1591,8 @@ void statisticHandler::loadPlaylist(const YUViewDomElement &root)
 {
   for (int row = 0; row < statsTypeList.length(); ++row)
     statsTypeList[row].loadPlaylist(root);
+  updateLoadingTypeList();
+  invalidateLayers();
 }
 
 void statisticHandler::updateSettings()
@@ -1224,6 +1607,9 @@ void statisticHandler::updateSettings()
 
 void statisticHandler::updateStatisticsHandlerControls()
 {
+  // The types may have changed. Nothing that was rasterized before can be reused.
+  invalidateLayers();
+
   // First run a check if all statisticsTypes are identical
   bool controlsStillValid = true;
   if (statsTypeList.length() != itemNameCheckBoxes[0].count())
@@ -1321,6 +1707,7 @@ void statisticHandler::updateStatisticsHandlerControls()
         }
       }
     }
+    updateLoadingTypeList();
 
     // Create new controls
     createStatisticsHandlerControls(true);
@@ -1354,6 +1741,7 @@ void statisticHandler::addStatType(const StatisticsType &type)
   {
     statsTypeList.append(type);
   }
+  updateLoadingTypeList();
 }
 
 void statisticHandler::clearStatTypes()
@@ -1362,8 +1750,10 @@ void statisticHandler::clearStatTypes()
   // to revert the new controls. This way we can see which statistics were drawn / how.
   statsTypeListBackup = statsTypeList;
 
-  // Clear the old list. New items can be added now.
+  // Clear the old list. New items can be added now. The cached statistics belong to the old types.
   statsTypeList.clear();
+  updateLoadingTypeList();
+  clearStatisticsCache();
 }
 
 void statisticHandler::onStyleButtonClicked(int id)
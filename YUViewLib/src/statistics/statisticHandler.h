@@ -33,7 +33,12 @@
 #ifndef STATISTICSOURCE_H
 #define STATISTICSOURCE_H
 
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QMap>
 #include <QPointer>
+#include <QSet>
 #include <QVector>
 #include <QMutex>
 #include "statisticsExtensions.h"
@@ -53,12 +58,19 @@ class statisticHandler : public QObject
 
 public:
   statisticHandler();
+  ~statisticHandler();
 
   // Get the statistics values under the cursor position (if they are visible)
   QStringPairList getValuesAt(const QPoint &pos);
 
   // Get the list of all statistics that this source can provide
   StatisticsTypeList getStatisticsTypeList() const { return statsTypeList; }
+  // Get the IDs of all statistics types that are currently rendered. This is thread safe.
+  QSet<int> getRenderedStatisticsTypeIDs() const;
+  // Get the copy of the statistics types for the loading threads. The GUI thread may change statsTypeList at any
+  // time. The loading threads (the caching threads and the loadStatisticToCache functions of the items) must only
+  // read the types from this copy.
+  StatisticsTypeList getLoadingStatisticsTypeList() const;
   // Set the attributes of the statistics that this source can provide (rendered, drawGrid...)
   bool setStatisticsTypeList(const StatisticsTypeList &typeList);
   
@@ -80,8 +92,12 @@ public:
   // Returns false if the statistics need to be loaded first.
   void paintStatistics(QPainter *painter, int frameIdx, double zoomFactor);
 
+  // Draw the aggregated cells of a level of detail instead of the blocks
+  void paintValueLevel(QPainter *painter, const StatisticsType &type, const statisticsLevelOfDetail::valueLevel &level, double zoomFactor, const QRect &visibleRect);
+  void paintVectorLevel(QPainter *painter, const StatisticsType &type, const statisticsLevelOfDetail::vectorLevel &level, double zoomFactor, const QRect &visibleRect, int maxVectorComponent);
+
   // Draw a vector.
-  void paintVector(QPainter *painter, const int &statTypeIdx, const double &zoomFactor,
+  void paintVector(QPainter *painter, const StatisticsType &type, const double &zoomFactor,
                    const int &x1, const int &y1, const int &x2, const int &y2,
                    const float &vx, const float &vy, bool isLine, const int &xMin, const int &xMax, const int &yMin, const int &yMax);
 
@@ -92,6 +108,26 @@ public:
   // data that is needed to render the statistics for the given frame.
   void loadStatistics(int frameIdx);
 
+  // Load the statistics of all types (rendered or not) for the given frame index and return them.
+  // They are not added to the frame cache. This is used to convert a statistics file into another format.
+  QHash<int, statisticsData> loadAllStatistics(int frameIdx);
+
+  // ----- Caching -----
+  // The statistics of multiple frames are kept in the frame cache. The frames that were loaded for drawing are kept
+  // (up to STATISTICS_MAX_RECENT_FRAMES) and the items can prefetch frames from the caching threads of the videoCache.
+  // Prefetched frames are kept until the videoCache removes them. The functions are thread safe.
+
+  // Load the statistics of all rendered types for the given frame into the frame cache.
+  void cacheStatistics(int frameIdx);
+  QList<int> getCachedFrames() const;
+  int getNumberCachedFrames() const;
+  // The average size of the cached frames in bytes (or an estimate if nothing was loaded yet)
+  unsigned int getCachingFrameSize() const;
+  void removeFrameFromCache(int frameIdx);
+  void removeAllFramesFromCache();
+  // Remove everything from the frame cache (e.g. because the source changed). Everything is loaded again when needed.
+  void clearStatisticsCache();
+
   // Get the statisticsType with the given typeID from p_statsTypeList
   StatisticsType *getStatisticsType(int typeID);
 
@@ -110,8 +146,9 @@ public:
   void savePlaylist(YUViewDomElement &root) const;
   void loadPlaylist(const YUViewDomElement &root);
 
-  QHash<int, statisticsData> statsCache; // cache of the statistics for the current POC [statsTypeID]
-  int statsCacheFrameIdx;
+  // The statistics of the frame that is currently being loaded [statsTypeID]. The item adds the data for a type
+  // here when requestStatisticsLoading is emitted. The types that are already cached for the frame are in here.
+  QHash<int, statisticsData> statsCache;
 
   // Update the settings. For the statistics this means updating the icons for editing statistic.
   void updateSettings();
@@ -121,18 +158,83 @@ signals:
   void updateItem(bool redraw);
   // Request to load the statistics for the given frame index/typeIdx into statsCache.
   void requestStatisticsLoading(int frameIdx, int typeIdx);
+  // A statistics type that was not rendered before is rendered now. The prefetched frames did not contain it and
+  // were removed from the cache. The item should rethink what to cache.
+  void prefetchedFramesInvalid();
 
 private:
 
   // The frame size of the statistics. Needed for drawing the statistics at the right position.
   QSize statFrameSize;
 
-  // Make sure that nothing is read from the stats cache while it is being changed.
-  QMutex statsCacheAccessMutex;
+  // The statistics of a frame in the frame cache [statsTypeID]
+  struct cachedFrame
+  {
+    QHash<int, statisticsData> data;
+    qint64 memorySize {0};
+    // The frame was prefetched by the videoCache. It is kept until the videoCache removes it.
+    bool prefetched {false};
+  };
+  QMap<int, cachedFrame> frameCache;
+  qint64 frameCacheMemorySize {0};
+  // The frames that were loaded for drawing (most recent first)
+  QList<int> recentFrames;
+  // The frame that was drawn last. getValuesAt() returns the values of this frame.
+  int drawnFrameIdx {-1};
+
+  // Make sure that nothing is read from the frame cache while it is being changed.
+  mutable QMutex statsCacheAccessMutex;
+  // The items fill statsCache and can only load one frame at a time.
+  QMutex statsLoadingMutex;
+
+  // Load the rendered types that are not cached yet for the given frame into the frame cache
+  void loadFrameToCache(int frameIdx, bool prefetch);
+  // Remove all prefetched frames and emit prefetchedFramesInvalid
+  void invalidatePrefetchedFrames();
+  // Remove the frame from the frame cache if it is neither prefetched nor recently drawn. The statsCacheAccessMutex must be locked.
+  void removeUnusedFrame(int frameIdx);
+  // Get the cached statistics of the given frame. The data is implicitly shared so this is cheap.
+  QHash<int, statisticsData> getCachedStatistics(int frameIdx) const;
+
+  // Draw all given statistics of the given types. The painter must be translated so that (0,0) is the
+  // top left of the zoomed statistics. Only items in visibleRect are drawn.
+  void paintStatisticsData(QPainter *painter, const QHash<int, statisticsData> &statistics, const StatisticsTypeList &types, double zoomFactor, const QRect &visibleRect);
+
+  // The statistics are rasterized into images (layers) in the background. As long as the frame, zoom factor,
+  // visible area and the style of the statistics do not change, repainting only draws the image.
+  struct statisticsLayerKey
+  {
+    bool operator==(const statisticsLayerKey &other) const { return frameIdx == other.frameIdx && zoomFactor == other.zoomFactor && visibleRect == other.visibleRect && devicePixelRatio == other.devicePixelRatio && revision == other.revision; }
+    int frameIdx;
+    double zoomFactor;
+    QRect visibleRect;
+    qreal devicePixelRatio;
+    unsigned revision;
+  };
+  struct statisticsLayer
+  {
+    statisticsLayerKey key;
+    QImage image;
+  };
+  QList<statisticsLayer> layers;
+  // Incremented whenever the statistics or their style change. This invalidates all layers.
+  QAtomicInt layerRevision;
+  void invalidateLayers() { layerRevision.fetchAndAddOrdered(1); }
+  // Rasterize the given statistics for the layer with the given key. This runs in a worker thread (or in the GUI thread
+  // if there is nothing to show in the meantime). The statistics are an implicitly shared copy of the frame cache, so
+  // no lock is held while rasterizing. The font and pen are the ones of the target painter.
+  QImage rasterizeLayer(statisticsLayerKey key, QHash<int, statisticsData> statistics, StatisticsTypeList types, QFont font, QPen pen);
+  void addLayer(const statisticsLayer &layer);
+  QFutureWatcher<QImage> layerWatcher;
+  statisticsLayerKey pendingLayerKey;
 
   // The list of all statistics that this class can provide (and a backup for updating the list)
   StatisticsTypeList statsTypeList;
   StatisticsTypeList statsTypeListBackup;
+  // A copy of statsTypeList for the loading threads. It is replaced (under the statsCacheAccessMutex) whenever
+  // statsTypeList changes and is never changed in place.
+  StatisticsTypeList loadingTypeList;
+  void updateLoadingTypeList();
 
   // Primary controls for the statistics
   SafeUi<Ui::statisticHandler> ui;
@@ -157,7 +259,8 @@ private slots:
   void onStatisticsControlChanged();
   void onSecondaryStatisticsControlChanged();
   void onStyleButtonClicked(int id);
-  void updateStatisticItem() { emit updateItem(true); }
+  void updateStatisticItem() { invalidateLayers(); emit updateItem(true); }
+  void onLayerRasterized();
 };
 
 #endif
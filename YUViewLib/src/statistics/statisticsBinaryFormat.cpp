@@ -0,0 +1,509 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "statisticsBinaryFormat.h"
+
+#include <QBuffer>
+#include <QColor>
+#include <QDataStream>
+#include <QPen>
+#include <QtEndian>
+#include <climits>
+#include <cstring>
+
+namespace statisticsBinaryFormat
+{
+
+const char *fileExtension = "yuvstats";
+
+namespace
+{
+  const char magic[] = "YUVSTATS";
+  const int magicLength = 8;
+  const quint32 formatVersion = 1;
+  // The position of the frame table offset in the file (after the magic and the version)
+  const qint64 frameTableOffsetPos = magicLength + 4;
+
+  void setupStream(QDataStream &stream)
+  {
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setVersion(QDataStream::Qt_5_0);
+  }
+
+  void writeType(QDataStream &stream, const StatisticsType &t)
+  {
+    stream << qint32(t.typeID) << t.typeName << t.description << t.valMap;
+    stream << t.render << qint32(t.alphaFactor);
+    stream << t.hasValueData << t.renderValueData << t.scaleValueToBlockSize;
+    stream << qint32(t.colMapper.type) << qint32(t.colMapper.rangeMin) << qint32(t.colMapper.rangeMax);
+    stream << t.colMapper.minColor << t.colMapper.maxColor << t.colMapper.colorMap << t.colMapper.colorMapOther << t.colMapper.complexType;
+    stream << t.hasVectorData << t.hasAffineTFData << t.renderVectorData << t.renderVectorDataValues << t.scaleVectorToZoom;
+    stream << t.vectorPen << qint32(t.vectorScale) << t.mapVectorToColor << qint32(t.arrowHead);
+    stream << t.renderGrid << t.gridPen << t.scaleGridToZoom << t.isPolygon;
+  }
+
+  void readType(QDataStream &stream, StatisticsType &t)
+  {
+    qint32 typeID, alphaFactor, mapperType, rangeMin, rangeMax, vectorScale, arrowHead;
+    stream >> typeID >> t.typeName >> t.description >> t.valMap;
+    stream >> t.render >> alphaFactor;
+    stream >> t.hasValueData >> t.renderValueData >> t.scaleValueToBlockSize;
+    stream >> mapperType >> rangeMin >> rangeMax;
+    stream >> t.colMapper.minColor >> t.colMapper.maxColor >> t.colMapper.colorMap >> t.colMapper.colorMapOther >> t.colMapper.complexType;
+    stream >> t.hasVectorData >> t.hasAffineTFData >> t.renderVectorData >> t.renderVectorDataValues >> t.scaleVectorToZoom;
+    stream >> t.vectorPen >> vectorScale >> t.mapVectorToColor >> arrowHead;
+    stream >> t.renderGrid >> t.gridPen >> t.scaleGridToZoom >> t.isPolygon;
+
+    t.typeID = typeID;
+    t.alphaFactor = alphaFactor;
+    t.colMapper.type = colorMapper::mappingType(mapperType);
+    t.colMapper.rangeMin = rangeMin;
+    t.colMapper.rangeMax = rangeMax;
+    t.vectorScale = vectorScale;
+    t.arrowHead = StatisticsType::arrowHead_t(arrowHead);
+    t.setInitialState();
+  }
+
+  // Unsigned values are written as LEB128 varints, signed values are zigzag coded first
+  void appendUnsigned(QByteArray &out, quint32 value)
+  {
+    while (value >= 0x80)
+    {
+      out.append(char((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+    out.append(char(value));
+  }
+
+  void appendSigned(QByteArray &out, int value)
+  {
+    appendUnsigned(out, (quint32(value) << 1) ^ quint32(value >> 31));
+  }
+
+  template<typename T>
+  void appendUnsignedColumn(QByteArray &out, const QVector<T> &column)
+  {
+    for (const T &value : column)
+      appendUnsigned(out, quint32(value));
+  }
+
+  // Append a column of signed values. If isDelta is set, the difference to the previous value is written.
+  template<typename T>
+  void appendSignedColumn(QByteArray &out, const QVector<T> &column, bool isDelta)
+  {
+    int last = 0;
+    for (const T &value : column)
+    {
+      appendSigned(out, int(value) - last);
+      if (isDelta)
+        last = int(value);
+    }
+  }
+
+  void appendPointColumns(QByteArray &out, const QVector<QPoint> &points, bool isDelta)
+  {
+    for (int c = 0; c < 2; c++)
+    {
+      int last = 0;
+      for (const QPoint &p : points)
+      {
+        const int value = (c == 0) ? p.x() : p.y();
+        appendSigned(out, value - last);
+        if (isDelta)
+          last = value;
+      }
+    }
+  }
+
+  // Append the number of blocks and the positions and sizes of the blocks as columns
+  void appendBlockColumns(QByteArray &out, const statisticsBlockArrays &blocks)
+  {
+    appendUnsigned(out, quint32(blocks.size()));
+    appendSignedColumn(out, blocks.posX, true);
+    appendSignedColumn(out, blocks.posY, true);
+    appendUnsignedColumn(out, blocks.width);
+    appendUnsignedColumn(out, blocks.height);
+  }
+
+  // Append the number of polygons, the number of corners of each polygon and the corners as columns
+  void appendPolygonColumns(QByteArray &out, const statisticsPolygonArrays &polygons)
+  {
+    appendUnsigned(out, quint32(polygons.size()));
+    for (int i = 0; i < polygons.size(); i++)
+      appendUnsigned(out, quint32(polygons.getNrCorners(i)));
+    appendPointColumns(out, polygons.corners, true);
+  }
+
+  void appendTypeBlock(QByteArray &out, const statisticsData &data)
+  {
+    appendBlockColumns(out, data.valueData);
+    appendSignedColumn(out, data.valueData.value, false);
+
+    const statisticsVectorArrays &vectors = data.vectorData;
+    appendBlockColumns(out, vectors);
+    appendUnsignedColumn(out, vectors.isLine);
+    appendPointColumns(out, vectors.point0, false);
+    // The second point is only written for lines
+    for (int c = 0; c < 2; c++)
+      for (int i = 0; i < vectors.size(); i++)
+        if (vectors.isLine[i])
+          appendSigned(out, (c == 0) ? vectors.point1[i].x() : vectors.point1[i].y());
+
+    appendBlockColumns(out, data.affineTFData);
+    for (int k = 0; k < 3; k++)
+      appendPointColumns(out, data.affineTFData.point[k], false);
+
+    appendPolygonColumns(out, data.polygonValueData);
+    appendSignedColumn(out, data.polygonValueData.value, false);
+
+    appendPolygonColumns(out, data.polygonVectorData);
+    appendPointColumns(out, data.polygonVectorData.point, false);
+  }
+
+  class cursor
+  {
+  public:
+    cursor(const uchar *begin, const uchar *end) : p(begin), end(end) {}
+
+    quint32 readUnsigned()
+    {
+      quint32 value = 0;
+      for (int shift = 0; shift < 35; shift += 7)
+      {
+        if (p == end)
+        {
+          ok = false;
+          return 0;
+        }
+        const uchar byte = *p++;
+        value |= quint32(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+          return value;
+      }
+      ok = false;
+      return 0;
+    }
+    int readSigned()
+    {
+      const quint32 value = readUnsigned();
+      return int(value >> 1) ^ -int(value & 1);
+    }
+    // Read a number of items that can not be more than the remaining bytes
+    int readCount()
+    {
+      const quint32 count = readUnsigned();
+      if (count > quint32(end - p))
+      {
+        ok = false;
+        return 0;
+      }
+      return int(count);
+    }
+    void readColumn(QVector<int> &column, int count, bool isSigned, bool isDelta)
+    {
+      column.resize(count);
+      int last = 0;
+      for (int i = 0; i < count; i++)
+      {
+        int value = isSigned ? readSigned() : int(readUnsigned());
+        if (isDelta)
+        {
+          value += last;
+          last = value;
+        }
+        column[i] = value;
+      }
+    }
+
+    const uchar *p;
+    const uchar *end;
+    bool ok {true};
+  };
+}
+
+bool writer::open(const QString &filePath, const QSize &frameSize, double frameRate, const StatisticsTypeList &types)
+{
+  this->file.setFileName(filePath);
+  if (!this->file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+  this->frameOffsets.clear();
+
+  QDataStream stream(&this->file);
+  setupStream(stream);
+  stream.writeRawData(magic, magicLength);
+  stream << formatVersion << quint64(0);
+  stream << frameSize << frameRate << qint32(types.size());
+  for (const StatisticsType &t : types)
+    writeType(stream, t);
+  return stream.status() == QDataStream::Ok;
+}
+
+bool writer::writeFrame(int frameIdx, const QHash<int, statisticsData> &frameData)
+{
+  if (frameIdx < 0 || !this->file.isOpen())
+    return false;
+  if (frameIdx >= this->frameOffsets.size())
+    this->frameOffsets.resize(frameIdx + 1);
+  if (this->frameOffsets[frameIdx] != 0)
+    return false;
+
+  QByteArray block;
+  this->frameBuffer.clear();
+  appendUnsigned(this->frameBuffer, quint32(frameData.size()));
+  for (auto it = frameData.constBegin(); it != frameData.constEnd(); it++)
+  {
+    block.clear();
+    appendTypeBlock(block, it.value());
+    appendSigned(this->frameBuffer, it.key());
+    appendUnsigned(this->frameBuffer, quint32(block.size()));
+    this->frameBuffer.append(block);
+  }
+
+  this->frameOffsets[frameIdx] = quint64(this->file.pos());
+  return this->file.write(this->frameBuffer) == this->frameBuffer.size();
+}
+
+bool writer::close()
+{
+  if (!this->file.isOpen())
+    return false;
+
+  const quint64 frameTableOffset = quint64(this->file.pos());
+  QDataStream stream(&this->file);
+  setupStream(stream);
+  stream << quint32(this->frameOffsets.size());
+  for (quint64 offset : this->frameOffsets)
+    stream << offset;
+
+  this->file.seek(frameTableOffsetPos);
+  stream << frameTableOffset;
+  const bool ok = (stream.status() == QDataStream::Ok);
+  this->file.close();
+  return ok;
+}
+
+reader::~reader()
+{
+  if (this->fileData != nullptr)
+    this->file.unmap(const_cast<uchar*>(this->fileData));
+}
+
+bool reader::open(const QString &filePath)
+{
+  this->file.setFileName(filePath);
+  if (!this->file.open(QIODevice::ReadOnly))
+  {
+    this->error = "Error opening the file.";
+    return false;
+  }
+  this->fileSize = this->file.size();
+  if (this->fileSize > 0)
+    this->fileData = this->file.map(0, this->fileSize);
+  if (this->fileData == nullptr)
+  {
+    this->error = "Error mapping the file.";
+    return false;
+  }
+
+  QByteArray rawData = QByteArray::fromRawData(reinterpret_cast<const char*>(this->fileData), int(qMin(this->fileSize, qint64(INT_MAX))));
+  QBuffer buffer(&rawData);
+  buffer.open(QIODevice::ReadOnly);
+  QDataStream stream(&buffer);
+  setupStream(stream);
+
+  char fileMagic[magicLength];
+  quint32 version;
+  quint64 frameTableOffset;
+  qint32 nrTypes;
+  if (stream.readRawData(fileMagic, magicLength) != magicLength || std::memcmp(fileMagic, magic, magicLength) != 0)
+  {
+    this->error = "The file is not a binary statistics file.";
+    return false;
+  }
+  stream >> version >> frameTableOffset;
+  if (version != formatVersion)
+  {
+    this->error = QString("Unsupported version %1 of the binary statistics file.").arg(version);
+    return false;
+  }
+  stream >> this->frameSize >> this->frameRate >> nrTypes;
+  for (int i = 0; i < nrTypes && stream.status() == QDataStream::Ok; i++)
+  {
+    StatisticsType t;
+    readType(stream, t);
+    this->types.append(t);
+  }
+
+  if (stream.status() != QDataStream::Ok)
+  {
+    this->error = "The header of the binary statistics file is corrupt.";
+    return false;
+  }
+
+  // The frame table is read directly from the mapped file because it may be located beyond 2GB
+  if (frameTableOffset < quint64(buffer.pos()) || frameTableOffset + 4 > quint64(this->fileSize))
+  {
+    this->error = "The frame table of the binary statistics file is corrupt.";
+    return false;
+  }
+  const uchar *frameTable = this->fileData + frameTableOffset;
+  const quint32 nrFrames = qFromLittleEndian<quint32>(frameTable);
+  if (quint64(nrFrames) * 8 > quint64(this->fileSize) - frameTableOffset - 4)
+  {
+    this->error = "The frame table of the binary statistics file is corrupt.";
+    return false;
+  }
+  this->frameOffsets.resize(int(nrFrames));
+  for (quint32 i = 0; i < nrFrames; i++)
+    this->frameOffsets[i] = qFromLittleEndian<quint64>(frameTable + 4 + i * 8);
+  return true;
+}
+
+bool reader::readFrameType(int frameIdx, int typeID, statisticsData &data)
+{
+  if (frameIdx < 0 || frameIdx >= this->frameOffsets.size())
+    return false;
+  const quint64 frameOffset = this->frameOffsets[frameIdx];
+  if (frameOffset == 0 || frameOffset >= quint64(this->fileSize))
+    return false;
+
+  // Skip the blocks of the other types
+  cursor c(this->fileData + frameOffset, this->fileData + this->fileSize);
+  const int nrTypeBlocks = c.readCount();
+  for (int i = 0; i < nrTypeBlocks && c.ok; i++)
+  {
+    const int blockTypeID = c.readSigned();
+    const int blockSize = c.readCount();
+    if (!c.ok)
+      return false;
+    if (blockTypeID != typeID)
+    {
+      c.p += blockSize;
+      continue;
+    }
+
+    cursor b(c.p, c.p + blockSize);
+    QVector<int> *col = this->columns;
+
+    // Values: x, y, w, h, value
+    int n = b.readCount();
+    b.readColumn(col[0], n, true, true);
+    b.readColumn(col[1], n, true, true);
+    b.readColumn(col[2], n, false, false);
+    b.readColumn(col[3], n, false, false);
+    b.readColumn(col[4], n, true, false);
+    if (!b.ok)
+      return false;
+    data.valueData.reserve(data.valueData.size() + n);
+    for (int j = 0; j < n; j++)
+      data.addBlockValue(col[0][j], col[1][j], col[2][j], col[3][j], col[4][j]);
+
+    // Vectors and lines: x, y, w, h, isLine, vector x/y, second point x/y (only for lines)
+    n = b.readCount();
+    for (int k = 0; k < 4; k++)
+      b.readColumn(col[k], n, k < 2, k < 2);
+    b.readColumn(col[4], n, false, false);
+    b.readColumn(col[5], n, true, false);
+    b.readColumn(col[6], n, true, false);
+    int nrLines = 0;
+    for (int j = 0; j < n; j++)
+      if (col[4][j] != 0)
+        nrLines++;
+    b.readColumn(col[7], nrLines, true, false);
+    b.readColumn(col[8], nrLines, true, false);
+    if (!b.ok)
+      return false;
+    data.vectorData.reserve(data.vectorData.size() + n);
+    for (int j = 0, line = 0; j < n; j++)
+    {
+      if (col[4][j] != 0)
+      {
+        data.addLine(col[0][j], col[1][j], col[2][j], col[3][j], col[5][j], col[6][j], col[7][line], col[8][line]);
+        line++;
+      }
+      else
+        data.addBlockVector(col[0][j], col[1][j], col[2][j], col[3][j], col[5][j], col[6][j]);
+    }
+
+    // Affine transforms: x, y, w, h, 3 vectors
+    n = b.readCount();
+    for (int k = 0; k < 10; k++)
+      b.readColumn(col[k], n, k < 2 || k >= 4, k < 2);
+    if (!b.ok)
+      return false;
+    data.affineTFData.reserve(data.affineTFData.size() + n);
+    for (int j = 0; j < n; j++)
+      data.addBlockAffineTF(col[0][j], col[1][j], col[2][j], col[3][j], col[4][j], col[5][j], col[6][j], col[7][j], col[8][j], col[9][j]);
+
+    // Polygons: number of corners, corners x, corners y, value or vector x/y
+    QVector<QPoint> points;
+    for (int polygonType = 0; polygonType < 2; polygonType++)
+    {
+      n = b.readCount();
+      b.readColumn(col[0], n, false, false);
+      if (!b.ok)
+        return false;
+      // Every corner takes at least one byte. Checking each count against the remaining bytes also
+      // prevents the sum from overflowing.
+      const int bytesLeft = int(b.end - b.p);
+      int nrCorners = 0;
+      for (int j = 0; j < n; j++)
+      {
+        if (col[0][j] < 0 || col[0][j] > bytesLeft - nrCorners)
+          return false;
+        nrCorners += col[0][j];
+      }
+      b.readColumn(col[1], nrCorners, true, true);
+      b.readColumn(col[2], nrCorners, true, true);
+      b.readColumn(col[3], n, true, false);
+      if (polygonType == 1)
+        b.readColumn(col[4], n, true, false);
+      if (!b.ok)
+        return false;
+      for (int j = 0, corner = 0; j < n; j++)
+      {
+        points.clear();
+        for (int k = 0; k < col[0][j]; k++, corner++)
+          points.append(QPoint(col[1][corner], col[2][corner]));
+        if (polygonType == 0)
+          data.addPolygonValue(points, col[3][j]);
+        else
+          data.addPolygonVector(points, col[3][j], col[4][j]);
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+}
@@ -0,0 +1,108 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef STATISTICSBINARYFORMAT_H
+#define STATISTICSBINARYFORMAT_H
+
+#include <QFile>
+#include <QHash>
+#include <QSize>
+#include <QVector>
+
+#include "statistics/statisticHandler.h"
+#include "statistics/statisticsExtensions.h"
+
+/* A compact binary container for statistics which can be loaded without parsing text.
+ *
+ * File layout (all fixed size values little endian):
+ *  - 8 bytes magic "YUVSTATS", quint32 version, quint64 offset of the frame table
+ *  - The header as a QDataStream: frame size, frame rate and the list of StatisticsTypes
+ *  - The frames. Each frame holds one block per type. A block contains the items of the type in columns
+ *    (x, y, w, h, values ...). All columns are varint coded, positions as the difference to the previous item.
+ *  - The frame table: quint32 number of frames and a quint64 file offset per frame (0 if the frame has no data)
+ */
+namespace statisticsBinaryFormat
+{
+  // The file extension of binary statistics files
+  extern const char *fileExtension;
+
+  class writer
+  {
+  public:
+    bool open(const QString &filePath, const QSize &frameSize, double frameRate, const StatisticsTypeList &types);
+    // Write the statistics of all types of one frame. Every frame can only be written once.
+    bool writeFrame(int frameIdx, const QHash<int, statisticsData> &frameData);
+    // Write the frame table. The file is not valid before this was called.
+    bool close();
+
+  private:
+    QFile file;
+    QVector<quint64> frameOffsets;
+    QByteArray frameBuffer;
+  };
+
+  class reader
+  {
+  public:
+    ~reader();
+
+    // Map the file and read the header and the frame table
+    bool open(const QString &filePath);
+    QString getError() const { return error; }
+
+    QSize getFrameSize() const { return frameSize; }
+    double getFrameRate() const { return frameRate; }
+    StatisticsTypeList getTypes() const { return types; }
+    int getNrFrames() const { return frameOffsets.size(); }
+
+    // Read the items of the given type in the given frame and add them to data.
+    // Return false if the frame does not contain the type or if the data is corrupt.
+    bool readFrameType(int frameIdx, int typeID, statisticsData &data);
+
+  private:
+    QFile file;
+    const uchar *fileData {nullptr};
+    qint64 fileSize {0};
+    QString error;
+
+    QSize frameSize;
+    double frameRate {0.0};
+    StatisticsTypeList types;
+    QVector<quint64> frameOffsets;
+
+    // Decoded columns. These are kept to not allocate them for every frame.
+    QVector<int> columns[10];
+  };
+}
+
+#endif // STATISTICSBINARYFORMAT_H
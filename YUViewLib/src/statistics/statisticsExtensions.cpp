@@ -32,6 +32,7 @@
 
 #include "statisticsExtensions.h"
 
+#include <algorithm>
 #include <cmath>
 #include <random>
 
@@ -302,7 +303,7 @@ void StatisticsType::loadPlaylist(const YUViewDomElement &root)
 
 // If the internal valueMap can map the value to text, text and value will be returned.
 // Otherwise just the value as QString will be returned.
-QString StatisticsType::getValueTxt(int val)
+QString StatisticsType::getValueTxt(int val) const
 {
   if (valMap.contains(val))
   {
@@ -312,83 +313,435 @@ QString StatisticsType::getValueTxt(int val)
   return QString("%1").arg(val);
 }
 
+void statisticsBlockIndex::build(const statisticsBlockArrays &blocks)
+{
+  const int cellSize = 1 << cellSizeLog2;
+  nrBlocks = blocks.size();
+  nrCellsX = 0;
+  nrCellsY = 0;
+  for (int i = 0; i < nrBlocks; i++)
+  {
+    nrCellsX = std::max(nrCellsX, (blocks.posX[i] >> cellSizeLog2) + 1);
+    nrCellsY = std::max(nrCellsY, (blocks.posY[i] >> cellSizeLog2) + 1);
+  }
+
+  // Count the blocks per cell, then sort them into the cells (counting sort). Within a cell the blocks stay in order.
+  cellStart.fill(0, nrCellsX * nrCellsY + 1);
+  largeBlocks.clear();
+  for (int i = 0; i < nrBlocks; i++)
+  {
+    if (blocks.width[i] > cellSize || blocks.height[i] > cellSize)
+      largeBlocks.append(i);
+    else
+      cellStart[(blocks.posY[i] >> cellSizeLog2) * nrCellsX + (blocks.posX[i] >> cellSizeLog2) + 1]++;
+  }
+  for (int c = 0; c < nrCellsX * nrCellsY; c++)
+    cellStart[c + 1] += cellStart[c];
+
+  cellBlocks.resize(nrBlocks - largeBlocks.size());
+  QVector<int> cellFill = cellStart;
+  for (int i = 0; i < nrBlocks; i++)
+  {
+    if (blocks.width[i] <= cellSize && blocks.height[i] <= cellSize)
+      cellBlocks[cellFill[(blocks.posY[i] >> cellSizeLog2) * nrCellsX + (blocks.posX[i] >> cellSizeLog2)]++] = i;
+  }
+}
+
+bool statisticsBlockIndex::isValid(const statisticsBlockArrays &blocks) const
+{
+  return nrBlocks == blocks.size();
+}
+
+void statisticsBlockIndex::getBlocksInRect(const statisticsBlockArrays &blocks, const QRect &rect, QVector<int> &indices) const
+{
+  indices.clear();
+  if (!isValid(blocks))
+  {
+    indices.reserve(blocks.size());
+    for (int i = 0; i < blocks.size(); i++)
+      indices.append(i);
+    return;
+  }
+
+  // A block that overlaps the rect can start up to one cell left/above of it
+  const int cellSize = 1 << cellSizeLog2;
+  const int cellX0 = std::max((rect.left() - cellSize) >> cellSizeLog2, 0);
+  const int cellY0 = std::max((rect.top() - cellSize) >> cellSizeLog2, 0);
+  const int cellX1 = std::min(rect.right() >> cellSizeLog2, nrCellsX - 1);
+  const int cellY1 = std::min(rect.bottom() >> cellSizeLog2, nrCellsY - 1);
+  for (int y = cellY0; y <= cellY1; y++)
+    for (int x = cellX0; x <= cellX1; x++)
+    {
+      const int c = y * nrCellsX + x;
+      for (int j = cellStart[c]; j < cellStart[c + 1]; j++)
+        indices.append(cellBlocks[j]);
+    }
+  indices.append(largeBlocks);
+
+  // Keep the order in which the blocks were added (the drawing order)
+  std::sort(indices.begin(), indices.end());
+}
+
+// The size of the area that is covered by the blocks (starting at 0,0)
+static QSize getBlocksExtent(const statisticsBlockArrays &blocks)
+{
+  int width = 0;
+  int height = 0;
+  for (int i = 0; i < blocks.size(); i++)
+  {
+    width = std::max(width, blocks.posX[i] + blocks.width[i]);
+    height = std::max(height, blocks.posY[i] + blocks.height[i]);
+  }
+  return QSize(width, height);
+}
+
+static int getNrCells(int size, int cellSizeLog2)
+{
+  return ((size - 1) >> cellSizeLog2) + 1;
+}
+
+// The finest cell size (not smaller than minCellSizeLog2) for which there are fewer cells than nrBlocks
+static int getFinestLevel(const QSize &extent, int nrBlocks, int minCellSizeLog2)
+{
+  int cellSizeLog2 = minCellSizeLog2;
+  while (qint64(getNrCells(extent.width(), cellSizeLog2)) * getNrCells(extent.height(), cellSizeLog2) >= nrBlocks)
+    cellSizeLog2++;
+  return cellSizeLog2;
+}
+
+// The area that a value covers in a cell. The cell is the index of the cell in the level (y << 16 | x).
+struct cellValue
+{
+  bool operator<(const cellValue &other) const { return cell < other.cell || (cell == other.cell && value < other.value); }
+  quint32 cell;
+  int value;
+  qint64 area;
+  // The area multiplied with the value divided by its block size
+  double areaPerPixel;
+};
+
+void statisticsLevelOfDetail::buildValueLevels(const statisticsValueArrays &values)
+{
+  valueLevels.clear();
+  if (values.size() <= 1)
+    return;
+
+  const QSize extent = getBlocksExtent(values);
+  if (extent.isEmpty())
+    return;
+  int cellSizeLog2 = getFinestLevel(extent, values.size(), firstCellSizeLog2);
+
+  // Split the blocks into the parts that they cover in each cell of the finest level
+  QVector<cellValue> cellValues;
+  cellValues.reserve(values.size());
+  for (int i = 0; i < values.size(); i++)
+  {
+    const int x = values.posX[i], y = values.posY[i], w = values.width[i], h = values.height[i];
+    if (w == 0 || h == 0)
+      continue;
+    for (int cy = y >> cellSizeLog2; cy <= (y + h - 1) >> cellSizeLog2; cy++)
+    {
+      const int overlapY = std::min(y + h, (cy + 1) << cellSizeLog2) - std::max(y, cy << cellSizeLog2);
+      for (int cx = x >> cellSizeLog2; cx <= (x + w - 1) >> cellSizeLog2; cx++)
+      {
+        const int overlapX = std::min(x + w, (cx + 1) << cellSizeLog2) - std::max(x, cx << cellSizeLog2);
+        const qint64 area = qint64(overlapX) * overlapY;
+        cellValues.append({quint32(cy) << 16 | quint32(cx), values.value[i], area, double(values.value[i]) / (w * h) * area});
+      }
+    }
+  }
+
+  // Each level is aggregated from the (merged) cell values of the level before
+  while (true)
+  {
+    // Merge the entries of the same value in a cell
+    std::sort(cellValues.begin(), cellValues.end());
+    int nrMerged = 0;
+    for (int i = 0; i < cellValues.size(); i++)
+    {
+      if (nrMerged > 0 && cellValues[nrMerged - 1].cell == cellValues[i].cell && cellValues[nrMerged - 1].value == cellValues[i].value)
+      {
+        cellValues[nrMerged - 1].area += cellValues[i].area;
+        cellValues[nrMerged - 1].areaPerPixel += cellValues[i].areaPerPixel;
+      }
+      else
+        cellValues[nrMerged++] = cellValues[i];
+    }
+    cellValues.resize(nrMerged);
+
+    valueLevel level;
+    level.cellSizeLog2 = cellSizeLog2;
+    level.nrCellsX = getNrCells(extent.width(), cellSizeLog2);
+    level.nrCellsY = getNrCells(extent.height(), cellSizeLog2);
+    const int nrCells = level.nrCellsX * level.nrCellsY;
+    level.covered.fill(false, nrCells);
+    level.mode.fill(0, nrCells);
+    level.mean.fill(0, nrCells);
+    level.meanPerPixel.fill(0, nrCells);
+    for (int start = 0; start < cellValues.size();)
+    {
+      const quint32 cell = cellValues[start].cell;
+      qint64 area = 0, modeArea = 0;
+      double valueSum = 0, perPixelSum = 0;
+      int mode = 0;
+      int i = start;
+      for (; i < cellValues.size() && cellValues[i].cell == cell; i++)
+      {
+        area += cellValues[i].area;
+        valueSum += double(cellValues[i].value) * cellValues[i].area;
+        perPixelSum += cellValues[i].areaPerPixel;
+        if (cellValues[i].area > modeArea)
+        {
+          mode = cellValues[i].value;
+          modeArea = cellValues[i].area;
+        }
+      }
+      const int idx = int(cell >> 16) * level.nrCellsX + int(cell & 0xffff);
+      level.covered[idx] = true;
+      level.mode[idx] = mode;
+      level.mean[idx] = float(valueSum / area);
+      level.meanPerPixel[idx] = float(perPixelSum / area);
+      start = i;
+    }
+    valueLevels.append(level);
+
+    if (nrCells == 1)
+      break;
+
+    // Move the values to the cells of the next coarser level
+    for (cellValue &v : cellValues)
+      v.cell = (v.cell >> 17) << 16 | (v.cell & 0xffff) >> 1;
+    cellSizeLog2++;
+  }
+}
+
+void statisticsLevelOfDetail::buildVectorLevels(const statisticsVectorArrays &vectors)
+{
+  vectorLevels.clear();
+  const int nrVectors = int(vectors.isLine.count(false));
+  vectorLines = nrVectors < vectors.size();
+  if (nrVectors <= 1)
+    return;
+
+  const QSize extent = getBlocksExtent(vectors);
+  if (extent.isEmpty())
+    return;
+  int cellSizeLog2 = getFinestLevel(extent, nrVectors, firstCellSizeLog2);
+
+  // Sum up the vectors (weighted by the covered area) in the cells of the finest level
+  int nrCellsX = getNrCells(extent.width(), cellSizeLog2);
+  int nrCellsY = getNrCells(extent.height(), cellSizeLog2);
+  QVector<double> sumX(nrCellsX * nrCellsY, 0), sumY(nrCellsX * nrCellsY, 0), sumArea(nrCellsX * nrCellsY, 0);
+  for (int i = 0; i < vectors.size(); i++)
+  {
+    if (vectors.isLine[i])
+      continue;
+    const int x = vectors.posX[i], y = vectors.posY[i], w = vectors.width[i], h = vectors.height[i];
+    for (int cy = y >> cellSizeLog2; h > 0 && cy <= (y + h - 1) >> cellSizeLog2; cy++)
+    {
+      const int overlapY = std::min(y + h, (cy + 1) << cellSizeLog2) - std::max(y, cy << cellSizeLog2);
+      for (int cx = x >> cellSizeLog2; w > 0 && cx <= (x + w - 1) >> cellSizeLog2; cx++)
+      {
+        const int overlapX = std::min(x + w, (cx + 1) << cellSizeLog2) - std::max(x, cx << cellSizeLog2);
+        const double area = double(overlapX) * overlapY;
+        const int idx = cy * nrCellsX + cx;
+        sumX[idx] += vectors.point0[i].x() * area;
+        sumY[idx] += vectors.point0[i].y() * area;
+        sumArea[idx] += area;
+      }
+    }
+  }
+
+  while (true)
+  {
+    vectorLevel level;
+    level.cellSizeLog2 = cellSizeLog2;
+    level.nrCellsX = nrCellsX;
+    level.nrCellsY = nrCellsY;
+    level.covered.resize(nrCellsX * nrCellsY);
+    level.vector.resize(nrCellsX * nrCellsY);
+    for (int idx = 0; idx < nrCellsX * nrCellsY; idx++)
+    {
+      level.covered[idx] = sumArea[idx] > 0;
+      if (level.covered[idx])
+        level.vector[idx] = QPoint(qRound(sumX[idx] / sumArea[idx]), qRound(sumY[idx] / sumArea[idx]));
+    }
+    vectorLevels.append(level);
+
+    if (nrCellsX * nrCellsY == 1)
+      break;
+
+    // Add up the sums of 2x2 cells for the next coarser level
+    const int nextCellsX = (nrCellsX + 1) / 2;
+    const int nextCellsY = (nrCellsY + 1) / 2;
+    QVector<double> nextX(nextCellsX * nextCellsY, 0), nextY(nextCellsX * nextCellsY, 0), nextArea(nextCellsX * nextCellsY, 0);
+    for (int cy = 0; cy < nrCellsY; cy++)
+      for (int cx = 0; cx < nrCellsX; cx++)
+      {
+        const int idx = cy * nrCellsX + cx;
+        const int nextIdx = (cy / 2) * nextCellsX + cx / 2;
+        nextX[nextIdx] += sumX[idx];
+        nextY[nextIdx] += sumY[idx];
+        nextArea[nextIdx] += sumArea[idx];
+      }
+    sumX.swap(nextX);
+    sumY.swap(nextY);
+    sumArea.swap(nextArea);
+    nrCellsX = nextCellsX;
+    nrCellsY = nextCellsY;
+    cellSizeLog2++;
+  }
+}
+
+template <typename T>
+static const T *getLevel(const QVector<T> &levels, int cellSizeLog2)
+{
+  if (levels.isEmpty() || cellSizeLog2 < levels.first().cellSizeLog2)
+    return nullptr;
+  return &levels[std::min(cellSizeLog2 - levels.first().cellSizeLog2, levels.size() - 1)];
+}
+
+const statisticsLevelOfDetail::valueLevel *statisticsLevelOfDetail::getValueLevel(int cellSizeLog2) const
+{
+  return getLevel(valueLevels, cellSizeLog2);
+}
+
+const statisticsLevelOfDetail::vectorLevel *statisticsLevelOfDetail::getVectorLevel(int cellSizeLog2) const
+{
+  return getLevel(vectorLevels, cellSizeLog2);
+}
+
+int statisticsLevelOfDetail::getCellSizeLog2(double zoomFactor, int minCellSize)
+{
+  int cellSizeLog2 = 0;
+  while ((1 << cellSizeLog2) * zoomFactor < minCellSize && cellSizeLog2 < 30)
+    cellSizeLog2++;
+  return cellSizeLog2;
+}
+
+template <typename T>
+static qint64 getVectorMemorySize(const QVector<T> &v)
+{
+  return qint64(v.capacity()) * sizeof(T);
+}
+
+qint64 statisticsBlockIndex::getMemorySize() const
+{
+  return getVectorMemorySize(cellStart) + getVectorMemorySize(cellBlocks) + getVectorMemorySize(largeBlocks);
+}
+
+static qint64 getBlocksMemorySize(const statisticsBlockArrays &blocks)
+{
+  return getVectorMemorySize(blocks.posX) + getVectorMemorySize(blocks.posY) + getVectorMemorySize(blocks.width) + getVectorMemorySize(blocks.height) + blocks.index.getMemorySize();
+}
+
+static qint64 getPolygonsMemorySize(const statisticsPolygonArrays &polygons)
+{
+  return getVectorMemorySize(polygons.corners) + getVectorMemorySize(polygons.cornerStart);
+}
+
+qint64 statisticsLevelOfDetail::getMemorySize() const
+{
+  qint64 size = 0;
+  for (const valueLevel &l : valueLevels)
+    size += getVectorMemorySize(l.covered) + getVectorMemorySize(l.mode) + getVectorMemorySize(l.mean) + getVectorMemorySize(l.meanPerPixel);
+  for (const vectorLevel &l : vectorLevels)
+    size += getVectorMemorySize(l.covered) + getVectorMemorySize(l.vector);
+  return size;
+}
+
+qint64 statisticsData::getMemorySize() const
+{
+  qint64 size = sizeof(statisticsData);
+  size += getBlocksMemorySize(valueData) + getVectorMemorySize(valueData.value);
+  size += getBlocksMemorySize(vectorData) + getVectorMemorySize(vectorData.isLine) + getVectorMemorySize(vectorData.point0) + getVectorMemorySize(vectorData.point1);
+  size += getBlocksMemorySize(affineTFData);
+  for (int i = 0; i < 3; i++)
+    size += getVectorMemorySize(affineTFData.point[i]);
+  size += getPolygonsMemorySize(polygonValueData) + getVectorMemorySize(polygonValueData.value);
+  size += getPolygonsMemorySize(polygonVectorData) + getVectorMemorySize(polygonVectorData.point);
+  size += levelOfDetail.getMemorySize();
+  return size;
+}
+
+void statisticsData::buildIndex()
+{
+  if (!valueData.index.isValid(valueData))
+  {
+    valueData.index.build(valueData);
+    levelOfDetail.buildValueLevels(valueData);
+  }
+  if (!vectorData.index.isValid(vectorData) || !affineTFData.index.isValid(affineTFData))
+  {
+    vectorData.index.build(vectorData);
+    levelOfDetail.buildVectorLevels(vectorData);
+    affineTFData.index.build(affineTFData);
+
+    maxVectorComponent = 0;
+    auto updateMax = [this](const QVector<QPoint> &points)
+    {
+      for (const QPoint &p : points)
+        maxVectorComponent = std::max(maxVectorComponent, std::max(std::abs(p.x()), std::abs(p.y())));
+    };
+    updateMax(vectorData.point0);
+    updateMax(vectorData.point1);
+    for (int i = 0; i < 3; i++)
+      updateMax(affineTFData.point[i]);
+  }
+}
+
 void statisticsData::addBlockValue(unsigned short x, unsigned short y, unsigned short w, unsigned short h, int val)
 {
-  statisticsItem_Value value;
-  value.pos[0] = x;
-  value.pos[1] = y;
-  value.size[0] = w;
-  value.size[1] = h;
-  value.value = val;
+  valueData.appendBlock(x, y, w, h);
+  valueData.value.append(val);
 
   // Always keep the biggest block size updated.
   unsigned int wh = w*h;
   if (wh > maxBlockSize)
     maxBlockSize = wh;
-
-  valueData.append(value);
 }
 
 void statisticsData::addBlockVector(unsigned short x, unsigned short y, unsigned short w, unsigned short h, int vecX, int vecY)
 {
-  statisticsItem_Vector vec;
-  vec.pos[0] = x;
-  vec.pos[1] = y;
-  vec.size[0] = w;
-  vec.size[1] = h;
-  vec.point[0] = QPoint(vecX,vecY);
-  vec.isLine = false;
-  vectorData.append(vec);
+  vectorData.appendBlock(x, y, w, h);
+  vectorData.isLine.append(false);
+  vectorData.point0.append(QPoint(vecX,vecY));
+  vectorData.point1.append(QPoint());
 }
 
 void statisticsData::addBlockAffineTF(unsigned short x, unsigned short y, unsigned short w, unsigned short h, int vecX0, int vecY0, int vecX1, int vecY1, int vecX2, int vecY2)
 {
-  statisticsItem_AffineTF affineTF;
-  affineTF.pos[0] = x;
-  affineTF.pos[1] = y;
-  affineTF.size[0] = w;
-  affineTF.size[1] = h;
-  affineTF.point[0] = QPoint(vecX0,vecY0);
-  affineTF.point[1] = QPoint(vecX1,vecY1);
-  affineTF.point[2] = QPoint(vecX2,vecY2);
-  affineTFData.append(affineTF);
+  affineTFData.appendBlock(x, y, w, h);
+  affineTFData.point[0].append(QPoint(vecX0,vecY0));
+  affineTFData.point[1].append(QPoint(vecX1,vecY1));
+  affineTFData.point[2].append(QPoint(vecX2,vecY2));
 }
 
 
 void statisticsData::addLine(unsigned short x, unsigned short y, unsigned short w, unsigned short h, int x1, int y1, int x2, int y2)
 {
-  statisticsItem_Vector vec;
-  vec.pos[0] = x;
-  vec.pos[1] = y;
-  vec.size[0] = w;
-  vec.size[1] = h;
-  vec.point[0] = QPoint(x1,y1);
-  vec.point[1] = QPoint(x2,y2);
-  vec.isLine = true;
-  vectorData.append(vec);
+  vectorData.appendBlock(x, y, w, h);
+  vectorData.isLine.append(true);
+  vectorData.point0.append(QPoint(x1,y1));
+  vectorData.point1.append(QPoint(x2,y2));
 }
 
 void statisticsData::addPolygonValue(const QVector<QPoint> &points, int val)
 {
-  statisticsItemPolygon_Value value;
-  value.corners = QPolygon(points);
-  value.value = val;
+  polygonValueData.appendPolygon(points);
+  polygonValueData.value.append(val);
 
 // todo: how to do this nicely?
 //  // Always keep the biggest block size updated.
 //  unsigned int wh = w*h;
 //  if (wh > maxBlockSize)
 //    maxBlockSize = wh;
-
-  polygonValueData.append(value);
 }
 
 void statisticsData::addPolygonVector(const QVector<QPoint> &points, int vecX, int vecY)
 {
-  statisticsItemPolygon_Vector vec;
-  vec.corners = QPolygon(points);
-  vec.point[0] = QPoint(vecX,vecY);
-  polygonVectorData.append(vec);
+  polygonVectorData.appendPolygon(points);
+  polygonVectorData.point.append(QPoint(vecX,vecY));
 }
 
 // Setup an invalid (uninitialized color mapper)
@@ -429,7 +782,7 @@ colorMapper::colorMapper(const QString &rangeName, int min, int max)
   colorMapOther = Qt::black;
 }
 
-QColor colorMapper::getColor(int value)
+QColor colorMapper::getColor(int value) const
 {
   if (type == map)
   {
@@ -444,7 +797,7 @@ QColor colorMapper::getColor(int value)
   }
 }
 
-QColor colorMapper::getColor(float value)
+QColor colorMapper::getColor(float value) const
 {
   if (type == map)
     // Round and use the integer value to get the value from the map
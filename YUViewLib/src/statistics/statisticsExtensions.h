@@ -36,6 +36,9 @@
 #include <QColor>
 #include <QMap>
 #include <QPen>
+#include <QPolygon>
+#include <QRect>
+#include <QVector>
 
 class YUViewDomElement;
 
@@ -56,8 +59,8 @@ public:
   colorMapper(int min, const QColor &colMin, int max, const QColor &colMax);
   colorMapper(const QString &rangeName, int min, int max);
 
-  QColor getColor(int value);
-  QColor getColor(float value);
+  QColor getColor(int value) const;
+  QColor getColor(float value) const;
   int getMinVal();
   int getMaxVal();
 
@@ -111,7 +114,7 @@ public:
   QString description;
 
   // Get the value text (from the value map (if there is an entry))
-  QString getValueTxt(int val);
+  QString getValueTxt(int val) const;
 
   // If set, this map is used to map values to text
   QMap<int, QString> valMap;
@@ -180,56 +183,157 @@ private:
   initialState init;
 };
 
-struct statisticsItem_Value
+struct statisticsBlockArrays;
+
+/* A uniform grid over blocks to find the blocks in an area without testing every block.
+ * Each block is sorted into the grid cell of its top left corner. Blocks that are bigger than a cell
+ * are kept in a separate list and are always returned.
+ */
+class statisticsBlockIndex
 {
-  // The position and size of the item. (max 65535)
-  unsigned short pos[2];
-  unsigned short size[2];
+public:
+  void build(const statisticsBlockArrays &blocks);
+  // Is the index up to date with the given blocks? (No blocks were added after building it)
+  bool isValid(const statisticsBlockArrays &blocks) const;
+
+  // Get the indices of all blocks that may overlap the given area in ascending order. If the index is not
+  // valid, all blocks are returned.
+  void getBlocksInRect(const statisticsBlockArrays &blocks, const QRect &rect, QVector<int> &indices) const;
 
-  // The actual value
-  int value;
+  // How many bytes does the index use?
+  qint64 getMemorySize() const;
+
+private:
+  static const int cellSizeLog2 = 6;
+  int nrBlocks {-1};
+  int nrCellsX {0};
+  int nrCellsY {0};
+  // The blocks of cell i are cellBlocks[cellStart[i]] to cellBlocks[cellStart[i+1]-1]
+  QVector<int> cellStart;
+  QVector<int> cellBlocks;
+  QVector<int> largeBlocks;
 };
 
-struct statisticsItem_Vector
+/* The items of a statistics type are stored as a structure of arrays. Every property of the items is kept
+ * in a separate contiguous array. Adding items does not allocate memory per item and drawing can run over
+ * the arrays directly. All arrays of one struct always have the same size.
+ */
+struct statisticsBlockArrays
 {
-  // The position and size of the item. (max 65535)
-  unsigned short pos[2];
-  unsigned short size[2];
-
-  bool isLine; // the vector is specified by two points
-  // The actual vector value
-  QPoint point[2];
+  int size() const { return posX.size(); }
+  bool isEmpty() const { return posX.isEmpty(); }
+  QRect getRect(int i) const { return QRect(posX[i], posY[i], width[i], height[i]); }
+  void reserveBlocks(int n) { posX.reserve(n); posY.reserve(n); width.reserve(n); height.reserve(n); }
+  void appendBlock(unsigned short x, unsigned short y, unsigned short w, unsigned short h) { posX.append(x); posY.append(y); width.append(w); height.append(h); }
+
+  // The position and size of the blocks. (max 65535)
+  QVector<unsigned short> posX, posY;
+  QVector<unsigned short> width, height;
+  // The spatial index over the blocks. It is built by statisticsData::buildIndex().
+  statisticsBlockIndex index;
 };
 
-struct statisticsItem_AffineTF
+struct statisticsValueArrays : statisticsBlockArrays
 {
-  // The position and size of the item. (max 65535)
-  unsigned short pos[2];
-  unsigned short size[2];
+  void reserve(int n) { reserveBlocks(n); value.reserve(n); }
+  // The actual values
+  QVector<int> value;
+};
 
-  // the vector is specified by two points
-  // The actual vector value
-  QPoint point[3];
+struct statisticsVectorArrays : statisticsBlockArrays
+{
+  void reserve(int n) { reserveBlocks(n); isLine.reserve(n); point0.reserve(n); point1.reserve(n); }
+  // Is the vector specified by two points (a line)?
+  QVector<bool> isLine;
+  // The vector value or the first point of a line
+  QVector<QPoint> point0;
+  // The second point of a line (unused for vectors)
+  QVector<QPoint> point1;
 };
 
-struct statisticsItemPolygon_Value
+struct statisticsAffineTFArrays : statisticsBlockArrays
 {
-  // The position and size of the item.
-  QPolygon corners;
+  void reserve(int n) { reserveBlocks(n); for (int i = 0; i < 3; i++) point[i].reserve(n); }
+  // The three vectors of the affine transform (LT, RT, LB)
+  QVector<QPoint> point[3];
+};
 
-  // The actual value
-  int value;
+struct statisticsPolygonArrays
+{
+  int size() const { return cornerStart.size(); }
+  bool isEmpty() const { return cornerStart.isEmpty(); }
+  int getNrCorners(int i) const { return ((i + 1 < cornerStart.size()) ? cornerStart[i + 1] : corners.size()) - cornerStart[i]; }
+  const QPoint *getCorners(int i) const { return corners.constData() + cornerStart[i]; }
+  QPolygon getPolygon(int i) const { return QPolygon(corners.mid(cornerStart[i], getNrCorners(i))); }
+  void appendPolygon(const QVector<QPoint> &points) { cornerStart.append(corners.size()); corners.append(points); }
+
+  // The corners of all polygons and the index of the first corner of each polygon in corners
+  QVector<QPoint> corners;
+  QVector<int> cornerStart;
 };
 
-struct statisticsItemPolygon_Vector
+struct statisticsPolygonValueArrays : statisticsPolygonArrays
 {
-  // The position and size of the item.
-  QPolygon corners;
+  // The actual values
+  QVector<int> value;
+};
 
-  // The actual vector value
-  QPoint point[2];
+struct statisticsPolygonVectorArrays : statisticsPolygonArrays
+{
+  // The actual vector values
+  QVector<QPoint> point;
 };
 
+/* Coarser grids of the block statistics that are drawn instead of the blocks at low zoom factors (level of detail).
+ * The levels have cells of 2^cellSizeLog2 pixels (starting at 2^firstCellSizeLog2). A level is only built if it has
+ * fewer cells than there are blocks. So drawing a level is always cheaper than drawing the blocks.
+ */
+class statisticsLevelOfDetail
+{
+public:
+  struct valueLevel
+  {
+    int cellSizeLog2;
+    int nrCellsX, nrCellsY;
+    // For each cell (row by row): Is it covered by a block? The most frequent value, the mean value and the mean of
+    // the values divided by their block size. All are weighted by the area that the blocks cover in the cell.
+    QVector<bool> covered;
+    QVector<int> mode;
+    QVector<float> mean;
+    QVector<float> meanPerPixel;
+  };
+  struct vectorLevel
+  {
+    int cellSizeLog2;
+    int nrCellsX, nrCellsY;
+    // For each cell (row by row): Is it covered by a block and the mean vector (weighted by the covered area)
+    QVector<bool> covered;
+    QVector<QPoint> vector;
+  };
+
+  void buildValueLevels(const statisticsValueArrays &values);
+  // Lines are not aggregated. Only the vectors are.
+  void buildVectorLevels(const statisticsVectorArrays &vectors);
+
+  // Get the level with cells of the given size (or the coarsest level if the size is bigger).
+  // Returns nullptr if there is no such level because drawing the blocks is cheaper.
+  const valueLevel *getValueLevel(int cellSizeLog2) const;
+  const vectorLevel *getVectorLevel(int cellSizeLog2) const;
+  // Are there lines in the vector data? They are not part of the vector levels.
+  bool hasVectorLines() const { return vectorLines; }
+
+  // Get the size of the smallest cells that are at least minCellSize pixels big at the given zoom factor
+  static int getCellSizeLog2(double zoomFactor, int minCellSize);
+
+  // How many bytes do the levels use?
+  qint64 getMemorySize() const;
+
+private:
+  static const int firstCellSizeLog2 = 3;
+  QVector<valueLevel> valueLevels;
+  QVector<vectorLevel> vectorLevels;
+  bool vectorLines {false};
+};
 
 // A collection of statistics data (value and vector) for a certain context (for example for a certain type and a certain POC).
 class statisticsData
@@ -243,14 +347,27 @@ public:
   void addPolygonVector(const QVector<QPoint> &points, int vecX, int vecY);
   void addPolygonValue(const QVector<QPoint> &points, int val);
 
-  QList<statisticsItem_Value> valueData;
-  QList<statisticsItem_Vector> vectorData;
-  QList<statisticsItem_AffineTF> affineTFData;
-  QList<statisticsItemPolygon_Value> polygonValueData;
-  QList<statisticsItemPolygon_Vector> polygonVectorData;
+  statisticsValueArrays valueData;
+  statisticsVectorArrays vectorData;
+  statisticsAffineTFArrays affineTFData;
+  statisticsPolygonValueArrays polygonValueData;
+  statisticsPolygonVectorArrays polygonVectorData;
+
+  // The aggregated values and vectors for drawing at low zoom factors. They are built by buildIndex().
+  statisticsLevelOfDetail levelOfDetail;
+
+  // Build the spatial indices and the level of detail of the blocks (if they are not up to date).
+  // Call this when all items were added.
+  void buildIndex();
+
+  // How many bytes do the statistics (including the indices) use?
+  qint64 getMemorySize() const;
 
   // What is the size (area) of the biggest block)? This is needed for scaling the blocks according to their size.
   unsigned int maxBlockSize;
+  // The biggest absolute vector component (or line point) of the vectors and affine transforms.
+  // An arrow can not reach further than this from its block.
+  int maxVectorComponent {0};
 };
 
 #endif // STATISTICSEXTENSIONS_H
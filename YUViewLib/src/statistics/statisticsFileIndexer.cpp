@@ -0,0 +1,187 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "statisticsFileIndexer.h"
+
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstdlib>
+
+#include "filesource/fileSourceMapped.h"
+
+namespace
+{
+  // The file is split into about this many chunks per thread so that the work is balanced
+  // and that the chunks around the playhead are done early.
+  const int nrChunksPerThread = 4;
+  const int64_t minChunkSize = int64_t(4) << 20;
+  const int64_t maxChunkSize = int64_t(256) << 20;
+
+  // For sorting the chunks by priority, only the first statistics line of each chunk is parsed.
+  const int maxLinesForFirstPOC = 1000;
+}
+
+statisticsFileIndexer::statisticsFileIndexer(const QString &filePath, lineParser parser, const bool &cancel) :
+  filePath(filePath),
+  parser(parser),
+  cancel(cancel)
+{
+}
+
+statisticsFileIndexer::~statisticsFileIndexer()
+{
+  // The tasks check the cancel flag. If it is not set, we have to wait until all chunks are scanned.
+  this->threadPool.waitForDone();
+}
+
+bool statisticsFileIndexer::start(int playheadPOC)
+{
+  fileSourceMapped file;
+  if (!file.openFile(this->filePath))
+    return false;
+  this->fileSize = file.getFileSize();
+  if (this->fileSize == 0)
+    return true;
+
+  const int nrThreads = qMax(1, QThread::idealThreadCount());
+  const int64_t chunkSize = qBound(minChunkSize, this->fileSize / (nrThreads * nrChunksPerThread), maxChunkSize);
+
+  // Move the chunk borders to the start of the next line
+  const char *line;
+  int lineLength;
+  int64_t chunkStart = 0;
+  while (chunkStart < this->fileSize)
+  {
+    int64_t chunkEnd = chunkStart + chunkSize;
+    if (chunkEnd >= this->fileSize)
+      chunkEnd = this->fileSize;
+    else
+    {
+      // If the byte before the border is a newline, this returns an empty line and the border is a line start
+      chunkEnd--;
+      if (!file.readLine(chunkEnd, line, lineLength))
+        chunkEnd = this->fileSize;
+    }
+
+    chunk c;
+    c.startPos = chunkStart;
+    c.endPos = chunkEnd;
+    this->chunks.append(c);
+    chunkStart = chunkEnd;
+  }
+
+  // Get the first POC of every chunk
+  QVector<int> firstPOC(this->chunks.size(), -1);
+  for (int i = 0; i < this->chunks.size(); i++)
+  {
+    int64_t pos = this->chunks[i].startPos;
+    int type;
+    for (int l = 0; l < maxLinesForFirstPOC && pos < this->chunks[i].endPos && file.readLine(pos, line, lineLength); l++)
+      if (this->parser(line, lineLength, firstPOC[i], type))
+        break;
+  }
+
+  // The playhead POC is (probably) in all chunks where it lies between the first POC of the chunk and the first POC of the next one.
+  // These are scanned first. Then the others in the order of the distance to the first of these.
+  QVector<int> scanOrder;
+  for (int i = 0; i < this->chunks.size(); i++)
+  {
+    const bool isLast = (i == this->chunks.size() - 1);
+    const bool pocWraps = !isLast && firstPOC[i + 1] < firstPOC[i];
+    if (firstPOC[i] != -1 && firstPOC[i] <= playheadPOC && (isLast || pocWraps || playheadPOC <= firstPOC[i + 1]))
+      scanOrder.append(i);
+  }
+  const int playheadChunk = scanOrder.isEmpty() ? 0 : scanOrder.first();
+  QVector<int> remainingChunks;
+  for (int i = 0; i < this->chunks.size(); i++)
+    if (!scanOrder.contains(i))
+      remainingChunks.append(i);
+  std::stable_sort(remainingChunks.begin(), remainingChunks.end(), [playheadChunk](int a, int b) {
+    return std::abs(a - playheadChunk) < std::abs(b - playheadChunk);
+  });
+  scanOrder.append(remainingChunks);
+
+  // The thread pool runs the tasks in the order in which they were started
+  this->threadPool.setMaxThreadCount(nrThreads);
+  for (int idx : scanOrder)
+    QtConcurrent::run(&this->threadPool, [this, idx]() { this->scanChunk(idx); });
+
+  return true;
+}
+
+void statisticsFileIndexer::scanChunk(int idx)
+{
+  chunk &c = this->chunks[idx];
+
+  fileSourceMapped file;
+  if (!this->cancel && file.openFile(this->filePath))
+  {
+    int64_t lineStartPos = c.startPos;
+    int64_t nextLinePos = c.startPos;
+    const char *line;
+    int lineLength;
+    while (nextLinePos < c.endPos && !this->cancel && file.readLine(nextLinePos, line, lineLength))
+    {
+      int poc, type;
+      if (lineLength > 0 && this->parser(line, lineLength, poc, type))
+      {
+        if (c.runs.isEmpty() || c.runs.last().poc != poc || c.runs.last().type != type)
+        {
+          if (!c.runs.isEmpty() && c.runs.last().poc == poc)
+            c.typeChangeWithinPOC = true;
+          c.runs.append({poc, type, lineStartPos});
+        }
+      }
+      lineStartPos = nextLinePos;
+    }
+  }
+
+  QMutexLocker locker(&this->finishedChunksMutex);
+  this->finishedChunks.append(idx);
+  this->chunkFinished.wakeAll();
+}
+
+int statisticsFileIndexer::waitForNextChunk()
+{
+  if (this->nrChunksReturned >= this->chunks.size())
+    return -1;
+
+  QMutexLocker locker(&this->finishedChunksMutex);
+  while (this->finishedChunks.isEmpty())
+    this->chunkFinished.wait(&this->finishedChunksMutex);
+  if (this->cancel)
+    return -1;
+
+  this->nrChunksReturned++;
+  return this->finishedChunks.takeFirst();
+}
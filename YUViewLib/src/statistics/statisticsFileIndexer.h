@@ -0,0 +1,107 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef STATISTICSFILEINDEXER_H
+#define STATISTICSFILEINDEXER_H
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+#include <functional>
+
+/* Scan a (large) text statistics file in parallel for the positions where the POC/type changes.
+ * The file is split into chunks at line boundaries. Each chunk is scanned in its own task and
+ * results in a list of runs (consecutive lines with the same POC/type). The chunks which
+ * (probably) contain the playhead POC are scanned first.
+ *
+ * The runs of the chunks must be merged in file order by the caller because only then it is
+ * known if the first run of a chunk continues the last run of the previous chunk.
+ */
+class statisticsFileIndexer
+{
+public:
+  // Get the POC and type of the statistics in the given line. Return false if the line contains no statistics.
+  // This is called from multiple threads at the same time.
+  typedef std::function<bool(const char *line, int lineLength, int &poc, int &type)> lineParser;
+
+  struct run
+  {
+    int poc;
+    int type;
+    int64_t startPos;
+  };
+  struct chunk
+  {
+    int64_t startPos {0};
+    int64_t endPos {0};
+    QVector<run> runs;
+    // Did the type change while the POC stayed the same somewhere in this chunk?
+    bool typeChangeWithinPOC {false};
+  };
+
+  statisticsFileIndexer(const QString &filePath, lineParser parser, const bool &cancel);
+  ~statisticsFileIndexer();
+
+  // Split the file into chunks and start scanning them. The chunks around the playhead POC are scanned first.
+  bool start(int playheadPOC);
+
+  // Wait until the next chunk was scanned (in any order). Return its index or -1 if all chunks were returned
+  // or if the scan was canceled.
+  int waitForNextChunk();
+
+  int getNrChunks() const { return chunks.size(); }
+  const chunk &getChunk(int idx) const { return chunks[idx]; }
+  int64_t getFileSize() const { return fileSize; }
+
+private:
+  void scanChunk(int idx);
+
+  QString filePath;
+  lineParser parser;
+  const bool &cancel;
+  int64_t fileSize {0};
+
+  QVector<chunk> chunks;
+  int nrChunksReturned {0};
+
+  QList<int> finishedChunks;
+  QMutex finishedChunksMutex;
+  QWaitCondition chunkFinished;
+
+  QThreadPool threadPool;
+};
+
+#endif // STATISTICSFILEINDEXER_H
@@ -0,0 +1,206 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "statisticsVTMBMSLexer.h"
+
+#include <algorithm>
+
+namespace statisticsVTMBMSLexer
+{
+
+namespace
+{
+  const char pocString[] = "BlockStat: POC ";
+  const int pocStringLength = int(sizeof(pocString)) - 1;
+
+  class cursor
+  {
+  public:
+    cursor(const char *begin, const char *end) : c(begin), end(end) {}
+
+    void skipSpaces()
+    {
+      while (c != end && *c == ' ')
+        c++;
+    }
+    bool peek(char expected)
+    {
+      skipSpaces();
+      return c != end && *c == expected;
+    }
+    bool expect(char expected)
+    {
+      if (!peek(expected))
+        return false;
+      c++;
+      return true;
+    }
+    bool parseUnsigned(int &value)
+    {
+      skipSpaces();
+      if (c == end || *c < '0' || *c > '9')
+        return false;
+      value = 0;
+      for (; c != end && *c >= '0' && *c <= '9'; c++)
+        value = value * 10 + (*c - '0');
+      return true;
+    }
+    bool parseInt(int &value)
+    {
+      skipSpaces();
+      const bool negative = (c != end && *c == '-');
+      if (negative)
+        c++;
+      if (!parseUnsigned(value))
+        return false;
+      if (negative)
+        value = -value;
+      return true;
+    }
+    // A name consists of letters, digits and underscores
+    bool parseName(const char *&name, int &nameLength)
+    {
+      skipSpaces();
+      name = c;
+      while (c != end && ((*c >= '0' && *c <= '9') || (*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || *c == '_'))
+        c++;
+      nameLength = int(c - name);
+      return nameLength > 0;
+    }
+
+    const char *c;
+    const char *end;
+  };
+
+  // Get a cursor behind the "BlockStat: POC ". The POC number must follow directly.
+  bool findPOC(const char *line, int lineLength, cursor &c)
+  {
+    const char *lineEnd = line + lineLength;
+    const char *match = std::search(line, lineEnd, pocString, pocString + pocStringLength);
+    if (match == lineEnd)
+      return false;
+    c = cursor(match + pocStringLength, lineEnd);
+    return c.c != lineEnd && *c.c >= '0' && *c.c <= '9';
+  }
+}
+
+bool parsePOC(const char *line, int lineLength, int &poc)
+{
+  cursor c(line, line + lineLength);
+  return findPOC(line, lineLength, c) && c.parseUnsigned(poc);
+}
+
+bool parseLine(const char *line, int lineLength, blockStat &stat)
+{
+  cursor c(line, line + lineLength);
+  if (!findPOC(line, lineLength, c) || !c.parseUnsigned(stat.poc))
+    return false;
+  if (!c.expect('@'))
+    return false;
+
+  if (c.peek('('))
+  {
+    // @( 112,  88) [ 8x 8]
+    stat.isPolygon = false;
+    stat.nrPolygonPoints = 0;
+    if (!c.expect('(') || !c.parseUnsigned(stat.posX) || !c.expect(',') || !c.parseUnsigned(stat.posY) || !c.expect(')'))
+      return false;
+    if (!c.expect('[') || !c.parseUnsigned(stat.width) || !c.expect('x') || !c.parseUnsigned(stat.height) || !c.expect(']'))
+      return false;
+  }
+  else if (c.expect('['))
+  {
+    // @[(505, 384)--(511, 384)--(511, 415)--]
+    stat.isPolygon = true;
+    stat.posX = stat.posY = stat.width = stat.height = 0;
+    stat.nrPolygonPoints = 0;
+    while (!c.expect(']'))
+    {
+      if (stat.nrPolygonPoints == blockStat::maxNrPolygonPoints)
+        return false;
+      int x, y;
+      if (!c.expect('(') || !c.parseUnsigned(x) || !c.expect(',') || !c.parseUnsigned(y) || !c.expect(')'))
+        return false;
+      if (!c.expect('-') || !c.expect('-'))
+        return false;
+      stat.polygonPoints[stat.nrPolygonPoints++] = QPoint(x, y);
+    }
+    if (stat.nrPolygonPoints < 3)
+      return false;
+  }
+  else
+    return false;
+
+  if (!c.parseName(stat.name, stat.nameLength) || !c.expect('='))
+    return false;
+
+  stat.nrValues = 0;
+  stat.isList = c.expect('{');
+  if (stat.isList)
+  {
+    // {-324,-116,-276,-116,-324, -92}
+    do
+    {
+      if (stat.nrValues == blockStat::maxNrValues || !c.parseInt(stat.values[stat.nrValues]))
+        return false;
+      stat.nrValues++;
+    } while (c.expect(','));
+    if (!c.expect('}'))
+      return false;
+  }
+  else
+  {
+    if (!c.parseInt(stat.values[0]))
+      return false;
+    stat.nrValues = 1;
+  }
+  return true;
+}
+
+bool parseName(const char *line, int lineLength, const char *&name, int &nameLength)
+{
+  const char *lineEnd = line + lineLength;
+  const char *equals = std::find(line, lineEnd, '=');
+  if (equals == lineEnd)
+    return false;
+  const char *nameEnd = equals;
+  while (nameEnd != line && *(nameEnd - 1) == ' ')
+    nameEnd--;
+  name = nameEnd;
+  while (name != line && ((name[-1] >= '0' && name[-1] <= '9') || (name[-1] >= 'a' && name[-1] <= 'z') || (name[-1] >= 'A' && name[-1] <= 'Z') || name[-1] == '_'))
+    name--;
+  nameLength = int(nameEnd - name);
+  return nameLength > 0;
+}
+
+}
@@ -0,0 +1,88 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef STATISTICSVTMBMSLEXER_H
+#define STATISTICSVTMBMSLEXER_H
+
+#include <QPoint>
+
+/* A hand written lexer for the block statistics lines that the VTM writes with --TraceFile:
+ *
+ * BlockStat: POC 1 @( 112,  88) [ 8x 8] PredMode=0
+ * BlockStat: POC 1 @( 120,  80) [ 8x 8] MVL0={ -24,  -2}
+ * BlockStat: POC 2 @( 192,  96) [64x32] AffineMVL0={-324,-116,-276,-116,-324, -92}
+ * BlockStat: POC 2 @( 192,  96) [64x32] Line={0,0,31,31}
+ * BlockStat: POC 2 @[(505, 384)--(511, 384)--(511, 415)--] GeoPUInterIntraFlag=0
+ *
+ * Lines are parsed in place without any allocation.
+ */
+namespace statisticsVTMBMSLexer
+{
+  struct blockStat
+  {
+    int poc {0};
+
+    // Either a block (position and size) or a polygon with 3 to 5 points
+    bool isPolygon {false};
+    int posX {0};
+    int posY {0};
+    int width {0};
+    int height {0};
+    static const int maxNrPolygonPoints = 5;
+    QPoint polygonPoints[maxNrPolygonPoints];
+    int nrPolygonPoints {0};
+
+    // The name of the statistics type. This points into the parsed line.
+    const char *name {nullptr};
+    int nameLength {0};
+
+    // A single value (Name=1) or a list of values (Name={1,2})
+    bool isList {false};
+    static const int maxNrValues = 6;
+    int values[maxNrValues];
+    int nrValues {0};
+  };
+
+  // Find the "BlockStat: POC n" in the line and get the POC. Return false if the line contains no block statistics.
+  bool parsePOC(const char *line, int lineLength, int &poc);
+
+  // Parse a complete block statistics line. Return false if the line contains no block statistics
+  // or if the line could not be parsed.
+  bool parseLine(const char *line, int lineLength, blockStat &stat);
+
+  // Get the name of the statistics type (the name before the first '='). This also works for lines that
+  // parseLine can not parse. Return false if there is no name.
+  bool parseName(const char *line, int lineLength, const char *&name, int &nameLength);
+}
+
+#endif // STATISTICSVTMBMSLEXER_H
@@ -39,13 +39,18 @@
 #include "handler/singleInstanceHandler.h"
 #include "common/typedef.h"
 
-YUViewApplication::YUViewApplication(int argc, char *argv[]) : QApplication(argc, argv)
+void YUViewApplication::setApplicationNames()
 {
   QString versionString = QString::fromUtf8(YUVIEW_VERSION);
-  setApplicationName("YUView");
-  setApplicationVersion(versionString);
-  setOrganizationName("Institut für Nachrichtentechnik, RWTH Aachen University");
-  setOrganizationDomain("ient.rwth-aachen.de");
+  QCoreApplication::setApplicationName("YUView");
+  QCoreApplication::setApplicationVersion(versionString);
+  QCoreApplication::setOrganizationName("Institut für Nachrichtentechnik, RWTH Aachen University");
+  QCoreApplication::setOrganizationDomain("ient.rwth-aachen.de");
+}
+
+YUViewApplication::YUViewApplication(int argc, char *argv[]) : QApplication(argc, argv)
+{
+  setApplicationNames();
 #ifdef Q_OS_LINUX
 #if QT_VERSION >= QT_VERSION_CHECK(5, 7, 0)
   QGuiApplication::setDesktopFileName("YUView");
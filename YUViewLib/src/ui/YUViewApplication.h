@@ -40,6 +40,8 @@ class YUViewApplication : public QApplication
     Q_OBJECT
 public:
     YUViewApplication(int argc, char *argv[]);
+    // Set the names that are also used for the settings. Also used by the decoder host process (no GUI).
+    static void setApplicationNames();
     int returnCode{0};
 };
 
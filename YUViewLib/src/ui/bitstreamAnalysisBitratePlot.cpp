@@ -32,9 +32,10 @@
 
 #include "bitstreamAnalysisBitratePlot.h"
 
+#include <QtGui/QWheelEvent>
 #include <QtWidgets/QVBoxLayout>
-#include <QtCharts/QStackedBarSeries>
-#include <QtCharts/QLineSeries>
+
+#include <cmath>
 
 QT_CHARTS_USE_NAMESPACE
 
@@ -95,6 +96,7 @@ BitrateBarChart::BitrateBarChart(QWidget *parent)
   this->chartView = new QChartView(this);
   this->chartView->setRenderHint(QPainter::Antialiasing);
   this->chartView->setMinimumSize(640, 480);
+  this->chartView->viewport()->installEventFilter(this);
   mainLayout->addWidget(this->chartView);
 
   this->chartView->setChart(&this->chart);
@@ -107,74 +109,68 @@ BitrateBarChart::BitrateBarChart(QWidget *parent)
 
 void BitrateBarChart::setModel(parserCommon::BitrateItemModel *model)
 {
+  if (this->model)
+    disconnect(this->model, nullptr, this, nullptr);
   this->model = model;
   
-  // Clear the current chart
+  // Clear the current chart. This also deletes the series and the bar sets.
   this->chart.removeAllSeries();
-  if (!this->barMapper.isNull())
-  {
-    delete this->barMapper;
-    this->barMapper.clear();
-  }
-  if (!this->lineModelMapper.isNull())
-  {
-    delete this->lineModelMapper;
-    this->lineModelMapper.clear();
-  }
-  if (!this->axisX.isNull())
+  for (auto axis : {this->axisX, this->axisY, this->axisXBars})
   {
-    this->chart.removeAxis(this->axisX);
-    delete this->axisX;
-    this->axisX.clear();
-  }
-  if (!this->axisY.isNull())
-  {
-    this->chart.removeAxis(this->axisY);
-    delete this->axisY;
-    this->axisY.clear();
+    if (!axis.isNull())
+    {
+      this->chart.removeAxis(axis);
+      delete axis;
+    }
   }
+  this->currentTooltip.hide();
 
   if (!this->model)
     return;
 
-  Q_ASSERT(this->barMapper.isNull());
-  Q_ASSERT(this->lineModelMapper.isNull());
+  Q_ASSERT(this->barSeries.isNull());
   Q_ASSERT(this->axisX.isNull());
   Q_ASSERT(this->axisY.isNull());
+  Q_ASSERT(this->axisXBars.isNull());
 
-  QStackedBarSeries *barSeries = new QStackedBarSeries;
-  barSeries->setBarWidth(1.0);
+  this->barSeries = new QStackedBarSeries;
+  this->barSeries->setBarWidth(1.0);
   this->chart.setAnimationOptions(QChart::NoAnimation);
 
   this->updateScrollBarRange();
 
-  this->barMapper = new QVBarModelMapper(this);
-  this->barMapper->setFirstBarSetColumn(2);
-  this->barMapper->setLastBarSetColumn(3);
-  this->barMapper->setRowCount(this->model->rowCount());
-  this->barMapper->setSeries(barSeries);
-  this->barMapper->setModel(this->model);
-  this->chart.addSeries(barSeries);
-
-  QLineSeries *lineSeries = new QLineSeries;
-  lineSeries->setName("Average");
-  this->lineModelMapper = new QVXYModelMapper(this);
-  this->lineModelMapper->setXColumn(0);
-  this->lineModelMapper->setYColumn(1);
-  this->lineModelMapper->setSeries(lineSeries);
-  this->lineModelMapper->setModel(this->model);
-  this->chart.addSeries(lineSeries);
+  this->barSetNonKeyframe = new QBarSet(this->model->headerData(2, Qt::Horizontal).toString());
+  this->barSetKeyframe = new QBarSet(this->model->headerData(3, Qt::Horizontal).toString());
+  this->barSeries->append(this->barSetNonKeyframe);
+  this->barSeries->append(this->barSetKeyframe);
+  this->chart.addSeries(this->barSeries);
+
+  this->lineSeriesAverage = new QLineSeries;
+  this->lineSeriesAverage->setName("Average");
+  this->chart.addSeries(this->lineSeriesAverage);
+
+  this->lineSeriesMinimum = new QLineSeries;
+  this->lineSeriesMinimum->setName("Minimum");
+  this->chart.addSeries(this->lineSeriesMinimum);
 
   this->axisX = new QValueAxis();
   this->axisX->setLabelFormat("%.0f");
   this->axisY = new QValueAxis();
+  this->axisY->setMin(0);
+  this->axisY->setMax(this->model->getMaximumBitrateValue() * 1.05);
+  this->axisXBars = new QValueAxis();
+  this->axisXBars->setVisible(false);
   this->chart.addAxis(this->axisX, Qt::AlignBottom);
+  this->chart.addAxis(this->axisXBars, Qt::AlignBottom);
   this->chart.addAxis(this->axisY, Qt::AlignLeft);
-  barSeries->attachAxis(this->axisX);
-  lineSeries->attachAxis(this->axisX);
-  barSeries->attachAxis(this->axisY);
-  lineSeries->attachAxis(this->axisY);
-  connect(barSeries, &QAbstractBarSeries::hovered, this, &BitrateBarChart::tooltip);
+  this->barSeries->attachAxis(this->axisXBars);
+  this->barSeries->attachAxis(this->axisY);
+  for (auto lineSeries : {this->lineSeriesAverage, this->lineSeriesMinimum})
+  {
+    lineSeries->attachAxis(this->axisX);
+    lineSeries->attachAxis(this->axisY);
+  }
+  connect(this->barSeries, &QAbstractBarSeries::hovered, this, &BitrateBarChart::tooltip);
 
   this->onScrollBarValueChanged(0);
 
@@ -195,7 +191,8 @@ void BitrateBarChart::tooltip(bool status, int index, QBarSet *barset)
   {
     if (this->model)
     {
-      QString itemInfoText = this->model->getItemInfoText(index);
+      // The index is the index in the bar set. The bar series is the first series so the anchor is in bar units.
+      QString itemInfoText = this->model->getBucketInfoText(this->currentLevel, this->currentFirstBucket + index);
       this->currentTooltip.setTextAndAnchor(itemInfoText, QPointF(double(index), 3));
       this->currentTooltip.setZValue(11);
       this->currentTooltip.show();
@@ -211,11 +208,11 @@ void BitrateBarChart::onRowsInserted(const QModelIndex &parent, int first, int l
   Q_UNUSED(first);
   Q_UNUSED(last);
 
-  if (!this->barMapper.isNull())
+  if (!this->barSeries.isNull())
   {
     this->axisY->setMax(this->model->getMaximumBitrateValue() * 1.05);
-    this->barMapper->setRowCount(this->model->rowCount());
     this->updateScrollBarRange();
+    this->updateVisibleData();
   }
 }
 
@@ -226,6 +223,29 @@ void BitrateBarChart::resizeEvent(QResizeEvent *event)
   this->updateAxis();
 }
 
+bool BitrateBarChart::eventFilter(QObject *watched, QEvent *event)
+{
+  // Zoom in/out using the mouse wheel. The first visible frame stays where it is.
+  if (watched == this->chartView->viewport() && event->type() == QEvent::Wheel && this->model)
+  {
+    auto wheelEvent = static_cast<QWheelEvent*>(event);
+    const int delta = wheelEvent->angleDelta().y();
+    if (delta == 0)
+      return false;
+
+    const auto plotWidth = this->chart.plotArea().width();
+    const double barsForAllFrames = plotWidth > 0 ? this->model->rowCount() * 100.0 / plotWidth : 0.0;
+    const double maxBarsPerWidthOf100Pixels = qMax(8.0, barsForAllFrames);
+    const double factor = std::pow(1.25, -double(delta) / 120);
+    this->barsPerWidthOf100Pixels = qBound(1.0, this->barsPerWidthOf100Pixels * factor, maxBarsPerWidthOf100Pixels);
+
+    this->updateScrollBarRange();
+    this->updateAxis();
+    return true;
+  }
+  return QWidget::eventFilter(watched, event);
+}
+
 void BitrateBarChart::updateAxis()
 {
   if (this->axisX.isNull())
@@ -238,20 +258,24 @@ void BitrateBarChart::updateAxis()
   double v = double(currentScrollBarValue) / scrollBarScale;
   this->axisX->setRange(v - 0.5, v + barsVisible - 0.5);
 #if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+  // Keep the number of ticks constant when zooming out
+  const double tickInterval = qMax(5.0, 5.0 * std::pow(2.0, std::ceil(std::log2(this->barsPerWidthOf100Pixels / 8.0))));
   this->axisX->setTickType(QValueAxis::TicksDynamic);
-  this->axisX->setTickInterval(5.0);
+  this->axisX->setTickInterval(tickInterval);
 #endif
+
+  this->updateVisibleData();
 }
 
 void BitrateBarChart::updateScrollBarRange()
 {
-  if (this->barMapper.isNull())
+  if (this->model.isNull())
     return;
 
   const auto plotWidth = this->chart.plotArea().width();
   const double barsVisible = plotWidth / 100 * this->barsPerWidthOf100Pixels;
 
-  auto nrRows = this->barMapper->model()->rowCount();
+  auto nrRows = this->model->rowCount();
   auto maxValue = scrollBarScale * nrRows - int(barsVisible * scrollBarScale);
   if (maxValue <= 0)
     this->scrollBar->setEnabled(false);
@@ -261,5 +285,69 @@ void BitrateBarChart::updateScrollBarRange()
     this->scrollBar->setEnabled(true);
     this->scrollBar->setMinimum(0);
     this->scrollBar->setMaximum(maxValue);
+    this->scrollBar->setPageStep(int(barsVisible * scrollBarScale));
+  }
+}
+
+void BitrateBarChart::updateVisibleData()
+{
+  if (this->model.isNull() || this->barSeries.isNull() || this->axisXBars.isNull())
+    return;
+
+  const auto plotWidth = this->chart.plotArea().width();
+  if (plotWidth <= 0)
+    return;
+  const double barsVisible = plotWidth / 100 * this->barsPerWidthOf100Pixels;
+  const double v = double(this->scrollBar->value()) / scrollBarScale;
+
+  // Use the finest level of detail where a bar is at least 2 pixels wide
+  int level = 0;
+  while (barsVisible / double(1 << level) > plotWidth / 2 && level < 30)
+    level++;
+  const int bucketSize = 1 << level;
+  const int firstFrame = qMax(0, int(std::floor(v - 0.5)));
+  const int firstBucket = firstFrame >> level;
+  const int nrBuckets = int(std::ceil(barsVisible / bucketSize)) + 2;
+
+  const auto buckets = this->model->getBitrateBuckets(level, firstBucket, nrBuckets);
+  this->currentLevel = level;
+  this->currentFirstBucket = firstBucket;
+
+  QList<qreal> valuesNonKeyframe;
+  QList<qreal> valuesKeyframe;
+  QList<QPointF> pointsAverage;
+  QList<QPointF> pointsMinimum;
+  for (int i = 0; i < buckets.size(); i++)
+  {
+    const auto &bucket = buckets.at(i);
+    valuesNonKeyframe.append(bucket.maxNonKeyframeBitrate);
+    // Stacked on top of the non keyframes so that the total height is the maximum
+    const bool keyframeIsMax = bucket.containsKeyframe && bucket.maxBitrate > bucket.maxNonKeyframeBitrate;
+    valuesKeyframe.append(keyframeIsMax ? bucket.maxBitrate - bucket.maxNonKeyframeBitrate : 0);
+
+    const double frameCenter = double(firstBucket + i) * bucketSize + double(bucketSize - 1) / 2;
+    if (level == 0)
+    {
+      // For single frames, show the moving average from the model
+      const auto averageIndex = this->model->index(firstBucket + i, 1);
+      pointsAverage.append(QPointF(frameCenter, this->model->data(averageIndex).toDouble()));
+    }
+    else
+    {
+      pointsAverage.append(QPointF(frameCenter, bucket.getAverageBitrate()));
+      pointsMinimum.append(QPointF(frameCenter, bucket.minBitrate));
+    }
   }
+
+  this->barSetNonKeyframe->remove(0, this->barSetNonKeyframe->count());
+  this->barSetNonKeyframe->append(valuesNonKeyframe);
+  this->barSetKeyframe->remove(0, this->barSetKeyframe->count());
+  this->barSetKeyframe->append(valuesKeyframe);
+  this->lineSeriesAverage->replace(pointsAverage);
+  this->lineSeriesMinimum->replace(pointsMinimum);
+  this->lineSeriesMinimum->setVisible(level > 0);
+
+  // Map the visible frame range of axisX to the bar indices
+  auto frameToBarIndex = [&](double frame) { return (frame - double(bucketSize - 1) / 2) / bucketSize - firstBucket; };
+  this->axisXBars->setRange(frameToBarIndex(v - 0.5), frameToBarIndex(v + barsVisible - 0.5));
 }
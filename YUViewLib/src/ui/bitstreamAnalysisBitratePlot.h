@@ -38,9 +38,9 @@
 #include <QtCharts/QBarSet>
 #include <QtCharts/QChart>
 #include <QtCharts/QChartView>
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QStackedBarSeries>
 #include <QtCore/QPointer>
-#include <QtCharts/QVBarModelMapper>
-#include <QtCharts/QVXYModelMapper>
 #include <QtWidgets/QWidget>
 #include <QtWidgets/QScrollBar>
 #include <QtCharts/QValueAxis>
@@ -80,10 +80,18 @@ private:
   QPointer<QtCharts::QChartView> chartView;
   QPointer<QScrollBar> scrollBar;
 
-  QPointer<QtCharts::QVBarModelMapper> barMapper;
-  QPointer<QtCharts::QVXYModelMapper> lineModelMapper;
+  // Only the values in the visible range are put into the series. For long streams, multiple frames
+  // are aggregated into one bar (see BitrateItemModel::getBitrateBuckets) so that the number of bars
+  // is limited by the width of the plot.
+  QPointer<QtCharts::QStackedBarSeries> barSeries;
+  QPointer<QtCharts::QBarSet> barSetNonKeyframe;
+  QPointer<QtCharts::QBarSet> barSetKeyframe;
+  QPointer<QtCharts::QLineSeries> lineSeriesAverage;
+  QPointer<QtCharts::QLineSeries> lineSeriesMinimum;
   QPointer<QtCharts::QValueAxis> axisX;
   QPointer<QtCharts::QValueAxis> axisY;
+  // The bars are positioned by their index in the bar sets. This hidden axis maps the index to the frames on axisX.
+  QPointer<QtCharts::QValueAxis> axisXBars;
   
   QtCharts::QChart chart;
 
@@ -93,10 +101,16 @@ private:
 
 protected:
   void resizeEvent(QResizeEvent *event) override;
+  bool eventFilter(QObject *watched, QEvent *event) override;
 
   void updateAxis();
   void updateScrollBarRange();
+  void updateVisibleData();
 
   double barsPerWidthOf100Pixels{ 8.0 };
   double maxYValue{ 0 };
+
+  // The level of detail and the first bucket that is currently shown in the bar sets
+  int currentLevel{ 0 };
+  int currentFirstBucket{ 0 };
 };
\ No newline at end of file
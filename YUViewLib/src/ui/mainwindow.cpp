@@ -256,6 +256,7 @@ void MainWindow::createMenusAndActions()
   // The playback menu
   QMenu *playbackMenu = menuBar()->addMenu(tr("&Playback"));
   playbackMenu->addAction("Play/Pause", ui.playbackController, SLOT(on_playPauseButton_clicked()), Qt::Key_Space);
+  playbackMenu->addAction("Play/Pause Backwards", ui.playbackController, SLOT(on_playBackwardsButton_clicked()), Qt::SHIFT + Qt::Key_Space);
   playbackMenu->addAction("Next Playlist Item", ui.playlistTreeWidget, SLOT(selectNextItem()), Qt::Key_Down);
   playbackMenu->addAction("Previous Playlist Item", ui.playlistTreeWidget, SLOT(selectPreviousItem()), Qt::Key_Up);
   playbackMenu->addAction("Next Frame", ui.playbackController, SLOT(nextFrame()), Qt::Key_Right);
@@ -406,6 +407,11 @@ bool MainWindow::handleKeyPress(QKeyEvent *event, bool keyFromSeparateView)
     ui.displaySplitView->toggleFullScreenAction();
     return true;
   }
+  else if (key == Qt::Key_Space && event->modifiers() == Qt::ShiftModifier)
+  {
+    ui.playbackController->on_playBackwardsButton_clicked();
+    return true;
+  }
   else if (key == Qt::Key_Space)
   {
     ui.playbackController->on_playPauseButton_clicked();
@@ -792,6 +798,7 @@ void MainWindow::performanceTest()
       info.append(QString("UPDATE_FEATURE_ENABLE %1\n").arg(UPDATE_FEATURE_ENABLE));
       info.append(QString("pixmapImageFormat %1\n").arg(functions::pixelFormatToString(functions::pixmapImageFormat())));
       info.append(QString("getOptimalThreadCount %1\n").arg(functions::getOptimalThreadCount()));
+      info.append(QString("getDecoderThreadCount %1\n").arg(functions::getDecoderThreadCount()));
       info.append(QString("systemMemorySizeInMB %1\n").arg(functions::systemMemorySizeInMB()));
 
       QMessageBox::information(this, "Internal Info", info);
@@ -37,6 +37,7 @@
 #include "playlistitem/playlistItem.h"
 #include "common/functions.h"
 #include "common/typedef.h"
+#include "video/videoHandler.h"
 
 // Activate this if you want to know when which buffer is loaded/converted to image and so on.
 #define PLAYBACKCONTROLLER_DEBUG 0
@@ -102,32 +103,68 @@ void PlaybackController::on_stopButton_clicked()
   setCurrentFrame(0);
 }
 
-void PlaybackController::on_playPauseButton_clicked()
+void PlaybackController::stopPlayback()
+{
+  // Stop the timer, update the icon and fps label text and unfreeze the primary view (maype it was frozen).
+  DEBUG_PLAYBACK("PlaybackController::stopPlayback");
+  timer.stop();
+  playbackMode = PlaybackStopped;
+  // The items (and the caching of compressed videos) must not keep loading in the backward direction
+  setPlaybackDirection(false);
+  emit(waitForItemCaching(nullptr));
+  updatePlaybackIcons();
+  fpsLabel->setText("0");
+  fpsLabel->setStyleSheet("");
+  splitViewPrimary->freezeView(false);
+
+  splitViewPrimary->update(false, true);
+  splitViewSeparate->update(false, true);
+}
+
+void PlaybackController::setPlaybackDirection(bool backwards)
+{
+  playingBackwards = backwards;
+  videoHandler::setPlaybackBackwards(backwards);
+}
+
+void PlaybackController::updatePlaybackIcons()
+{
+  playPauseButton->setIcon((playing() && !playingBackwards) ? iconPause : iconPlay);
+  playBackwardsButton->setIcon((playing() && playingBackwards) ? iconPause : iconPlayBackwards);
+}
+
+void PlaybackController::togglePlayback(bool backwards)
 {
   // If no item is selected there is nothing to play back
   if (!currentItem[0])
     return;
 
-  if (playing())
+  if (playing() && playingBackwards == backwards)
+    stopPlayback();
+  else if (playing())
   {
-    // Stop the timer, update the icon and fps label text and unfreeze the primary view (maype it was frozen).
-    DEBUG_PLAYBACK("PlaybackController::on_playPauseButton_clicked Stop");
-    timer.stop();
-    playbackMode = PlaybackStopped;
-    emit(waitForItemCaching(nullptr));
-    playPauseButton->setIcon(iconPlay);
-    fpsLabel->setText("0");
-    fpsLabel->setStyleSheet("");
-    splitViewPrimary->freezeView(false);
-
-    splitViewPrimary->update(false, true);
-    splitViewSeparate->update(false, true);
+    // Playback is running in the other direction. Turn around without stopping.
+    DEBUG_PLAYBACK("PlaybackController::togglePlayback Change direction %s", backwards ? "backwards" : "forwards");
+    setPlaybackDirection(backwards);
+    updatePlaybackIcons();
+    // The cache queue and the double buffers must follow the new direction
+    emit(signalPlaybackStarting());
+    if (playbackMode == PlaybackRunning)
+      splitViewPrimary->playbackStarted(getNextFrameIndex());
   }
   else
   {
     // Playback is not running. Start it.
-    DEBUG_PLAYBACK("PlaybackController::on_playPauseButton_clicked Start");
-    if (currentFrameIdx >= frameSlider->maximum() && repeatMode == RepeatModeOff)
+    DEBUG_PLAYBACK("PlaybackController::togglePlayback Start %s", backwards ? "backwards" : "forwards");
+    setPlaybackDirection(backwards);
+    if (backwards && currentFrameIdx <= frameSlider->minimum() && repeatMode == RepeatModeOff)
+    {
+      // We are currently at the beginning of the sequence and the user pressed play backwards.
+      // If there is no previous item to play, replay the current item from the end.
+      if (!playlist->hasPreviousItem())
+        setCurrentFrame(frameSlider->maximum());
+    }
+    else if (!backwards && currentFrameIdx >= frameSlider->maximum() && repeatMode == RepeatModeOff)
     {
       // We are currently at the end of the sequence and the user pressed play.
       // If there is no next item to play, replay the current item from the beginning.
@@ -140,9 +177,9 @@ void PlaybackController::on_playPauseButton_clicked()
     if (waitForCachingOfItem)
     {
       // Caching is enabled and we shall wait for caching of the current item to complete before starting playback.
-      DEBUG_PLAYBACK("PlaybackController::on_playPauseButton_clicked waiting for caching...");
+      DEBUG_PLAYBACK("PlaybackController::togglePlayback waiting for caching...");
       playbackMode = PlaybackWaitingForCache;
-      playPauseButton->setIcon(iconPause);
+      updatePlaybackIcons();
       splitViewPrimary->freezeView(true);
       playbackWasStalled = false;
       emit(waitForItemCaching(currentItem[0]));
@@ -177,6 +214,7 @@ void PlaybackController::startPlayback()
 {
   // Start the timer, update the icon and (possibly) freeze the primary view.
   startOrUpdateTimer();
+  updatePlaybackIcons();
 
   // Tell the primary split view that playback just started. This will toggle loading
   // of the double buffer of the currently visible items (if required).
@@ -234,6 +272,21 @@ void PlaybackController::on_frameSlider_valueChanged(int value)
   setCurrentFrame(value);
 }
 
+void PlaybackController::on_frameSlider_sliderPressed()
+{
+  pausePlayback();
+  videoHandler::setScrubbing(true);
+}
+
+void PlaybackController::on_frameSlider_sliderReleased()
+{
+  videoHandler::setScrubbing(false);
+
+  // Items that showed an approximation of the current frame will now load it exactly
+  splitViewPrimary->update(true);
+  splitViewSeparate->update();
+}
+
 /** Toggle the repeat mode (loop through the list)
   * The signal repeatModeButton->clicked() is connected to this slot
   */
@@ -382,6 +435,7 @@ void PlaybackController::updateSettings()
 
   // Load the icons for the buttons
   iconPlay = functions::convertIcon(":img_play.png");
+  iconPlayBackwards = functions::convertIcon(":img_play.png", true);
   iconStop = functions::convertIcon(":img_stop.png");
   iconPause = functions::convertIcon(":img_pause.png");
   iconRepeatOff = functions::convertIcon(":img_repeat.png");
@@ -389,10 +443,7 @@ void PlaybackController::updateSettings()
   iconRepeatOne = functions::convertIcon(":img_repeat_one.png");
 
   // Set button icons
-  if (playing())
-    playPauseButton->setIcon(iconPlay);
-  else
-    playPauseButton->setIcon(iconPause);
+  updatePlaybackIcons();
   stopButton->setIcon(iconStop);
 
   // Don't change the repeat mode but set the icons
@@ -443,17 +494,18 @@ void PlaybackController::enableControls(bool enable)
 
 int PlaybackController::getNextFrameIndex()
 {
-  if (currentFrameIdx >= frameSlider->maximum() || (!currentItem[0]->isIndexedByFrame() && (!currentItem[1] || !currentItem[1]->isIndexedByFrame())))
+  const bool endReached = playingBackwards ? (currentFrameIdx <= frameSlider->minimum()) : (currentFrameIdx >= frameSlider->maximum());
+  if (endReached || (!currentItem[0]->isIndexedByFrame() && (!currentItem[1] || !currentItem[1]->isIndexedByFrame())))
   {
-    // The sequence is at the end. Check the repeat mode to see what the next frame index is
+    // The sequence is at the end (or at the beginning if playing backwards). Check the repeat mode to see what the next frame index is
     if (repeatMode == RepeatModeOne)
-      // The next frame is the first frame of the current item
-      return frameSlider->minimum();
+      // The next frame is the first frame of the current item (the last frame when playing backwards)
+      return playingBackwards ? frameSlider->maximum() : frameSlider->minimum();
     else
-      // The next frame is the first frame of the next item
+      // The next frame is the first frame of the next item (the last frame of the previous item)
       return -1;
   }
-  return currentFrameIdx + 1;
+  return currentFrameIdx + (playingBackwards ? -1 : 1);
 }
 
 void PlaybackController::timerEvent(QTimerEvent *event)
@@ -488,11 +540,12 @@ void PlaybackController::timerEvent(QTimerEvent *event)
     }
 
     bool wrapAround = (repeatMode == RepeatModeAll);
-    if (playlist->selectNextItem(wrapAround, true))
+    if (playingBackwards ? playlist->selectPreviousItem(wrapAround, true) : playlist->selectNextItem(wrapAround, true))
     {
-      // We jumped to the next item. Start at the first frame.
-      DEBUG_PLAYBACK("PlaybackController::timerEvent next item frame %d", frameSlider->minimum());
-      setCurrentFrame(frameSlider->minimum());
+      // We jumped to the next item. Start at the first frame (at the last frame of the previous item when playing backwards).
+      const int startFrame = playingBackwards ? frameSlider->maximum() : frameSlider->minimum();
+      DEBUG_PLAYBACK("PlaybackController::timerEvent next item frame %d", startFrame);
+      setCurrentFrame(startFrame);
 
       // Check if we wait for the caching process before playing the next item
       if (waitForCachingOfItem)
@@ -512,7 +565,7 @@ void PlaybackController::timerEvent(QTimerEvent *event)
     {
       // There is no next item. Stop playback
       DEBUG_PLAYBACK("PlaybackController::timerEvent playback done");
-      on_playPauseButton_clicked();
+      stopPlayback();
     }
   }
   else
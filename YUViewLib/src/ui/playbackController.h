@@ -58,12 +58,14 @@ public:
   void setSplitViews(splitViewWidget *primary, splitViewWidget *separate) { splitViewPrimary = primary; splitViewSeparate = separate; }
   void setPlaylist (PlaylistTreeWidget *playlistWidget) { playlist = playlistWidget; }
 
-  // If playback is running, stop it by pressing the playPauseButton.
-  void pausePlayback() { if (playing()) on_playPauseButton_clicked(); }
+  // If playback is running (in any direction), stop it.
+  void pausePlayback() { if (playing()) stopPlayback(); }
 
   // What is the sate of the playback?
   bool playing() const { return playbackMode != PlaybackStopped; }
   bool isWaitingForCaching() const { return playbackMode == PlaybackWaitingForCache; }
+  // Does playback run from the last to the first frame?
+  bool isPlayingBackwards() const { return playing() && playingBackwards; }
 
   // Get the currently shown frame index
   int getCurrentFrame() const { return currentFrameIdx; }
@@ -71,13 +73,15 @@ public:
   // Return if an update was performed.
   bool setCurrentFrame(int frame, bool updateView=true);
 
-  // Using the currentFrameIdx and the repreat mode, calculate the next frame index.
-  // -1: The next frame is the first fame of the next item.
+  // Using the currentFrameIdx, the playback direction and the repreat mode, calculate the next frame index.
+  // -1: The next frame is the first fame of the next item (the last frame of the previous item when playing backwards).
   int getNextFrameIndex();
 
 public slots:
   // Slots for the play/stop/toggleRepera buttons (these are automatically connected by the UI file (connectSlotsByName))
-  void on_playPauseButton_clicked();
+  // If playback is running in the other direction, the play buttons change the direction.
+  void on_playPauseButton_clicked() { togglePlayback(false); }
+  void on_playBackwardsButton_clicked() { togglePlayback(true); }
   void on_stopButton_clicked();
   void on_repeatModeButton_clicked();
 
@@ -119,6 +123,9 @@ private slots:
   // The user is fiddeling with the slider/spinBox controls (automatically connected)
   void on_frameSlider_valueChanged(int val);
   void on_frameSpinBox_valueChanged(int val) { on_frameSlider_valueChanged(val); }
+  // While the slider is dragged, the items may show approximations of the frames (scrubbing)
+  void on_frameSlider_sliderPressed();
+  void on_frameSlider_sliderReleased();
 
 private:
 
@@ -139,6 +146,16 @@ private:
   void startOrUpdateTimer();
   // Start playback. Start the timer (startOrUpdateTimer()), set the icons, inform the split views...
   void startPlayback(); 
+  // Start playback in the given direction, stop it or change the direction if it is running in the other direction.
+  void togglePlayback(bool backwards);
+  // Stop the timer, update the icons and unfreeze the primary view.
+  void stopPlayback();
+
+  // Does playback run backwards? The direction is also set in the videoHandler for the double buffering.
+  bool playingBackwards {false};
+  void setPlaybackDirection(bool backwards);
+  // Show the pause icon on the button of the running playback direction and the play icons otherwise
+  void updatePlaybackIcons();
 
   // Set the new repeat mode and save it into the settings. Update the control.
   // Always use this function to set the new repeat mode.
@@ -151,6 +168,7 @@ private:
   void setRepeatMode(RepeatMode mode);
 
   QIcon iconPlay;
+  QIcon iconPlayBackwards;
   QIcon iconStop;
   QIcon iconPause;
   QIcon iconRepeatOff;
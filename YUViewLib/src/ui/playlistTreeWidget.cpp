@@ -494,6 +494,16 @@ bool PlaylistTreeWidget::hasNextItem()
   return false;
 }
 
+bool PlaylistTreeWidget::hasPreviousItem()
+{
+  QList<QTreeWidgetItem*> items = selectedItems();
+  if (items.count() == 0)
+    return false;
+
+  // Is there an item before the current one?
+  return indexOfTopLevelItem(items[0]) > 0;
+}
+
 bool PlaylistTreeWidget::selectNextItem(bool wrapAround, bool callByPlayback)
 {
   QList<QTreeWidgetItem*> items = selectedItems();
@@ -513,45 +523,51 @@ bool PlaylistTreeWidget::selectNextItem(bool wrapAround, bool callByPlayback)
       return false;
   }
 
-  if (callByPlayback)
-  {
-    // Select the next item but emit the selectionRangeChanged event with changedByPlayback=true.
-    const QScopedValueRollback<bool> back(ignoreSlotSelectionChanged, true);
-
-    // Select the next item
-    QTreeWidgetItem *nextItem = topLevelItem(idx + 1);
-    setCurrentItem(nextItem, 0, QItemSelectionModel::ClearAndSelect);
-    assert(selectedItems().count() == 1);
-
-    // Do what the function slotSelectionChanged usually does but this time with changedByPlayback=false.
-    auto items = getSelectedItems();
-    emit selectionRangeChanged(items[0], items[1], true);
-  }
-  else
-    // Set next item as current and emit the selectionRangeChanged event with changedByPlayback=false.
-    setCurrentItem(topLevelItem(idx + 1));
-
-  // Another item was selected. The caching thread also has to be notified about this.
-  emit playlistChanged();
-
+  selectTopLevelItem(idx + 1, callByPlayback);
   return true;
 }
 
-void PlaylistTreeWidget::selectPreviousItem()
+bool PlaylistTreeWidget::selectPreviousItem(bool wrapAround, bool callByPlayback)
 {
   QList<QTreeWidgetItem*> items = selectedItems();
   if (items.count() == 0)
-    return;
+    return false;
 
   // Get index of current item
   int idx = indexOfTopLevelItem(items[0]);
 
   // Is there a previous item?
   if (idx == 0)
-    return;
+  {
+    if (wrapAround)
+      // The previous item is the last one
+      idx = topLevelItemCount();
+    else
+      return false;
+  }
+
+  selectTopLevelItem(idx - 1, callByPlayback);
+  return true;
+}
+
+void PlaylistTreeWidget::selectTopLevelItem(int idx, bool callByPlayback)
+{
+  if (callByPlayback)
+  {
+    // Select the item but emit the selectionRangeChanged event with changedByPlayback=true.
+    const QScopedValueRollback<bool> back(ignoreSlotSelectionChanged, true);
+
+    // Select the item
+    setCurrentItem(topLevelItem(idx), 0, QItemSelectionModel::ClearAndSelect);
+    assert(selectedItems().count() == 1);
 
-  // Set next item as current
-  setCurrentItem(topLevelItem(idx - 1));
+    // Do what the function slotSelectionChanged usually does but this time with changedByPlayback=false.
+    auto items = getSelectedItems();
+    emit selectionRangeChanged(items[0], items[1], true);
+  }
+  else
+    // Set the item as current and emit the selectionRangeChanged event with changedByPlayback=false.
+    setCurrentItem(topLevelItem(idx));
 
   // Another item was selected. The caching thread also has to be notified about this.
   emit playlistChanged();
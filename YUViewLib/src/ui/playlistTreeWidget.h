@@ -76,6 +76,8 @@ public:
 
   // Is there a next item? Is the currently selected item the last one in the playlist?
   bool hasNextItem();
+  // Is there a previous item? Is the currently selected item the first one in the playlist?
+  bool hasPreviousItem();
 
   // Check if the source of the items is still up to date. If not aske the user if he wants to reload the item.
   void checkAndUpdateItems();
@@ -100,8 +102,9 @@ public slots:
   // goto the first item in the list. Return if there is a next item.
   // callByPlayback is true if this call is caused by the playback function going to the next item.
   bool selectNextItem(bool wrapAround=false, bool callByPlayback=false);
-  // Goto the previous item
-  void selectPreviousItem();
+  // Goto the previous item. WrapAround = if the current item is the first one in the list, goto the last item.
+  // Return if there is a previous item. callByPlayback is true if playback runs backwards and goes to the previous item.
+  bool selectPreviousItem(bool wrapAround=false, bool callByPlayback=false);
 
   // Slots for adding text/difference items
   void addTextItem();
@@ -184,6 +187,9 @@ private:
   // Whether slotSelectionChanged should immediately exit
   bool ignoreSlotSelectionChanged {false};
 
+  // Select the top level item with the given index (used by selectNextItem/selectPreviousItem)
+  void selectTopLevelItem(int idx, bool callByPlayback);
+
   // If the playlist is changed and the changes have not been saved yet, this will be true.
   bool isSaved { true };
 
@@ -135,6 +135,10 @@ SettingsDialog::SettingsDialog(QWidget *parent) :
   for (int i=0; i<YUView::decoderEngineNum; i++)
     ui.comboBoxDefaultDecoder->addItem(functions::getDecoderEngineName((YUView::decoderEngine)i));
   ui.comboBoxDefaultDecoder->setCurrentIndex(settings.value("DefaultDecoder", 0).toInt());
+  ui.checkBoxNrDecoderThreads->setChecked(settings.value("SetNrThreads", false).toBool());
+  ui.spinBoxNrDecoderThreads->setValue(functions::getDecoderThreadCount());
+  ui.spinBoxNrDecoderThreads->setEnabled(ui.checkBoxNrDecoderThreads->isChecked());
+  ui.checkBoxDecoderSeparateProcess->setChecked(settings.value("SeparateProcess", false).toBool());
 
   ui.lineEditLibde265File->setText(settings.value("libde265File", "").toString());
   ui.lineEditLibHMFile->setText(settings.value("libHMFile", "").toString());
@@ -164,6 +168,13 @@ void SettingsDialog::on_checkBoxNrThreads_stateChanged(int newState)
     ui.spinBoxNrThreads->setValue(functions::getOptimalThreadCount());
 }
 
+void SettingsDialog::on_checkBoxNrDecoderThreads_stateChanged(int newState)
+{
+  ui.spinBoxNrDecoderThreads->setEnabled(newState);
+  if (newState == Qt::Unchecked)
+    ui.spinBoxNrDecoderThreads->setValue(functions::getOptimalDecoderThreadCount());
+}
+
 void SettingsDialog::on_checkBoxEnablePlaybackCaching_stateChanged(int state)
 {
   // Enable/disable the spinBoxThreadLimit
@@ -387,6 +398,9 @@ void SettingsDialog::on_pushButtonSave_clicked()
   settings.beginGroup("Decoders");
   settings.setValue("SearchPath", ui.lineEditDecoderPath->text());
   settings.setValue("DefaultDecoder", ui.comboBoxDefaultDecoder->currentIndex());
+  settings.setValue("SetNrThreads", ui.checkBoxNrDecoderThreads->isChecked());
+  settings.setValue("NrThreads", ui.spinBoxNrDecoderThreads->value());
+  settings.setValue("SeparateProcess", ui.checkBoxDecoderSeparateProcess->isChecked());
   // Raw coded video files
   settings.setValue("libde265File", ui.lineEditLibde265File->text());
   settings.setValue("libHMFile", ui.lineEditLibHMFile->text());
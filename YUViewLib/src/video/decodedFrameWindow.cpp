@@ -0,0 +1,134 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "decodedFrameWindow.h"
+
+bool decodedFrameWindow::getFrame(int frameIdx, frame &f)
+{
+  QMutexLocker locker(&accessMutex);
+  auto it = frames.constFind(frameIdx);
+  if (it == frames.constEnd())
+    return false;
+  f = it.value();
+  currentFrame = frameIdx;
+  return true;
+}
+
+bool decodedFrameWindow::contains(int frameIdx) const
+{
+  QMutexLocker locker(&accessMutex);
+  return frames.contains(frameIdx);
+}
+
+indexRange decodedFrameWindow::getRange() const
+{
+  QMutexLocker locker(&accessMutex);
+  if (frames.isEmpty())
+    return indexRange(-1, -1);
+  return indexRange(frames.firstKey(), frames.lastKey());
+}
+
+int64_t decodedFrameWindow::getMemoryUsage() const
+{
+  QMutexLocker locker(&accessMutex);
+  return memoryUsage;
+}
+
+void decodedFrameWindow::setMaxMemory(int64_t nrBytes)
+{
+  QMutexLocker locker(&accessMutex);
+  maxMemory = nrBytes;
+  makeRoom(0);
+}
+
+void decodedFrameWindow::setCurrentFrame(int frameIdx)
+{
+  QMutexLocker locker(&accessMutex);
+  currentFrame = frameIdx;
+}
+
+void decodedFrameWindow::addFrames(int startFrameIdx, const QList<frame> &newFrames, bool extendOnly)
+{
+  if (newFrames.isEmpty())
+    return;
+
+  QMutexLocker locker(&accessMutex);
+  const int endFrameIdx = startFrameIdx + newFrames.count() - 1;
+  if (!frames.isEmpty() && (endFrameIdx < frames.firstKey() - 1 || startFrameIdx > frames.lastKey() + 1))
+  {
+    if (extendOnly)
+      return;
+    // The new frames are somewhere else in the sequence. Start over.
+    frames.clear();
+    memoryUsage = 0;
+  }
+
+  // Add from the last frame on so that the window stays consecutive if we run out of memory
+  for (int i = newFrames.count() - 1; i >= 0; i--)
+  {
+    const int frameIdx = startFrameIdx + i;
+    auto it = frames.find(frameIdx);
+    if (it != frames.end())
+    {
+      // Replace the frame (it was decoded again)
+      memoryUsage -= it.value().nrBytes;
+      frames.erase(it);
+    }
+    if (!makeRoom(newFrames[i].nrBytes))
+      return;
+    frames.insert(frameIdx, newFrames[i]);
+    memoryUsage += newFrames[i].nrBytes;
+  }
+}
+
+void decodedFrameWindow::clear()
+{
+  QMutexLocker locker(&accessMutex);
+  frames.clear();
+  memoryUsage = 0;
+  currentFrame = -1;
+}
+
+bool decodedFrameWindow::makeRoom(int64_t nrBytes)
+{
+  while (memoryUsage + nrBytes > maxMemory)
+  {
+    if (frames.isEmpty() || frames.lastKey() <= currentFrame)
+      return false;
+    auto last = frames.end();
+    --last;
+    memoryUsage -= last.value().nrBytes;
+    frames.erase(last);
+  }
+  return true;
+}
@@ -0,0 +1,94 @@
+/*  This file is part of YUView - The YUV player with advanced analytics toolset
+*   <https://github.com/IENT/YUView>
+*   Copyright (C) 2015  Institut f�r Nachrichtentechnik, RWTH Aachen University, GERMANY
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   In addition, as a special exception, the copyright holders give
+*   permission to link the code of portions of this program with the
+*   OpenSSL library under certain conditions as described in each
+*   individual source file, and distribute linked combinations including
+*   the two.
+*   
+*   You must obey the GNU General Public License in all respects for all
+*   of the code used other than OpenSSL. If you modify file(s) with this
+*   exception, you may extend this exception to your version of the
+*   file(s), but you are not obligated to do so. If you do not wish to do
+*   so, delete this exception statement from your version. If you delete
+*   this exception statement from all source files in the program, then
+*   also delete it here.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef DECODEDFRAMEWINDOW_H
+#define DECODEDFRAMEWINDOW_H
+
+#include <QList>
+#include <QMap>
+#include <QMutex>
+
+#include "common/typedef.h"
+#include "video/videoHandlerYUV.h"
+
+/* A window of consecutive decoded frames (in display order) of a compressed video.
+ * To step one frame backwards in a compressed video, we have to seek to the previous random access point and decode
+ * the GOP up to the requested frame. The frames that are decoded on the way are put into this window so that the
+ * following backward steps can be served without decoding again. The window can be extended backwards GOP by GOP.
+ * The memory that the window may use is limited. If the limit is reached, the frames after the current frame are
+ * dropped first (these were already shown and the decoder can get them again quickly in forward direction).
+ * All functions are thread safe.
+*/
+class decodedFrameWindow
+{
+public:
+  struct frame
+  {
+    QByteArray rawData;                    //< The raw data in a packed buffer (if the picture is not valid)
+    YUV_Internals::yuvPictureRef picture;  //< A reference to the picture in the buffer of the decoder
+    int64_t nrBytes {0};                   //< The memory that is held by the frame
+  };
+
+  decodedFrameWindow(int64_t maxMemory = 0) : maxMemory(maxMemory) {}
+
+  // Set the memory limit (in bytes). If the window holds more than this, frames after the current frame are dropped.
+  void setMaxMemory(int64_t nrBytes);
+
+  // Get the frame from the window. If the frame is in the window, it becomes the current frame.
+  bool getFrame(int frameIdx, frame &f);
+  bool contains(int frameIdx) const;
+  // The range of frames in the window (first, last) or (-1, -1) if the window is empty.
+  indexRange getRange() const;
+  int64_t getMemoryUsage() const;
+
+  // Set the frame that is currently shown. Frames after it are the first ones to be dropped.
+  void setCurrentFrame(int frameIdx);
+
+  // Add the consecutive frames startFrameIdx, startFrameIdx+1, ... to the window. If they do not overlap or adjoin
+  // the frames in the window, the window is cleared first (or nothing is added if extendOnly is set). The frames are
+  // added from the last one on. If the memory limit is reached, adding stops and the lower frames are not added.
+  void addFrames(int startFrameIdx, const QList<frame> &newFrames, bool extendOnly=false);
+  void clear();
+
+private:
+  // Drop frames after the current frame until nrBytes more fit into the window. Return false if this is not possible.
+  bool makeRoom(int64_t nrBytes);
+
+  mutable QMutex accessMutex;
+  QMap<int, frame> frames;
+  int currentFrame {-1};
+  int64_t memoryUsage {0};
+  int64_t maxMemory;
+};
+
+#endif // DECODEDFRAMEWINDOW_H
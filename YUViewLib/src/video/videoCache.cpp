@@ -40,8 +40,10 @@
 #include <QThread>
 
 #include "common/functions.h"
+#include "common/loadingCancellation.h"
 #include "ui/playbackController.h"
 #include "playlistitem/playlistItem.h"
+#include "playlistitem/playlistItemContainer.h"
 
 // This debug setting has two values:
 // 1: Basic operation is written to qDebug: If a new item is selected, what is the decision to cache/remove next?
@@ -61,6 +63,9 @@
 #define DEBUG_CACHING_DETAIL(fmt,...) ((void)0)
 #endif
 
+// The measured time that it takes to cache a frame of an item is smoothed with this factor (exponential moving average)
+#define CACHING_FRAME_COST_SMOOTHING 0.2
+
 #define CACHING_THREAD_JOBS_OUTPUT 0
 #if CACHING_THREAD_JOBS_OUTPUT && !NDEBUG
 #include <QDebug>
@@ -77,10 +82,15 @@ class loadingWorker : public QObject
 public:
   loadingWorker(QObject *parent) : QObject(parent) { currentCacheItem = nullptr; working = false; id = id_counter++; }
   playlistItem *getCacheItem() { return currentCacheItem; }
+  // The item and the duration (in ms) of the last finished caching job
+  playlistItem *getFinishedCacheItem() { return finishedCacheItem; }
+  double getFinishedCacheJobDuration() { return finishedCacheJobDuration; }
   int getCacheFrame() { return currentFrame; }
   void setJob(playlistItem *item, int frame, bool test=false);
   void setWorking(bool state) { working = state; }
   bool isWorking() { return working; }
+  // Cancel the loading job that is currently processed. The worker checks this at safe points (see loadingCancellation).
+  void cancelLoadingJob() { cancelled.store(1); }
   QString getStatus() { return QString("T%1: %2").arg(id).arg(working ? QString::number(currentFrame) : QString("-")); }
   // Process the job in the thread that this worker was moved to. This function can be directly
   // called from the main thread. It will still process the call in the separate thread.
@@ -93,9 +103,12 @@ private slots:
   void processLoadingJobInternal(bool playing, bool loadRawData);
 private:
   playlistItem *currentCacheItem;
+  playlistItem *finishedCacheItem {nullptr};
+  double finishedCacheJobDuration {0};
   int currentFrame;
   bool working;
   bool testMode;
+  QAtomicInt cancelled;
   int id;   // A static ID of the thread. Only used in getStatus().
   static int id_counter;
 };
@@ -109,6 +122,7 @@ void loadingWorker::setJob(playlistItem *item, int frame, bool test)
   currentCacheItem = item;
   currentFrame = frame;
   testMode = test;
+  cancelled.store(0);
 }
 
 void loadingWorker::processCacheJob()
@@ -131,7 +145,11 @@ void loadingWorker::processCacheJobInternal()
 
   // Just cache the frame that was given to us.
   // This is performed in the thread that this worker is currently placed in.
+  QElapsedTimer jobTimer;
+  jobTimer.start();
   currentCacheItem->cacheFrame(currentFrame, testMode);
+  finishedCacheJobDuration = jobTimer.nsecsElapsed() / 1000000.0;
+  finishedCacheItem = currentCacheItem;
   
   currentCacheItem = nullptr;
   DEBUG_JOBS("loadingWorker::processCacheJobInternal emit loadingFinished");
@@ -147,7 +165,12 @@ void loadingWorker::processLoadingJobInternal(bool playing, bool loadRawData)
 
   // Load the frame of the item that was given to us.
   // This is performed in the thread (the loading thread with higher priority.
+  // If a newer request arrives in the meantime, this job may be cancelled.
+  loadingCancellation::setThreadFlag(&cancelled);
   currentCacheItem->loadFrame(currentFrame, playing, loadRawData);
+  loadingCancellation::setThreadFlag(nullptr);
+  if (cancelled.load() != 0)
+    DEBUG_JOBS("loadingWorker::processLoadingJobInternal job was cancelled");
 
   currentCacheItem = nullptr;
   emit loadingFinished();
@@ -351,6 +374,10 @@ void videoCache::loadFrame(playlistItem * item, int frameIndex, int loadingSlot)
       DEBUG_CACHING_DETAIL("videoCache::loadFrame %d queued for later - slot %d", frameIndex, loadingSlot);
       interactiveItemQueued[loadingSlot] = item;
       interactiveItemQueued_Idx[loadingSlot] = frameIndex;
+      // The user moved on (e.g. by holding a key or dragging the slider). Don't wait for the frame that is currently
+      // being loaded. When playing, the running request is the next frame which is still needed.
+      if (!playback->playing())
+        interactiveThread[loadingSlot]->worker()->cancelLoadingJob();
     }
   }
   else
@@ -464,6 +491,7 @@ void videoCache::updateCacheQueue()
   // Firstly clear the old cache queues
   cacheQueue.clear();
   cacheDeQueue.clear();
+  fairShareItems.clear();
 
   // Get all items from the playlist. There are two lists. For the caching status (how full is the cache) we have to consider
   // all items in the playlist. However, we only cache top level items and no child items.
@@ -497,11 +525,24 @@ void videoCache::updateCacheQueue()
   // Playback is running:
   // 1: The item after this item has the highest priority (it will be played next)
   // 2: The item after 2 is next and so on (wrap around in the playlist) until the previous item is reached.
+  // Frames are cached in the playback direction starting at the current frame. When playback runs backwards,
+  // the items before this item are played next and the frames of each item are cached from the last to the first one.
 
   // Let's start with the currently selected item (if no item is selected, the first item in the playlist is considered as being selected)
   auto selection = playlist->getSelectedItems();
   if (selection[0] == nullptr)
     selection[0] = allItems[0];
+  // The selected items (and their children) are shown at the playhead. These items share the caching threads fairly.
+  for (playlistItem *item : selection)
+  {
+    if (item == nullptr)
+      continue;
+    fairShareItems.append(item);
+    if (auto container = dynamic_cast<playlistItemContainer*>(item))
+      for (playlistItem *child : container->getAllChildPlaylistItems())
+        fairShareItems.append(child);
+  }
+
   // Get the position of the curretnly selected item
   int itemPos = allItems.indexOf(selection[0]);
   Q_ASSERT_X(itemPos >= 0, "updateCacheQueue", "The current item is not in the list of all items? No possible.");
@@ -566,6 +607,7 @@ void videoCache::updateCacheQueue()
     // Go through the playlist starting with the currently selected item.
     // Add as much of all items as possible. When the cache is full, mark the remaining frames as "can be
     // deleted"
+    const bool backwards = playback->isPlayingBackwards();
     int i = itemPos;
     int64_t newCacheLevel = 0;
 
@@ -580,23 +622,44 @@ void videoCache::updateCacheQueue()
         indexRange itemRange = allItems[i]->getFrameIdxRange();
         int64_t itemCacheSize = (itemRange.second - itemRange.first + 1) * int64_t(allItems[i]->getCachingFrameSize());
 
+        // Where does playback enter the item? In the current item, this is the current frame.
+        int startFrame = backwards ? itemRange.second : itemRange.first;
+        if (i == itemPos)
+          startFrame = clip(playback->getCurrentFrame(), itemRange.first, itemRange.second);
+
         if (adding && allItems[i]->isCachable())
         {
           if (newCacheLevel + itemCacheSize <= cacheLevelMax)
           {
             // All frames of the item fit and there is even more space. We remain in "adding" mode.
-            enqueueCacheJob(allItems[i], itemRange);
+            // Cache the frames that are played next first and the frames that were already played last.
+            if (backwards)
+            {
+              enqueueCacheJob(allItems[i], indexRange(itemRange.first, startFrame), true);
+              if (startFrame < itemRange.second)
+                enqueueCacheJob(allItems[i], indexRange(startFrame + 1, itemRange.second), true);
+            }
+            else
+            {
+              enqueueCacheJob(allItems[i], indexRange(startFrame, itemRange.second));
+              if (startFrame > itemRange.first)
+                enqueueCacheJob(allItems[i], indexRange(itemRange.first, startFrame - 1));
+            }
             newCacheLevel += itemCacheSize;
           }
           else
           {
             // Not all frames fit. Enqueue the ones that fit and set the ones that don't as "can be deleted".
             int64_t availableSpace = cacheLevelMax - newCacheLevel;
-            int64_t nrFramesCachable = availableSpace / allItems[i]->getCachingFrameSize() + 1;
+            int nrFramesCachable = int(availableSpace / allItems[i]->getCachingFrameSize() + 1);
 
             // These frames should be added...
-            indexRange addFrames = indexRange(itemRange.first, itemRange.first + nrFramesCachable - 1);
-            enqueueCacheJob(allItems[i], addFrames);
+            indexRange addFrames;
+            if (backwards)
+              addFrames = indexRange(qMax(itemRange.first, startFrame - nrFramesCachable + 1), startFrame);
+            else
+              addFrames = indexRange(startFrame, qMin(itemRange.second, startFrame + nrFramesCachable - 1));
+            enqueueCacheJob(allItems[i], addFrames, backwards);
             newCacheLevel += nrFramesCachable * allItems[i]->getCachingFrameSize();
             // ... and the rest should be removed (if they are cached)
             QList<int> cachedFrames = allItems[i]->getCachedFrames();
@@ -617,10 +680,12 @@ void videoCache::updateCacheQueue()
         }
       }
 
-      // Goto the next item in the list
-      i++;
+      // Goto the next item in the list (the previous one when playing backwards)
+      i += backwards ? -1 : 1;
       if (i >= allItems.count())
         i = 0;
+      else if (i < 0)
+        i = allItems.count() - 1;
     } while (i != itemPos);
 
     // Done. However, the list of frames that can be deleted is sorted the wrong way around. Reverse it.
@@ -854,15 +919,52 @@ void videoCache::updateCacheQueue()
 #endif
 }
 
-void videoCache::enqueueCacheJob(playlistItem* item, indexRange range)
+void videoCache::enqueueCacheJob(playlistItem* item, indexRange range, bool backwards)
 {
   // Only schedule frames for caching that were not yet cached.
   QList<int> cachedFrames = item->getCachedFrames();
-  int i = range.first;
-  while (cachedFrames.contains(i) && i < range.second)
-    range.first = ++i;
+  if (backwards)
+  {
+    int i = range.second;
+    while (cachedFrames.contains(i) && i > range.first)
+      range.second = --i;
+  }
+  else
+  {
+    int i = range.first;
+    while (cachedFrames.contains(i) && i < range.second)
+      range.first = ++i;
+  }
   if (range.first != range.second)
-    cacheQueue.append(cacheJob(item, range));
+    cacheQueue.append(cacheJob(item, range, backwards));
+}
+
+void videoCache::updateItemFrameCost(playlistItem *item, double duration)
+{
+  auto it = itemFrameCost.find(item);
+  if (it == itemFrameCost.end())
+    itemFrameCost.insert(item, duration);
+  else
+    *it += (duration - *it) * CACHING_FRAME_COST_SMOOTHING;
+}
+
+double videoCache::getCacheJobSlack(const cacheJob &job) const
+{
+  // How far (in frames) is the next frame of the job ahead of the playhead? The second job of an item
+  // (the frames before the playhead) wraps around.
+  const int frame = job.backwards ? job.frameRange.second : job.frameRange.first;
+  const int playhead = playback->getCurrentFrame();
+  int distance = job.backwards ? playhead - frame : frame - playhead;
+  if (distance < 0)
+  {
+    indexRange itemRange = job.plItem->getFrameIdxRange();
+    distance += itemRange.second - itemRange.first + 1;
+  }
+
+  // The time until the frame is shown minus the time that it takes to cache the frame
+  const double frameRate = job.plItem->getFrameRate();
+  const double framePeriod = (frameRate > 0) ? 1000.0 / frameRate : 40.0;
+  return distance * framePeriod - itemFrameCost.value(job.plItem, 0.0);
 }
 
 void videoCache::startCaching()
@@ -924,6 +1026,11 @@ void videoCache::threadCachingFinished()
   worker->setWorking(false);
   DEBUG_CACHING_DETAIL("videoCache::threadCachingFinished - state %d - worker %p", workersState, worker);
 
+  // The cost of an item that is about to be deleted must not be added again. A new item could get the same address.
+  playlistItem *finishedItem = worker->getFinishedCacheItem();
+  if (!testMode && finishedItem && !finishedItem->taggedForDeletion() && !itemsToDelete.contains(finishedItem))
+    updateItemFrameCost(finishedItem, worker->getFinishedCacheJobDuration());
+
   // Check if all threads have stopped.
   bool jobsRunning = false;
   for (loadingThread *t : cachingThreadList)
@@ -1076,6 +1183,11 @@ void videoCache::threadCachingFinished()
     for (loadingThread *t : cachingThreadList)
       if (t->worker() == worker)
         jobsRunning |= pushNextJobToCachingThread(t);
+    // Other threads may be idle because the running jobs used up all threads (cachingThreadCost).
+    // Some of these threads may be free again now.
+    for (loadingThread *t : cachingThreadList)
+      if (!t->worker()->isWorking())
+        jobsRunning |= pushNextJobToCachingThread(t);
   }
 
   if (!jobsRunning)
@@ -1161,55 +1273,82 @@ bool videoCache::pushNextJobToCachingThread(loadingThread *thread)
     }
   }
 
-  QMutableListIterator<cacheJob> j(cacheQueue);
-  playlistItem *plItem = nullptr;
-  indexRange range;
-  while (j.hasNext())
+  // Account for the threads that the decoders of the items use internally
+  const int threadLoad = getCachingThreadLoad();
+  const int maxThreadLoad = cachingThreadList.count() - deleteNrThreads;
+
+  // Find the job to take the next frame from. Usually this is the first job in the queue that we can start another
+  // thread for. The items that are shown at the playhead share the threads fairly (see getCacheJobSlack).
+  int jobIdx = -1;
+  int queueJobIdx = -1;
+  double jobSlack = 0;
+  for (int i = 0; i < cacheQueue.count(); i++)
   {
-    cacheJob &job = j.next();
+    const cacheJob &job = cacheQueue[i];
     if (!job.plItem->isCachable())
-      // Remove the item from the list
-      j.remove();
-    else 
     {
-      // We might be able to cache from this item. Check if there is a thread limit for the item.
-      int threadLimit = job.plItem->cachingThreadLimit();
-      if (threadLimit != -1)
-      {
-        // How many threads are currently caching the given item?
-        int nrThreadsForItem = 0;
-        for (loadingThread *t : cachingThreadList)
-          if (t->worker()->isWorking() && t->worker()->getCacheItem() == job.plItem)
-            nrThreadsForItem++;
-        if (nrThreadsForItem >= threadLimit)
-          // Go to the next item. We can not add another thread to this one.
-          continue;
-      }
+      // Remove the item from the list
+      cacheQueue.removeAt(i--);
+      continue;
+    }
 
-      // We can start another thread for this item
-      plItem = job.plItem;
-      range = job.frameRange;
+    if (threadLoad > 0 && threadLoad + job.plItem->cachingThreadCost() > maxThreadLoad)
+    {
+      // Caching from this item would use more threads than we have. Try the next item.
+      DEBUG_CACHING_DETAIL("videoCache::pushNextJobToCachingThread thread load %d cost %d max %d", threadLoad, job.plItem->cachingThreadCost(), maxThreadLoad);
+      continue;
+    }
 
-      // Check if this is the last frame to cache in the item 
-      if (range.first == range.second)
-        j.remove();
-      else
-        // Update the frame range of the head item in the cache queue
-        job.frameRange.first = range.first + 1;
+    // We might be able to cache from this item. Check if there is a thread limit for the item.
+    // How many threads are currently caching the given item?
+    int nrThreadsForItem = 0;
+    for (loadingThread *t : cachingThreadList)
+      if (t->worker()->isWorking() && t->worker()->getCacheItem() == job.plItem)
+        nrThreadsForItem++;
+    int threadLimit = job.plItem->cachingThreadLimit();
+    if (threadLimit != -1 && nrThreadsForItem >= threadLimit)
+      // Go to the next item. We can not add another thread to this one.
+      continue;
+
+    if (!fairShareItems.contains(job.plItem))
+    {
+      // Not shown at the playhead. Only take this job if no job of a shown item can be started.
+      if (queueJobIdx == -1)
+        queueJobIdx = i;
+      continue;
+    }
 
-      break;
+    // We can start another thread for this item. Take the job with the least slack.
+    const double slack = getCacheJobSlack(job);
+    if (jobIdx == -1 || slack < jobSlack)
+    {
+      jobIdx = i;
+      jobSlack = slack;
     }
   }
-  if (plItem == nullptr)
+  if (jobIdx == -1)
+    jobIdx = queueJobIdx;
+  if (jobIdx == -1)
     // No item found that we can start another caching thread for.
     return false;
 
+  cacheJob &job = cacheQueue[jobIdx];
+  playlistItem *plItem = job.plItem;
+  indexRange range = job.frameRange;
+  int frameToCache = job.backwards ? range.second : range.first;
+
+  // Check if this is the last frame to cache in the item 
+  if (range.first == range.second)
+    cacheQueue.removeAt(jobIdx);
+  else if (job.backwards)
+    // Update the frame range of the job in the cache queue
+    job.frameRange.second = range.second - 1;
+  else
+    job.frameRange.first = range.first + 1;
+
   // Get the size of one frame in bytes
   unsigned int frameSize = plItem->getCachingFrameSize();
 
-  // We found an item that we can cache. Cache the first frame of it.
-  int frameToCache = range.first;
-
   // First check if we need to free up space to cache this frame.
   while (cacheLevelCurrent + frameSize >= cacheLevelMax && !cacheDeQueue.isEmpty())
   {
@@ -1250,6 +1389,7 @@ void videoCache::itemAboutToBeDeleted(playlistItem* item)
   // Are we currently loading a frame from this item in one of the interactive loading threads?
   bool loadingItem = (interactiveThread[0]->worker()->getCacheItem() == item || interactiveThread[1]->worker()->getCacheItem() == item);
   bool cachingItem = false;
+  itemFrameCost.remove(item);
 
   if (workersState != workersIdle)
   {
@@ -1299,7 +1439,8 @@ void videoCache::itemNeedsRecache(playlistItem* item, recacheIndicator clearItem
   {
     // Something about the given playlistitem changed and all items in the cache are invalid.
     // If a thread is currently caching the given item, we have to stop caching, clear the cache,
-    // rethink what to cache and restart the caching.
+    // rethink what to cache and restart the caching. The time to cache a frame may have changed, too.
+    itemFrameCost.remove(item);
     if (workersState != workersIdle)
     {
       // Are we currently caching a frame from this item?
@@ -1366,13 +1507,22 @@ void videoCache::testConversionSpeed()
     workersState = workersIntReqRestart;
 }
 
+int videoCache::getCachingThreadLoad() const
+{
+  int threadLoad = 0;
+  for (loadingThread *t : cachingThreadList)
+    if (t->worker()->isWorking() && t->worker()->getCacheItem() != nullptr)
+      threadLoad += t->worker()->getCacheItem()->cachingThreadCost();
+  return threadLoad;
+}
+
 QStringList videoCache::getCacheStatusText()
 {
   QStringList txt;
   txt.append("Interactive:");
   txt.append(interactiveThread[0]->worker()->getStatus());
   txt.append(interactiveThread[1]->worker()->getStatus());
-  txt.append("Caching:");
+  txt.append(QString("Caching (thread load %1 of %2, %3 threads per decoder):").arg(getCachingThreadLoad()).arg(cachingThreadList.count()).arg(functions::getDecoderThreadCount()));
   for (loadingThread *t : cachingThreadList)
     txt.append(t->worker()->getStatus());
   return txt;
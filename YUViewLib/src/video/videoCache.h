@@ -35,6 +35,7 @@
 
 #include <QDockWidget>
 #include <QElapsedTimer>
+#include <QHash>
 #include <QLabel>
 #include <QPointer>
 #include <QProgressDialog>
@@ -106,12 +107,14 @@ private slots:
  
 private:
   // A cache job. Has a pointer to a playlist item and a range of frames to be cached.
+  // The frames are cached from the first to the last frame (from the last to the first if backwards is set).
   struct cacheJob
   {
     cacheJob() {}
-    cacheJob(playlistItem *item, indexRange range) { plItem = item; frameRange = range; }
+    cacheJob(playlistItem *item, indexRange range, bool backwards=false) { plItem = item; frameRange = range; this->backwards = backwards; }
     QPointer<playlistItem> plItem;
     indexRange frameRange;
+    bool backwards {false};
   };
   typedef QPair<QPointer<playlistItem>, int> plItemFrame;
 
@@ -134,7 +137,18 @@ private:
   int64_t cacheLevelCurrent;
 
   // Enqueue the job in the queue. If all frames within the range are already cached in the item, do nothing.
-  void enqueueCacheJob(playlistItem* item, indexRange range);
+  void enqueueCacheJob(playlistItem* item, indexRange range, bool backwards=false);
+
+  // The items that are shown at the playhead (the selected items and their children). Instead of caching these
+  // one after the other in queue order, the next frame is taken from the job with the least slack (getCacheJobSlack).
+  // So slow items (e.g. a VTM stream next to an FFmpeg stream) get the threads first and all items become playable
+  // at about the same time.
+  QList<QPointer<playlistItem>> fairShareItems;
+  // The measured time (in ms) that it takes to cache one frame of the item
+  QHash<playlistItem*, double> itemFrameCost;
+  void updateItemFrameCost(playlistItem *item, double duration);
+  // The time until the next frame of the job is shown at the playhead minus the time it takes to cache it (in ms)
+  double getCacheJobSlack(const cacheJob &job) const;
 
   // Start the given number of worker threads (if caching is running, also new jobs will be pushed to the workers)
   void startWorkerThreads(int nrThreads);
@@ -142,6 +156,9 @@ private:
   int deleteNrThreads {0};
   // How many threads are to be used when playback is running?
   int nrThreadsPlayback;
+  // How many threads are occupied by the running caching jobs? Jobs of items that decode with internal decoder
+  // threads count more than once (playlistItem::cachingThreadCost). The sum is kept below the number of caching threads.
+  int getCachingThreadLoad() const;
 
   // Our tiny internal state machine for the workers
   enum workersStateEnum
@@ -44,6 +44,9 @@
 #define DEBUG_VIDEO(fmt,...) ((void)0)
 #endif
 
+QAtomicInt videoHandler::playbackStep(1);
+QAtomicInt videoHandler::scrubbing(0);
+
 videoHandler::videoHandler()
 {
   // Initialize variables
@@ -100,26 +103,29 @@ itemLoadingState videoHandler::needsLoading(int frameIdx, bool loadRawValues)
       return state;
   }
 
+  // The frame that will be shown next (the previous one if playback runs backwards)
+  const int nextFrameIdx = frameIdx + getPlaybackStep();
+
   // Lock the mutex for checking the cache
   QMutexLocker lock(&imageCacheAccess);
 
   // The raw values are not needed. 
   if (frameIdx == currentImageIdx)
   {
-    if (doubleBufferImageFrameIdx == frameIdx + 1)
+    if (doubleBufferImageFrameIdx == nextFrameIdx)
     {
-      DEBUG_VIDEO("videoHandler::needsLoading %d is current and %d found in double buffer", frameIdx, frameIdx+1);
+      DEBUG_VIDEO("videoHandler::needsLoading %d is current and %d found in double buffer", frameIdx, nextFrameIdx);
       return LoadingNotNeeded;
     }
-    else if (cacheValid && imageCache.contains(frameIdx + 1))
+    else if (cacheValid && imageCache.contains(nextFrameIdx))
     {
-      DEBUG_VIDEO("videoHandler::needsLoading %d is current and %d found in cache", frameIdx, frameIdx+1);
+      DEBUG_VIDEO("videoHandler::needsLoading %d is current and %d found in cache", frameIdx, nextFrameIdx);
       return LoadingNotNeeded;
     }
     else
     {
       // The next frame is not in the double buffer so that needs to be loaded.
-      DEBUG_VIDEO("videoHandler::needsLoading %d is current but %d not found in double buffer", frameIdx, frameIdx+1);
+      DEBUG_VIDEO("videoHandler::needsLoading %d is current but %d not found in double buffer", frameIdx, nextFrameIdx);
       return LoadingNeededDoubleBuffer;
     }
   }
@@ -128,7 +134,7 @@ itemLoadingState videoHandler::needsLoading(int frameIdx, bool loadRawValues)
   if (doubleBufferImageFrameIdx == frameIdx)
   {
     // The frame in question is in the double buffer...
-    if (cacheValid && imageCache.contains(frameIdx + 1))
+    if (cacheValid && imageCache.contains(nextFrameIdx))
     {
       // ... and the one after that is in the cache.
       DEBUG_VIDEO("videoHandler::needsLoading %d found in double buffer. Next frame in cache.", frameIdx);
@@ -148,20 +154,20 @@ itemLoadingState videoHandler::needsLoading(int frameIdx, bool loadRawValues)
   if (cacheValid && imageCache.contains(frameIdx))
   {
     // What about the next frame? Is it also in the cache or in the double buffer?
-    if (doubleBufferImageFrameIdx == frameIdx + 1)
+    if (doubleBufferImageFrameIdx == nextFrameIdx)
     {
-      DEBUG_VIDEO("videoHandler::needsLoading %d in cache and %d found in double buffer", frameIdx, frameIdx+1);
+      DEBUG_VIDEO("videoHandler::needsLoading %d in cache and %d found in double buffer", frameIdx, nextFrameIdx);
       return LoadingNotNeeded;
     }
-    else if (cacheValid && imageCache.contains(frameIdx + 1))
+    else if (cacheValid && imageCache.contains(nextFrameIdx))
     {
-      DEBUG_VIDEO("videoHandler::needsLoading %d in cache and %d found in cache", frameIdx, frameIdx+1);
+      DEBUG_VIDEO("videoHandler::needsLoading %d in cache and %d found in cache", frameIdx, nextFrameIdx);
       return LoadingNotNeeded;
     }
     else
     {
       // The next frame is not in the double buffer so that needs to be loaded.
-      DEBUG_VIDEO("videoHandler::needsLoading %d found in cache but %d not found in double buffer", frameIdx, frameIdx+1);
+      DEBUG_VIDEO("videoHandler::needsLoading %d found in cache but %d not found in double buffer", frameIdx, nextFrameIdx);
       return LoadingNeededDoubleBuffer;
     }
   }
@@ -384,6 +390,16 @@ void videoHandler::invalidateAllBuffers()
   cacheValid = true;
 }
 
+void videoHandler::invalidateCurrentFrame()
+{
+  QMutexLocker imageLock(&currentImageSetMutex);
+  currentFrameRawData_frameIdx = -1;
+  rawData_frameIdx = -1;
+  requestedFrame_idx = -1;
+  currentImageIdx = -1;
+  doubleBufferImageFrameIdx = -1;
+}
+
 void videoHandler::activateDoubleBuffer()
 {
   if (doubleBufferImageFrameIdx != -1)
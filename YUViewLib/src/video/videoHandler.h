@@ -33,6 +33,7 @@
 #ifndef VIDEOHANDLER_H
 #define VIDEOHANDLER_H
 
+#include <QAtomicInt>
 #include <QBasicTimer>
 #include <QFileInfo>
 #include <QMutex>
@@ -127,6 +128,21 @@ public:
 
   // Scale a value with limited mpeg range (16 ... 245) to the full range (0 ... 255) for output.
   static int convScaleLimitedRange(int value);
+
+  // The double buffer always holds the frame that is shown after the current one. When playback runs backwards,
+  // this is the previous frame. The playback controller sets this when playback starts or changes its direction.
+  static void setPlaybackBackwards(bool backwards) { playbackStep.store(backwards ? -1 : 1); }
+  // The frame that is shown after frameIdx is frameIdx + getPlaybackStep()
+  static int getPlaybackStep() { return playbackStep.load(); }
+
+  // While the user drags the frame slider, items may show a fast approximation of the requested frame
+  // (e.g. the closest random access point) instead of decoding it exactly.
+  static void setScrubbing(bool scrub) { scrubbing.store(scrub ? 1 : 0); }
+  static bool isScrubbing() { return scrubbing.load() != 0; }
+
+  // The current frame (and the double buffer) do not show the exact frame that they are labeled with (e.g. an
+  // approximation while scrubbing). Mark them as invalid so that they are loaded again. The cache is not touched.
+  void invalidateCurrentFrame();
   
 signals:
 
@@ -190,6 +206,12 @@ protected:
   // Until then, however, the items that are in the cache (or are being put into the cache by the still running threads) are invalid.
   bool cacheValid;
 
+private:
+  // +1 when playing forwards, -1 when playing backwards. This is read from the loading threads.
+  static QAtomicInt playbackStep;
+  // Is the user currently scrubbing (dragging the frame slider)?
+  static QAtomicInt scrubbing;
+
 private slots:
   // Override the slotVideoControlChanged slot. For a videoHandler, also the number of frames might have changed.
   void slotVideoControlChanged() Q_DECL_OVERRIDE;
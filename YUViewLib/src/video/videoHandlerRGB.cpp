@@ -36,6 +36,7 @@
 
 #include "common/functions.h"
 #include "common/fileInfo.h"
+#include "common/loadingCancellation.h"
 
 using namespace RGB_Internals;
 
@@ -493,6 +494,11 @@ void videoHandlerRGB::loadFrame(int frameIndex, bool loadToDoubleBuffer)
     DEBUG_RGB("videoHandlerRGB::loadFrame Loading faile or is still running in the background");
     return;
   }
+  if (loadingCancellation::isCancelled())
+  {
+    DEBUG_RGB("videoHandlerRGB::loadFrame Loading was cancelled");
+    return;
+  }
 
   // The data in currentFrameRawData is now up to date. If necessary
   // convert the data to RGB.
@@ -40,6 +40,7 @@
 
 #include "common/fileInfo.h"
 #include "common/functions.h"
+#include "common/loadingCancellation.h"
 
 using namespace YUV_Internals;
 
@@ -489,6 +490,58 @@ namespace YUV_Internals
       chromaOffset[1] = 1;
   }
 
+  yuvPictureRef::yuvPictureRef(QSharedPointer<yuvPictureBuffer> buffer, const unsigned char *planeY, int strideY, const unsigned char *planeU, const unsigned char *planeV, int strideC) :
+    buffer(buffer)
+  {
+    plane[0] = planeY;
+    plane[1] = planeU;
+    plane[2] = planeV;
+    stride[0] = strideY;
+    stride[1] = strideC;
+    stride[2] = strideC;
+  }
+
+  QByteArray yuvPictureRef::toPackedBuffer(const yuvPixelFormat &format, const QSize &frameSize) const
+  {
+    if (!isValid() || !format.planar || format.uvInterleaved)
+      return QByteArray();
+
+    QByteArray packed;
+    packed.resize(format.bytesPerFrame(frameSize));
+
+    // Copy line by line. Write the planes in the order of the format.
+    const int nrBytesPerSample = (format.bitsPerSample > 8) ? 2 : 1;
+    const int nrPlanes = (format.subsampling == YUV_400) ? 1 : 3;
+    const bool uPlaneFirst = (format.planeOrder == Order_YUV || format.planeOrder == Order_YUVA);
+    char *dst = packed.data();
+    for (int i = 0; i < nrPlanes; i++)
+    {
+      const int c = (i == 0 || uPlaneFirst) ? i : 3 - i;
+      const int width = (c == 0) ? frameSize.width() : frameSize.width() / format.getSubsamplingHor();
+      const int height = (c == 0) ? frameSize.height() : frameSize.height() / format.getSubsamplingVer();
+      const int widthInBytes = width * nrBytesPerSample;
+      const unsigned char *src = plane[c];
+      for (int y = 0; y < height; y++)
+      {
+        memcpy(dst, src, widthInBytes);
+        src += stride[c];
+        dst += widthInBytes;
+      }
+    }
+    return packed;
+  }
+
+  int64_t yuvPictureRef::getMemorySize(const yuvPixelFormat &format, const QSize &frameSize) const
+  {
+    if (!isValid())
+      return 0;
+
+    int64_t nrBytes = int64_t(stride[0]) * frameSize.height();
+    if (format.subsampling != YUV_400)
+      nrBytes += int64_t(stride[1] + stride[2]) * (frameSize.height() / format.getSubsamplingVer());
+    return nrBytes;
+  }
+
   videoHandlerYUV_CustomFormatDialog::videoHandlerYUV_CustomFormatDialog(const yuvPixelFormat &yuvFormat)
   {
     setupUi(this);
@@ -1104,6 +1157,8 @@ QStringPairList videoHandlerYUV::getPixelValues(const QPoint &pixelPos, int fram
     // Do not get the pixel values if the buffer for the raw YUV values is out of date.
     if (currentFrameRawData_frameIdx != frameIdx || yuvItem2->currentFrameRawData_frameIdx != frameIdx1)
       return QStringPairList();
+    updateCurrentFrameRawData();
+    yuvItem2->updateCurrentFrameRawData();
 
     int width  = qMin(frameSize.width(), yuvItem2->frameSize.width());
     int height = qMin(frameSize.height(), yuvItem2->frameSize.height());
@@ -1159,6 +1214,7 @@ QStringPairList videoHandlerYUV::getPixelValues(const QPoint &pixelPos, int fram
     // Do not get the pixel values if the buffer for the raw YUV values is out of date.
     if (currentFrameRawData_frameIdx != frameIdx)
       return QStringPairList();
+    updateCurrentFrameRawData();
 
     if (pixelPos.x() < 0 || pixelPos.x() >= width || pixelPos.y() < 0 || pixelPos.y() >= height)
       return QStringPairList();
@@ -1224,6 +1280,9 @@ void videoHandlerYUV::drawPixelValues(QPainter *painter, const int frameIdx, con
     return;
   if (yuvItem2 && yuvItem2->currentFrameRawData_frameIdx != frameIdxItem1)
     return;
+  updateCurrentFrameRawData();
+  if (yuvItem2)
+    yuvItem2->updateCurrentFrameRawData();
 
   // For difference items, we support difference bit depths for the two items.
   // If the bit depth is different, we scale to value with the lower bit depth to the higher bit depth and calculate the difference there.
@@ -1773,20 +1832,29 @@ void videoHandlerYUV::loadFrame(int frameIndex, bool loadToDoubleBuffer)
   if (!loadRawYUVData(frameIndex))
     // Loading failed or it is still being performed in the background
     return;
+  if (loadingCancellation::isCancelled())
+    // A newer frame was requested. Don't spend time on the conversion.
+    return;
 
-  // The data in currentFrameRawData is now up to date. If necessary
+  // The data in currentFrameRawData (or currentFramePicture) is now up to date. If necessary
   // convert the data to RGB.
   if (loadToDoubleBuffer)
   {
     QImage newImage;
-    convertYUVToImage(currentFrameRawData, newImage, srcPixelFormat, frameSize);
+    if (currentFramePicture.isValid())
+      convertYUVToImage(currentFramePicture, newImage, srcPixelFormat, frameSize);
+    else
+      convertYUVToImage(currentFrameRawData, newImage, srcPixelFormat, frameSize);
     doubleBufferImage = newImage;
     doubleBufferImageFrameIdx = frameIndex;
   }
   else if (currentImageIdx != frameIndex)
   {
     QImage newImage;
-    convertYUVToImage(currentFrameRawData, newImage, srcPixelFormat, frameSize);
+    if (currentFramePicture.isValid())
+      convertYUVToImage(currentFramePicture, newImage, srcPixelFormat, frameSize);
+    else
+      convertYUVToImage(currentFrameRawData, newImage, srcPixelFormat, frameSize);
     QMutexLocker setLock(&currentImageSetMutex);    
     currentImage = newImage;
     currentImageIdx = frameIndex;
@@ -1804,6 +1872,7 @@ void videoHandlerYUV::loadFrameForCaching(int frameIndex, QImage &frameToCache)
   requestDataMutex.lock();
   emit signalRequestRawData(frameIndex, true);
   QByteArray tmpBufferRawYUVDataCaching = rawData;
+  yuvPictureRef tmpPictureCaching = rawPicture;
   requestDataMutex.unlock();
 
   if (frameIndex != rawData_frameIdx)
@@ -1814,7 +1883,10 @@ void videoHandlerYUV::loadFrameForCaching(int frameIndex, QImage &frameToCache)
   }
 
   // Convert YUV to image. This can then be cached.
-  convertYUVToImage(tmpBufferRawYUVDataCaching, frameToCache, yuvFormat, curFrameSize);
+  if (tmpPictureCaching.isValid())
+    convertYUVToImage(tmpPictureCaching, frameToCache, yuvFormat, curFrameSize);
+  else
+    convertYUVToImage(tmpBufferRawYUVDataCaching, frameToCache, yuvFormat, curFrameSize);
 }
 
 // Load the raw YUV data for the given frame index into currentFrameRawData.
@@ -1831,7 +1903,7 @@ bool videoHandlerYUV::loadRawYUVData(int frameIndex)
   requestDataMutex.lock();
   emit signalRequestRawData(frameIndex, false);
 
-  if (frameIndex != rawData_frameIdx || rawData.isEmpty())
+  if (frameIndex != rawData_frameIdx || (rawData.isEmpty() && !rawPicture.isValid()))
   {
     // Loading failed
     DEBUG_YUV("videoHandlerYUV::loadRawYUVData Loading failed");
@@ -1840,6 +1912,7 @@ bool videoHandlerYUV::loadRawYUVData(int frameIndex)
   }
 
   currentFrameRawData = rawData;
+  currentFramePicture = rawPicture;
   currentFrameRawData_frameIdx = frameIndex;
   requestDataMutex.unlock();
   
@@ -1847,6 +1920,15 @@ bool videoHandlerYUV::loadRawYUVData(int frameIndex)
   return true;
 }
 
+void videoHandlerYUV::updateCurrentFrameRawData()
+{
+  if (!currentFramePicture.isValid() || !currentFrameRawData.isEmpty())
+    return;
+
+  DEBUG_YUV("videoHandlerYUV::updateCurrentFrameRawData copy picture of frame %d", currentFrameRawData_frameIdx);
+  currentFrameRawData = currentFramePicture.toPackedBuffer(srcPixelFormat, frameSize);
+}
+
 inline int clip8Bit(int val)
 {
   if (val < 0)
@@ -1951,61 +2033,67 @@ inline void setValueInBuffer(unsigned char * restrict dst, const int val, const
 
 // For every input sample in src, apply YUV transformation, (scale to 8 bit if required) and set the value as RGB (monochrome).
 // inValSkip: skip this many values in the input for every value. For pure planar formats, this 1. If the UV components are interleaved, this is 2 or 3.
-inline void YUVPlaneToRGBMonochrome_444(const int componentSize, const yuvMathParameters math, const unsigned char * restrict src, unsigned char * restrict dst,
+// stride: The number of values from the start of one line in src to the start of the next line. For a packed plane, this is the
+// width of the plane times inValSkip. If the plane is in the buffer of a decoder, there may be padding at the end of each line.
+inline void YUVPlaneToRGBMonochrome_444(const int w, const int h, const yuvMathParameters math, const unsigned char * restrict src, const int stride, unsigned char * restrict dst,
                                         const int inMax, const int bps, const bool bigEndian, const int inValSkip, const bool fullRange)
 {
   const bool applyMath = math.yuvMathRequired();
   const int shiftTo8Bit = bps - 8;
-  for (int i = 0; i < componentSize; ++i)
-  {
-    int newVal = getValueFromSource(src, i*inValSkip, bps, bigEndian);
-    if (applyMath)
-      newVal = transformYUV(math.invert, math.scale, math.offset, newVal, inMax);
+  for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++)
+    {
+      int newVal = getValueFromSource(src, y*stride+x*inValSkip, bps, bigEndian);
+      if (applyMath)
+        newVal = transformYUV(math.invert, math.scale, math.offset, newVal, inMax);
 
-    if (shiftTo8Bit > 0)
-      newVal = clip8Bit(newVal >> shiftTo8Bit);
-    if (!fullRange)
-      newVal = videoHandler::convScaleLimitedRange(newVal);
+      if (shiftTo8Bit > 0)
+        newVal = clip8Bit(newVal >> shiftTo8Bit);
+      if (!fullRange)
+        newVal = videoHandler::convScaleLimitedRange(newVal);
 
-    // Set the value for R, G and B (BGRA)
-    dst[i*4  ] = (unsigned char)newVal;
-    dst[i*4+1] = (unsigned char)newVal;
-    dst[i*4+2] = (unsigned char)newVal;
-    dst[i*4+3] = (unsigned char)255;
-  }
+      // Set the value for R, G and B (BGRA)
+      const int i = y*w+x;
+      dst[i*4  ] = (unsigned char)newVal;
+      dst[i*4+1] = (unsigned char)newVal;
+      dst[i*4+2] = (unsigned char)newVal;
+      dst[i*4+3] = (unsigned char)255;
+    }
 }
 
 // For every input sample in the YZV 422 src, apply interpolation (sample and hold), apply YUV transformation, (scale to 8 bit if required)
 // and set the value as RGB (monochrome).
-inline void YUVPlaneToRGBMonochrome_422(const int componentSize, const yuvMathParameters math, const unsigned char * restrict src, unsigned char * restrict dst,
+inline void YUVPlaneToRGBMonochrome_422(const int w, const int h, const yuvMathParameters math, const unsigned char * restrict src, const int stride, unsigned char * restrict dst,
                                         const int inMax, const int bps, const bool bigEndian, const int inValSkip, const bool fullRange)
 {
   const bool applyMath = math.yuvMathRequired();
   const int shiftTo8Bit = bps - 8;
-  for (int i = 0; i < componentSize; ++i)
-  {
-    int newVal = getValueFromSource(src, i*inValSkip, bps, bigEndian);
-    if (applyMath)
-      newVal = transformYUV(math.invert, math.scale, math.offset, newVal, inMax);
+  for (int y = 0; y < h; y++)
+    for (int x = 0; x < w/2; x++)
+    {
+      int newVal = getValueFromSource(src, y*stride+x*inValSkip, bps, bigEndian);
+      if (applyMath)
+        newVal = transformYUV(math.invert, math.scale, math.offset, newVal, inMax);
 
-    if (shiftTo8Bit > 0)
-      newVal = clip8Bit(newVal >> shiftTo8Bit);
-    if (!fullRange)
-      newVal = videoHandler::convScaleLimitedRange(newVal);
+      if (shiftTo8Bit > 0)
+        newVal = clip8Bit(newVal >> shiftTo8Bit);
+      if (!fullRange)
+        newVal = videoHandler::convScaleLimitedRange(newVal);
 
-    // Set the value for R, G and B of 2 pixels (BGRA)
-    dst[i*8  ] = (unsigned char)newVal;
-    dst[i*8+1] = (unsigned char)newVal;
-    dst[i*8+2] = (unsigned char)newVal;
-    dst[i*8+3] = (unsigned char)255;
-    dst[i*8+4] = (unsigned char)newVal;
-    dst[i*8+5] = (unsigned char)newVal;
-    dst[i*8+6] = (unsigned char)newVal;
-    dst[i*8+7] = (unsigned char)255;
-  }
+      // Set the value for R, G and B of 2 pixels (BGRA)
+      const int o = (y*w + x*2)*4;
+      dst[o  ] = (unsigned char)newVal;
+      dst[o+1] = (unsigned char)newVal;
+      dst[o+2] = (unsigned char)newVal;
+      dst[o+3] = (unsigned char)255;
+      dst[o+4] = (unsigned char)newVal;
+      dst[o+5] = (unsigned char)newVal;
+      dst[o+6] = (unsigned char)newVal;
+      dst[o+7] = (unsigned char)255;
+    }
 }
 
-inline void YUVPlaneToRGBMonochrome_420(const int w, const int h, const yuvMathParameters math, const unsigned char * restrict src, unsigned char * restrict dst,
+inline void YUVPlaneToRGBMonochrome_420(const int w, const int h, const yuvMathParameters math, const unsigned char * restrict src, const int stride, unsigned char * restrict dst,
                                         const int inMax, const int bps, const bool bigEndian, const int inValSkip, const bool fullRange)
 {
   const bool applyMath = math.yuvMathRequired();
@@ -2013,8 +2101,7 @@ inline void YUVPlaneToRGBMonochrome_420(const int w, const int h, const yuvMathP
   for (int y = 0; y < h/2; y++)
     for (int x = 0; x < w/2; x++)
     {
-      const int srcIdx = y*(w/2)+x;
-      int newVal = getValueFromSource(src, srcIdx*inValSkip, bps, bigEndian);
+      int newVal = getValueFromSource(src, y*stride+x*inValSkip, bps, bigEndian);
       if (applyMath)
         newVal = transformYUV(math.invert, math.scale, math.offset, newVal, inMax);
 
@@ -2204,7 +2291,7 @@ inline int interpolateUV8Pos(int prev, int cur, const int offsetX8)
 
 // Re-sample the chroma component so that the chroma samples and the luma samples are aligned after this operation.
 inline void UVPlaneResamplingChromaOffset(const yuvPixelFormat format, const int w, const int h, 
-                                          const unsigned char * restrict srcU, const unsigned char * restrict srcV, const int inValSkip,
+                                          const unsigned char * restrict srcU, const unsigned char * restrict srcV, const int srcStride, const int inValSkip,
                                           unsigned char * restrict dstU, unsigned char * restrict dstV)
 {
   // We can perform linear interpolation for 7 positions (6 in between) two pixels.
@@ -2218,18 +2305,17 @@ inline void UVPlaneResamplingChromaOffset(const yuvPixelFormat format, const int
   const bool bigEndian = format.bigEndian;
   const int bps = format.bitsPerSample;
 
-  const int stride = bps > 8 ? w*2 : w;
   if (offsetX8 != 0)
   {
     // Perform horizontal re-sampling
     for (int y = 0; y < h; y++)
     {
       // On the left side, there is no previous sample, so the first value is never changed.
-      const int srcIdx = y * stride * inValSkip;
+      const int srcIdx = y * srcStride;
       int prevU = getValueFromSource(srcU, srcIdx, bps, bigEndian);
       int prevV = getValueFromSource(srcV, srcIdx, bps, bigEndian);
-      setValueInBuffer(dstU, prevU, y*stride, bps, bigEndian);
-      setValueInBuffer(dstV, prevV, y*stride, bps, bigEndian);
+      setValueInBuffer(dstU, prevU, y*w, bps, bigEndian);
+      setValueInBuffer(dstV, prevV, y*w, bps, bigEndian);
 
       for (int x = 0; x < w-1; x++)
       {
@@ -2241,8 +2327,8 @@ inline void UVPlaneResamplingChromaOffset(const yuvPixelFormat format, const int
         // Perform interpolation and save the value for the current UV value. Goto next value.
         int newU = interpolateUV8Pos(prevU, curU, offsetX8);
         int newV = interpolateUV8Pos(prevV, curV, offsetX8);
-        setValueInBuffer(dstU, newU, y*stride+x, bps, bigEndian);
-        setValueInBuffer(dstV, newV, y*stride+x, bps, bigEndian);
+        setValueInBuffer(dstU, newU, y*w+x, bps, bigEndian);
+        setValueInBuffer(dstV, newV, y*w+x, bps, bigEndian);
 
         prevU = curU;
         prevV = curV;
@@ -2254,6 +2340,7 @@ inline void UVPlaneResamplingChromaOffset(const yuvPixelFormat format, const int
   const unsigned char *srcUStep2 = (offsetX8 == 0) ? srcU : dstU;
   const unsigned char *srcVStep2 = (offsetX8 == 0) ? srcV : dstV;
   const int valSkipStep2 = (offsetX8 == 0) ? inValSkip : 1;
+  const int strideStep2 = (offsetX8 == 0) ? srcStride : w;
 
   if (offsetY8 != 0)
   {
@@ -2269,15 +2356,15 @@ inline void UVPlaneResamplingChromaOffset(const yuvPixelFormat format, const int
       for (int y = 0; y < h-1; y++)
       {
         // Calculate the new current value using the previous and the current value
-        const int srcIdx = (y+1) * w + x;
-        int curU = getValueFromSource(srcUStep2, srcIdx*valSkipStep2, bps, bigEndian);
-        int curV = getValueFromSource(srcVStep2, srcIdx*valSkipStep2, bps, bigEndian);
+        const int srcIdx = (y+1) * strideStep2 + x*valSkipStep2;
+        int curU = getValueFromSource(srcUStep2, srcIdx, bps, bigEndian);
+        int curV = getValueFromSource(srcVStep2, srcIdx, bps, bigEndian);
 
         // Perform interpolation and save the value for the current UV value. Goto next value.
         int newU = interpolateUV8Pos(prevU, curU, offsetY8);
         int newV = interpolateUV8Pos(prevV, curV, offsetY8);
-        setValueInBuffer(dstU, newU, srcIdx, bps, bigEndian);
-        setValueInBuffer(dstV, newV, srcIdx, bps, bigEndian);
+        setValueInBuffer(dstU, newU, (y+1)*w+x, bps, bigEndian);
+        setValueInBuffer(dstV, newV, (y+1)*w+x, bps, bigEndian);
 
         prevU = curU;
         prevV = curV;
@@ -2286,41 +2373,43 @@ inline void UVPlaneResamplingChromaOffset(const yuvPixelFormat format, const int
   }
 }
 
-inline void YUVPlaneToRGB_444(const int componentSize, const yuvMathParameters mathY, const yuvMathParameters mathC,
-                              const unsigned char * restrict srcY, const unsigned char * restrict srcU, const unsigned char * restrict srcV,
+inline void YUVPlaneToRGB_444(const int w, const int h, const yuvMathParameters mathY, const yuvMathParameters mathC,
+                              const unsigned char * restrict srcY, const unsigned char * restrict srcU, const unsigned char * restrict srcV, const int strideY, const int strideC,
                               unsigned char * restrict dst, const int RGBConv[5], const bool fullRange, const int inMax, const int bps, const bool bigEndian, const int inValSkip)
 {
   const bool applyMathLuma = mathY.yuvMathRequired();
   const bool applyMathChroma = mathC.yuvMathRequired();
 
-  for (int i = 0; i < componentSize; ++i)
-  {
-    unsigned int valY = getValueFromSource(srcY, i, bps, bigEndian);
-    unsigned int valU = getValueFromSource(srcU, i*inValSkip, bps, bigEndian);
-    unsigned int valV = getValueFromSource(srcV, i*inValSkip, bps, bigEndian);
-
-    if (applyMathLuma)
-      valY = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY, inMax);
-    if (applyMathChroma)
+  for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++)
     {
-      valU = transformYUV(mathC.invert, mathC.scale, mathC.offset, valU, inMax);
-      valV = transformYUV(mathC.invert, mathC.scale, mathC.offset, valV, inMax);
-    }
+      unsigned int valY = getValueFromSource(srcY, y*strideY+x, bps, bigEndian);
+      unsigned int valU = getValueFromSource(srcU, y*strideC+x*inValSkip, bps, bigEndian);
+      unsigned int valV = getValueFromSource(srcV, y*strideC+x*inValSkip, bps, bigEndian);
 
-    // Get the RGB values for this sample
-    int valR, valG, valB;
-    convertYUVToRGB8Bit(valY, valU, valV, valR, valG, valB, RGBConv, fullRange, bps);
+      if (applyMathLuma)
+        valY = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY, inMax);
+      if (applyMathChroma)
+      {
+        valU = transformYUV(mathC.invert, mathC.scale, mathC.offset, valU, inMax);
+        valV = transformYUV(mathC.invert, mathC.scale, mathC.offset, valV, inMax);
+      }
 
-    // Save the RGB values
-    dst[i*4  ] = valB;
-    dst[i*4+1] = valG;
-    dst[i*4+2] = valR;
-    dst[i*4+3] = 255;
-  }
+      // Get the RGB values for this sample
+      int valR, valG, valB;
+      convertYUVToRGB8Bit(valY, valU, valV, valR, valG, valB, RGBConv, fullRange, bps);
+
+      // Save the RGB values
+      const int i = y*w+x;
+      dst[i*4  ] = valB;
+      dst[i*4+1] = valG;
+      dst[i*4+2] = valR;
+      dst[i*4+3] = 255;
+    }
 }
 
 inline void YUVPlaneToRGB_422(const int w, const int h, const yuvMathParameters mathY, const yuvMathParameters mathC,
-                              const unsigned char * restrict srcY, const unsigned char * restrict srcU, const unsigned char * restrict srcV,
+                              const unsigned char * restrict srcY, const unsigned char * restrict srcU, const unsigned char * restrict srcV, const int strideY, const int strideC,
                               unsigned char * restrict dst, const int RGBConv[5], const bool fullRange, const int inMax, const InterpolationMode interpolation, const int bps, const bool bigEndian, const int inValSkip)
 {
   const bool applyMathLuma = mathY.yuvMathRequired();
@@ -2328,9 +2417,9 @@ inline void YUVPlaneToRGB_422(const int w, const int h, const yuvMathParameters
   // Horizontal up-sampling is required. Process two Y values at a time
   for (int y = 0; y < h; y++)
   {
-    const int srcIdxUV = y*w/2;
-    int curUSample = getValueFromSource(srcU, srcIdxUV*inValSkip, bps, bigEndian);
-    int curVSample = getValueFromSource(srcV, srcIdxUV*inValSkip, bps, bigEndian);
+    const int srcIdxUV = y*strideC;
+    int curUSample = getValueFromSource(srcU, srcIdxUV, bps, bigEndian);
+    int curVSample = getValueFromSource(srcV, srcIdxUV, bps, bigEndian);
     if (applyMathChroma)
     {
       curUSample = transformYUV(mathC.invert, mathC.scale, mathC.offset, curUSample, inMax);
@@ -2340,9 +2429,9 @@ inline void YUVPlaneToRGB_422(const int w, const int h, const yuvMathParameters
     for (int x = 0; x < (w/2)-1; x++)
     {
       // Get the next U/V sample
-      const int srcPosLineUV = srcIdxUV + x + 1;
-      int nextUSample = getValueFromSource(srcU, srcPosLineUV*inValSkip, bps, bigEndian);
-      int nextVSample = getValueFromSource(srcV, srcPosLineUV*inValSkip, bps, bigEndian);
+      const int srcPosLineUV = srcIdxUV + (x+1)*inValSkip;
+      int nextUSample = getValueFromSource(srcU, srcPosLineUV, bps, bigEndian);
+      int nextVSample = getValueFromSource(srcV, srcPosLineUV, bps, bigEndian);
       if (applyMathChroma)
       {
         nextUSample = transformYUV(mathC.invert, mathC.scale, mathC.offset, nextUSample, inMax);
@@ -2354,8 +2443,8 @@ inline void YUVPlaneToRGB_422(const int w, const int h, const yuvMathParameters
       int interpolatedV = interpolateUVSample(interpolation, curVSample, nextVSample);
 
       // Get the 2 Y samples
-      int valY1 = getValueFromSource(srcY, y*w+x*2,   bps, bigEndian);
-      int valY2 = getValueFromSource(srcY, y*w+x*2+1, bps, bigEndian);
+      int valY1 = getValueFromSource(srcY, y*strideY+x*2,   bps, bigEndian);
+      int valY2 = getValueFromSource(srcY, y*strideY+x*2+1, bps, bigEndian);
       if (applyMathLuma)
       {
         valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2384,8 +2473,8 @@ inline void YUVPlaneToRGB_422(const int w, const int h, const yuvMathParameters
     // For the last row, there is no next sample. Just reuse the current one again. No interpolation required either.
 
     // Get the 2 Y samples
-    int valY1 = getValueFromSource(srcY, (y+1)*w-2, bps, bigEndian);
-    int valY2 = getValueFromSource(srcY, (y+1)*w-1, bps, bigEndian);
+    int valY1 = getValueFromSource(srcY, y*strideY+w-2, bps, bigEndian);
+    int valY2 = getValueFromSource(srcY, y*strideY+w-1, bps, bigEndian);
     if (applyMathLuma)
     {
       valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2500,7 +2589,7 @@ inline void YUVPlaneToRGB_440(const int w, const int h, const yuvMathParameters
 }
 
 inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters mathY, const yuvMathParameters mathC,
-                              const unsigned char * restrict srcY, const unsigned char * restrict srcU, const unsigned char * restrict srcV,
+                              const unsigned char * restrict srcY, const unsigned char * restrict srcU, const unsigned char * restrict srcV, const int strideY, const int strideC,
                               unsigned char * restrict dst, const int RGBConv[5], const bool fullRange,const int inMax, const InterpolationMode interpolation, const int bps, const bool bigEndian, const int inValSkip)
 {
   const bool applyMathLuma = mathY.yuvMathRequired();
@@ -2511,12 +2600,12 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
   for (int y = 0; y < hh-1; y++)
   {
     // Get the current U/V samples for this y line and the next one (_NL)
-    const int srcIdxUV0 = y*wh;
-    const int srcIdxUV1 = (y+1)*wh;
-    int curU    = getValueFromSource(srcU, srcIdxUV0*inValSkip, bps, bigEndian);
-    int curV    = getValueFromSource(srcV, srcIdxUV0*inValSkip, bps, bigEndian);
-    int curU_NL = getValueFromSource(srcU, srcIdxUV1*inValSkip, bps, bigEndian);
-    int curV_NL = getValueFromSource(srcV, srcIdxUV1*inValSkip, bps, bigEndian);
+    const int srcIdxUV0 = y*strideC;
+    const int srcIdxUV1 = (y+1)*strideC;
+    int curU    = getValueFromSource(srcU, srcIdxUV0, bps, bigEndian);
+    int curV    = getValueFromSource(srcV, srcIdxUV0, bps, bigEndian);
+    int curU_NL = getValueFromSource(srcU, srcIdxUV1, bps, bigEndian);
+    int curV_NL = getValueFromSource(srcV, srcIdxUV1, bps, bigEndian);
     if (applyMathChroma)
     {
       curU    = transformYUV(mathC.invert, mathC.scale, mathC.offset, curU, inMax);
@@ -2528,12 +2617,12 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
     for (int x = 0; x < wh-1; x++)
     {
       // Get the next U/V sample for this line and the next one
-      const int srcIdxUVLine0 = srcIdxUV0 + x + 1;
-      const int srcIdxUVLine1 = srcIdxUV1 + x + 1;
-      int nextU    = getValueFromSource(srcU, srcIdxUVLine0*inValSkip, bps, bigEndian);
-      int nextV    = getValueFromSource(srcV, srcIdxUVLine0*inValSkip, bps, bigEndian);
-      int nextU_NL = getValueFromSource(srcU, srcIdxUVLine1*inValSkip, bps, bigEndian);
-      int nextV_NL = getValueFromSource(srcV, srcIdxUVLine1*inValSkip, bps, bigEndian);
+      const int srcIdxUVLine0 = srcIdxUV0 + (x+1)*inValSkip;
+      const int srcIdxUVLine1 = srcIdxUV1 + (x+1)*inValSkip;
+      int nextU    = getValueFromSource(srcU, srcIdxUVLine0, bps, bigEndian);
+      int nextV    = getValueFromSource(srcV, srcIdxUVLine0, bps, bigEndian);
+      int nextU_NL = getValueFromSource(srcU, srcIdxUVLine1, bps, bigEndian);
+      int nextV_NL = getValueFromSource(srcV, srcIdxUVLine1, bps, bigEndian);
       if (applyMathChroma)
       {
         nextU    = transformYUV(mathC.invert, mathC.scale, mathC.offset, nextU, inMax);
@@ -2551,10 +2640,10 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
       int interpolatedV_Bi  = interpolateUVSample2D(interpolation, curV, nextV, curV_NL, nextV_NL);   // 2D interpolation
 
       // Get the 4 Y samples
-      int valY1 = getValueFromSource(srcY, (y*w+x)*2,   bps, bigEndian);
-      int valY2 = getValueFromSource(srcY, (y*w+x)*2+1, bps, bigEndian);
-      int valY3 = getValueFromSource(srcY, (y*2+1)*w+x*2,   bps, bigEndian);
-      int valY4 = getValueFromSource(srcY, (y*2+1)*w+x*2+1, bps, bigEndian);
+      int valY1 = getValueFromSource(srcY, y*2*strideY+x*2,       bps, bigEndian);
+      int valY2 = getValueFromSource(srcY, y*2*strideY+x*2+1,     bps, bigEndian);
+      int valY3 = getValueFromSource(srcY, (y*2+1)*strideY+x*2,   bps, bigEndian);
+      int valY4 = getValueFromSource(srcY, (y*2+1)*strideY+x*2+1, bps, bigEndian);
       if (applyMathLuma)
       {
         valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2600,10 +2689,10 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
     int interpolatedV_Ver = interpolateUVSample(interpolation, curV, curV_NL);
 
     // Get the 4 Y samples
-    int valY1 = getValueFromSource(srcY, (y*2+1)*w-2, bps, bigEndian);
-    int valY2 = getValueFromSource(srcY, (y*2+1)*w-1, bps, bigEndian);
-    int valY3 = getValueFromSource(srcY, (y*2+2)*w-2, bps, bigEndian);
-    int valY4 = getValueFromSource(srcY, (y*2+2)*w-1, bps, bigEndian);
+    int valY1 = getValueFromSource(srcY, y*2*strideY+w-2,     bps, bigEndian);
+    int valY2 = getValueFromSource(srcY, y*2*strideY+w-1,     bps, bigEndian);
+    int valY3 = getValueFromSource(srcY, (y*2+1)*strideY+w-2, bps, bigEndian);
+    int valY4 = getValueFromSource(srcY, (y*2+1)*strideY+w-1, bps, bigEndian);
     if (applyMathLuma)
     {
       valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2645,9 +2734,9 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
   const int y2 = (hh-1)*2;
 
   // Get 2 chroma samples from this line
-  const int srcIdxUV = y*wh;
-  int curU = getValueFromSource(srcU, srcIdxUV*inValSkip, bps, bigEndian);
-  int curV = getValueFromSource(srcV, srcIdxUV*inValSkip, bps, bigEndian);
+  const int srcIdxUV = y*strideC;
+  int curU = getValueFromSource(srcU, srcIdxUV, bps, bigEndian);
+  int curV = getValueFromSource(srcV, srcIdxUV, bps, bigEndian);
   if (applyMathChroma)
   {
     curU = transformYUV(mathC.invert, mathC.scale, mathC.offset, curU, inMax);
@@ -2657,9 +2746,9 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
   for (int x = 0; x < (w/2)-1; x++)
   {
     // Get the next U/V sample for this line and the next one
-    const int srcIdxLineUV = srcIdxUV + x + 1;
-    int nextU = getValueFromSource(srcU, srcIdxLineUV*inValSkip, bps, bigEndian);
-    int nextV = getValueFromSource(srcV, srcIdxLineUV*inValSkip, bps, bigEndian);
+    const int srcIdxLineUV = srcIdxUV + (x+1)*inValSkip;
+    int nextU = getValueFromSource(srcU, srcIdxLineUV, bps, bigEndian);
+    int nextV = getValueFromSource(srcV, srcIdxLineUV, bps, bigEndian);
     if (applyMathChroma)
     {
       nextU = transformYUV(mathC.invert, mathC.scale, mathC.offset, nextU, inMax);
@@ -2671,10 +2760,10 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
     int interpolatedV_Hor = interpolateUVSample(interpolation, curV, nextV);
 
     // Get the 4 Y samples
-    int valY1 = getValueFromSource(srcY, (y*w+x)*2,      bps, bigEndian);
-    int valY2 = getValueFromSource(srcY, (y*w+x)*2+1,    bps, bigEndian);
-    int valY3 = getValueFromSource(srcY, (y2+1)*w+x*2,   bps, bigEndian);
-    int valY4 = getValueFromSource(srcY, (y2+1)*w+x*2+1, bps, bigEndian);
+    int valY1 = getValueFromSource(srcY, y2*strideY+x*2,       bps, bigEndian);
+    int valY2 = getValueFromSource(srcY, y2*strideY+x*2+1,     bps, bigEndian);
+    int valY3 = getValueFromSource(srcY, (y2+1)*strideY+x*2,   bps, bigEndian);
+    int valY4 = getValueFromSource(srcY, (y2+1)*strideY+x*2+1, bps, bigEndian);
     if (applyMathLuma)
     {
       valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2717,10 +2806,10 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
   // Just sample and hold. No interpolation is required.
 
   // Get the 4 Y samples
-  int valY1 = getValueFromSource(srcY, (y2+1)*w-2, bps, bigEndian);
-  int valY2 = getValueFromSource(srcY, (y2+1)*w-1, bps, bigEndian);
-  int valY3 = getValueFromSource(srcY, (y2+2)*w-2, bps, bigEndian);
-  int valY4 = getValueFromSource(srcY, (y2+2)*w-1, bps, bigEndian);
+  int valY1 = getValueFromSource(srcY, y2*strideY+w-2,     bps, bigEndian);
+  int valY2 = getValueFromSource(srcY, y2*strideY+w-1,     bps, bigEndian);
+  int valY3 = getValueFromSource(srcY, (y2+1)*strideY+w-2, bps, bigEndian);
+  int valY4 = getValueFromSource(srcY, (y2+1)*strideY+w-1, bps, bigEndian);
   if (applyMathLuma)
   {
     valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -3077,6 +3166,40 @@ bool videoHandlerYUV::convertYUVPackedToPlanar(const QByteArray &sourceBuffer, Q
 }
 
 bool videoHandlerYUV::convertYUVPlanarToRGB(const QByteArray &sourceBuffer, uchar *targetBuffer, const QSize &curFrameSize, const yuvPixelFormat &sourceBufferFormat) const
+{
+  const yuvPixelFormat format = sourceBufferFormat;
+  const int w = curFrameSize.width();
+  const int h = curFrameSize.height();
+  const int bps = format.bitsPerSample;
+
+  // The luma component has full resolution. The size of each chroma components depends on the subsampling.
+  const int componentSizeLuma = (w * h);
+  const int componentSizeChroma = (w / format.getSubsamplingHor()) * (h / format.getSubsamplingVer());
+
+  // How many bytes are in each component?
+  const int nrBytesLumaPlane = (bps > 8) ? componentSizeLuma * 2 : componentSizeLuma;
+  const int nrBytesChromaPlane = (bps > 8) ? componentSizeChroma * 2 : componentSizeChroma;
+
+  // If the U and V (and A if present) components are interlevaed, we have to skip every nth value in the input when reading U and V
+  const int inputValSkip = format.uvInterleaved ? ((format.planeOrder == Order_YUV || format.planeOrder == Order_YVU) ? 2 : 3) : 1;
+
+  // Is the U plane the first or the second?
+  const bool uPlaneFirst = (format.planeOrder == Order_YUV || format.planeOrder == Order_YUVA);
+
+  // In case the U and V (and A if present) components are interleaved, the skip to the next plane is just 1 (or 2) bytes
+  int nrBytesToNextChromaPlane = nrBytesChromaPlane;
+  if (format.uvInterleaved)
+    nrBytesToNextChromaPlane = (bps > 8) ? 2 : 1;
+
+  // Get the pointers to the source planes. In the buffer, there is no padding at the end of the lines.
+  const unsigned char *srcY = (const unsigned char*)sourceBuffer.data();
+  const unsigned char *srcU = uPlaneFirst ? srcY + nrBytesLumaPlane : srcY + nrBytesLumaPlane + nrBytesToNextChromaPlane;
+  const unsigned char *srcV = uPlaneFirst ? srcY + nrBytesLumaPlane + nrBytesToNextChromaPlane: srcY + nrBytesLumaPlane;
+
+  return convertYUVPlanarToRGB(srcY, srcU, srcV, w, (w / format.getSubsamplingHor()) * inputValSkip, targetBuffer, curFrameSize, format);
+}
+
+bool videoHandlerYUV::convertYUVPlanarToRGB(const unsigned char *planeY, const unsigned char *planeU, const unsigned char *planeV, const int strideY, const int strideC, uchar *targetBuffer, const QSize &curFrameSize, const yuvPixelFormat &sourceBufferFormat) const
 {
   // These are constant for the runtime of this function. This way, the compiler can optimize the
   // hell out of this function.
@@ -3103,18 +3226,23 @@ bool videoHandlerYUV::convertYUVPlanarToRGB(const QByteArray &sourceBuffer, ucha
   Q_UNUSED(yOffset);
   Q_UNUSED(cZero);
 
-  // The luma component has full resolution. The size of each chroma components depends on the subsampling.
-  const int componentSizeLuma = (w * h);
-  const int componentSizeChroma = (w / format.getSubsamplingHor()) * (h / format.getSubsamplingVer());
-
-  // How many bytes are in each component?
-  const int nrBytesLumaPlane = (bps > 8) ? componentSizeLuma * 2 : componentSizeLuma;
+  // The size of each chroma components depends on the subsampling.
+  const int widthChroma = w / format.getSubsamplingHor();
+  const int heightChroma = h / format.getSubsamplingVer();
+  const int componentSizeChroma = widthChroma * heightChroma;
   const int nrBytesChromaPlane = (bps > 8) ? componentSizeChroma * 2 : componentSizeChroma;
 
   // If the U and V (and A if present) components are interlevaed, we have to skip every nth value in the input when reading U and V
   const int inputValSkip = format.uvInterleaved ? ((format.planeOrder == Order_YUV || format.planeOrder == Order_YVU) ? 2 : 3) : 1;
 
-  // A pointer to the output
+  // Only the 4:4:4, 4:2:2, 4:2:0 and 4:0:0 conversions can read lines with padding. The others need packed planes.
+  Q_ASSERT(format.subsampling == YUV_444 || format.subsampling == YUV_422 || format.subsampling == YUV_420 || format.subsampling == YUV_400 ||
+           (strideY == w && strideC == widthChroma * inputValSkip));
+
+  // Pointers to the source and the output
+  const unsigned char * restrict srcY = planeY;
+  const unsigned char * restrict srcU = planeU;
+  const unsigned char * restrict srcV = planeV;
   unsigned char * restrict dst = targetBuffer;
 
   if (component != DisplayAll || format.subsampling == YUV_400)
@@ -3123,31 +3251,18 @@ bool videoHandlerYUV::convertYUVPlanarToRGB(const QByteArray &sourceBuffer, ucha
     if (component == DisplayY || format.subsampling == YUV_400)
     {
       // Luma only. The chroma subsampling does not matter.
-      const unsigned char * restrict srcY = (unsigned char*)sourceBuffer.data();
-      YUVPlaneToRGBMonochrome_444(componentSizeLuma, mathY, srcY, dst, inputMax, bps, format.bigEndian, 1, fullRange);
+      YUVPlaneToRGBMonochrome_444(w, h, mathY, srcY, strideY, dst, inputMax, bps, format.bigEndian, 1, fullRange);
     }
     else
     {
       // Display only the U or V component
-      bool firstComponent = (((format.planeOrder == Order_YUV || format.planeOrder == Order_YUVA) && component == DisplayCb) ||
-                             ((format.planeOrder == Order_YVU || format.planeOrder == Order_YVUA) && component == DisplayCr));
-      
-      int srcOffset = nrBytesLumaPlane;
-      if (!firstComponent)
-      {
-        if (format.uvInterleaved)
-          srcOffset += (bps > 8) ? 2 : 1;
-        else
-          srcOffset += nrBytesChromaPlane;
-      }
-
-      const unsigned char * restrict srcC = (unsigned char*)sourceBuffer.data() + srcOffset;
+      const unsigned char * restrict srcC = (component == DisplayCb) ? srcU : srcV;
       if (format.subsampling == YUV_444)
-        YUVPlaneToRGBMonochrome_444(componentSizeChroma, mathC, srcC, dst, inputMax, bps, format.bigEndian, inputValSkip, fullRange);
+        YUVPlaneToRGBMonochrome_444(w, h, mathC, srcC, strideC, dst, inputMax, bps, format.bigEndian, inputValSkip, fullRange);
       else if (format.subsampling == YUV_422)
-        YUVPlaneToRGBMonochrome_422(componentSizeChroma, mathC, srcC, dst, inputMax, bps, format.bigEndian, inputValSkip, fullRange);
+        YUVPlaneToRGBMonochrome_422(w, h, mathC, srcC, strideC, dst, inputMax, bps, format.bigEndian, inputValSkip, fullRange);
       else if (format.subsampling == YUV_420)
-        YUVPlaneToRGBMonochrome_420(w, h, mathC, srcC, dst, inputMax, bps, format.bigEndian, inputValSkip, fullRange);
+        YUVPlaneToRGBMonochrome_420(w, h, mathC, srcC, strideC, dst, inputMax, bps, format.bigEndian, inputValSkip, fullRange);
       else if (format.subsampling == YUV_440)
         YUVPlaneToRGBMonochrome_440(w, h, mathC, srcC, dst, inputMax, bps, format.bigEndian, inputValSkip, fullRange);
       else if (format.subsampling == YUV_410)
@@ -3160,14 +3275,6 @@ bool videoHandlerYUV::convertYUVPlanarToRGB(const QByteArray &sourceBuffer, ucha
   }
   else
   {
-    // Is the U plane the first or the second?
-    const bool uPlaneFirst = (format.planeOrder == Order_YUV || format.planeOrder == Order_YUVA);
-
-    // In case the U and V (and A if present) components are interleaved, the skip to the next plane is just 1 (or 2) bytes
-    int nrBytesToNextChromaPlane = nrBytesChromaPlane;
-    if (format.uvInterleaved)
-      nrBytesToNextChromaPlane = (bps > 8) ? 2 : 1;
-
     // Get/set the parameters used for YUV -> RGB conversion
     const int RGBConv[5] = { 
       yuvRgbConvCoeffs[yuvColorConversionType][0],
@@ -3189,18 +3296,15 @@ bool videoHandlerYUV::convertYUVPlanarToRGB(const QByteArray &sourceBuffer, ucha
       // We have to perform pre-filtering for the U and V positions, because there is an offset between the pixel positions of Y and U/V
       unsigned char *restrict dstU = (unsigned char*)uvPlaneChromaResampled[0].data();
       unsigned char *restrict dstV = (unsigned char*)uvPlaneChromaResampled[1].data();
+      UVPlaneResamplingChromaOffset(format, widthChroma, heightChroma, srcU, srcV, strideC, inputValSkip, dstU, dstV);
 
-      unsigned char * restrict srcY = (unsigned char*)sourceBuffer.data();
-      unsigned char * restrict srcU = uPlaneFirst ? srcY + nrBytesLumaPlane : srcY + nrBytesLumaPlane + nrBytesToNextChromaPlane;
-      unsigned char * restrict srcV = uPlaneFirst ? srcY + nrBytesLumaPlane + nrBytesToNextChromaPlane: srcY + nrBytesLumaPlane;
-      UVPlaneResamplingChromaOffset(format, w / format.getSubsamplingHor(), h / format.getSubsamplingVer(), srcU, srcV, inputValSkip, dstU, dstV);
-
+      // The resampled chroma planes are packed
       if (format.subsampling == YUV_444)
-        YUVPlaneToRGB_444(componentSizeLuma, mathY, mathC, srcY, dstU, dstV, dst, RGBConv, fullRange, inputMax, bps, format.bigEndian, 1);
+        YUVPlaneToRGB_444(w, h, mathY, mathC, srcY, dstU, dstV, strideY, widthChroma, dst, RGBConv, fullRange, inputMax, bps, format.bigEndian, 1);
       else if (format.subsampling == YUV_422)
-        YUVPlaneToRGB_422(w, h, mathY, mathC, srcY, dstU, dstV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, 1);
+        YUVPlaneToRGB_422(w, h, mathY, mathC, srcY, dstU, dstV, strideY, widthChroma, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, 1);
       else if (format.subsampling == YUV_420)
-        YUVPlaneToRGB_420(w, h, mathY, mathC, srcY, dstU, dstV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, 1);
+        YUVPlaneToRGB_420(w, h, mathY, mathC, srcY, dstU, dstV, strideY, widthChroma, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, 1);
       else if (format.subsampling == YUV_440)
         YUVPlaneToRGB_440(w, h, mathY, mathC, srcY, dstU, dstV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, 1);
       else if (format.subsampling == YUV_410)
@@ -3212,25 +3316,18 @@ bool videoHandlerYUV::convertYUVPlanarToRGB(const QByteArray &sourceBuffer, ucha
     }
     else
     {
-      // Get the pointers to the source planes (8 bit per sample)
-      const unsigned char * restrict srcY = (unsigned char*)sourceBuffer.data();
-      const unsigned char * restrict srcU = uPlaneFirst ? srcY + nrBytesLumaPlane : srcY + nrBytesLumaPlane + nrBytesToNextChromaPlane;
-      const unsigned char * restrict srcV = uPlaneFirst ? srcY + nrBytesLumaPlane + nrBytesToNextChromaPlane: srcY + nrBytesLumaPlane;
-
       if (format.subsampling == YUV_444)
-        YUVPlaneToRGB_444(componentSizeLuma, mathY, mathC, srcY, srcU, srcV, dst, RGBConv, fullRange, inputMax, bps, format.bigEndian, inputValSkip);
+        YUVPlaneToRGB_444(w, h, mathY, mathC, srcY, srcU, srcV, strideY, strideC, dst, RGBConv, fullRange, inputMax, bps, format.bigEndian, inputValSkip);
       else if (format.subsampling == YUV_422)
-        YUVPlaneToRGB_422(w, h, mathY, mathC, srcY, srcU, srcV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, inputValSkip);
+        YUVPlaneToRGB_422(w, h, mathY, mathC, srcY, srcU, srcV, strideY, strideC, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, inputValSkip);
       else if (format.subsampling == YUV_420)
-        YUVPlaneToRGB_420(w, h, mathY, mathC, srcY, srcU, srcV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, inputValSkip);
+        YUVPlaneToRGB_420(w, h, mathY, mathC, srcY, srcU, srcV, strideY, strideC, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, inputValSkip);
       else if (format.subsampling == YUV_440)
         YUVPlaneToRGB_440(w, h, mathY, mathC, srcY, srcU, srcV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, inputValSkip);
       else if (format.subsampling == YUV_410)
         YUVPlaneToRGB_410(w, h, mathY, mathC, srcY, srcU, srcV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, inputValSkip);
       else if (format.subsampling == YUV_411)
         YUVPlaneToRGB_411(w, h, mathY, mathC, srcY, srcU, srcV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, inputValSkip);
-      else if (format.subsampling == YUV_400)
-        YUVPlaneToRGBMonochrome_444(componentSizeLuma, mathY, srcY, dst, fullRange, inputMax, bps, format.bigEndian, 1);
       else
         return false;
     }
@@ -3239,6 +3336,51 @@ bool videoHandlerYUV::convertYUVPlanarToRGB(const QByteArray &sourceBuffer, ucha
   return true;
 }
 
+// Create the output image for the conversion in the right format.
+// In all cases, we will set the alpha channel to 255. The format of the raw buffer is: BGRA (each 8 bit).
+// Internally, this is how QImage allocates the number of bytes per line (with depth = 32):
+// const int bytes_per_line = ((width * depth + 31) >> 5) << 2; // bytes per scanline (must be multiple of 4)
+inline QImage createOutputImage(const QSize &size)
+{
+  QImage image;
+  if (is_Q_OS_WIN || is_Q_OS_MAC)
+    image = QImage(size, functions::platformImageFormat());
+  else if (is_Q_OS_LINUX)
+  {
+    QImage::Format f = functions::platformImageFormat();
+    if (f == QImage::Format_ARGB32_Premultiplied || f == QImage::Format_ARGB32)
+      image = QImage(size, f);
+    else
+      image = QImage(size, QImage::Format_RGB32);
+  }
+
+  // Check the image buffer size before we write to it
+  assert(image.byteCount() >= size.width() * size.height() * 4);
+  return image;
+}
+
+// On linux, we may have to convert the image to the platform image format if it is not one of the
+// RGBA formats.
+inline void convertOutputImageToPlatformFormat(QImage &image)
+{
+  if (is_Q_OS_LINUX)
+  {
+    QImage::Format f = functions::platformImageFormat();
+    if (f != QImage::Format_ARGB32_Premultiplied && f != QImage::Format_ARGB32 && f != QImage::Format_RGB32)
+      image = image.convertToFormat(f);
+  }
+}
+
+// 8 bit 4:2:0, nearest neighbor, chroma offset (0,1) (the default for 4:2:0), all components displayed and no yuv math.
+// We can use a specialized function for this.
+bool videoHandlerYUV::canUseYUV420ToRGBConversion(const yuvPixelFormat &yuvFormat) const
+{
+  return yuvFormat.planar && yuvFormat.bitsPerSample == 8 && yuvFormat.subsampling == YUV_420 && !yuvFormat.uvInterleaved &&
+         yuvFormat.chromaOffset[0] == 0 && yuvFormat.chromaOffset[1] == 1 &&
+         interpolationMode == NearestNeighborInterpolation && componentDisplayMode == DisplayAll &&
+         !mathParameters[Luma].yuvMathRequired() && !mathParameters[Chroma].yuvMathRequired();
+}
+
 // Convert the given raw YUV data in sourceBuffer (using srcPixelFormat) to image (RGB-888), using the
 // buffer tmpRGBBuffer for intermediate RGB values.
 void videoHandlerYUV::convertYUVToImage(const QByteArray &sourceBuffer, QImage &outputImage, const yuvPixelFormat &yuvFormat, const QSize &curFrameSize)
@@ -3251,34 +3393,13 @@ void videoHandlerYUV::convertYUVToImage(const QByteArray &sourceBuffer, QImage &
 
   DEBUG_YUV("videoHandlerYUV::convertYUVToImage");
 
-  // Create the output image in the right format.
-  // In both cases, we will set the alpha channel to 255. The format of the raw buffer is: BGRA (each 8 bit).
-  // Internally, this is how QImage allocates the number of bytes per line (with depth = 32):
-  // const int bytes_per_line = ((width * depth + 31) >> 5) << 2; // bytes per scanline (must be multiple of 4)
-  if (is_Q_OS_WIN || is_Q_OS_MAC)
-    outputImage = QImage(curFrameSize, functions::platformImageFormat());
-  else if (is_Q_OS_LINUX)
-  {
-    QImage::Format f = functions::platformImageFormat();
-    if (f == QImage::Format_ARGB32_Premultiplied || f == QImage::Format_ARGB32)
-      outputImage = QImage(curFrameSize, f);
-    else
-      outputImage = QImage(curFrameSize, QImage::Format_RGB32);
-  }
+  outputImage = createOutputImage(curFrameSize);
 
-  // Check the image buffer size before we write to it
-  assert(outputImage.byteCount() >= curFrameSize.width() * curFrameSize.height() * 4);
-  
   // Convert the source to RGB
   bool convOK = true;
   if (yuvFormat.planar)
   {
-    if (yuvFormat.bitsPerSample == 8 && yuvFormat.subsampling == YUV_420 && interpolationMode == NearestNeighborInterpolation &&
-        yuvFormat.chromaOffset[0] == 0 && yuvFormat.chromaOffset[1] == 1 &&
-        componentDisplayMode == DisplayAll && !yuvFormat.uvInterleaved &&
-        !mathParameters[Luma].yuvMathRequired() && !mathParameters[Chroma].yuvMathRequired())
-      // 8 bit 4:2:0, nearest neighbor, chroma offset (0,1) (the default for 4:2:0), all components displayed and no yuv math.
-      // We can use a specialized function for this.
+    if (canUseYUV420ToRGBConversion(yuvFormat))
       convOK = convertYUV420ToRGB(sourceBuffer, outputImage.bits(), curFrameSize, yuvFormat);
     else
       convOK = convertYUVPlanarToRGB(sourceBuffer, outputImage.bits(), curFrameSize, yuvFormat);
@@ -3297,16 +3418,43 @@ void videoHandlerYUV::convertYUVToImage(const QByteArray &sourceBuffer, QImage &
 
   assert(convOK);
 
-  if (is_Q_OS_LINUX)
+  convertOutputImageToPlatformFormat(outputImage);
+
+  DEBUG_YUV("videoHandlerYUV::convertYUVToImage Done");
+}
+
+// Convert the given picture (the planes of a decoded picture with padding at the end of the lines) to image (RGB-888).
+// The conversion reads the planes directly if possible. Otherwise the picture is copied to a packed buffer first.
+void videoHandlerYUV::convertYUVToImage(const yuvPictureRef &picture, QImage &outputImage, const yuvPixelFormat &yuvFormat, const QSize &curFrameSize)
+{
+  const bool stridedConversion = (yuvFormat.planar && !yuvFormat.uvInterleaved && 
+                                  (yuvFormat.subsampling == YUV_444 || yuvFormat.subsampling == YUV_422 || yuvFormat.subsampling == YUV_420 || yuvFormat.subsampling == YUV_400));
+  if (!stridedConversion || !canConvertToRGB(yuvFormat, curFrameSize))
   {
-    // On linux, we may have to convert the image to the platform image format if it is not one of the
-    // RGBA formats.
-    QImage::Format f = functions::platformImageFormat();
-    if (f != QImage::Format_ARGB32_Premultiplied && f != QImage::Format_ARGB32 && f != QImage::Format_RGB32)
-      outputImage = outputImage.convertToFormat(f);
+    convertYUVToImage(picture.toPackedBuffer(yuvFormat, curFrameSize), outputImage, yuvFormat, curFrameSize);
+    return;
   }
 
-  DEBUG_YUV("videoHandlerYUV::convertYUVToImage Done");
+  DEBUG_YUV("videoHandlerYUV::convertYUVToImage from picture");
+
+  outputImage = createOutputImage(curFrameSize);
+
+  // The conversion functions expect the strides in values
+  const int nrBytesPerSample = (yuvFormat.bitsPerSample > 8) ? 2 : 1;
+  const int strideY = picture.getStride(0) / nrBytesPerSample;
+  const int strideC = picture.getStride(1) / nrBytesPerSample;
+
+  bool convOK;
+  if (canUseYUV420ToRGBConversion(yuvFormat))
+    convOK = convertYUV420ToRGB(picture.getPlane(0), picture.getPlane(1), picture.getPlane(2), strideY, strideC, outputImage.bits(), curFrameSize);
+  else
+    convOK = convertYUVPlanarToRGB(picture.getPlane(0), picture.getPlane(1), picture.getPlane(2), strideY, strideC, outputImage.bits(), curFrameSize, yuvFormat);
+
+  assert(convOK);
+
+  convertOutputImageToPlatformFormat(outputImage);
+
+  DEBUG_YUV("videoHandlerYUV::convertYUVToImage from picture Done");
 }
 
 videoHandlerYUV::yuv_t videoHandlerYUV::getPixelValue(const QPoint &pixelPos) const
@@ -3508,6 +3656,25 @@ bool videoHandlerYUV::convertYUV420ToRGB(const QByteArray &sourceBuffer, unsigne
   }
 #endif
 
+  // Get pointers to the source planes. In the buffer, there is no padding at the end of the lines.
+  const bool uPplaneFirst = (format.planeOrder == Order_YUV || format.planeOrder == Order_YUVA); // Is the U plane the first or the second?
+  const unsigned char *srcY = (unsigned char*)sourceBuffer.data();
+  const unsigned char *srcU = uPplaneFirst ? srcY + componentLenghtY : srcY + componentLenghtY + componentLengthUV;
+  const unsigned char *srcV = uPplaneFirst ? srcY + componentLenghtY + componentLengthUV : srcY + componentLenghtY;
+
+  return convertYUV420ToRGB(srcY, srcU, srcV, frameWidth, frameWidth / 2, targetBuffer, size);
+}
+
+// Convert 8-bit YUV 4:2:0 to RGB888 using NearestNeighborInterpolation (see above). The lines of the source
+// planes may be padded: strideY and strideUV are the number of bytes from the start of one line to the next one.
+bool videoHandlerYUV::convertYUV420ToRGB(const unsigned char *planeY, const unsigned char *planeU, const unsigned char *planeV, const int strideY, const int strideUV, unsigned char *targetBuffer, const QSize &size)
+{
+  const int frameWidth = size.width();
+  const int frameHeight = size.height();
+
+  // For 4:2:0, w and h must be dividible by 2
+  assert(frameWidth % 2 == 0 && frameHeight % 2 == 0);
+
   // Perform software based 420 to RGB conversion
   static unsigned char clp_buf[384+256+384];
   static unsigned char *clip_buf = clp_buf+384;
@@ -3538,11 +3705,10 @@ bool videoHandlerYUV::convertYUV420ToRGB(const QByteArray &sourceBuffer, unsigne
     yuvRgbConvCoeffs[yuvColorConversionType][4]
   };
 
-  // Get pointers to the source and the output array
-  const bool uPplaneFirst = (format.planeOrder == Order_YUV || format.planeOrder == Order_YUVA); // Is the U plane the first or the second?
-  const unsigned char * restrict srcY = (unsigned char*)sourceBuffer.data();
-  const unsigned char * restrict srcU = uPplaneFirst ? srcY + componentLenghtY : srcY + componentLenghtY + componentLengthUV;
-  const unsigned char * restrict srcV = uPplaneFirst ? srcY + componentLenghtY + componentLengthUV : srcY + componentLenghtY;
+  // Get pointers to the source
+  const unsigned char * restrict srcY = planeY;
+  const unsigned char * restrict srcU = planeU;
+  const unsigned char * restrict srcV = planeV;
 
   int yh;
   for (yh=0; yh < frameHeight / 2; yh++)
@@ -3551,9 +3717,9 @@ bool videoHandlerYUV::convertYUV420ToRGB(const QByteArray &sourceBuffer, unsigne
 
     int dstAddr1 = yh * 2 * frameWidth * 4;         // The RGB output address of line yh*2
     int dstAddr2 = (yh * 2 + 1) * frameWidth * 4;   // The RGB output address of line yh*2+1
-    int srcAddrY1 = yh * 2 * frameWidth;            // The Y source address of line yh*2
-    int srcAddrY2 = (yh * 2 + 1) * frameWidth;      // The Y source address of line yh*2+1
-    int srcAddrUV = yh * frameWidth / 2;            // The UV source address of both lines (UV are identical)
+    int srcAddrY1 = yh * 2 * strideY;               // The Y source address of line yh*2
+    int srcAddrY2 = (yh * 2 + 1) * strideY;         // The Y source address of line yh*2+1
+    int srcAddrUV = yh * strideUV;                  // The UV source address of both lines (UV are identical)
 
     for (int xh=0, x=0; xh < frameWidth / 2; xh++, x+=2)
     {
@@ -3763,6 +3929,8 @@ QImage videoHandlerYUV::calculateDifference(frameHandler *item2, const int frame
     return QImage();  // Loading failed
   if (!yuvItem2->loadRawYUVData(frameIdxItem1))
     return QImage();  // Loading failed
+  updateCurrentFrameRawData();
+  yuvItem2->updateCurrentFrameRawData();
 
   // Both YUV buffers are up to date. Really calculate the difference.
   DEBUG_YUV("videoHandlerYUV::calculateDifference frame idx item 0 %d - item 1 %d", frameIdxItem0, frameIdxItem1);
@@ -33,6 +33,8 @@
 #ifndef VIDEOHANDLERYUV_H
 #define VIDEOHANDLERYUV_H
 
+#include <QSharedPointer>
+
 #include "videoHandler.h"
 
 #include "ui_videoHandlerYUV.h"
@@ -155,6 +157,41 @@ namespace YUV_Internals
     bool bytePacking;
   };
 
+  // The owner of the memory that a yuvPictureRef points to (e.g. a reference to a picture of a decoder).
+  // Subclasses release the memory in the destructor.
+  class yuvPictureBuffer
+  {
+  public:
+    virtual ~yuvPictureBuffer() {}
+  };
+
+  // A reference counted reference to the planes of a planar YUV picture that is not in a packed buffer. This can be any
+  // memory (like the picture buffer of a decoder) where each line of a plane may be followed by padding. The memory
+  // is kept alive until the last copy of the reference is destroyed. The planes are not interleaved.
+  class yuvPictureRef
+  {
+  public:
+    yuvPictureRef() {}
+    // The strides are given in bytes. For a 4:0:0 picture, planeU and planeV are not used.
+    yuvPictureRef(QSharedPointer<yuvPictureBuffer> buffer, const unsigned char *planeY, int strideY, const unsigned char *planeU, const unsigned char *planeV, int strideC);
+
+    bool isValid() const { return !buffer.isNull(); }
+    void clear() { buffer.clear(); }
+    const unsigned char *getPlane(int component) const { return plane[component]; }
+    int getStride(int component) const { return stride[component]; }
+
+    // Copy the planes into a packed buffer in the given format (no padding, planes in the order of the format).
+    // This is only needed if the raw values are accessed directly. The conversion to RGB can read the planes.
+    QByteArray toPackedBuffer(const yuvPixelFormat &format, const QSize &frameSize) const;
+    // The memory that the referenced planes occupy (including the padding at the end of the lines)
+    int64_t getMemorySize(const yuvPixelFormat &format, const QSize &frameSize) const;
+
+  private:
+    QSharedPointer<yuvPictureBuffer> buffer;
+    const unsigned char *plane[3] {nullptr, nullptr, nullptr};
+    int stride[3] {0, 0, 0};
+  };
+
   class videoHandlerYUV_CustomFormatDialog : public QDialog, public Ui::CustomYUVFormatDialog
   {
     Q_OBJECT
@@ -258,6 +295,10 @@ public:
 
   bool getIs_YUV_diff() const;
 
+  // Instead of filling rawData, a decoder can provide a reference to its decoded picture when signalRequestRawData()
+  // is emitted. If this is valid, rawData is not used. The picture is only copied to a packed buffer if the raw values are needed.
+  YUV_Internals::yuvPictureRef rawPicture;
+
 protected:
   
   // How do we perform interpolation for the subsampled YUV formats?
@@ -310,8 +351,16 @@ private:
   // Return false is loading failed.
   bool loadRawYUVData(int frameIndex);
 
+  // If the current frame was loaded as a reference to a decoded picture (currentFramePicture), currentFrameRawData is only
+  // filled by this function when the raw values are needed (pixel values, difference).
+  YUV_Internals::yuvPictureRef currentFramePicture;
+  void updateCurrentFrameRawData();
+
   // Convert from YUV (which ever format is selected) to image (RGB-888)
   void convertYUVToImage(const QByteArray &sourceBuffer, QImage &outputImage, const YUV_Internals::yuvPixelFormat &yuvFormat, const QSize &curFrameSize);
+  void convertYUVToImage(const YUV_Internals::yuvPictureRef &picture, QImage &outputImage, const YUV_Internals::yuvPixelFormat &yuvFormat, const QSize &curFrameSize);
+  // Can the specialized conversion for 8 bit 4:2:0 be used with the current settings?
+  bool canUseYUV420ToRGBConversion(const YUV_Internals::yuvPixelFormat &yuvFormat) const;
 
   // Set the new pixel format thread save (lock the mutex). We should also emit that something changed (can be disabled).
   void setSrcPixelFormat(YUV_Internals::yuvPixelFormat newFormat, bool emitChangedSignal=true);
@@ -328,9 +377,12 @@ private:
 #else
   bool convertYUV420ToRGB(const QByteArray &sourceBuffer, unsigned char *targetBuffer, const QSize &size, const YUV_Internals::yuvPixelFormat format);
 #endif
+  bool convertYUV420ToRGB(const unsigned char *planeY, const unsigned char *planeU, const unsigned char *planeV, const int strideY, const int strideUV, unsigned char *targetBuffer, const QSize &size);
 
   bool convertYUVPackedToPlanar(const QByteArray &sourceBuffer, QByteArray &targetBuffer, const QSize &frameSize, YUV_Internals::yuvPixelFormat &sourceBufferFormat);
   bool convertYUVPlanarToRGB(const QByteArray &sourceBuffer, unsigned char *targetBuffer, const QSize &frameSize, const YUV_Internals::yuvPixelFormat &sourceBufferFormat) const;
+  // The strides are the number of values (not bytes) from the start of one line to the next one.
+  bool convertYUVPlanarToRGB(const unsigned char *planeY, const unsigned char *planeU, const unsigned char *planeV, const int strideY, const int strideC, unsigned char *targetBuffer, const QSize &frameSize, const YUV_Internals::yuvPixelFormat &sourceBufferFormat) const;
   bool markDifferencesYUVPlanarToRGB(const QByteArray &sourceBuffer, unsigned char *targetBuffer, const QSize &frameSize, const YUV_Internals::yuvPixelFormat &sourceBufferFormat) const;
 
 #if SSE_CONVERSION_420_ALT
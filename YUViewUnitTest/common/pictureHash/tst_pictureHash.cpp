@@ -0,0 +1,175 @@
+#include <QtTest>
+
+#include <random>
+
+#include <common/pictureHash.h>
+
+using namespace pictureHash;
+
+namespace
+{
+
+// These are the reference implementations from the HM that process one sample (or bit) at a time
+
+QByteArray referenceMD5(const QByteArray &plane, int stride, int width, int height, int bitDepth)
+{
+    const int bytesPerSample = (bitDepth > 8) ? 2 : 1;
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    for (int y = 0; y < height; y++)
+        hash.addData(plane.constData() + y * stride, width * bytesPerSample);
+    return hash.result();
+}
+
+QByteArray referenceCRC(const QByteArray &plane, int stride, int width, int height, int bitDepth)
+{
+    const int bytesPerSample = (bitDepth > 8) ? 2 : 1;
+    const unsigned char *src = (const unsigned char*)plane.constData();
+    unsigned int crcVal = 0xffff;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width * bytesPerSample; x++)
+        {
+            const unsigned int data = src[y * stride + x];
+            for (int bitIdx = 0; bitIdx < 8; bitIdx++)
+            {
+                const unsigned int crcMsb = (crcVal >> 15) & 1;
+                const unsigned int bitVal = (data >> (7 - bitIdx)) & 1;
+                crcVal = (((crcVal << 1) + bitVal) & 0xffff) ^ (crcMsb * 0x1021);
+            }
+        }
+    }
+    for (int bitIdx = 0; bitIdx < 16; bitIdx++)
+    {
+        const unsigned int crcMsb = (crcVal >> 15) & 1;
+        crcVal = ((crcVal << 1) & 0xffff) ^ (crcMsb * 0x1021);
+    }
+
+    QByteArray hash;
+    hash.append(char(crcVal >> 8));
+    hash.append(char(crcVal & 0xff));
+    return hash;
+}
+
+QByteArray referenceChecksum(const QByteArray &plane, int stride, int width, int height, int bitDepth)
+{
+    const unsigned char *src = (const unsigned char*)plane.constData();
+    quint32 checksum = 0;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            const unsigned int xorMask = (x & 0xff) ^ (y & 0xff) ^ (x >> 8) ^ (y >> 8);
+            if (bitDepth > 8)
+            {
+                const unsigned int value = src[y * stride + 2 * x] + (src[y * stride + 2 * x + 1] << 8);
+                checksum = (checksum + ((value & 0xff) ^ xorMask)) & 0xffffffff;
+                checksum = (checksum + ((value >> 8) ^ xorMask)) & 0xffffffff;
+            }
+            else
+                checksum = (checksum + (src[y * stride + x] ^ xorMask)) & 0xffffffff;
+        }
+    }
+
+    QByteArray hash;
+    for (int i = 3; i >= 0; i--)
+        hash.append(char((checksum >> (8 * i)) & 0xff));
+    return hash;
+}
+
+}
+
+class pictureHashTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testPlaneHash_data();
+    void testPlaneHash();
+
+    void benchmarkPlaneHash_data();
+    void benchmarkPlaneHash();
+};
+
+void pictureHashTest::testPlaneHash_data()
+{
+    QTest::addColumn<int>("hashTypeIdx");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<int>("bitDepth");
+
+    const QList<hashType> types = {hashMD5, hashCRC, hashChecksum};
+    for (hashType type : types)
+    {
+        const QByteArray name = getHashTypeName(type).toLatin1();
+        QTest::newRow((name + " 8 bit").constData()) << int(type) << 64 << 32 << 8;
+        QTest::newRow((name + " 10 bit").constData()) << int(type) << 64 << 32 << 10;
+        // The checksum mask uses the upper bits of the coordinates for large pictures
+        QTest::newRow((name + " 8 bit large").constData()) << int(type) << 300 << 260 << 8;
+        QTest::newRow((name + " 10 bit odd size").constData()) << int(type) << 33 << 17 << 10;
+    }
+}
+
+void pictureHashTest::testPlaneHash()
+{
+    QFETCH(int, hashTypeIdx);
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(int, bitDepth);
+
+    // Reproducible random samples. The lines are padded with values that must not be part of the hash.
+    const int bytesPerSample = (bitDepth > 8) ? 2 : 1;
+    const int stride = (width + 16) * bytesPerSample;
+    QByteArray plane(stride * height, char(0xaa));
+    std::mt19937 generator(width * height + bitDepth);
+    std::uniform_int_distribution<int> distribution(0, (1 << bitDepth) - 1);
+    unsigned char *dst = (unsigned char*)plane.data();
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+        {
+            const int value = distribution(generator);
+            if (bytesPerSample == 1)
+                dst[y * stride + x] = value;
+            else
+            {
+                dst[y * stride + 2 * x] = value & 0xff;
+                dst[y * stride + 2 * x + 1] = value >> 8;
+            }
+        }
+
+    const hashType type = hashType(hashTypeIdx);
+    const QByteArray hash = calculatePlaneHash(type, (const unsigned char*)plane.constData(), stride, width, height, bitDepth);
+    QCOMPARE(hash.size(), getHashLength(type));
+
+    if (type == hashMD5)
+        QCOMPARE(hash, referenceMD5(plane, stride, width, height, bitDepth));
+    else if (type == hashCRC)
+        QCOMPARE(hash, referenceCRC(plane, stride, width, height, bitDepth));
+    else
+        QCOMPARE(hash, referenceChecksum(plane, stride, width, height, bitDepth));
+}
+
+void pictureHashTest::benchmarkPlaneHash_data()
+{
+    QTest::addColumn<int>("hashTypeIdx");
+
+    QTest::newRow("MD5") << int(hashMD5);
+    QTest::newRow("CRC") << int(hashCRC);
+    QTest::newRow("Checksum") << int(hashChecksum);
+}
+
+void pictureHashTest::benchmarkPlaneHash()
+{
+    QFETCH(int, hashTypeIdx);
+
+    // One 1080p luma plane with 10 bit
+    const int stride = 1920 * 2;
+    const QByteArray plane(stride * 1080, char(0x01));
+    QBENCHMARK
+    {
+        calculatePlaneHash(hashType(hashTypeIdx), (const unsigned char*)plane.constData(), stride, 1920, 1080, 10);
+    }
+}
+
+QTEST_MAIN(pictureHashTest)
+
+#include "tst_pictureHash.moc"
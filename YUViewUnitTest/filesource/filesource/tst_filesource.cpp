@@ -1,6 +1,7 @@
 #include <QtTest>
 
 #include <filesource/fileSource.h>
+#include <filesource/fileSourceMapped.h>
 
 class fileSourceTest : public QObject
 {
@@ -14,6 +15,9 @@ private slots:
     void testFormatFromFilename_data();
     void testFormatFromFilename();
 
+    void testMappedReadLine_data();
+    void testMappedReadLine();
+    void testMappedFields();
 };
 
 fileSourceTest::fileSourceTest()
@@ -115,6 +119,70 @@ void fileSourceTest::testFormatFromFilename()
     QCOMPARE(fileFormat.packed, packed);
 }
 
+void fileSourceTest::testMappedReadLine_data()
+{
+    QTest::addColumn<qint64>("windowSize");
+
+    // Lines crossing the window border have to be read after moving the window
+    QTest::newRow("smallWindow") << qint64(24);
+    QTest::newRow("defaultWindow") << qint64(fileSourceMapped::defaultWindowSize);
+}
+
+void fileSourceTest::testMappedReadLine()
+{
+    QFETCH(qint64, windowSize);
+
+    QStringList lines;
+    for (int i = 0; i < 100; i++)
+        lines.append(QString("%1;%2;%3").arg(i).arg(i * 7 % 13).arg(QString(i % 5, 'x')));
+
+    QTemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    for (int i = 0; i < lines.size(); i++)
+    {
+        // Mix unix and windows line endings and do not end the last line
+        tempFile.write(lines[i].toLatin1());
+        if (i < lines.size() - 1)
+            tempFile.write((i % 3 == 0) ? "\r\n" : "\n");
+    }
+    tempFile.close();
+
+    fileSourceMapped mappedFile(windowSize);
+    QVERIFY(mappedFile.openFile(tempFile.fileName()));
+
+    int64_t pos = 0;
+    const char *line;
+    int lineLength;
+    int lineIdx = 0;
+    while (mappedFile.readLine(pos, line, lineLength))
+    {
+        QVERIFY(lineIdx < lines.size());
+        QCOMPARE(QString::fromLatin1(line, lineLength), lines[lineIdx]);
+        lineIdx++;
+    }
+    QCOMPARE(lineIdx, lines.size());
+    QCOMPARE(pos, mappedFile.getFileSize());
+}
+
+void fileSourceTest::testMappedFields()
+{
+    const char *line = " 12 ; -3;;+7;2 147483647;2147483648;abc;%x";
+    fileSourceMappedFields fields;
+    fields.tokenize(line, int(strlen(line)), ';');
+
+    QCOMPARE(fields.count(), 8);
+    QCOMPARE(fields.toInt(0), 12);
+    QCOMPARE(fields.toInt(1), -3);
+    QVERIFY(fields.isEmpty(2));
+    QCOMPARE(fields.toInt(2), 0);
+    QCOMPARE(fields.toInt(3), 7);
+    QCOMPARE(fields.toInt(4), 2147483647);
+    QCOMPARE(fields.toInt(5), 0);
+    QCOMPARE(fields.toInt(6), 0);
+    QCOMPARE(fields.firstChar(7), '%');
+    QCOMPARE(fields.toInt(8), 0);
+}
+
 QTEST_MAIN(fileSourceTest)
 
 #include "tst_filesource.moc"
@@ -0,0 +1,162 @@
+#include <QtTest>
+
+#include <parser/parserAnnexBSeekIndex.h>
+
+namespace
+{
+
+struct frame
+{
+    int poc;
+    bool randomAccessPoint;
+};
+
+// This is the linear search that the parsers used before the randomAccessPointTable existed
+bool getClosestBeforeLinear(const QList<frame> &frameList, int seekPOC, int &poc, int &codingOrderFrameIdx)
+{
+    int bestSeekPOC = -1;
+    bool found = false;
+    for (int i = 0; i < frameList.length(); i++)
+    {
+        const frame &f = frameList[i];
+        if (!f.randomAccessPoint)
+            continue;
+        if (found && f.poc > seekPOC)
+            break;
+        bestSeekPOC = f.poc;
+        codingOrderFrameIdx = i;
+        found = true;
+    }
+    poc = bestSeekPOC;
+    return found;
+}
+
+}
+
+class annexBSeekIndexTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testClosestRandomAccessPoint_data();
+    void testClosestRandomAccessPoint();
+    void testParameterSetHistory();
+
+    void benchmarkRandomAccessPointSeek_data();
+    void benchmarkRandomAccessPointSeek();
+};
+
+void annexBSeekIndexTest::testClosestRandomAccessPoint_data()
+{
+    QTest::addColumn<int>("nrFrames");
+    QTest::addColumn<int>("intraPeriod");
+    QTest::addColumn<bool>("pocReset");
+
+    QTest::newRow("singleRAP") << 20 << 100 << false;
+    QTest::newRow("intraPeriod1") << 50 << 1 << false;
+    QTest::newRow("intraPeriod8") << 500 << 8 << false;
+    QTest::newRow("intraPeriod33") << 1000 << 33 << false;
+    QTest::newRow("pocReset") << 1000 << 16 << true;
+}
+
+void annexBSeekIndexTest::testClosestRandomAccessPoint()
+{
+    QFETCH(int, nrFrames);
+    QFETCH(int, intraPeriod);
+    QFETCH(bool, pocReset);
+
+    // A random access point every intraPeriod frames. If pocReset is set, the POC starts over at every random
+    // access point (like an IDR in AVC).
+    QList<frame> frameList;
+    randomAccessPointTable table;
+    for (int i = 0; i < nrFrames; i++)
+    {
+        const frame f = {pocReset ? (i % intraPeriod) : i, i % intraPeriod == 0};
+        frameList.append(f);
+        if (f.randomAccessPoint)
+            table.append(f.poc, i);
+    }
+
+    for (int seekPOC = -2; seekPOC < nrFrames + 2; seekPOC++)
+    {
+        int pocLinear = -1, idxLinear = -1;
+        int pocTable = -1, idxTable = -1;
+        const bool foundLinear = getClosestBeforeLinear(frameList, seekPOC, pocLinear, idxLinear);
+        const bool foundTable = table.getClosestBefore(seekPOC, pocTable, idxTable);
+        QCOMPARE(foundTable, foundLinear);
+        QCOMPARE(pocTable, pocLinear);
+        QCOMPARE(idxTable, idxLinear);
+    }
+
+    randomAccessPointTable emptyTable;
+    int poc = -1, idx = -1;
+    QVERIFY(!emptyTable.getClosestBefore(0, poc, idx));
+}
+
+void annexBSeekIndexTest::testParameterSetHistory()
+{
+    parameterSetHistory<int> history;
+    history.add(0, 0, QSharedPointer<int>(new int(100)));
+    history.add(1, 1, QSharedPointer<int>(new int(110)));
+    history.add(0, 5, QSharedPointer<int>(new int(101)));
+    history.add(2, 7, QSharedPointer<int>(new int(120)));
+
+    QCOMPARE(history.getActiveBefore(0).size(), 0);
+
+    auto active = history.getActiveBefore(1);
+    QCOMPARE(active.size(), 1);
+    QCOMPARE(*active[0], 100);
+
+    active = history.getActiveBefore(6);
+    QCOMPARE(active.size(), 2);
+    QCOMPARE(*active[0], 101);
+    QCOMPARE(*active[1], 110);
+
+    active = history.getActiveBefore(100);
+    QCOMPARE(active.size(), 3);
+    QCOMPARE(*active[0], 101);
+    QCOMPARE(*active[1], 110);
+    QCOMPARE(*active[2], 120);
+}
+
+void annexBSeekIndexTest::benchmarkRandomAccessPointSeek_data()
+{
+    QTest::addColumn<bool>("useTable");
+
+    QTest::newRow("linear") << false;
+    QTest::newRow("randomAccessPointTable") << true;
+}
+
+void annexBSeekIndexTest::benchmarkRandomAccessPointSeek()
+{
+    QFETCH(bool, useTable);
+
+    // About 4 hours of 60Hz video with an intra period of one second
+    const int nrFrames = 1000000;
+    QList<frame> frameList;
+    frameList.reserve(nrFrames);
+    randomAccessPointTable table;
+    for (int i = 0; i < nrFrames; i++)
+    {
+        frameList.append(frame{i, i % 64 == 0});
+        if (i % 64 == 0)
+            table.append(i, i);
+    }
+
+    int poc = -1, idx = -1;
+    QBENCHMARK
+    {
+        for (int seekPOC = 0; seekPOC < nrFrames; seekPOC += nrFrames / 100)
+        {
+            if (useTable)
+                table.getClosestBefore(seekPOC, poc, idx);
+            else
+                getClosestBeforeLinear(frameList, seekPOC, poc, idx);
+        }
+    }
+    QVERIFY(idx >= 0);
+}
+
+QTEST_MAIN(annexBSeekIndexTest)
+
+#include "tst_annexBSeekIndex.moc"
@@ -0,0 +1,196 @@
+#include <QtTest>
+
+#include <parser/parserCommon.h>
+
+using namespace parserCommon;
+
+namespace
+{
+
+// Write the values as ue(v) (or se(v)) codes followed by the rbsp_trailing_bits. Insert an emulation prevention
+// byte wherever two zero bytes are followed by a byte <= 3.
+QByteArray writeExpGolomb(const QList<int> &values, bool signedValues)
+{
+    sub_byte_writer writer;
+    for (int v : values)
+    {
+        const unsigned int codeNum = signedValues ? (v > 0 ? 2 * v - 1 : -2 * v) : v;
+        int len = 0;
+        while ((codeNum + 1) >> (len + 1))
+            len++;
+        writer.writeBits(0, len);
+        writer.writeBits(codeNum + 1, len + 1);
+    }
+    // The rbsp_stop_one_bit. The writer fills the last byte with zero bits.
+    writer.writeBool(true);
+
+    QByteArray data;
+    int nrZeros = 0;
+    for (char c : writer.getByteArray())
+    {
+        if (nrZeros == 2 && (unsigned char)c <= 3)
+        {
+            data.append(char(3));
+            nrZeros = 0;
+        }
+        data.append(c);
+        nrZeros = (c == 0) ? nrZeros + 1 : 0;
+    }
+    return data;
+}
+
+}
+
+class bitReaderTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testEmulationPreventionRemoval_data();
+    void testEmulationPreventionRemoval();
+    void testReadExpGolomb_data();
+    void testReadExpGolomb();
+    void testMoreRBSPData_data();
+    void testMoreRBSPData();
+};
+
+void bitReaderTest::testEmulationPreventionRemoval_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<int>("offset");
+    QTest::addColumn<QByteArray>("rbsp");
+
+    QTest::newRow("noEmulationPrevention") << QByteArray::fromHex("0102ff8000") << 0 << QByteArray::fromHex("0102ff8000");
+    QTest::newRow("emulationPrevention") << QByteArray::fromHex("0000030125") << 0 << QByteArray::fromHex("00000125");
+    QTest::newRow("twoEmulationPrevention") << QByteArray::fromHex("00000300000302") << 0 << QByteArray::fromHex("0000000002");
+    QTest::newRow("oneZeroOnly") << QByteArray::fromHex("00030100") << 0 << QByteArray::fromHex("00030100");
+    QTest::newRow("emulationPreventionAtEnd") << QByteArray::fromHex("25000003") << 0 << QByteArray::fromHex("250000");
+    QTest::newRow("withOffset") << QByteArray::fromHex("aabb0000030180") << 2 << QByteArray::fromHex("00000180");
+
+    // The fast_bit_reader removes the emulation prevention in blocks of 256 bytes
+    QByteArray blockBoundary(300, char(0x11));
+    blockBoundary[254] = 0;
+    blockBoundary[255] = 0;
+    blockBoundary[256] = 3;
+    QByteArray blockBoundaryRBSP = blockBoundary;
+    blockBoundaryRBSP.remove(256, 1);
+    QTest::newRow("blockBoundary") << blockBoundary << 0 << blockBoundaryRBSP;
+}
+
+// Read the data byte by byte with both readers. The position in the input (including the emulation prevention
+// bytes) must be the same for both readers after every byte.
+void bitReaderTest::testEmulationPreventionRemoval()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(int, offset);
+    QFETCH(QByteArray, rbsp);
+
+    sub_byte_reader subReader(data, offset);
+    fast_bit_reader fastReader(data, offset);
+    QCOMPARE(fastReader.nrBytesRead(), subReader.nrBytesRead());
+    QCOMPARE(fastReader.nrBytesLeft(), subReader.nrBytesLeft());
+
+    for (int i = 0; i < rbsp.size(); i++)
+    {
+        QString bitsRead;
+        const unsigned int subValue = subReader.readBits(8, bitsRead);
+        const unsigned int fastValue = fastReader.readBits(8);
+        QCOMPARE(subValue, (unsigned int)(unsigned char)rbsp.at(i));
+        QCOMPARE(fastValue, subValue);
+        QCOMPARE(fastReader.nrBytesRead(), subReader.nrBytesRead());
+        QCOMPARE(fastReader.nrBytesLeft(), subReader.nrBytesLeft());
+        QCOMPARE(fastReader.testReadingBits(8), subReader.testReadingBits(8));
+    }
+
+    // Both readers are at the end of the data
+    QString bitsRead;
+    QVERIFY_EXCEPTION_THROWN(subReader.readBits(1, bitsRead), std::logic_error);
+    QVERIFY_EXCEPTION_THROWN(fastReader.readBits(1), std::logic_error);
+}
+
+void bitReaderTest::testReadExpGolomb_data()
+{
+    QTest::addColumn<QList<int>>("values");
+    QTest::addColumn<bool>("signedValues");
+    QTest::addColumn<bool>("emulationPrevention");
+
+    QTest::newRow("ue(v)") << QList<int>({0, 1, 2, 3, 7, 8, 100, 255, 256, 1000, 0, 0, 5}) << false << false;
+    QTest::newRow("se(v)") << QList<int>({0, 1, -2, 3, -7, 8, -100, 255, -256, 1000, 0, 0, -5}) << true << false;
+    // Codes with long runs of zero bits result in zero bytes and emulation prevention (30 zero bits always contain
+    // two zero bytes followed by a byte <= 3).
+    QTest::newRow("ue(v) with emulation prevention")
+        << QList<int>({0, 1, 2, 3, 7, 8, 100, 255, 256, 1000, 1 << 16, 1 << 22, 0, (1 << 30) - 1, 1, 1 << 20, 0, 0, (1 << 22) + 5, 0, 0, 5})
+        << false << true;
+    QTest::newRow("se(v) with emulation prevention")
+        << QList<int>({0, 1, -2, 3, -7, 8, -100, 255, -256, 1000, -(1 << 16), 1 << 22, 0, (1 << 30) - 1, -1, 1 << 20, 0, 0, -((1 << 22) + 5), 0, 0, 5})
+        << true << true;
+}
+
+void bitReaderTest::testReadExpGolomb()
+{
+    QFETCH(QList<int>, values);
+    QFETCH(bool, signedValues);
+    QFETCH(bool, emulationPrevention);
+
+    const QByteArray data = writeExpGolomb(values, signedValues);
+    QCOMPARE(data.contains(QByteArray::fromHex("000003")), emulationPrevention);
+
+    sub_byte_reader subReader(data);
+    fast_bit_reader fastReader(data);
+    for (int v : values)
+    {
+        QString bitsRead;
+        int subBitCount = 0;
+        int fastBitCount = 0;
+        if (signedValues)
+        {
+            QCOMPARE(subReader.readSE_V(bitsRead, subBitCount), v);
+            QCOMPARE(fastReader.readSE_V(fastBitCount), v);
+        }
+        else
+        {
+            QCOMPARE(int(subReader.readUE_V(bitsRead, subBitCount)), v);
+            QCOMPARE(int(fastReader.readUE_V(fastBitCount)), v);
+        }
+        QCOMPARE(fastBitCount, subBitCount);
+        QCOMPARE(fastReader.nrBytesRead(), subReader.nrBytesRead());
+        QCOMPARE(fastReader.nrBytesLeft(), subReader.nrBytesLeft());
+    }
+}
+
+void bitReaderTest::testMoreRBSPData_data()
+{
+    QTest::addColumn<QList<int>>("values");
+
+    QTest::newRow("short") << QList<int>({0, 3, 1});
+    QTest::newRow("stopBitInNewByte") << QList<int>({0, 0, 0, 0, 0, 0, 0, 0});
+    QTest::newRow("long") << QList<int>({0, 1, 2, 3, 7, 8, 100, 255, 256, 1000, 0, 0, 5});
+    QTest::newRow("emulationPrevention") << QList<int>({0, 1 << 16, 1 << 22, 0, (1 << 30) - 1, 1, 1 << 20, 0, 0, 5});
+}
+
+void bitReaderTest::testMoreRBSPData()
+{
+    QFETCH(QList<int>, values);
+
+    const QByteArray data = writeExpGolomb(values, false);
+    sub_byte_reader subReader(data);
+    fast_bit_reader fastReader(data);
+    for (int v : values)
+    {
+        QVERIFY(subReader.more_rbsp_data());
+        QVERIFY(fastReader.more_rbsp_data());
+
+        QString bitsRead;
+        int bitCount = 0;
+        QCOMPARE(int(subReader.readUE_V(bitsRead, bitCount)), v);
+        QCOMPARE(int(fastReader.readUE_V(bitCount)), v);
+    }
+
+    // Only the rbsp_trailing_bits are left
+    QVERIFY(!subReader.more_rbsp_data());
+    QVERIFY(!fastReader.more_rbsp_data());
+}
+
+QTEST_MAIN(bitReaderTest)
+
+#include "tst_bitReader.moc"
@@ -0,0 +1,59 @@
+#include <QtTest>
+
+#include <QScopedPointer>
+
+#include <parser/parserCommon.h>
+
+using namespace parserCommon;
+
+class treeItemTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testStrings_data();
+    void testStrings();
+};
+
+void treeItemTest::testStrings_data()
+{
+    QTest::addColumn<int>("maxNrStrings");
+
+    // -1: The items are created without a string table
+    QTest::newRow("noTable") << -1;
+    QTest::newRow("emptyTable") << 0;
+    // The table is full after the name and coding of the first item
+    QTest::newRow("fullTable") << 2;
+    QTest::newRow("bigTable") << 1000;
+}
+
+// No matter if the strings could be added to the table or not, the items must return all of them
+void treeItemTest::testStrings()
+{
+    QFETCH(int, maxNrStrings);
+
+    TreeItemStringTable table(qMax(maxNrStrings, 0));
+    QScopedPointer<TreeItemStringTable::scope> tableScope;
+    if (maxNrStrings >= 0)
+        tableScope.reset(new TreeItemStringTable::scope(&table));
+
+    TreeItem root(nullptr);
+    new TreeItem("slice_type", 2, "ue(v)", "011", "B slice", &root);
+    new TreeItem("pic_output_flag", 1, "u(1)", "1", "Output the picture", &root);
+    new TreeItem("slice_type", 0, "ue(v)", "1", "P slice", &root);
+    tableScope.reset();
+
+    const QStringList expected[] = {
+        {"slice_type", "2", "ue(v)", "011", "B slice"},
+        {"pic_output_flag", "1", "u(1)", "1", "Output the picture"},
+        {"slice_type", "0", "ue(v)", "1", "P slice"}
+    };
+    QCOMPARE(root.childItems.size(), 3);
+    for (int i = 0; i < 3; i++)
+        for (int column = 0; column < 5; column++)
+            QCOMPARE(root.childItems[i]->getData(column, table), expected[i][column]);
+}
+
+QTEST_MAIN(treeItemTest)
+
+#include "tst_treeItem.moc"
@@ -0,0 +1,151 @@
+#include <QtTest>
+
+#include <statistics/statisticsBinaryFormat.h>
+
+namespace
+{
+
+void compareStatistics(const statisticsData &a, const statisticsData &b)
+{
+    QCOMPARE(a.valueData.posX, b.valueData.posX);
+    QCOMPARE(a.valueData.posY, b.valueData.posY);
+    QCOMPARE(a.valueData.width, b.valueData.width);
+    QCOMPARE(a.valueData.height, b.valueData.height);
+    QCOMPARE(a.valueData.value, b.valueData.value);
+
+    QCOMPARE(a.vectorData.posX, b.vectorData.posX);
+    QCOMPARE(a.vectorData.posY, b.vectorData.posY);
+    QCOMPARE(a.vectorData.width, b.vectorData.width);
+    QCOMPARE(a.vectorData.height, b.vectorData.height);
+    QCOMPARE(a.vectorData.isLine, b.vectorData.isLine);
+    QCOMPARE(a.vectorData.point0, b.vectorData.point0);
+    for (int i = 0; i < a.vectorData.size(); i++)
+        if (a.vectorData.isLine[i])
+            QCOMPARE(a.vectorData.point1[i], b.vectorData.point1[i]);
+
+    QCOMPARE(a.affineTFData.posX, b.affineTFData.posX);
+    QCOMPARE(a.affineTFData.posY, b.affineTFData.posY);
+    for (int k = 0; k < 3; k++)
+        QCOMPARE(a.affineTFData.point[k], b.affineTFData.point[k]);
+
+    QCOMPARE(a.polygonValueData.corners, b.polygonValueData.corners);
+    QCOMPARE(a.polygonValueData.cornerStart, b.polygonValueData.cornerStart);
+    QCOMPARE(a.polygonValueData.value, b.polygonValueData.value);
+    QCOMPARE(a.polygonVectorData.corners, b.polygonVectorData.corners);
+    QCOMPARE(a.polygonVectorData.cornerStart, b.polygonVectorData.cornerStart);
+    QCOMPARE(a.polygonVectorData.point, b.polygonVectorData.point);
+}
+
+}
+
+class binaryFormatTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testWriteRead_data();
+    void testWriteRead();
+    void testNotAStatisticsFile();
+};
+
+void binaryFormatTest::testWriteRead_data()
+{
+    QTest::addColumn<int>("seed");
+
+    QTest::newRow("seed1") << 1;
+    QTest::newRow("seed7") << 7;
+    QTest::newRow("seed13") << 13;
+}
+
+void binaryFormatTest::testWriteRead()
+{
+    QFETCH(int, seed);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filePath = dir.filePath("test.yuvstats");
+
+    StatisticsTypeList types;
+    types.append(StatisticsType(0, "Value", "jet", -100, 100));
+    types.append(StatisticsType(3, "Vector", 4));
+
+    // Items of every kind (values, vectors, lines, affine transforms and polygons). Frame 1 has no statistics.
+    statisticsData frames[3];
+    for (int f = 0; f < 3; f++)
+    {
+        statisticsData &data = frames[f];
+        const int frameSeed = seed + 6 * f;
+        for (int i = 0; i < 50; i++)
+        {
+            const unsigned short x = (i * 8 + frameSeed) % 640;
+            const unsigned short y = (i * 16) % 480;
+            data.addBlockValue(x, y, 8, 16, i * frameSeed - 100);
+            data.addBlockVector(x, y, 8, 8, -i, i + frameSeed);
+            if (i % 5 == 0)
+                data.addLine(x, y, 16, 16, i, -i, 2 * i, frameSeed);
+            data.addBlockAffineTF(x, y, 32, 32, i, -i, frameSeed, 0, -frameSeed, i * 2);
+        }
+        data.addPolygonValue(QVector<QPoint>() << QPoint(0, 0) << QPoint(15, 0) << QPoint(0, 15), frameSeed);
+        data.addPolygonValue(QVector<QPoint>() << QPoint(416, 448) << QPoint(447, 448) << QPoint(447, 478) << QPoint(416, 463), -frameSeed);
+        data.addPolygonVector(QVector<QPoint>() << QPoint(505, 384) << QPoint(511, 384) << QPoint(511, 415), 4, -8);
+    }
+    QHash<int, statisticsData> frame0, frame2;
+    frame0[0] = frames[0];
+    frame2[0] = frames[1];
+    frame2[3] = frames[2];
+
+    {
+        statisticsBinaryFormat::writer writer;
+        QVERIFY(writer.open(filePath, QSize(640, 480), 50.0, types));
+        QVERIFY(writer.writeFrame(0, frame0));
+        QVERIFY(writer.writeFrame(2, frame2));
+        // Every frame can only be written once
+        QVERIFY(!writer.writeFrame(0, frame0));
+        QVERIFY(writer.close());
+    }
+
+    statisticsBinaryFormat::reader reader;
+    QVERIFY2(reader.open(filePath), qPrintable(reader.getError()));
+    QCOMPARE(reader.getFrameSize(), QSize(640, 480));
+    QCOMPARE(reader.getFrameRate(), 50.0);
+    QCOMPARE(reader.getNrFrames(), 3);
+    QCOMPARE(reader.getTypes().size(), 2);
+    QCOMPARE(reader.getTypes()[0].typeID, 0);
+    QCOMPARE(reader.getTypes()[0].typeName, QString("Value"));
+    QCOMPARE(reader.getTypes()[1].typeID, 3);
+    QCOMPARE(reader.getTypes()[1].vectorScale, 4);
+
+    statisticsData read0, read2Value, read2Vector, readEmpty;
+    QVERIFY(reader.readFrameType(0, 0, read0));
+    compareStatistics(frame0[0], read0);
+    QVERIFY(reader.readFrameType(2, 0, read2Value));
+    compareStatistics(frame2[0], read2Value);
+    QVERIFY(reader.readFrameType(2, 3, read2Vector));
+    compareStatistics(frame2[3], read2Vector);
+
+    // Types or frames without data
+    QVERIFY(!reader.readFrameType(0, 3, readEmpty));
+    QVERIFY(!reader.readFrameType(1, 0, readEmpty));
+    QVERIFY(!reader.readFrameType(3, 0, readEmpty));
+    QVERIFY(readEmpty.valueData.isEmpty());
+}
+
+void binaryFormatTest::testNotAStatisticsFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filePath = dir.filePath("test.yuvstats");
+
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("BlockStat: POC 1 @( 112,  88) [ 8x 8] PredMode=0\n");
+    file.close();
+
+    statisticsBinaryFormat::reader reader;
+    QVERIFY(!reader.open(filePath));
+    QVERIFY(!reader.getError().isEmpty());
+}
+
+QTEST_MAIN(binaryFormatTest)
+
+#include "tst_binaryFormat.moc"
@@ -0,0 +1,114 @@
+#include <QtTest>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include <statistics/statisticsExtensions.h>
+
+class blockIndexTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testBlocksInRect_data();
+    void testBlocksInRect();
+    void testInvalidIndex();
+    void testNoBlocks();
+};
+
+void blockIndexTest::testBlocksInRect_data()
+{
+    QTest::addColumn<QRect>("rect");
+    QTest::addColumn<bool>("filtered");
+
+    QTest::newRow("topLeft") << QRect(0, 0, 100, 100) << true;
+    QTest::newRow("center") << QRect(900, 500, 64, 64) << true;
+    QTest::newRow("cellBorder") << QRect(63, 65, 1, 1) << true;
+    QTest::newRow("bottomRight") << QRect(1800, 1000, 200, 200) << true;
+    QTest::newRow("outside") << QRect(3000, 3000, 10, 10) << true;
+    QTest::newRow("frame") << QRect(0, 0, 1920, 1080) << false;
+}
+
+// The index must return (at least) every block that intersects the rect and the blocks must be in the order in
+// which they were added.
+void blockIndexTest::testBlocksInRect()
+{
+    QFETCH(QRect, rect);
+    QFETCH(bool, filtered);
+
+    // Blocks of random position and size in a 1920x1080 frame. Every 100th block is bigger than a cell of the index.
+    std::mt19937 random(42);
+    statisticsData data;
+    for (int i = 0; i < 2000; i++)
+    {
+        const unsigned short x = random() % 1900;
+        const unsigned short y = random() % 1060;
+        if (i % 100 == 0)
+            data.addBlockValue(x, y, 128, 256, i);
+        else
+            data.addBlockValue(x, y, 4 << (random() % 5), 4 << (random() % 5), i);
+    }
+    data.buildIndex();
+    const statisticsValueArrays &blocks = data.valueData;
+    QVERIFY(blocks.index.isValid(blocks));
+
+    QVector<int> indices;
+    blocks.index.getBlocksInRect(blocks, rect, indices);
+    QVERIFY(std::adjacent_find(indices.begin(), indices.end(), std::greater_equal<int>()) == indices.end());
+
+    for (int i = 0; i < blocks.size(); i++)
+    {
+        const bool isLarge = blocks.width[i] > 64 || blocks.height[i] > 64;
+        if (isLarge || blocks.getRect(i).intersects(rect))
+            QVERIFY2(std::binary_search(indices.begin(), indices.end(), i), qPrintable(QString("Block %1 is missing").arg(i)));
+    }
+
+    if (filtered)
+        QVERIFY(indices.size() < blocks.size() / 2);
+    else
+        QCOMPARE(indices.size(), blocks.size());
+}
+
+void blockIndexTest::testInvalidIndex()
+{
+    statisticsData data;
+    for (int y = 0; y < 1080; y += 64)
+        for (int x = 0; x < 1920; x += 64)
+            data.addBlockValue(x, y, 64, 64, x + y);
+    QVector<int> all(data.valueData.size());
+    std::iota(all.begin(), all.end(), 0);
+
+    // The index was not built yet
+    QVector<int> indices;
+    QVERIFY(!data.valueData.index.isValid(data.valueData));
+    data.valueData.index.getBlocksInRect(data.valueData, QRect(0, 0, 8, 8), indices);
+    QCOMPARE(indices, all);
+
+    // A block was added after building the index
+    data.buildIndex();
+    data.addBlockValue(0, 0, 8, 8, 0);
+    all.append(all.size());
+    QVERIFY(!data.valueData.index.isValid(data.valueData));
+    data.valueData.index.getBlocksInRect(data.valueData, QRect(0, 0, 8, 8), indices);
+    QCOMPARE(indices, all);
+
+    data.buildIndex();
+    QVERIFY(data.valueData.index.isValid(data.valueData));
+    QVERIFY(data.valueData.index.getMemorySize() > 0);
+}
+
+void blockIndexTest::testNoBlocks()
+{
+    statisticsData data;
+    data.buildIndex();
+    QVERIFY(data.valueData.index.isValid(data.valueData));
+
+    QVector<int> indices;
+    data.valueData.index.getBlocksInRect(data.valueData, QRect(0, 0, 1920, 1080), indices);
+    QVERIFY(indices.isEmpty());
+}
+
+QTEST_MAIN(blockIndexTest)
+
+#include "tst_blockIndex.moc"
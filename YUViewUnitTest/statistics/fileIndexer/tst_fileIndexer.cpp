@@ -0,0 +1,144 @@
+#include <QtTest>
+
+#include <statistics/statisticsFileIndexer.h>
+
+namespace
+{
+
+// Lines are "<poc> <type> <payload>". Lines that start with a '#' contain no statistics.
+bool parseLine(const char *line, int lineLength, int &poc, int &type)
+{
+    if (lineLength == 0 || line[0] == '#')
+        return false;
+    const QList<QByteArray> fields = QByteArray::fromRawData(line, lineLength).split(' ');
+    if (fields.size() < 2)
+        return false;
+    poc = fields[0].toInt();
+    type = fields[1].toInt();
+    return true;
+}
+
+}
+
+class fileIndexerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRuns_data();
+    void testRuns();
+    void testCancel();
+    void testEmptyFile();
+};
+
+void fileIndexerTest::testRuns_data()
+{
+    QTest::addColumn<int>("playheadPOC");
+
+    QTest::newRow("start") << 0;
+    QTest::newRow("middle") << 50;
+    QTest::newRow("end") << 99;
+    QTest::newRow("notInFile") << 1000;
+}
+
+// Create a file that is split into multiple chunks, merge the runs of the chunks in file order and compare them
+// with the runs that were written.
+void fileIndexerTest::testRuns()
+{
+    QFETCH(int, playheadPOC);
+
+    QByteArray fileData;
+    QVector<statisticsFileIndexer::run> expectedRuns;
+    const QByteArray payload(50, 'x');
+    for (int poc = 0; poc < 100; poc++)
+    {
+        fileData.append(QString("# POC %1\n").arg(poc).toLatin1());
+        for (int type = 0; type < 3; type++)
+        {
+            expectedRuns.append({poc, type, fileData.size()});
+            for (int i = 0; i < 700; i++)
+                fileData.append(QString("%1 %2 ").arg(poc).arg(type).toLatin1() + payload + "\n");
+        }
+    }
+
+    QTemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    tempFile.write(fileData);
+    tempFile.close();
+
+    bool cancel = false;
+    statisticsFileIndexer indexer(tempFile.fileName(), &parseLine, cancel);
+    QVERIFY(indexer.start(playheadPOC));
+    QCOMPARE(indexer.getFileSize(), int64_t(fileData.size()));
+    QVERIFY(indexer.getNrChunks() > 1);
+
+    // Every chunk is returned exactly once
+    QVector<bool> returned(indexer.getNrChunks(), false);
+    int nrReturned = 0;
+    for (int idx = indexer.waitForNextChunk(); idx != -1; idx = indexer.waitForNextChunk())
+    {
+        QVERIFY(idx >= 0 && idx < indexer.getNrChunks());
+        QVERIFY(!returned[idx]);
+        returned[idx] = true;
+        nrReturned++;
+    }
+    QCOMPARE(nrReturned, indexer.getNrChunks());
+
+    // The chunks cover the file without gaps and start at the start of a line
+    QVector<statisticsFileIndexer::run> mergedRuns;
+    for (int i = 0; i < indexer.getNrChunks(); i++)
+    {
+        const statisticsFileIndexer::chunk &c = indexer.getChunk(i);
+        QCOMPARE(c.startPos, (i == 0) ? int64_t(0) : indexer.getChunk(i - 1).endPos);
+        QVERIFY(c.startPos == 0 || fileData[int(c.startPos) - 1] == '\n');
+        QVERIFY(c.typeChangeWithinPOC);
+
+        for (const statisticsFileIndexer::run &r : c.runs)
+            if (mergedRuns.isEmpty() || mergedRuns.last().poc != r.poc || mergedRuns.last().type != r.type)
+                mergedRuns.append(r);
+    }
+    QCOMPARE(indexer.getChunk(indexer.getNrChunks() - 1).endPos, int64_t(fileData.size()));
+
+    QCOMPARE(mergedRuns.size(), expectedRuns.size());
+    for (int i = 0; i < expectedRuns.size(); i++)
+    {
+        QCOMPARE(mergedRuns[i].poc, expectedRuns[i].poc);
+        QCOMPARE(mergedRuns[i].type, expectedRuns[i].type);
+        QCOMPARE(mergedRuns[i].startPos, expectedRuns[i].startPos);
+    }
+}
+
+void fileIndexerTest::testCancel()
+{
+    QTemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    for (int i = 0; i < 100; i++)
+        tempFile.write(QString("%1 0 x\n").arg(i).toLatin1());
+    tempFile.close();
+
+    bool cancel = true;
+    statisticsFileIndexer indexer(tempFile.fileName(), &parseLine, cancel);
+    QVERIFY(indexer.start(0));
+    QCOMPARE(indexer.getNrChunks(), 1);
+    QCOMPARE(indexer.waitForNextChunk(), -1);
+}
+
+void fileIndexerTest::testEmptyFile()
+{
+    QTemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    tempFile.close();
+
+    bool cancel = false;
+    statisticsFileIndexer indexer(tempFile.fileName(), &parseLine, cancel);
+    QVERIFY(indexer.start(0));
+    QCOMPARE(indexer.getNrChunks(), 0);
+    QCOMPARE(indexer.waitForNextChunk(), -1);
+
+    statisticsFileIndexer missing(tempFile.fileName() + ".missing", &parseLine, cancel);
+    QVERIFY(!missing.start(0));
+}
+
+QTEST_MAIN(fileIndexerTest)
+
+#include "tst_fileIndexer.moc"
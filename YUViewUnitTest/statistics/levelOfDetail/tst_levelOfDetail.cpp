@@ -0,0 +1,154 @@
+#include <QtTest>
+
+#include <statistics/statisticsExtensions.h>
+
+class levelOfDetailTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testGetCellSizeLog2_data();
+    void testGetCellSizeLog2();
+    void testValueLevels();
+    void testVectorLevels();
+    void testNoLevels();
+};
+
+void levelOfDetailTest::testGetCellSizeLog2_data()
+{
+    QTest::addColumn<double>("zoomFactor");
+    QTest::addColumn<int>("minCellSize");
+    QTest::addColumn<int>("cellSizeLog2");
+
+    QTest::newRow("zoom1") << 1.0 << 8 << 3;
+    QTest::newRow("zoom0.5") << 0.5 << 8 << 4;
+    QTest::newRow("zoom0.1") << 0.1 << 8 << 7;
+    QTest::newRow("zoom16") << 16.0 << 8 << 0;
+    QTest::newRow("notPowerOfTwo") << 1.0 << 12 << 4;
+}
+
+void levelOfDetailTest::testGetCellSizeLog2()
+{
+    QFETCH(double, zoomFactor);
+    QFETCH(int, minCellSize);
+    QFETCH(int, cellSizeLog2);
+
+    QCOMPARE(statisticsLevelOfDetail::getCellSizeLog2(zoomFactor, minCellSize), cellSizeLog2);
+}
+
+// 8x8 blocks in a 256x256 area. The left half has the value 2 and the right half the value 4. The bottom right
+// 64x64 pixels are not covered.
+void levelOfDetailTest::testValueLevels()
+{
+    statisticsData data;
+    for (int y = 0; y < 256; y += 8)
+        for (int x = 0; x < 256; x += 8)
+            if (x < 192 || y < 192)
+                data.addBlockValue(x, y, 8, 8, (x < 128) ? 2 : 4);
+    data.buildIndex();
+    const statisticsLevelOfDetail &lod = data.levelOfDetail;
+
+    // There are as many 8x8 cells as there are blocks. Drawing the blocks is not more expensive.
+    QVERIFY(lod.getValueLevel(3) == nullptr);
+
+    const statisticsLevelOfDetail::valueLevel *level = lod.getValueLevel(4);
+    QVERIFY(level != nullptr);
+    QCOMPARE(level->cellSizeLog2, 4);
+    QCOMPARE(level->nrCellsX, 16);
+    QCOMPARE(level->nrCellsY, 16);
+    for (int cy = 0; cy < 16; cy++)
+        for (int cx = 0; cx < 16; cx++)
+        {
+            const int idx = cy * 16 + cx;
+            const bool covered = (cx < 12 || cy < 12);
+            QCOMPARE(level->covered[idx], covered);
+            if (!covered)
+                continue;
+            const int value = (cx < 8) ? 2 : 4;
+            QCOMPARE(level->mode[idx], value);
+            QCOMPARE(level->mean[idx], float(value));
+            QCOMPARE(level->meanPerPixel[idx], float(value) / 64);
+        }
+
+    level = lod.getValueLevel(7);
+    QVERIFY(level != nullptr);
+    QCOMPARE(level->cellSizeLog2, 7);
+    QCOMPARE(level->nrCellsX, 2);
+    QVERIFY(level->covered[3]);
+    QCOMPARE(level->mean[3], 4.0f);
+
+    // All bigger cell sizes get the coarsest level with a single cell
+    level = lod.getValueLevel(20);
+    QVERIFY(level != nullptr);
+    QCOMPARE(level->cellSizeLog2, 8);
+    QCOMPARE(level->nrCellsX, 1);
+    QCOMPARE(level->nrCellsY, 1);
+    QVERIFY(level->covered[0]);
+    // The value 4 covers less area because of the hole
+    QCOMPARE(level->mode[0], 2);
+    const double area2 = 128 * 256, area4 = 128 * 256 - 64 * 64;
+    QCOMPARE(level->mean[0], float((2 * area2 + 4 * area4) / (area2 + area4)));
+    QCOMPARE(level->meanPerPixel[0], float((2 * area2 + 4 * area4) / (area2 + area4) / 64));
+
+    QVERIFY(lod.getMemorySize() > 0);
+}
+
+// 8x8 vectors in a 64x64 area. The left half points right and the right half points up.
+void levelOfDetailTest::testVectorLevels()
+{
+    statisticsData data;
+    for (int y = 0; y < 64; y += 8)
+        for (int x = 0; x < 64; x += 8)
+        {
+            if (x < 32)
+                data.addBlockVector(x, y, 8, 8, 4, 0);
+            else
+                data.addBlockVector(x, y, 8, 8, 0, -8);
+        }
+    // Lines are not part of the levels
+    data.addLine(0, 0, 64, 64, 100, 100, 200, 200);
+    data.buildIndex();
+    const statisticsLevelOfDetail &lod = data.levelOfDetail;
+
+    QVERIFY(lod.hasVectorLines());
+    QVERIFY(lod.getVectorLevel(3) == nullptr);
+
+    const statisticsLevelOfDetail::vectorLevel *level = lod.getVectorLevel(4);
+    QVERIFY(level != nullptr);
+    QCOMPARE(level->nrCellsX, 4);
+    QCOMPARE(level->nrCellsY, 4);
+    for (int idx = 0; idx < 16; idx++)
+    {
+        QVERIFY(level->covered[idx]);
+        QCOMPARE(level->vector[idx], (idx % 4 < 2) ? QPoint(4, 0) : QPoint(0, -8));
+    }
+
+    level = lod.getVectorLevel(6);
+    QVERIFY(level != nullptr);
+    QCOMPARE(level->nrCellsX, 1);
+    QCOMPARE(level->vector[0], QPoint(2, -4));
+}
+
+void levelOfDetailTest::testNoLevels()
+{
+    // A single block is always cheaper to draw than any level
+    statisticsData data;
+    data.addBlockValue(0, 0, 64, 64, 1);
+    data.addBlockVector(0, 0, 64, 64, 1, 1);
+    data.buildIndex();
+    for (int cellSizeLog2 = 0; cellSizeLog2 < 10; cellSizeLog2++)
+    {
+        QVERIFY(data.levelOfDetail.getValueLevel(cellSizeLog2) == nullptr);
+        QVERIFY(data.levelOfDetail.getVectorLevel(cellSizeLog2) == nullptr);
+    }
+    QVERIFY(!data.levelOfDetail.hasVectorLines());
+
+    statisticsData empty;
+    empty.buildIndex();
+    QVERIFY(empty.levelOfDetail.getValueLevel(10) == nullptr);
+    QVERIFY(empty.levelOfDetail.getVectorLevel(10) == nullptr);
+}
+
+QTEST_MAIN(levelOfDetailTest)
+
+#include "tst_levelOfDetail.moc"
@@ -0,0 +1,3 @@
+TEMPLATE = subdirs
+
+SUBDIRS = binaryFormat blockIndex fileIndexer levelOfDetail vtmbmsLexer
@@ -0,0 +1,126 @@
+#include <QtTest>
+
+#include <statistics/statisticsVTMBMSLexer.h>
+
+class vtmbmsLexerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testCompareToRegex_data();
+    void testCompareToRegex();
+    void testNoBlockStatistics();
+};
+
+void vtmbmsLexerTest::testCompareToRegex_data()
+{
+    QTest::addColumn<QString>("line");
+
+    QTest::newRow("scalar") << "BlockStat: POC 1 @( 112,  88) [ 8x 8] PredMode=0";
+    QTest::newRow("scalarNegative") << "BlockStat: POC 12 @(   0,   0) [128x128] QP=-4";
+    QTest::newRow("vector") << "BlockStat: POC 1 @( 120,  80) [ 8x 8] MVL0={ -24,  -2}";
+    QTest::newRow("affine") << "BlockStat: POC 2 @( 192,  96) [64x32] AffineMVL0={-324,-116,-276,-116,-324, -92}";
+    QTest::newRow("line") << "BlockStat: POC 2 @( 192,  96) [64x32] Line={0,0,31,31}";
+    QTest::newRow("polygon3") << "BlockStat: POC 2 @[(505, 384)--(511, 384)--(511, 415)--] GeoPUInterIntraFlag=0";
+    QTest::newRow("polygon4") << "BlockStat: POC 2 @[(416, 448)--(447, 448)--(447, 478)--(416, 463)--] GeoPUInterIntraFlag=1";
+    QTest::newRow("polygonVector") << "BlockStat: POC 3 @[(0, 0)--(15, 0)--(0, 15)--] GeoMVL0={ 4, -8}";
+}
+
+// Parse the line with the regular expressions that were used to parse VTM BMS files before the lexer existed
+// and compare the captured values with the output of the lexer.
+void vtmbmsLexerTest::testCompareToRegex()
+{
+    QFETCH(QString, line);
+
+    const QByteArray lineData = line.toLatin1();
+    statisticsVTMBMSLexer::blockStat stat;
+    QVERIFY(statisticsVTMBMSLexer::parseLine(lineData.constData(), lineData.size(), stat));
+
+    int poc;
+    QVERIFY(statisticsVTMBMSLexer::parsePOC(lineData.constData(), lineData.size(), poc));
+    QCOMPARE(poc, stat.poc);
+
+    QRegularExpression pocRegex("BlockStat: POC ([0-9]+)");
+    QCOMPARE(stat.poc, pocRegex.match(line).captured(1).toInt());
+
+    const QString name = QString::fromLatin1(stat.name, stat.nameLength);
+    QVERIFY(QRegularExpression(" " + name + "=").match(line).hasMatch());
+
+    QRegularExpression scalarRegex("POC ([0-9]+) @\\( *([0-9]+), *([0-9]+)\\) *\\[ *([0-9]+)x *([0-9]+)\\] *\\w+=([0-9\\-]+)");
+    QRegularExpression vectorRegex("POC ([0-9]+) @\\( *([0-9]+), *([0-9]+)\\) *\\[ *([0-9]+)x *([0-9]+)\\] *\\w+={ *([0-9\\-]+), *([0-9\\-]+)}");
+    QRegularExpression affineTFRegex("POC ([0-9]+) @\\( *([0-9]+), *([0-9]+)\\) *\\[ *([0-9]+)x *([0-9]+)\\] *\\w+={ *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+)}");
+    QRegularExpression lineRegex("POC ([0-9]+) @\\( *([0-9]+), *([0-9]+)\\) *\\[ *([0-9]+)x *([0-9]+)\\] *\\w+={ *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+)}");
+    QRegularExpression scalarPolygonRegex("POC ([0-9]+) @\\[((?:\\( *[0-9]+, *[0-9]+\\)--){3,5})\\] *\\w+=([0-9\\-]+)");
+    QRegularExpression vectorPolygonRegex("POC ([0-9]+) @\\[((?:\\( *[0-9]+, *[0-9]+\\)--){3,5})\\] *\\w+={ *([0-9\\-]+), *([0-9\\-]+)}");
+
+    QRegularExpressionMatch match;
+    if (!stat.isPolygon)
+    {
+        if (!stat.isList)
+            match = scalarRegex.match(line);
+        else if (stat.nrValues == 2)
+            match = vectorRegex.match(line);
+        else if (stat.nrValues == 4)
+            match = lineRegex.match(line);
+        else if (stat.nrValues == 6)
+            match = affineTFRegex.match(line);
+        QVERIFY(match.hasMatch());
+        QCOMPARE(stat.posX, match.captured(2).toInt());
+        QCOMPARE(stat.posY, match.captured(3).toInt());
+        QCOMPARE(stat.width, match.captured(4).toInt());
+        QCOMPARE(stat.height, match.captured(5).toInt());
+        for (int i = 0; i < stat.nrValues; i++)
+            QCOMPARE(stat.values[i], match.captured(6 + i).toInt());
+    }
+    else
+    {
+        match = stat.isList ? vectorPolygonRegex.match(line) : scalarPolygonRegex.match(line);
+        QVERIFY(match.hasMatch());
+
+        QRegularExpression cornerRegex("\\( *([0-9]+), *([0-9]+)\\)");
+        QStringList cornerList = match.captured(2).split("--", QString::SkipEmptyParts);
+        QCOMPARE(stat.nrPolygonPoints, cornerList.size());
+        for (int i = 0; i < cornerList.size(); i++)
+        {
+            QRegularExpressionMatch cornerMatch = cornerRegex.match(cornerList[i]);
+            QVERIFY(cornerMatch.hasMatch());
+            QCOMPARE(stat.polygonPoints[i].x(), cornerMatch.captured(1).toInt());
+            QCOMPARE(stat.polygonPoints[i].y(), cornerMatch.captured(2).toInt());
+        }
+        for (int i = 0; i < stat.nrValues; i++)
+            QCOMPARE(stat.values[i], match.captured(3 + i).toInt());
+    }
+}
+
+void vtmbmsLexerTest::testNoBlockStatistics()
+{
+    const char *lines[] = {
+        "# Sequence size: [832x 480]",
+        "BlockStat: POC x @( 112,  88) [ 8x 8] PredMode=0",
+        "BlockStat: POC 1 @( 112,  88) [ 8x 8]",
+        "BlockStat: POC 1 @[(505, 384)--(511, 384)--] GeoPUInterIntraFlag=0",
+        "BlockStat: POC 1 @( 120,  80) [ 8x 8] MVL0={ -24,  -2"
+    };
+
+    int poc = -1;
+    QVERIFY(!statisticsVTMBMSLexer::parsePOC(lines[0], int(strlen(lines[0])), poc));
+    QVERIFY(!statisticsVTMBMSLexer::parsePOC(lines[1], int(strlen(lines[1])), poc));
+    statisticsVTMBMSLexer::blockStat stat;
+    for (const char *line : lines)
+        QVERIFY(!statisticsVTMBMSLexer::parseLine(line, int(strlen(line)), stat));
+
+    // The name can still be found so that errors are only reported for the types that are loaded
+    const char *name;
+    int nameLength;
+    QVERIFY(!statisticsVTMBMSLexer::parseName(lines[2], int(strlen(lines[2])), name, nameLength));
+    QVERIFY(statisticsVTMBMSLexer::parseName(lines[1], int(strlen(lines[1])), name, nameLength));
+    QCOMPARE(QByteArray(name, nameLength), QByteArray("PredMode"));
+    QVERIFY(statisticsVTMBMSLexer::parseName(lines[3], int(strlen(lines[3])), name, nameLength));
+    QCOMPARE(QByteArray(name, nameLength), QByteArray("GeoPUInterIntraFlag"));
+    QVERIFY(statisticsVTMBMSLexer::parseName(lines[4], int(strlen(lines[4])), name, nameLength));
+    QCOMPARE(QByteArray(name, nameLength), QByteArray("MVL0"));
+}
+
+QTEST_MAIN(vtmbmsLexerTest)
+
+#include "tst_vtmbmsLexer.moc"
@@ -0,0 +1,123 @@
+#include <QtTest>
+
+#include <video/decodedFrameWindow.h>
+
+class decodedFrameWindowTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testAddFrames_data();
+    void testAddFrames();
+    void testSetMaxMemory();
+};
+
+void decodedFrameWindowTest::testAddFrames_data()
+{
+    QTest::addColumn<int>("maxMemory");
+    QTest::addColumn<int>("windowStart");
+    QTest::addColumn<int>("windowNrFrames");
+    QTest::addColumn<int>("currentFrame");
+    QTest::addColumn<int>("addStart");
+    QTest::addColumn<int>("addNrFrames");
+    QTest::addColumn<int>("addFrameSize");
+    QTest::addColumn<bool>("extendOnly");
+    QTest::addColumn<int>("rangeFirst");
+    QTest::addColumn<int>("rangeLast");
+    QTest::addColumn<int>("memoryUsage");
+
+    // The window initially holds windowNrFrames frames of 100 bytes. The currentFrame (if not -1) is set before
+    // adding the new frames.
+    QTest::newRow("emptyWindow") << 1000 << 0 << 0 << -1 << 10 << 4 << 100 << false << 10 << 13 << 400;
+    // Adjoining frames extend the window
+    QTest::newRow("adjoiningBefore") << 1000 << 10 << 4 << -1 << 6 << 4 << 100 << false << 6 << 13 << 800;
+    QTest::newRow("adjoiningAfter") << 1000 << 10 << 4 << -1 << 14 << 2 << 100 << false << 10 << 15 << 600;
+    // Frames that don't adjoin the window are only added if the window may be replaced
+    QTest::newRow("elsewhereExtendOnly") << 1000 << 10 << 4 << -1 << 2 << 4 << 100 << true << 10 << 13 << 400;
+    QTest::newRow("elsewhere") << 1000 << 10 << 4 << -1 << 2 << 4 << 100 << false << 2 << 5 << 400;
+    // Frames that were decoded again replace the ones in the window and are not counted twice
+    QTest::newRow("replaceFrames") << 1000 << 10 << 4 << -1 << 12 << 3 << 50 << false << 10 << 14 << 350;
+    // To add the GOP before the window, the frames after the current frame are dropped (from the last one on)
+    QTest::newRow("dropFramesAfterCurrent") << 400 << 10 << 4 << 11 << 8 << 2 << 100 << false << 8 << 11 << 400;
+    // Nothing after the current frame is left. The lower frames are not added and the window stays consecutive.
+    QTest::newRow("noFramesAfterCurrent") << 400 << 8 << 4 << 11 << 5 << 3 << 100 << false << 8 << 11 << 400;
+    // Frames are added from the last one on until the limit is reached
+    QTest::newRow("keepCurrentFrame") << 400 << 0 << 0 << 13 << 8 << 6 << 100 << false << 10 << 13 << 400;
+}
+
+void decodedFrameWindowTest::testAddFrames()
+{
+    QFETCH(int, maxMemory);
+    QFETCH(int, windowStart);
+    QFETCH(int, windowNrFrames);
+    QFETCH(int, currentFrame);
+    QFETCH(int, addStart);
+    QFETCH(int, addNrFrames);
+    QFETCH(int, addFrameSize);
+    QFETCH(bool, extendOnly);
+    QFETCH(int, rangeFirst);
+    QFETCH(int, rangeLast);
+    QFETCH(int, memoryUsage);
+
+    // The first byte of each frame is its index
+    auto createFrames = [](int startFrameIdx, int nrFrames, int frameSize)
+    {
+        QList<decodedFrameWindow::frame> frames;
+        for (int i = 0; i < nrFrames; i++)
+        {
+            decodedFrameWindow::frame f;
+            f.rawData = QByteArray(frameSize, 0);
+            f.rawData[0] = char(startFrameIdx + i);
+            f.nrBytes = frameSize;
+            frames.append(f);
+        }
+        return frames;
+    };
+
+    decodedFrameWindow window(maxMemory);
+    QCOMPARE(window.getRange(), indexRange(-1, -1));
+    window.addFrames(windowStart, createFrames(windowStart, windowNrFrames, 100));
+    if (currentFrame != -1)
+        window.setCurrentFrame(currentFrame);
+
+    window.addFrames(addStart, createFrames(addStart, addNrFrames, addFrameSize), extendOnly);
+    QCOMPARE(window.getRange(), indexRange(rangeFirst, rangeLast));
+    QCOMPARE(window.getMemoryUsage(), int64_t(memoryUsage));
+
+    decodedFrameWindow::frame f;
+    for (int frameIdx = rangeFirst; frameIdx <= rangeLast; frameIdx++)
+    {
+        QVERIFY(window.getFrame(frameIdx, f));
+        QCOMPARE(int(f.rawData.at(0)), frameIdx);
+    }
+    QVERIFY(!window.getFrame(rangeFirst - 1, f));
+    QVERIFY(!window.contains(rangeLast + 1));
+}
+
+void decodedFrameWindowTest::testSetMaxMemory()
+{
+    QList<decodedFrameWindow::frame> frames;
+    for (int i = 0; i < 8; i++)
+    {
+        decodedFrameWindow::frame f;
+        f.rawData = QByteArray(100, char(10 + i));
+        f.nrBytes = 100;
+        frames.append(f);
+    }
+
+    decodedFrameWindow window(1000);
+    window.addFrames(10, frames);
+    window.setCurrentFrame(12);
+
+    window.setMaxMemory(500);
+    QCOMPARE(window.getRange(), indexRange(10, 14));
+    QCOMPARE(window.getMemoryUsage(), int64_t(500));
+
+    window.clear();
+    QCOMPARE(window.getRange(), indexRange(-1, -1));
+    QCOMPARE(window.getMemoryUsage(), int64_t(0));
+}
+
+QTEST_MAIN(decodedFrameWindowTest)
+
+#include "tst_decodedFrameWindow.moc"